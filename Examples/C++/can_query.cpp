@@ -0,0 +1,150 @@
+//
+//  can_query.cpp
+//  PCANBasic-Wrapper
+//  Query binary trace files by time range and identifiers (PeakCAN_Tracefile.h)
+//  Library: u3canpcb.dll, libUVCANPCB.dylib, libuvcanpcb.so
+//
+//  Usage: can_query [--from=<time>] [--until=<time>] [--id=<id>]... <file>...
+//
+//  A time is given in seconds of the time-stamps (e.g. 1234.5), or as time
+//  of day (e.g. 14:02:10) when the time-stamps are wall-clock time. With the
+//  index of a compact trace file only blocks that could hold a matching
+//  record are read.
+//
+#ifdef _MSC_VER
+//no Microsoft extensions please!
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 1
+#endif
+#endif
+#include <iostream>
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#define OPTION_CANAPI_DRIVER  1
+#include "PeakCAN_Tracefile.h"
+
+static bool time_arg(const char *arg, const can_trc_header_t &header, uint64_t &nsec);
+
+int main(int argc, const char * argv[]) {
+    can_trc_query_t query = {};
+    query.until = UINT64_MAX;
+    const char *from = NULL, *until = NULL;
+    int files = 0, result = 0;
+    char *end;
+
+    // options: time range and identifiers
+    for (int i = 1; i < argc; i++) {
+        if (!strncmp(argv[i], "--from=", 7))
+            from = &argv[i][7];
+        else if (!strncmp(argv[i], "--until=", 8))
+            until = &argv[i][8];
+        else if (!strncmp(argv[i], "--id=", 5)) {
+            if (query.count >= CANTRC_QUERY_IDS) {
+                std::cerr << "+++ error: too many identifiers (max. " << CANTRC_QUERY_IDS << ")" << std::endl;
+                return 1;
+            }
+            query.ids[query.count++] = (uint32_t)strtoul(&argv[i][5], &end, 0);
+            if (*end != '\0') {
+                std::cerr << "+++ error: illegal identifier '" << &argv[i][5] << "'" << std::endl;
+                return 1;
+            }
+        }
+        else if (argv[i][0] == '-') {
+            std::cerr << "Usage: " << argv[0] << " [--from=<time>] [--until=<time>] [--id=<id>]... <file>..." << std::endl;
+            return 1;
+        }
+        else
+            files++;
+    }
+    if (!files) {
+        std::cerr << "Usage: " << argv[0] << " [--from=<time>] [--until=<time>] [--id=<id>]... <file>..." << std::endl;
+        return 1;
+    }
+    // trace files: one after the other (e.g. the segments of a trace session)
+    for (int i = 1; (i < argc) && !result; i++) {
+        can_trc_reader_t *reader = NULL;
+        can_trc_header_t header = {};
+        can_trc_record_t record = {};
+        can_trc_stats_t stats = {};
+        if (argv[i][0] == '-')
+            continue;
+        if ((result = can_trc_open(argv[i], &reader)) != CANERR_NOERROR) {
+            std::cerr << "+++ error: trace file '" << argv[i] << "' could not be opened (" << result << ")" << std::endl;
+            break;
+        }
+        (void)can_trc_header(reader, &header);
+        const char *illegal = (from && !time_arg(from, header, query.from)) ? from :
+                              (until && !time_arg(until, header, query.until)) ? until : NULL;
+        if (illegal) {
+            std::cerr << "+++ error: illegal time '" << illegal << "'" << std::endl;
+            (void)can_trc_close(reader);
+            result = 1;
+            break;
+        }
+        auto start = std::chrono::steady_clock::now();
+        if ((result = can_trc_query(reader, &query)) == CANERR_NOERROR) {
+            while ((result = can_trc_read(reader, &record)) == CANERR_NOERROR) {
+                fprintf(stdout, "%llu.%09u\t", (unsigned long long)(record.nsec / 1000000000ull), (unsigned int)(record.nsec % 1000000000ull));
+                fprintf(stdout, "%s\t", (record.flags & CANTRC_FLAG_TX) ? "Tx" : "Rx");
+                fprintf(stdout, (record.flags & CANTRC_FLAG_XTD) ? "%08X\t" : "%03X\t", record.id);
+                if (!(record.flags & CANTRC_FLAG_STS)) {
+                    fputc((record.flags & CANTRC_FLAG_XTD) ? 'X' : 'S', stdout);
+                    fputc((record.flags & CANTRC_FLAG_FDF) ? 'F' : '-', stdout);
+                    fputc((record.flags & CANTRC_FLAG_BRS) ? 'B' : '-', stdout);
+                    fputc((record.flags & CANTRC_FLAG_ESI) ? 'E' : '-', stdout);
+                    fputc((record.flags & CANTRC_FLAG_RTR) ? 'R' : '-', stdout);
+                } else {
+                    fprintf(stdout, "Error");
+                }
+                fprintf(stdout, " [%u]", record.len);
+                for (uint8_t j = 0; j < record.len; j++)
+                    fprintf(stdout, " %02X", record.data[j]);
+                fprintf(stdout, "\n");
+            }
+            if (result == CANERR_RX_EMPTY)
+                result = CANERR_NOERROR;
+            else
+                std::cerr << "+++ error: trace file '" << argv[i] << "' is corrupted (" << result << ")" << std::endl;
+        }
+        auto stop = std::chrono::steady_clock::now();
+        (void)can_trc_stats(reader, &stats);
+        (void)can_trc_close(reader);
+        fprintf(stderr, "%s: %llu of %llu records, %u blocks read, %u of %u blocks skipped (%s), %.3f ms\n", argv[i],
+                (unsigned long long)stats.matched, (unsigned long long)stats.records, stats.read, stats.skipped, stats.blocks,
+                stats.blocks ? "indexed" : "no index", std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    return result;
+}
+
+static bool time_arg(const char *arg, const can_trc_header_t &header, uint64_t &nsec) {
+    unsigned int hh, mm;
+    double ss;
+    char *end;
+
+    // time of day: on the day of the trace session (wall-clock time-stamps only)
+    if (strchr(arg, ':')) {
+        if ((header.time_mode != PCAN_TIME_REALTIME) ||
+            (sscanf(arg, "%u:%u:%lf", &hh, &mm, &ss) != 3) || (hh > 23U) || (mm > 59U) || (ss < 0.0) || (ss >= 61.0))
+            return false;
+        time_t start = (time_t)(header.start / 1000000ull);
+        struct tm tm = *localtime(&start);
+        tm.tm_hour = (int)hh;
+        tm.tm_min = (int)mm;
+        tm.tm_sec = 0;
+        tm.tm_isdst = -1;
+        time_t day = mktime(&tm);
+        if (day == (time_t)-1)
+            return false;
+        nsec = ((uint64_t)day * 1000000000ull) + (uint64_t)(ss * 1000000000.0);
+        return true;
+    }
+    // seconds of the time-stamps
+    double sec = strtod(arg, &end);
+    if ((*end != '\0') || (sec < 0.0))
+        return false;
+    nsec = (uint64_t)(sec * 1000000000.0);
+    return true;
+}
@@ -118,65 +118,84 @@
 /*  -----------  types  --------------------------------------------------
  */
 
+struct msg_formatter_t_ {               /* message formatter (context): */
+    msg_format_t format;                /*   message output format {DEFAULT, ...} */
+    struct {                            /*   format option: */
+        msg_fmt_timestamp_t  time_stamp;    /* time-stamp {ZERO, ABS, REL} */
+        msg_fmt_option_t     time_usec;     /* time-stamp in usec {OFF, ON} */
+        msg_fmt_time_t       time_format;   /* time format {TIME, SEC, DJD} */
+        msg_fmt_number_t     id;            /* identifier {HEX, DEC, OCT, BIN} */
+        msg_fmt_option_t     id_xtd;        /* extended identifier {OFF, ON} */
+        msg_fmt_number_t     dlc;           /* DLC/length {HEX, DEC, OCT, BIN} */
+        msg_fmt_canfd_t      dlc_format;    /* CAN FD format {DLC, LENGTH} */
+        int                  dlc_brackets;  /* DLC in brackets {'\0', '(', '['} */
+        msg_fmt_option_t     flags;         /* message flags {ON, OFF} */
+        msg_fmt_number_t     data;          /* message data {HEX, DEC, OCT, BIN} */
+        msg_fmt_option_t     ascii;         /* data as ASCII {ON, OFF} */
+        int                  ascii_subst;   /* substitute for non-printables */
+        msg_fmt_option_t     channel;       /* message source {OFF, ON} */
+        msg_fmt_option_t     counter;       /* message counter {ON, OFF} */
+        msg_fmt_separator_t  separator;     /* separator {SPACES, TABS} */
+        msg_fmt_wraparound_t wraparound;    /* wraparound {NO, 8, 16, 32, 64} */
+        msg_fmt_option_t     end_of_line;   /* end-of-line character {ON, OFF} */
+        char                 rx_prompt[6+1];/* prompt for received messages */
+        char                 tx_prompt[6+1];/* prompt for sent messages */
+    } option;
+    struct {                            /*   time-stamp reference: */
+        msg_timestamp_t      last;          /* first (ZERO) or previous (REL) time-stamp */
+        int                  first;         /* no time-stamp formatted so far */
+    } stamp;
+};
+
 
 /*  -----------  prototypes  ---------------------------------------------
  */
 
-static void format_time(char *string, const msg_message_t *message);
-static void format_id(char *string, const msg_message_t *message);
-static void format_dlc(char *string, const msg_message_t *message);
-static void format_data(char *string, const msg_message_t *message, int ascii, int indent);
-static void format_ascii(char *string, const msg_message_t *message);
-static void format_data_byte(char *string, unsigned char data);
-static void format_data_ascii(char *string, unsigned char data);
-static void format_fill_byte(char *string);
+static void format_time(char *string, msg_formatter_t *formatter, const msg_message_t *message);
+static void format_id(char *string, const msg_formatter_t *formatter, const msg_message_t *message);
+static void format_flags(char *string, const msg_message_t *message);
+static void format_dlc(char *string, const msg_formatter_t *formatter, const msg_message_t *message);
+static void format_data(char *string, const msg_formatter_t *formatter, const msg_message_t *message, int ascii, int indent);
+static void format_ascii(char *string, const msg_formatter_t *formatter, const msg_message_t *message);
+static void format_data_byte(char *string, const msg_formatter_t *formatter, unsigned char data);
+static void format_data_ascii(char *string, const msg_formatter_t *formatter, unsigned char data);
+static void format_fill_byte(char *string, const msg_formatter_t *formatter);
+static char *format_result(char *buffer, size_t length, const char *string);
 
 
 /*  -----------  variables  ----------------------------------------------
  */
 
-static struct {                         /* format option: */
-    msg_fmt_timestamp_t  time_stamp;    /*   time-stamp {ZERO, ABS, REL} */
-    msg_fmt_option_t     time_usec;     /*   time-stamp in usec {OFF, ON} */
-    msg_fmt_time_t       time_format;   /*   time format {TIME, SEC, DJD} */
-    msg_fmt_number_t     id;            /*   identifier {HEX, DEC, OCT, BIN} */
-    msg_fmt_option_t     id_xtd;        /*   extended identifier {OFF, ON} */
-    msg_fmt_number_t     dlc;           /*   DLC/length {HEX, DEC, OCT, BIN} */
-    msg_fmt_canfd_t      dlc_format;    /*   CAN FD format {DLC, LENGTH} */
-    int                  dlc_brackets;  /*   DLC in brackets {'\0', '(', '['} */
-    msg_fmt_option_t     flags;         /*   message flags {ON, OFF} */
-    msg_fmt_number_t     data;          /*   message data {HEX, DEC, OCT, BIN} */
-    msg_fmt_option_t     ascii;         /*   data as ASCII {ON, OFF} */
-    int                  ascii_subst;   /*   substitute for non-printables */
-    msg_fmt_option_t     channel;       /*   message source {OFF, ON} */
-    msg_fmt_option_t     counter;       /*   message counter {ON, OFF} */
-    msg_fmt_separator_t  separator;     /*   separator {SPACES, TABS} */
-    msg_fmt_wraparound_t wraparound;    /*   wraparound {NO, 8, 16, 32, 64} */
-    msg_fmt_option_t     end_of_line;   /*   end-of-line character {ON, OFF} */
-    char                 rx_prompt[6+1];/*   prompt for received messages */
-    char                 tx_prompt[6+1];/*   prompt for sent messages */
-}   msg_option = {
-                        .time_stamp = MSG_FMT_TIMESTAMP_ZERO,
-                        .time_usec = MSG_FMT_OPTION_OFF,
-                        .time_format = MSG_FMT_TIME_SEC,
-                        .id = MSG_FMT_NUMBER_HEX,
-                        .id_xtd = MSG_FMT_OPTION_OFF,
-                        .dlc = MSG_FMT_NUMBER_DEC,
-                        .dlc_format = MSG_FMT_CANFD_LENGTH,
-                        .dlc_brackets = '\0',
-                        .flags = MSG_FMT_OPTION_ON,
-                        .data = MSG_FMT_NUMBER_HEX,
-                        .ascii = MSG_FMT_OPTION_ON,
-                        .ascii_subst = '.',
-                        .channel = MSG_FMT_OPTION_OFF,
-                        .counter = MSG_FMT_OPTION_ON,
-                        .separator = MSG_FMT_SEPARATOR_SPACES,
-                        .wraparound = MSG_FMT_WRAPAROUND_NO,
-                        .end_of_line = MSG_FMT_OPTION_OFF,
-                        .rx_prompt = "",
-                        .tx_prompt = ""
-};
-static msg_format_t msg_format = MSG_FORMAT_DEFAULT;
+#define MSG_FORMATTER_INIT  { \
+    .format = MSG_FORMAT_DEFAULT, \
+    .option = { \
+        .time_stamp = MSG_FMT_TIMESTAMP_ZERO, \
+        .time_usec = MSG_FMT_OPTION_OFF, \
+        .time_format = MSG_FMT_TIME_SEC, \
+        .id = MSG_FMT_NUMBER_HEX, \
+        .id_xtd = MSG_FMT_OPTION_OFF, \
+        .dlc = MSG_FMT_NUMBER_DEC, \
+        .dlc_format = MSG_FMT_CANFD_LENGTH, \
+        .dlc_brackets = '\0', \
+        .flags = MSG_FMT_OPTION_ON, \
+        .data = MSG_FMT_NUMBER_HEX, \
+        .ascii = MSG_FMT_OPTION_ON, \
+        .ascii_subst = '.', \
+        .channel = MSG_FMT_OPTION_OFF, \
+        .counter = MSG_FMT_OPTION_ON, \
+        .separator = MSG_FMT_SEPARATOR_SPACES, \
+        .wraparound = MSG_FMT_WRAPAROUND_NO, \
+        .end_of_line = MSG_FMT_OPTION_OFF, \
+        .rx_prompt = "", \
+        .tx_prompt = "" \
+    }, \
+    .stamp = { \
+        .last = { 0, 0 }, \
+        .first = 1 \
+    } \
+}
+static const msg_formatter_t msg_initial = MSG_FORMATTER_INIT;
+static msg_formatter_t msg_default = MSG_FORMATTER_INIT;  /* context of the legacy API */
 static char msg_string[MSG_STRING_LENGTH] = "";
 static const unsigned char dlc_table[16] = {
     0U,1U,2U,3U,4U,5U,6U,7U,8U,12U,16U,20U,24U,32U,48U,64U
@@ -186,190 +205,341 @@ static const unsigned char dlc_table[16] = {
 /*  -----------  functions  ----------------------------------------------
  */
 
+/* legacy API: default formatter and static result string (not reentrant) */
 char *msg_format_message(const msg_message_t *message, msg_direction_t direction,
                                msg_counter_t counter, msg_channel_t channel)
 {
-    char tmp_string[MSG_STRING_LENGTH];
+    msg_string[0] = '\0';
+    (void)msg_format_message_r(&msg_default, message, direction, channel, counter, msg_string, sizeof(msg_string));
+    return msg_string;
+}
 
-    memset(msg_string, 0, sizeof(msg_string));
+char *msg_format_time(const msg_message_t *message)
+{
+    msg_string[0] = '\0';
+    (void)msg_format_time_r(&msg_default, message, msg_string, sizeof(msg_string));
+    return msg_string;
+}
 
-    if (message) {
-        /* prompt (optional) */
-        if (strlen(msg_option.tx_prompt) && (direction == MSG_TX_MESSAGE)) {
-            strcat(msg_string, msg_option.tx_prompt);
-            strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : " ");
-        }
-        else if (strlen(msg_option.rx_prompt)) { /* defaults to MSG_DIRECTION_RX_MSG */
-            strcat(msg_string, msg_option.rx_prompt);
-            strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : " ");
-        }
-        /* counter (optional) */
-        if ((msg_option.counter != MSG_FMT_OPTION_OFF) && ((msg_option.separator == MSG_FMT_SEPARATOR_TABS))) {
-            sprintf(tmp_string, "%" PRIu64 "\t", counter);
-            strcat(msg_string, tmp_string);
-        }
-        else if (msg_option.counter != MSG_FMT_OPTION_OFF) { /* defaults to MSG_FMT_SEPARATOR_SPACES */
-            sprintf(tmp_string, "%-7" PRIu64 "  ", counter);
-            strcat(msg_string, tmp_string);
-        }
-        /* time-stamp (abs/rel/zero) (hhmmss/sec/DJD).(msec/usec) */
-        format_time(tmp_string, message);
-        strcat(msg_string, tmp_string);
-        strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : "  ");
-
-        /* channel (optional) */
-        if ((msg_option.channel != MSG_FMT_OPTION_OFF) && (msg_option.separator == MSG_FMT_SEPARATOR_TABS)) {
-            sprintf(tmp_string, "%i\t", channel);
-            strcat(msg_string, tmp_string);
-        }
-        else if (msg_option.channel != MSG_FMT_OPTION_OFF) { /* defaults to MSG_FMT_SEPARATOR_SPACES */
-            sprintf(tmp_string, "%-2i  ", channel);
-            strcat(msg_string, tmp_string);
-        }
-        /* identifier (hex/dec/oct) */
-        format_id(tmp_string, message);
-        strcat(msg_string, tmp_string);
-        strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : "  ");
+char *msg_format_id(const msg_message_t *message)
+{
+    msg_string[0] = '\0';
+    (void)msg_format_id_r(&msg_default, message, msg_string, sizeof(msg_string));
+    return msg_string;
+}
 
-        /* flags (optional) */
-        if (msg_option.flags != MSG_FMT_OPTION_OFF) {
-#if (OPTION_CAN_2_0_ONLY == 0)
-            if (!message->sts) {
-                strcat(msg_string, message->xtd ? "X" : "S");
-                strcat(msg_string, message->fdf ? "F" : "-");
-                strcat(msg_string, message->brs ? "B" : "-");
-                strcat(msg_string, message->esi ? "E" : "-");
-                strcat(msg_string, message->rtr ? "R" : "-");
-            }
-            else {
-                strcat(msg_string, "Error");
-            }
-#else
-            if (!message->sts) {
-                strcat(msg_string, message->xtd ? "X" : "S");
-                strcat(msg_string, message->rtr ? "R" : "-");
-            }
-            else {
-                strcat(msg_string, "E!");
-            }
-#endif
-            strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : " ");  /* only one space! */
-        }
-        /* dlc/length (hex/dec/oct) */
-        format_dlc(tmp_string, message);
-        strcat(msg_string, tmp_string);
-
-        /* data (hex/dec/oct) plus ascii (optional) */
-        if (message->dlc && !message->rtr) {
-            strcat(msg_string, (msg_option.separator == MSG_FMT_SEPARATOR_TABS) ? "\t" : "  ");
-            format_data(tmp_string, message, (msg_option.ascii == MSG_FMT_OPTION_OFF) ? 0 : 1, (int)strlen(msg_string));
-            strcat(msg_string, tmp_string);
-        }
-        /* end-of-line (optional) */
-        if (msg_option.end_of_line) {
-            strcat(msg_string, "\n");
-        }
-    }
+char *msg_format_flags(const msg_message_t *message)
+{
+    msg_string[0] = '\0';
+    (void)msg_format_flags_r(&msg_default, message, msg_string, sizeof(msg_string));
     return msg_string;
 }
 
-char *msg_format_time(const msg_message_t *message)
+char *msg_format_dlc(const msg_message_t *message)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    msg_string[0] = '\0';
+    (void)msg_format_dlc_r(&msg_default, message, msg_string, sizeof(msg_string));
+    return msg_string;
+}
 
-    if (message) {
-        /* time-stamp (abs/rel/zero) (hhmmss/sec/DJD).(msec/usec) */
-        format_time(msg_string, message);
-    }
+char *msg_format_data(const msg_message_t *message)
+{
+    msg_string[0] = '\0';
+    (void)msg_format_data_r(&msg_default, message, msg_string, sizeof(msg_string));
     return msg_string;
 }
 
-char *msg_format_id(const msg_message_t *message)
+char *msg_format_ascii(const msg_message_t *message)
+{
+    msg_string[0] = '\0';
+    (void)msg_format_ascii_r(&msg_default, message, msg_string, sizeof(msg_string));
+    return msg_string;
+}
+
+int msg_set_format(msg_format_t format)
+{
+    return msg_set_format_r(&msg_default, format);
+}
+
+int msg_set_fmt_time_stamp(msg_fmt_timestamp_t option)
+{
+    return msg_set_fmt_time_stamp_r(&msg_default, option);
+}
+
+int msg_set_fmt_time_usec(msg_fmt_option_t option)
+{
+    return msg_set_fmt_time_usec_r(&msg_default, option);
+}
+
+int msg_set_fmt_time_format(msg_fmt_time_t option)
+{
+    return msg_set_fmt_time_format_r(&msg_default, option);
+}
+
+int msg_set_fmt_id(msg_fmt_number_t option)
+{
+    return msg_set_fmt_id_r(&msg_default, option);
+}
+
+int msg_set_fmt_id_xtd(msg_fmt_option_t option)
+{
+    return msg_set_fmt_id_xtd_r(&msg_default, option);
+}
+
+int msg_set_fmt_dlc(msg_fmt_number_t option)
+{
+    return msg_set_fmt_dlc_r(&msg_default, option);
+}
+
+int msg_set_fmt_dlc_format(msg_fmt_canfd_t option)
+{
+    return msg_set_fmt_dlc_format_r(&msg_default, option);
+}
+
+int msg_set_fmt_dlc_brackets(int option)
+{
+    return msg_set_fmt_dlc_brackets_r(&msg_default, option);
+}
+
+int msg_set_fmt_flags(msg_fmt_option_t option)
+{
+    return msg_set_fmt_flags_r(&msg_default, option);
+}
+
+int msg_set_fmt_data(msg_fmt_number_t option)
+{
+    return msg_set_fmt_data_r(&msg_default, option);
+}
+
+int msg_set_fmt_ascii(msg_fmt_option_t option)
+{
+    return msg_set_fmt_ascii_r(&msg_default, option);
+}
+
+int msg_set_fmt_ascii_subst(int option)
+{
+    return msg_set_fmt_ascii_subst_r(&msg_default, option);
+}
+
+int msg_set_fmt_channel(msg_fmt_option_t option)
+{
+    return msg_set_fmt_channel_r(&msg_default, option);
+}
+
+int msg_set_fmt_counter(msg_fmt_option_t option)
+{
+    return msg_set_fmt_counter_r(&msg_default, option);
+}
+
+int msg_set_fmt_separator(msg_fmt_separator_t option)
+{
+    return msg_set_fmt_separator_r(&msg_default, option);
+}
+
+int msg_set_fmt_wraparound(msg_fmt_wraparound_t option)
+{
+    return msg_set_fmt_wraparound_r(&msg_default, option);
+}
+
+int msg_set_fmt_eol(msg_fmt_option_t option)
+{
+    return msg_set_fmt_eol_r(&msg_default, option);
+}
+
+int msg_set_fmt_rx_prompt(const char *option)
+{
+    return msg_set_fmt_rx_prompt_r(&msg_default, option);
+}
+
+int msg_set_fmt_tx_prompt(const char *option)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    return msg_set_fmt_tx_prompt_r(&msg_default, option);
+}
 
-    if (message) {
-        /* identifier (hex/dec/oct) */
-        format_id(msg_string, message);
+
+/* formatter context: default options, no time-stamp reference */
+msg_formatter_t *msg_create(msg_format_t format)
+{
+    msg_formatter_t *formatter;
+
+    if ((formatter = (msg_formatter_t*)malloc(sizeof(msg_formatter_t))) == NULL)
+        return NULL;
+    *formatter = msg_initial;
+    if (!msg_set_format_r(formatter, format)) {
+        free(formatter);
+        return NULL;
     }
-    return msg_string;
+    return formatter;
 }
 
-char *msg_format_flags(const msg_message_t *message)
+void msg_destroy(msg_formatter_t *formatter)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    if (formatter && (formatter != &msg_default))
+        free(formatter);
+}
 
-    if (message) {
-#if (OPTION_CAN_2_0_ONLY == 0)
-        if (!message->sts) {
-            strcat(msg_string, message->xtd ? "X" : "S");
-            strcat(msg_string, message->fdf ? "F" : "-");
-            strcat(msg_string, message->brs ? "B" : "-");
-            strcat(msg_string, message->esi ? "E" : "-");
-            strcat(msg_string, message->rtr ? "R" : "-");
-        }
-        else {
-            strcat(msg_string, "Error");
-        }
-#else
-        if (!message->sts) {
-            strcat(msg_string, message->xtd ? "X" : "S");
-            strcat(msg_string, message->rtr ? "R" : "-");
-        }
-        else {
-            strcat(msg_string, "E!");
-        }
-#endif
+void msg_reset_r(msg_formatter_t *formatter)
+{
+    if (formatter) {
+        formatter->stamp.last.tv_sec = 0;
+        formatter->stamp.last.tv_nsec = 0;
+        formatter->stamp.first = 1;
     }
-    return msg_string;
 }
 
-char *msg_format_dlc(const msg_message_t *message)
+char *msg_format_message_r(msg_formatter_t *formatter, const msg_message_t *message, msg_direction_t direction,
+                           msg_channel_t channel, msg_counter_t counter, char *buffer, size_t length)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    char tmp_string[MSG_STRING_LENGTH];
+    char out_string[MSG_STRING_LENGTH];
+    char *string = (length >= MSG_STRING_LENGTH) ? buffer : out_string;  /* large enough: in place */
+    int tabs;
 
-    if (message) {
-        /* dlc/length (hex/dec/oct) */
-        format_dlc(msg_string, message);
+    if (!formatter || !message || !buffer || !length)
+        return NULL;
+    tabs = (formatter->option.separator == MSG_FMT_SEPARATOR_TABS) ? 1 : 0;
+    string[0] = '\0';
+
+    /* prompt (optional) */
+    if (strlen(formatter->option.tx_prompt) && (direction == MSG_TX_MESSAGE)) {
+        strcat(string, formatter->option.tx_prompt);
+        strcat(string, tabs ? "\t" : " ");
     }
-    return msg_string;
+    else if (strlen(formatter->option.rx_prompt)) { /* defaults to MSG_DIRECTION_RX_MSG */
+        strcat(string, formatter->option.rx_prompt);
+        strcat(string, tabs ? "\t" : " ");
+    }
+    /* counter (optional) */
+    if ((formatter->option.counter != MSG_FMT_OPTION_OFF) && tabs) {
+        sprintf(tmp_string, "%" PRIu64 "\t", counter);
+        strcat(string, tmp_string);
+    }
+    else if (formatter->option.counter != MSG_FMT_OPTION_OFF) { /* defaults to MSG_FMT_SEPARATOR_SPACES */
+        sprintf(tmp_string, "%-7" PRIu64 "  ", counter);
+        strcat(string, tmp_string);
+    }
+    /* time-stamp (abs/rel/zero) (hhmmss/sec/DJD).(msec/usec) */
+    format_time(tmp_string, formatter, message);
+    strcat(string, tmp_string);
+    strcat(string, tabs ? "\t" : "  ");
+
+    /* channel (optional) */
+    if ((formatter->option.channel != MSG_FMT_OPTION_OFF) && tabs) {
+        sprintf(tmp_string, "%i\t", channel);
+        strcat(string, tmp_string);
+    }
+    else if (formatter->option.channel != MSG_FMT_OPTION_OFF) { /* defaults to MSG_FMT_SEPARATOR_SPACES */
+        sprintf(tmp_string, "%-2i  ", channel);
+        strcat(string, tmp_string);
+    }
+    /* identifier (hex/dec/oct) */
+    format_id(tmp_string, formatter, message);
+    strcat(string, tmp_string);
+    strcat(string, tabs ? "\t" : "  ");
+
+    /* flags (optional) */
+    if (formatter->option.flags != MSG_FMT_OPTION_OFF) {
+        format_flags(tmp_string, message);
+        strcat(string, tmp_string);
+        strcat(string, tabs ? "\t" : " ");  /* only one space! */
+    }
+    /* dlc/length (hex/dec/oct) */
+    format_dlc(tmp_string, formatter, message);
+    strcat(string, tmp_string);
+
+    /* data (hex/dec/oct) plus ascii (optional) */
+    if (message->dlc && !message->rtr) {
+        strcat(string, tabs ? "\t" : "  ");
+        format_data(tmp_string, formatter, message, (formatter->option.ascii == MSG_FMT_OPTION_OFF) ? 0 : 1, (int)strlen(string));
+        strcat(string, tmp_string);
+    }
+    /* end-of-line (optional) */
+    if (formatter->option.end_of_line) {
+        strcat(string, "\n");
+    }
+    return format_result(buffer, length, string);
 }
 
-char *msg_format_data(const msg_message_t *message)
+char *msg_format_time_r(msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    char string[MSG_STRING_LENGTH];
 
-    if (message) {
-        /* data (hex/dec/oct) */
-        if (message->dlc) {
-            format_data(msg_string, message, 0, 0);
-        }
+    if (!formatter || !message || !buffer || !length)
+        return NULL;
+    /* time-stamp (abs/rel/zero) (hhmmss/sec/DJD).(msec/usec) */
+    format_time(string, formatter, message);
+    return format_result(buffer, length, string);
+}
+
+char *msg_format_id_r(const msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length)
+{
+    char string[MSG_STRING_LENGTH];
+
+    if (!formatter || !message || !buffer || !length)
+        return NULL;
+    /* identifier (hex/dec/oct) */
+    format_id(string, formatter, message);
+    return format_result(buffer, length, string);
+}
+
+char *msg_format_flags_r(const msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length)
+{
+    char string[MSG_STRING_LENGTH];
+
+    if (!formatter || !message || !buffer || !length)
+        return NULL;
+    format_flags(string, message);
+    return format_result(buffer, length, string);
+}
+
+char *msg_format_dlc_r(const msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length)
+{
+    char string[MSG_STRING_LENGTH];
+
+    if (!formatter || !message || !buffer || !length)
+        return NULL;
+    /* dlc/length (hex/dec/oct) */
+    format_dlc(string, formatter, message);
+    return format_result(buffer, length, string);
+}
+
+char *msg_format_data_r(const msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length)
+{
+    char string[MSG_STRING_LENGTH] = "";
+
+    if (!formatter || !message || !buffer || !length)
+        return NULL;
+    /* data (hex/dec/oct) */
+    if (message->dlc) {
+        format_data(string, formatter, message, 0, 0);
     }
-    return msg_string;
+    return format_result(buffer, length, string);
 }
 
-char *msg_format_ascii(const msg_message_t *message)
+char *msg_format_ascii_r(const msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length)
 {
-    memset(msg_string, 0, sizeof(msg_string));
+    char string[MSG_STRING_LENGTH] = "";
 
-    if (message) {
-        /* data (hex/dec/oct) */
-        if (message->dlc) {
-            format_ascii(msg_string, message);
-        }
+    if (!formatter || !message || !buffer || !length)
+        return NULL;
+    /* data (ascii) */
+    if (message->dlc) {
+        format_ascii(string, formatter, message);
     }
-    return msg_string;
+    return format_result(buffer, length, string);
 }
 
 
 /* message output format {DEFAULT, ...} */
-int msg_set_format(msg_format_t format)
+int msg_set_format_r(msg_formatter_t *formatter, msg_format_t format)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (format) {
     case MSG_FORMAT_DEFAULT:
-        msg_format = format;
+        formatter->format = format;
         break;
     default:
         rc = 0;
@@ -379,15 +549,17 @@ int msg_set_format(msg_format_t format)
 }
 
 /* formatter option: time-stamp {ZERO, ABS, REL} */
-int  msg_set_fmt_time_stamp(msg_fmt_timestamp_t option)
+int msg_set_fmt_time_stamp_r(msg_formatter_t *formatter, msg_fmt_timestamp_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_TIMESTAMP_ZERO:
     case MSG_FMT_TIMESTAMP_ABSOLUTE:
     case MSG_FMT_TIMESTAMP_RELATIVE:
-        msg_option.time_stamp = option;
+        formatter->option.time_stamp = option;
         break;
     default:
         rc = 0;
@@ -397,14 +569,16 @@ int  msg_set_fmt_time_stamp(msg_fmt_timestamp_t option)
 }
 
 /* formatter option: time-stamp in usec {ON, OFF} */
-int msg_set_fmt_time_usec(msg_fmt_option_t option)
+int msg_set_fmt_time_usec_r(msg_formatter_t *formatter, msg_fmt_option_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.time_usec = option;
+        formatter->option.time_usec = option;
         break;
     default:
         rc = 0;
@@ -414,15 +588,17 @@ int msg_set_fmt_time_usec(msg_fmt_option_t option)
 }
 
 /* formatter option: time format {TIME, SEC, DJD} */
-int msg_set_fmt_time_format(msg_fmt_time_t option)
+int msg_set_fmt_time_format_r(msg_formatter_t *formatter, msg_fmt_time_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_TIME_HHMMSS:
     case MSG_FMT_TIME_SEC:
     case MSG_FMT_TIME_DJD:
-        msg_option.time_format = option;
+        formatter->option.time_format = option;
         break;
     default:
         rc = 0;
@@ -432,15 +608,17 @@ int msg_set_fmt_time_format(msg_fmt_time_t option)
 }
 
 /* formatter option: identifier {HEX, DEC, OCT, BIN} */
-int msg_set_fmt_id(msg_fmt_number_t option)
+int msg_set_fmt_id_r(msg_formatter_t *formatter, msg_fmt_number_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_NUMBER_HEX:
     case MSG_FMT_NUMBER_DEC:
     case MSG_FMT_NUMBER_OCT:
-        msg_option.id = option;
+        formatter->option.id = option;
         break;
     default:
         rc = 0;
@@ -450,14 +628,16 @@ int msg_set_fmt_id(msg_fmt_number_t option)
 }
 
 /* formatter option: extended identifier {ON, OFF} */
-int msg_set_fmt_id_xtd(msg_fmt_option_t option)
+int msg_set_fmt_id_xtd_r(msg_formatter_t *formatter, msg_fmt_option_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.id_xtd = option;
+        formatter->option.id_xtd = option;
         break;
     default:
         rc = 0;
@@ -467,15 +647,17 @@ int msg_set_fmt_id_xtd(msg_fmt_option_t option)
 }
 
 /* formatter option: DLC/length {HEX, DEC, OCT, BIN} */
-int msg_set_fmt_dlc(msg_fmt_number_t option)
+int msg_set_fmt_dlc_r(msg_formatter_t *formatter, msg_fmt_number_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_NUMBER_HEX:
     case MSG_FMT_NUMBER_DEC:
     case MSG_FMT_NUMBER_OCT:
-        msg_option.dlc = option;
+        formatter->option.dlc = option;
         break;
     default:
         rc = 0;
@@ -485,14 +667,16 @@ int msg_set_fmt_dlc(msg_fmt_number_t option)
 }
 
 /* formatter option: CAN FD format {DLC, LENGTH} */
-int msg_set_fmt_dlc_format(msg_fmt_canfd_t option)
+int msg_set_fmt_dlc_format_r(msg_formatter_t *formatter, msg_fmt_canfd_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case  MSG_FMT_CANFD_DLC:
     case  MSG_FMT_CANFD_LENGTH:
-        msg_option.dlc_format = option;
+        formatter->option.dlc_format = option;
         break;
     default:
         rc = 0;
@@ -502,15 +686,17 @@ int msg_set_fmt_dlc_format(msg_fmt_canfd_t option)
 }
 
 /* formatter option: DLC in brackets {'\0', '(', '['} */
-int msg_set_fmt_dlc_brackets(int option)
+int msg_set_fmt_dlc_brackets_r(msg_formatter_t *formatter, int option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case '\0':
     case '(':
     case '[':
-        msg_option.dlc_brackets = option;
+        formatter->option.dlc_brackets = option;
         break;
     default:
         rc = 0;
@@ -520,14 +706,16 @@ int msg_set_fmt_dlc_brackets(int option)
 }
 
 /* formatter option: message flags {ON, OFF} */
-int msg_set_fmt_flags(msg_fmt_option_t option)
+int msg_set_fmt_flags_r(msg_formatter_t *formatter, msg_fmt_option_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.flags = option;
+        formatter->option.flags = option;
         break;
     default:
         rc = 0;
@@ -537,15 +725,17 @@ int msg_set_fmt_flags(msg_fmt_option_t option)
 }
 
 /* formatter option: message data {HEX, DEC, OCT, BIN} */
-int msg_set_fmt_data(msg_fmt_number_t option)
+int msg_set_fmt_data_r(msg_formatter_t *formatter, msg_fmt_number_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_NUMBER_HEX:
     case MSG_FMT_NUMBER_DEC:
     case MSG_FMT_NUMBER_OCT:
-        msg_option.data = option;
+        formatter->option.data = option;
         break;
     default:
         rc = 0;
@@ -555,14 +745,16 @@ int msg_set_fmt_data(msg_fmt_number_t option)
 }
 
 /* formatter option: data as ASCII {ON, OFF} */
-int msg_set_fmt_ascii(msg_fmt_option_t option)
+int msg_set_fmt_ascii_r(msg_formatter_t *formatter, msg_fmt_option_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.ascii = option;
+        formatter->option.ascii = option;
         break;
     default:
         rc = 0;
@@ -572,26 +764,28 @@ int msg_set_fmt_ascii(msg_fmt_option_t option)
 }
 
 /* formatter option: substitute for non-printables */
-int msg_set_fmt_ascii_subst(int option)
+int msg_set_fmt_ascii_subst_r(msg_formatter_t *formatter, int option)
 {
     int rc = 1;
 
-    if (isprint(option))
-        msg_option.ascii_subst = option;
+    if (formatter && isprint(option))
+        formatter->option.ascii_subst = option;
     else
         rc = 0;
     return rc;
 }
 
 /* formatter option: message source {ON, OFF} */
-int msg_set_fmt_channel(msg_fmt_option_t option)
+int msg_set_fmt_channel_r(msg_formatter_t *formatter, msg_fmt_option_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.channel = option;
+        formatter->option.channel = option;
         break;
     default:
         rc = 0;
@@ -601,14 +795,16 @@ int msg_set_fmt_channel(msg_fmt_option_t option)
 }
 
 /* formatter option: message counter {ON, OFF} */
-int msg_set_fmt_counter(msg_fmt_option_t option)
+int msg_set_fmt_counter_r(msg_formatter_t *formatter, msg_fmt_option_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.counter = option;
+        formatter->option.counter = option;
         break;
     default:
         rc = 0;
@@ -618,14 +814,16 @@ int msg_set_fmt_counter(msg_fmt_option_t option)
 }
 
 /* formatter option: separator {SPACES, TABS} */
-int msg_set_fmt_separator(msg_fmt_separator_t option)
+int msg_set_fmt_separator_r(msg_formatter_t *formatter, msg_fmt_separator_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_SEPARATOR_SPACES:
     case MSG_FMT_SEPARATOR_TABS:
-        msg_option.separator = option;
+        formatter->option.separator = option;
         break;
     default:
         rc = 0;
@@ -635,10 +833,12 @@ int msg_set_fmt_separator(msg_fmt_separator_t option)
 }
 
 /* formatter option: wraparound {NO, 8, 16, 32, 64} */
-int msg_set_fmt_wraparound(msg_fmt_wraparound_t option)
+int msg_set_fmt_wraparound_r(msg_formatter_t *formatter, msg_fmt_wraparound_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_WRAPAROUND_NO:
     case MSG_FMT_WRAPAROUND_8:
@@ -646,7 +846,7 @@ int msg_set_fmt_wraparound(msg_fmt_wraparound_t option)
     case MSG_FMT_WRAPAROUND_16:
     case MSG_FMT_WRAPAROUND_32:
     case MSG_FMT_WRAPAROUND_64:
-        msg_option.wraparound = option;
+        formatter->option.wraparound = option;
         break;
     default:
         rc = 0;
@@ -656,14 +856,16 @@ int msg_set_fmt_wraparound(msg_fmt_wraparound_t option)
 }
 
 /* formatter option: end-of-line character {ON, OFF} */
-int msg_set_fmt_eol(msg_fmt_option_t option)
+int msg_set_fmt_eol_r(msg_formatter_t *formatter, msg_fmt_option_t option)
 {
     int rc = 1;
 
+    if (!formatter)
+        return 0;
     switch (option) {
     case MSG_FMT_OPTION_OFF:
     case MSG_FMT_OPTION_ON:
-        msg_option.end_of_line = option;
+        formatter->option.end_of_line = option;
         break;
     default:
         rc = 0;
@@ -673,24 +875,24 @@ int msg_set_fmt_eol(msg_fmt_option_t option)
 }
 
 /* formatter option: prompt for received messages */
-int msg_set_fmt_rx_prompt(const char *option)
+int msg_set_fmt_rx_prompt_r(msg_formatter_t *formatter, const char *option)
 {
     int rc = 1;
 
-    if (strlen(option) <= 6)
-        strcpy(msg_option.rx_prompt, option);
+    if (formatter && option && (strlen(option) <= 6))
+        strcpy(formatter->option.rx_prompt, option);
     else
         rc = 0;
     return rc;
 }
 
 /* formatter option: prompt for sent messages */
-int msg_set_fmt_tx_prompt(const char *option)
+int msg_set_fmt_tx_prompt_r(msg_formatter_t *formatter, const char *option)
 {
     int rc = 1;
 
-    if (strlen(option) <= 6)
-        strcpy(msg_option.tx_prompt, option);
+    if (formatter && option && (strlen(option) <= 6))
+        strcpy(formatter->option.tx_prompt, option);
     else
         rc = 0;
     return rc;
@@ -842,29 +1044,27 @@ int msg_parse(const char *str, msg_message_t *msg, uint32_t *cnt, uint64_t *cyc,
 /*  -----------  local functions  ----------------------------------------
  */
 
-static void format_time(char *string, const msg_message_t *message)
+static void format_time(char *string, msg_formatter_t *formatter, const msg_message_t *message)
 {
-    static msg_timestamp_t laststamp = { 0, 0 };
-    static int first = 1;
-
     struct timespec difftime;
     struct tm tm; time_t t;
     char   timestring[25];
     double djd;
 
     assert(string);
+    assert(formatter);
     assert(message);
 
-    switch (msg_option.time_stamp) {
+    switch (formatter->option.time_stamp) {
     case MSG_FMT_TIMESTAMP_RELATIVE:
     case MSG_FMT_TIMESTAMP_ZERO:
-        if (first) { /* first time-stamp received */
-            first = 0;
-            laststamp.tv_sec = message->timestamp.tv_sec;
-            laststamp.tv_nsec = message->timestamp.tv_nsec;
+        if (formatter->stamp.first) { /* first time-stamp received */
+            formatter->stamp.first = 0;
+            formatter->stamp.last.tv_sec = message->timestamp.tv_sec;
+            formatter->stamp.last.tv_nsec = message->timestamp.tv_nsec;
         }
-        difftime.tv_sec = message->timestamp.tv_sec - laststamp.tv_sec;
-        difftime.tv_nsec = message->timestamp.tv_nsec - laststamp.tv_nsec;
+        difftime.tv_sec = message->timestamp.tv_sec - formatter->stamp.last.tv_sec;
+        difftime.tv_nsec = message->timestamp.tv_nsec - formatter->stamp.last.tv_nsec;
         if (difftime.tv_nsec < 0) {
             difftime.tv_sec -= 1;
             difftime.tv_nsec += 1000000000;
@@ -873,42 +1073,50 @@ static void format_time(char *string, const msg_message_t *message)
             difftime.tv_sec = 0;
             difftime.tv_nsec = 0;
         }
-        if (msg_option.time_stamp == MSG_FMT_TIMESTAMP_RELATIVE) { /* update for delta calculation */
-            laststamp.tv_sec = message->timestamp.tv_sec;
-            laststamp.tv_nsec = message->timestamp.tv_nsec;
+        if (formatter->option.time_stamp == MSG_FMT_TIMESTAMP_RELATIVE) { /* update for delta calculation */
+            formatter->stamp.last.tv_sec = message->timestamp.tv_sec;
+            formatter->stamp.last.tv_nsec = message->timestamp.tv_nsec;
         }
         t = (time_t)difftime.tv_sec;
-        tm = *gmtime(&t);
+#if defined(_WIN32) || defined(_WIN64)
+        (void)gmtime_s(&tm, &t);
+#else
+        (void)gmtime_r(&t, &tm);
+#endif
         break;
     case MSG_FMT_TIMESTAMP_ABSOLUTE:
     default:
         difftime.tv_sec = message->timestamp.tv_sec;
         difftime.tv_nsec = message->timestamp.tv_nsec;
         t = (time_t)message->timestamp.tv_sec;
-        tm = *localtime(&t);
+#if defined(_WIN32) || defined(_WIN64)
+        (void)localtime_s(&tm, &t);
+#else
+        (void)localtime_r(&t, &tm);
+#endif
         break;
     }
-    switch (msg_option.time_format) {
+    switch (formatter->option.time_format) {
     case MSG_FMT_TIME_HHMMSS:
         strftime(timestring, 24, "%H:%M:%S", &tm); // TODO: tm > 24h (?)
-        if (msg_option.time_usec)
+        if (formatter->option.time_usec)
             sprintf(string, "%s.%06li", timestring, (long)difftime.tv_nsec / 1000L);
         else/* resolution is 0.1 milliseconds! */
             sprintf(string, "%s.%04li", timestring, (long)difftime.tv_nsec / 100000L);
         break;
     case MSG_FMT_TIME_DJD:
-        if (!msg_option.time_usec)  /* round to milliseconds resolution */
+        if (!formatter->option.time_usec)  /* round to milliseconds resolution */
             difftime.tv_nsec = ((difftime.tv_nsec + 500000L) / 1000000L) * 1000000L;
         djd = (double)difftime.tv_sec / (double)86400;
         djd += (double)difftime.tv_nsec / (double)86400000000000;
-        if (msg_option.time_usec)
+        if (formatter->option.time_usec)
             sprintf(string, "%1.12lf", djd);
         else
             sprintf(string, "%1.9lf", djd);
         break;
     case MSG_FMT_TIME_SEC:
     default:
-        if (msg_option.time_usec)
+        if (formatter->option.time_usec)
             sprintf(string, "%3li.%06li", (long)difftime.tv_sec, (long)difftime.tv_nsec / 1000L);
         else/* resolution is 0.1 milliseconds! */
             sprintf(string, "%3li.%04li", (long)difftime.tv_sec, (long)difftime.tv_nsec / 100000L);
@@ -916,28 +1124,29 @@ static void format_time(char *string, const msg_message_t *message)
     }
 }
 
-static void format_id(char *string, const msg_message_t *message)
+static void format_id(char *string, const msg_formatter_t *formatter, const msg_message_t *message)
 {
     assert(string);
+    assert(formatter);
     assert(message);
 
     string[0] = '\0';
-    switch (msg_option.id) {
+    switch (formatter->option.id) {
     case MSG_FMT_NUMBER_DEC:
-        if (!msg_option.id_xtd)
+        if (!formatter->option.id_xtd)
             sprintf(string, "%-4" PRIu32, message->id);
         else
             sprintf(string, "%-9" PRIu32, message->id);
         break;
     case MSG_FMT_NUMBER_OCT:
-        if (!msg_option.id_xtd)
+        if (!formatter->option.id_xtd)
             sprintf(string, "%04" PRIo32, message->id);
         else
             sprintf(string, "%010" PRIo32, message->id);
         break;
     case MSG_FMT_NUMBER_HEX:
     default:
-        if (!msg_option.id_xtd)
+        if (!formatter->option.id_xtd)
             sprintf(string, "%03" PRIX32, message->id);
         else
             sprintf(string, "%08" PRIX32, message->id);
@@ -945,22 +1154,51 @@ static void format_id(char *string, const msg_message_t *message)
     }
 }
 
-static void format_dlc(char *string, const msg_message_t *message)
+static void format_flags(char *string, const msg_message_t *message)
 {
     assert(string);
     assert(message);
 
-    unsigned char length = (msg_option.dlc_format == MSG_FMT_CANFD_DLC) ? message->dlc : DLC2LEN(message->dlc);
+    string[0] = '\0';
+#if (OPTION_CAN_2_0_ONLY == 0)
+    if (!message->sts) {
+        strcat(string, message->xtd ? "X" : "S");
+        strcat(string, message->fdf ? "F" : "-");
+        strcat(string, message->brs ? "B" : "-");
+        strcat(string, message->esi ? "E" : "-");
+        strcat(string, message->rtr ? "R" : "-");
+    }
+    else {
+        strcat(string, "Error");
+    }
+#else
+    if (!message->sts) {
+        strcat(string, message->xtd ? "X" : "S");
+        strcat(string, message->rtr ? "R" : "-");
+    }
+    else {
+        strcat(string, "E!");
+    }
+#endif
+}
+
+static void format_dlc(char *string, const msg_formatter_t *formatter, const msg_message_t *message)
+{
+    assert(string);
+    assert(formatter);
+    assert(message);
+
+    unsigned char length = (formatter->option.dlc_format == MSG_FMT_CANFD_DLC) ? message->dlc : DLC2LEN(message->dlc);
     char pre = '\0', post = '\0';
     int blank = 0;
 
     string[0] = '\0';
-    switch (msg_option.dlc_brackets) {
+    switch (formatter->option.dlc_brackets) {
     case '(': pre = '('; post = ')'; break;
     case '[': pre = '['; post = ']'; break;
     default: break;
     }
-    switch (msg_option.dlc) {
+    switch (formatter->option.dlc) {
     case MSG_FMT_NUMBER_DEC:
         if (pre && post)
             sprintf(string, "%c%u%c", pre, length, post);
@@ -991,9 +1229,10 @@ static void format_dlc(char *string, const msg_message_t *message)
 #endif
 }
 
-static void format_data(char *string, const msg_message_t *message, int ascii, int indent)
+static void format_data(char *string, const msg_formatter_t *formatter, const msg_message_t *message, int ascii, int indent)
 {
     assert(string);
+    assert(formatter);
     assert(message);
 
     int length = DLC2LEN(message->dlc);
@@ -1002,27 +1241,27 @@ static void format_data(char *string, const msg_message_t *message, int ascii, i
 
     string[0] = '\0';
 #if (OPTION_CAN_2_0_ONLY == 0)
-    if (msg_option.wraparound == MSG_FMT_WRAPAROUND_NO)
+    if (formatter->option.wraparound == MSG_FMT_WRAPAROUND_NO)
         wraparound = message->fdf ? (int)MSG_FMT_WRAPAROUND_64 : (int)MSG_FMT_WRAPAROUND_8;
     else
-        wraparound = (int)msg_option.wraparound;
+        wraparound = (int)formatter->option.wraparound;
 #else
     wraparound = (int)MSG_FMT_WRAPAROUND_8;
 #endif
     for (i = 0, j = 0, col = 0; i < length; i++) {
-        format_data_byte(datastring, message->data[i]);
+        format_data_byte(datastring, formatter, message->data[i]);
         strcat(string, datastring);
         if ((i + 1) < length) {
             if ((col + 1) == wraparound) {
                 if (ascii) {
-                    strcat(string, msg_option.separator == MSG_FMT_SEPARATOR_TABS ? "\t" : "  ");
-                    for (col = 0; col < (int)msg_option.wraparound; j++, col++) {
-                        format_data_ascii(datastring, message->data[j]);
+                    strcat(string, formatter->option.separator == MSG_FMT_SEPARATOR_TABS ? "\t" : "  ");
+                    for (col = 0; col < (int)formatter->option.wraparound; j++, col++) {
+                        format_data_ascii(datastring, formatter, message->data[j]);
                         strcat(string, datastring);
                     }
                 }
                 strcat(string, "\n");
-                if (msg_option.separator != MSG_FMT_SEPARATOR_TABS) {
+                if (formatter->option.separator != MSG_FMT_SEPARATOR_TABS) {
                     for (col = 0; col < indent; col++)
                         strcat(string, " ");
                 }
@@ -1042,23 +1281,24 @@ static void format_data(char *string, const msg_message_t *message, int ascii, i
         if ((col < wraparound) && (i != 0)) {
             strcat(string, " ");
             for (; col < wraparound; col++) {
-                format_fill_byte(datastring);
+                format_fill_byte(datastring, formatter);
                 strcat(string, datastring);
                 if ((col + 1) != wraparound)
                     strcat(string, " ");
             }
         }
-        strcat(string, msg_option.separator == MSG_FMT_SEPARATOR_TABS ? "\t" : "  ");
+        strcat(string, formatter->option.separator == MSG_FMT_SEPARATOR_TABS ? "\t" : "  ");
         for (; j < length; j++) {
-            format_data_ascii(datastring, message->data[j]);
+            format_data_ascii(datastring, formatter, message->data[j]);
             strcat(string, datastring);
         }
     }
 }
 
-static void format_ascii(char *string, const msg_message_t *message)
+static void format_ascii(char *string, const msg_formatter_t *formatter, const msg_message_t *message)
 {
     assert(string);
+    assert(formatter);
     assert(message);
 
     int length = DLC2LEN(message->dlc);
@@ -1067,15 +1307,15 @@ static void format_ascii(char *string, const msg_message_t *message)
 
     string[0] = '\0';
 #if (OPTION_CAN_2_0_ONLY == 0)
-    if (msg_option.wraparound == MSG_FMT_WRAPAROUND_NO)
+    if (formatter->option.wraparound == MSG_FMT_WRAPAROUND_NO)
         wraparound = message->fdf ? (int)MSG_FMT_WRAPAROUND_64 : (int)MSG_FMT_WRAPAROUND_8;
     else
-        wraparound = (int)msg_option.wraparound;
+        wraparound = (int)formatter->option.wraparound;
 #else
     wraparound = (int)MSG_FMT_WRAPAROUND_8;
 #endif
     for (i = 0, col = 0; i < length; i++) {
-        format_data_ascii(datastring, message->data[i]);
+        format_data_ascii(datastring, formatter, message->data[i]);
         strcat(string, datastring);
         if ((i + 1) < length) {
             if ((col + 1) == wraparound) {
@@ -1090,11 +1330,12 @@ static void format_ascii(char *string, const msg_message_t *message)
     }
 }
 
-static void format_data_byte(char *string, unsigned char data)
+static void format_data_byte(char *string, const msg_formatter_t *formatter, unsigned char data)
 {
     assert(string);
+    assert(formatter);
 
-    switch (msg_option.data) {
+    switch (formatter->option.data) {
     case MSG_FMT_NUMBER_DEC:
         sprintf(string, "%-3u", data);
         break;
@@ -1108,11 +1349,12 @@ static void format_data_byte(char *string, unsigned char data)
     }
 }
 
-static void format_fill_byte(char *string)
+static void format_fill_byte(char *string, const msg_formatter_t *formatter)
 {
     assert(string);
+    assert(formatter);
 
-    switch (msg_option.data) {
+    switch (formatter->option.data) {
     case MSG_FMT_NUMBER_DEC:
         sprintf(string, "   ");
         break;
@@ -1126,11 +1368,31 @@ static void format_fill_byte(char *string)
     }
 }
 
-static void format_data_ascii(char *string, unsigned char data)
+static void format_data_ascii(char *string, const msg_formatter_t *formatter, unsigned char data)
 {
     assert(string);
+    assert(formatter);
 
-    sprintf(string, "%c", isprint((int)data) ? (char)data : (char)msg_option.ascii_subst);
+    sprintf(string, "%c", isprint((int)data) ? (char)data : (char)formatter->option.ascii_subst);
+}
+
+static char *format_result(char *buffer, size_t length, const char *string)
+{
+    size_t n;
+
+    assert(buffer);
+    assert(length);
+    assert(string);
+
+    /* copy into the caller's buffer (truncated), unless formatted in place */
+    if (string != buffer) {
+        n = strlen(string);
+        if (n >= length)
+            n = length - 1U;
+        memcpy(buffer, string, n);
+        buffer[n] = '\0';
+    }
+    return buffer;
 }
 
 /** @}
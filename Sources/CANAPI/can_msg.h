@@ -76,6 +76,7 @@ extern "C" {
 #include <stdbool.h>                    /*   C99 header for boolean type */
 #include <time.h>                       /*   for structure 'timespec' */
 #endif
+#include <stddef.h>                     /* for type 'size_t' */
 
 /*  -----------  options  ------------------------------------------------
  */
@@ -282,6 +283,14 @@ typedef enum msg_direction_t_ {
     MSG_TX_MESSAGE = 1
 } msg_direction_t;
 
+/** @brief       CAN Message Formatter (context, opaque):
+ *
+ *  @note        A formatter holds the format options and the reference of
+ *               the relative time-stamps. Use one formatter per channel or
+ *               thread; a formatter must not be used by two threads at once.
+ */
+typedef struct msg_formatter_t_ msg_formatter_t;
+
 
 /*  -----------  variables  ----------------------------------------------
  */
@@ -291,6 +300,10 @@ typedef enum msg_direction_t_ {
  */
 
 /** @brief       Returns the given CAN API V3 message as a formatted string.
+ *
+ *  @note        The msg_format_* and msg_set_* functions use one built-in
+ *               formatter and a static string; they are not reentrant.
+ *               Use msg_create and the *_r functions for concurrent use.
  *
  *  @param[in]   message  CAN API V3 messge
  *
@@ -507,6 +520,108 @@ extern int msg_set_fmt_rx_prompt(const char *option);
  */
 extern int msg_set_fmt_tx_prompt(const char *option);
 
+/** @brief       creates a message formatter with default options.
+ *
+ *  @param[in]   format - message output format {DEFAULT, ...}
+ *
+ *  @returns     pointer to a message formatter, or NULL on error.
+ */
+extern msg_formatter_t *msg_create(msg_format_t format);
+
+/** @brief       destroys a message formatter created by msg_create.
+ *
+ *  @param[in]   formatter - message formatter (or NULL)
+ */
+extern void msg_destroy(msg_formatter_t *formatter);
+
+/** @brief       resets the time-stamp reference of a message formatter.
+ *
+ *  @param[in]   formatter - message formatter
+ */
+extern void msg_reset_r(msg_formatter_t *formatter);
+
+/** @brief       Formats the given CAN API V3 message into a caller buffer (reentrant).
+ *
+ *  @param[in]   formatter  message formatter
+ *  @param[in]   message    CAN API V3 messge
+ *  @param[in]   direction  message direction (RX or TX)
+ *  @param[in]   channel    message source (channel)
+ *  @param[in]   counter    message counter
+ *  @param[out]  buffer     buffer for the zero-terminated string
+ *  @param[in]   length     size of the buffer (the string is truncated to fit)
+ *
+ *  @returns     pointer to the buffer, or NULL on error.
+ */
+extern char *msg_format_message_r(msg_formatter_t *formatter, const msg_message_t *message, msg_direction_t direction,
+                                  msg_channel_t channel, msg_counter_t counter, char *buffer, size_t length);
+
+/** @brief       Formats the time-stamp of a CAN API V3 message into a caller buffer (reentrant).
+ *
+ *  @returns     pointer to the buffer, or NULL on error.
+ */
+extern char *msg_format_time_r(msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length);
+
+/** @brief       Formats the identifier of a CAN API V3 message into a caller buffer (reentrant).
+ *
+ *  @returns     pointer to the buffer, or NULL on error.
+ */
+extern char *msg_format_id_r(const msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length);
+
+/** @brief       Formats the flags of a CAN API V3 message into a caller buffer (reentrant).
+ *
+ *  @returns     pointer to the buffer, or NULL on error.
+ */
+extern char *msg_format_flags_r(const msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length);
+
+/** @brief       Formats the data length code of a CAN API V3 message into a caller buffer (reentrant).
+ *
+ *  @returns     pointer to the buffer, or NULL on error.
+ */
+extern char *msg_format_dlc_r(const msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length);
+
+/** @brief       Formats the data of a CAN API V3 message into a caller buffer (binary representation, reentrant).
+ *
+ *  @returns     pointer to the buffer, or NULL on error.
+ */
+extern char *msg_format_data_r(const msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length);
+
+/** @brief       Formats the data of a CAN API V3 message into a caller buffer (ASCII representation, reentrant).
+ *
+ *  @returns     pointer to the buffer, or NULL on error.
+ */
+extern char *msg_format_ascii_r(const msg_formatter_t *formatter, const msg_message_t *message, char *buffer, size_t length);
+
+/** @brief       set message output format of a formatter (see msg_set_format).
+ *
+ *  @returns     non-zero value on success, otherwise 0.
+ */
+extern int msg_set_format_r(msg_formatter_t *formatter, msg_format_t format);
+
+/** @name        Formatter Options (reentrant)
+ *  @brief       Same as the msg_set_fmt_* functions, but for the given formatter.
+ *  @returns     non-zero value on success, otherwise 0.
+ *  @{ */
+extern int msg_set_fmt_time_stamp_r(msg_formatter_t *formatter, msg_fmt_timestamp_t option);
+extern int msg_set_fmt_time_usec_r(msg_formatter_t *formatter, msg_fmt_option_t option);
+extern int msg_set_fmt_time_format_r(msg_formatter_t *formatter, msg_fmt_time_t option);
+extern int msg_set_fmt_id_r(msg_formatter_t *formatter, msg_fmt_number_t option);
+extern int msg_set_fmt_id_xtd_r(msg_formatter_t *formatter, msg_fmt_option_t option);
+extern int msg_set_fmt_dlc_r(msg_formatter_t *formatter, msg_fmt_number_t option);
+extern int msg_set_fmt_dlc_format_r(msg_formatter_t *formatter, msg_fmt_canfd_t option);
+extern int msg_set_fmt_dlc_brackets_r(msg_formatter_t *formatter, int option);
+extern int msg_set_fmt_flags_r(msg_formatter_t *formatter, msg_fmt_option_t option);
+extern int msg_set_fmt_data_r(msg_formatter_t *formatter, msg_fmt_number_t option);
+extern int msg_set_fmt_ascii_r(msg_formatter_t *formatter, msg_fmt_option_t option);
+extern int msg_set_fmt_ascii_subst_r(msg_formatter_t *formatter, int option);
+extern int msg_set_fmt_channel_r(msg_formatter_t *formatter, msg_fmt_option_t option);
+extern int msg_set_fmt_counter_r(msg_formatter_t *formatter, msg_fmt_option_t option);
+extern int msg_set_fmt_separator_r(msg_formatter_t *formatter, msg_fmt_separator_t option);
+extern int msg_set_fmt_wraparound_r(msg_formatter_t *formatter, msg_fmt_wraparound_t option);
+extern int msg_set_fmt_eol_r(msg_formatter_t *formatter, msg_fmt_option_t option);
+extern int msg_set_fmt_rx_prompt_r(msg_formatter_t *formatter, const char *option);
+extern int msg_set_fmt_tx_prompt_r(msg_formatter_t *formatter, const char *option);
+/** @} */
+
 /** @brief Parse CAN API V3 message from ASCII string.
  *
  *  The syntax is taken from 'cansend' utility of the Linux SocketCAN package.
@@ -59,6 +59,7 @@
 #include "can_defs.h"
 #include "can_api.h"
 #include "can_btr.h"
+#include "PeakCAN_Extensions.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -332,6 +333,114 @@ CANAPI_Return_t CPeakCAN::ResetFilters() {
     return can_property(m_Handle, CANPROP_SET_FILTER_RESET, NULL, 0U);
 }
 
+EXPORT
+CANAPI_Return_t CPeakCAN::ReadMessages(CANAPI_Message_t *buffer, size_t max, size_t &count, uint16_t timeout) {
+    // read up to 'max' messages from the message queue of the CAN interface, if any
+    return can_read_multi(m_Handle, buffer, max, &count, timeout);
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::ReadMessage(CANAPI_Message_t &message, uint64_t &nsec, uint16_t timeout) {
+    // read one message and its time-stamp as an integer (no conversion by the caller)
+    return can_read_ns(m_Handle, &message, &nsec, NULL, timeout);
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::ReadMessage(CANAPI_Message_t &message, uint64_t &nsec, uint8_t &flags, uint16_t timeout) {
+    // read one message, its time-stamp as an integer and its flags (e.g. echo frame)
+    return can_read_ns(m_Handle, &message, &nsec, &flags, timeout);
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::WriteMessages(const CANAPI_Message_t *messages, size_t n, size_t &sent, uint16_t timeout) {
+    // transmit up to 'n' messages over the CAN bus (stops when the transmit queue is full)
+    // note: the time-out covers the whole batch, not each message
+    return can_write_multi(m_Handle, messages, n, &sent, timeout);
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::SetFilterList(const can_pcan_filter_t *ranges, size_t n) {
+    // set the software acceptance filter list of the CAN interface (if stopped)
+    return can_property(m_Handle, PCANPROP_SET_FILTER_LIST, (void*)ranges, n * sizeof(can_pcan_filter_t));
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::SetReceiveHandler(std::function<void(const CANAPI_Message_t *messages, size_t count)> handler, size_t batchMax) {
+    // stop the callback thread before the handler is replaced
+    CANAPI_Return_t rc = can_set_callback(m_Handle, NULL, NULL, 0U);
+    if (CANERR_NOERROR != rc)
+        return rc;
+    m_ReceiveHandler = handler;
+    if (!m_ReceiveHandler)
+        return CANERR_NOERROR;
+    // set the reception callback of the CAN interface (runs while started)
+    rc = can_set_callback(m_Handle, CPeakCAN::ReceiveCallback, (void*)this, batchMax);
+    if (CANERR_NOERROR != rc)
+        m_ReceiveHandler = nullptr;
+    return rc;
+}
+
+void CPeakCAN::ReceiveCallback(int handle, const can_message_t *messages, size_t count, void *context) {
+    CPeakCAN *object = static_cast<CPeakCAN*>(context);
+    // hand the messages over to the reception handler of the object
+    if (object && object->m_ReceiveHandler)
+        object->m_ReceiveHandler(messages, count);
+    (void)handle;
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::AddCyclic(CANAPI_Message_t message, uint32_t period, uint32_t phase, int &index) {
+    // add a cyclic message to the scheduler of the CAN interface (sent while started)
+    return can_cyclic_add(m_Handle, &message, period, phase, &index);
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::UpdateCyclic(int index, CANAPI_Message_t message) {
+    // replace identifier, flags and payload of a cyclic message in place
+    return can_cyclic_update(m_Handle, index, &message);
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::RemoveCyclic(int index) {
+    // remove a cyclic message from the scheduler of the CAN interface
+    return can_cyclic_remove(m_Handle, index);
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::GetCyclicStatistics(int index, can_pcan_cyclic_t &statistics) {
+    // retrieve the timing statistics of a cyclic message
+    return can_cyclic_stats(m_Handle, index, &statistics);
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::ReplayTrace(const char *file, const can_pcan_replay_t &options, can_pcan_replay_stats_t &statistics) {
+    // send the messages of a trace file at absolute deadlines (timing statistics on return)
+    return can_replay(m_Handle, file, &options, &statistics);
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::WaitAny(CPeakCAN *const objects[], size_t n, size_t *ready, size_t &count, uint16_t timeout) {
+    int handles[CANSELECT_MAX_HANDLES];
+    // check the given objects (note: 'ready' receives indexes into 'objects')
+    if (!objects)
+        return CANERR_NULLPTR;
+    if ((n == 0U) || (n > CANSELECT_MAX_HANDLES))
+        return CANERR_ILLPARA;
+    for (size_t i = 0U; i < n; i++) {
+        if (!objects[i])
+            return CANERR_NULLPTR;
+        handles[i] = objects[i]->m_Handle;
+    }
+    // wait until one or more of the CAN interfaces have received messages
+    return can_select(handles, n, ready, &count, timeout);
+}
+
+EXPORT
+CANAPI_Return_t CPeakCAN::RefreshChannels() {
+    // take a new snapshot of the attached channels (library property)
+    return can_property((-1), PCANPROP_SET_REFRESH_CHANNELS, NULL, 0U);
+}
+
 EXPORT
 char *CPeakCAN::GetHardwareVersion() {
     // retrieve the hardware version of the CAN controller
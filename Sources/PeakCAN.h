@@ -55,6 +55,8 @@
 #include "PeakCAN_Defaults.h"
 #include "CANAPI.h"
 
+#include <functional>
+
 /// \name   PeakCAN
 /// \brief  PeakCAN dynamic library
 /// \{
@@ -74,6 +76,8 @@
 class CANCPP CPeakCAN : public CCanApi {
 private:
     CANAPI_Handle_t m_Handle;  ///< CAN interface handle
+    std::function<void(const CANAPI_Message_t *messages, size_t count)> m_ReceiveHandler;  ///< reception handler
+    static void ReceiveCallback(int handle, const can_message_t *messages, size_t count, void *context);
 public:
     // constructor / destructor
     CPeakCAN();
@@ -129,6 +133,34 @@ public:
     CANAPI_Return_t GetFilter29Bit(uint32_t &code, uint32_t &mask);
     CANAPI_Return_t ResetFilters();
 
+    // CPeakCAN-specific extensions (not part of CAN API V3)
+    /// \brief  read up to 'max' messages from the message queue in one call
+    CANAPI_Return_t ReadMessages(CANAPI_Message_t *buffer, size_t max, size_t &count, uint16_t timeout = CANWAIT_INFINITE);
+    /// \brief  read one message and its time-stamp in [nsec] as a 64-bit integer (the message time-stamp is zero)
+    CANAPI_Return_t ReadMessage(CANAPI_Message_t &message, uint64_t &nsec, uint16_t timeout = CANWAIT_INFINITE);
+    /// \brief  as above, 'flags' tells if the message is an echo frame (PCAN_MSGFLAG_ECHO)
+    CANAPI_Return_t ReadMessage(CANAPI_Message_t &message, uint64_t &nsec, uint8_t &flags, uint16_t timeout = CANWAIT_INFINITE);
+    /// \brief  transmit up to 'n' messages, 'sent' tells how many went out ('timeout' covers the whole batch)
+    CANAPI_Return_t WriteMessages(const CANAPI_Message_t *messages, size_t n, size_t &sent, uint16_t timeout = 0U);
+    /// \brief  accept only identifiers within the given ranges (n = 0 turns the list off)
+    CANAPI_Return_t SetFilterList(const can_pcan_filter_t *ranges, size_t n);
+    /// \brief  hand received messages in batches to 'handler' (called from a library thread)
+    CANAPI_Return_t SetReceiveHandler(std::function<void(const CANAPI_Message_t *messages, size_t count)> handler, size_t batchMax = 64U);
+    /// \brief  transmit 'message' every 'period' [usec], first 'phase' [usec] after the start
+    CANAPI_Return_t AddCyclic(CANAPI_Message_t message, uint32_t period, uint32_t phase, int &index);
+    /// \brief  replace the content of a cyclic message (its deadlines are kept)
+    CANAPI_Return_t UpdateCyclic(int index, CANAPI_Message_t message);
+    /// \brief  stop the transmission of a cyclic message
+    CANAPI_Return_t RemoveCyclic(int index);
+    /// \brief  transmissions, missed deadlines and jitter of a cyclic message
+    CANAPI_Return_t GetCyclicStatistics(int index, can_pcan_cyclic_t &statistics);
+    /// \brief  replay a trace file at the pace of its time-stamps (blocks until its end or SignalChannel)
+    CANAPI_Return_t ReplayTrace(const char *file, const can_pcan_replay_t &options, can_pcan_replay_stats_t &statistics);
+    /// \brief  wait until one or more of the given objects have received messages
+    static CANAPI_Return_t WaitAny(CPeakCAN *const objects[], size_t n, size_t *ready, size_t &count, uint16_t timeout = CANWAIT_INFINITE);
+    /// \brief  take a new snapshot of the attached channels (served by ProbeChannel)
+    static CANAPI_Return_t RefreshChannels();
+
     char *GetHardwareVersion();  // (for compatibility reasons)
     char *GetFirmwareVersion();  // (for compatibility reasons)
     static char *GetVersion();  // (for compatibility reasons)
@@ -186,5 +218,28 @@ public:
 #define PEAKCAN_PROPERTY_CONTROLLER_NUMBER  (CANPROP_GET_VENDOR_PROP + PCAN_CONTROLLER_NUMBER)
 //#define PEAKCAN_PROPERTY_SERIAL_NUMBER      (CANPROP_GET_VENDOR_PROP + PCAN_SERIAL_NUMBER)
 //#define PEAKCAN_PROPERTY_CLOCK_DOMAINS      (CANPROP_GET_VENDOR_PROP + PCAN_CLOCK_DOMAIND)
+#define PEAKCAN_PROPERTY_TX_WAIT_TIME       (PCANPROP_GET_TX_WAIT_TIME)
+#define PEAKCAN_PROPERTY_TX_WAIT_MAX        (PCANPROP_GET_TX_WAIT_MAX)
+#define PEAKCAN_PROPERTY_TX_WAIT_COUNT      (PCANPROP_GET_TX_WAIT_COUNT)
+#define PEAKCAN_PROPERTY_MAX_HANDLES        (PCANPROP_GET_MAX_HANDLES)
+#define PEAKCAN_PROPERTY_RCV_QUEUE_SIZE     (PCANPROP_SET_RCV_QUEUE_SIZE)
+#define PEAKCAN_PROPERTY_FILTER_LIST        (PCANPROP_SET_FILTER_LIST)
+#define PEAKCAN_PROPERTY_FILTER_COUNT       (PCANPROP_GET_FILTER_COUNT)
+#define PEAKCAN_PROPERTY_TX_ECHO            (PCANPROP_SET_TX_ECHO)
+#define PEAKCAN_PROPERTY_TX_LATENCY         (PCANPROP_GET_TX_LATENCY)
+#define PEAKCAN_PROPERTY_TX_LATENCY_HIST    (PCANPROP_GET_TX_LATENCY_HIST)
+#define PEAKCAN_PROPERTY_REFRESH_CHANNELS   (PCANPROP_SET_REFRESH_CHANNELS)
+#define PEAKCAN_PROPERTY_CHANNEL_INFO       (PCANPROP_GET_CHANNEL_INFO)
+#define PEAKCAN_PROPERTY_RESTART_FULL       (PCANPROP_GET_RESTART_FULL)
+#define PEAKCAN_PROPERTY_RESTART_FAST       (PCANPROP_GET_RESTART_FAST)
+#define PEAKCAN_PROPERTY_SNAPSHOT           (PCANPROP_GET_SNAPSHOT)
+#define PEAKCAN_PROPERTY_TIME_MODE          (PCANPROP_SET_TIME_MODE)
+#define PEAKCAN_PROPERTY_TIME_SKEW          (PCANPROP_GET_TIME_SKEW)
+#define PEAKCAN_PROPERTY_TIME_JITTER        (PCANPROP_GET_TIME_JITTER)
+#define PEAKCAN_PROPERTY_TRM_QUEUE_SIZE     (PCANPROP_SET_TRM_QUEUE_SIZE)
+#define PEAKCAN_PROPERTY_TRM_QUEUE_LATENCY  (PCANPROP_GET_TRM_QUEUE_LATENCY)
+#define PEAKCAN_PROPERTY_TRM_QUEUE_DROPPED  (PCANPROP_GET_TRM_QUEUE_DROPPED)
+#define PEAKCAN_PROPERTY_TRACE_DROPPED      (PCANPROP_GET_TRACE_DROPPED)
+#define PEAKCAN_PROPERTY_TRACE_CODEC        (PCANPROP_SET_TRACE_CODEC)
 /// \}
 #endif // PEAKCAN_H_INCLUDED
@@ -160,6 +160,52 @@ extern "C" {
 #define PCAN_MAX_BUFFER_SIZE     256U   /**< max. buffer size for CAN_GetValue/CAN_SetValue */
 /** @} */
 
+/** @name  CAN API Driver Properties
+ *  @brief Driver-specific properties of the wrapper library
+ *  @note  Offset CANPROP_DRIVER_SPECIFIC (0x8000) from CANAPI_Types.h
+ *  @{ */
+#define PCANPROP_GET_TX_WAIT_TIME  (0x8000U + 0x00U)  /**< total time writes waited for the transmit queue in [usec] (uint64_t) */
+#define PCANPROP_GET_TX_WAIT_MAX   (0x8000U + 0x01U)  /**< longest time a write waited for the transmit queue in [usec] (uint32_t) */
+#define PCANPROP_GET_TX_WAIT_COUNT (0x8000U + 0x02U)  /**< number of writes that had to wait for the transmit queue (uint64_t) */
+#define PCANPROP_GET_MAX_HANDLES   (0x8000U + 0x03U)  /**< maximum number of open handles (uint32_t) */
+#define PCANPROP_SET_MAX_HANDLES   (0x8000U + 0x04U)  /**< set maximum number of open handles, if no handle is open (uint32_t) */
+#define PCANPROP_SET_RCV_QUEUE_SIZE (0x8000U + 0x05U) /**< set size of the software receive queue, if stopped (uint32_t, 0 = off) */
+#define PCANPROP_SET_FILTER_LIST   (0x8000U + 0x06U)  /**< set software acceptance filter list, if stopped (can_pcan_filter_t[], NULL = off) */
+#define PCANPROP_GET_FILTER_COUNT  (0x8000U + 0x07U)  /**< number of identifier ranges in the acceptance filter list (uint32_t) */
+#define PCANPROP_SET_TX_ECHO       (0x8000U + 0x08U)  /**< receive echo frames of transmitted messages, if stopped (uint8_t) */
+#define PCANPROP_GET_TX_LATENCY    (0x8000U + 0x09U)  /**< write-to-bus latency statistics (can_pcan_latency_t) */
+#define PCANPROP_GET_TX_LATENCY_HIST (0x8000U + 0x0AU)  /**< write-to-bus latency histogram (uint64_t[PCAN_LATENCY_BINS]) */
+#define PCANPROP_SET_REFRESH_CHANNELS (0x8000U + 0x0BU)  /**< take a new snapshot of the attached channels (NULL) */
+#define PCANPROP_GET_CHANNEL_INFO  (0x8000U + 0x0CU)  /**< snapshot data at actual index in the interface list (can_pcan_channel_t) */
+#define PCANPROP_GET_RESTART_FULL  (0x8000U + 0x0DU)  /**< number of restarts with reinitialization of the controller (uint64_t) */
+#define PCANPROP_GET_RESTART_FAST  (0x8000U + 0x0EU)  /**< number of restarts by resuming the controller (uint64_t) */
+#define PCANPROP_GET_SNAPSHOT      (0x8000U + 0x0FU)  /**< status, counters, bit-rate and filters in one call (can_pcan_snapshot_t) */
+#define PCANPROP_SET_TIME_MODE     (0x8000U + 0x10U)  /**< time base of the time-stamps, if stopped (uint8_t: PCAN_TIME_*) */
+#define PCANPROP_GET_TIME_SKEW     (0x8000U + 0x11U)  /**< skew of the device clock to the host clock in [ppb] (int32_t) */
+#define PCANPROP_GET_TIME_JITTER   (0x8000U + 0x12U)  /**< residual jitter of the host clock mapping in [nsec] (uint32_t) */
+#define PCANPROP_SET_TRM_QUEUE_SIZE (0x8000U + 0x13U) /**< set size of the software transmit queue, if stopped (uint32_t, 0 = off) */
+#define PCANPROP_GET_TRM_QUEUE_LATENCY (0x8000U + 0x14U)  /**< queuing latency per priority class (can_pcan_queuing_t[PCAN_TRMQ_CLASSES]) */
+#define PCANPROP_GET_TRACE_DROPPED (0x8000U + 0x15U)  /**< number of messages not traced (capture ring full) (uint64_t) */
+#define PCANPROP_GET_TRACE_CODEC   (0x8000U + 0x16U)  /**< block compression of a compact trace file (uint8_t: PCAN_TRACE_CODEC_*) */
+#define PCANPROP_SET_TRACE_CODEC   (0x8000U + 0x17U)  /**< set block compression of a compact trace file (uint8_t: PCAN_TRACE_CODEC_*) */
+#define PCANPROP_GET_TRM_QUEUE_DROPPED (0x8000U + 0x18U)  /**< number of queued messages dropped on a write error (uint64_t) */
+/** @} */
+
+/** @name  Time-stamp Modes
+ *  @brief Time base of the time-stamps of received messages (PCANPROP_SET_TIME_MODE)
+ *  @{ */
+#define PCAN_TIME_DEVICE         0U     /**< device clock (hardware time-stamp as is, default) */
+#define PCAN_TIME_MONOTONIC      1U     /**< host monotonic clock (CLOCK_MONOTONIC resp. performance counter) */
+#define PCAN_TIME_REALTIME       2U     /**< host wall-clock time (since 1970-01-01 UTC) */
+/** @} */
+
+/** @name  Trace File Codecs
+ *  @brief Block compression of a compact binary trace file (PCANPROP_SET_TRACE_CODEC)
+ *  @{ */
+#define PCAN_TRACE_CODEC_NONE    0U     /**< blocks of records are stored as is */
+#define PCAN_TRACE_CODEC_LZ4     1U     /**< blocks of records are compressed (LZ4 block format, default) */
+/** @} */
+
 
 /** @name  CAN API Library ID
  *  @brief Library ID and dynamic library names
@@ -189,6 +235,12 @@ extern "C" {
  *  @brief More or less useful stuff
  *  @{ */
 #define PCAN_LIB_VENDOR         "PEAK-System Technik GmbH, Darmstadt"
+#define PCAN_LATENCY_BINS       16      /**< latency histogram: bin n counts [2^n, 2^(n+1)) usec */
+#define PCAN_MSGFLAG_ECHO       0x01U   /**< message flag: echo of a transmitted frame (can_read_ns) */
+#define PCAN_TRMQ_CLASSES       8       /**< transmit queue: class n holds base identifiers [n*100h, n*100h+FFh] */
+#define PCAN_REPLAY_IDS         16      /**< trace replay: max. number of identifiers in the pass list */
+#define PCAN_REPLAY_REMAPS      16      /**< trace replay: max. number of remapped identifiers */
+#define PCAN_REPLAY_SPEED_MIN   10      /**< trace replay: slowest speed in [percent] of real time */
 #define PCAN_LIB_WEBSITE        "https://www.peak-system.com/"
 #define PCAN_LIB_HAZARD_NOTE    "If you connect your CAN device to a real CAN network when using this library,\n" \
                                 "you might damage your application."
@@ -206,6 +258,89 @@ typedef struct can_pcan_param_t_ {      /* device parameters: */
 } can_pcan_param_t;
 #define _pcan_param  can_pcan_param_t_  /* for compatibility with CAN/COP API V1 */
 
+/** @brief Identifier range of the software acceptance filter list
+  */
+typedef struct can_pcan_filter_t_ {     /* identifier range: */
+    uint32_t first;                     /**<  first identifier of the range */
+    uint32_t last;                      /**<  last identifier of the range (inclusive) */
+    uint8_t  xtd;                       /**<  29-bit identifier (otherwise 11-bit) */
+} can_pcan_filter_t;
+
+/** @brief Write-to-bus latency statistics (from echo frames)
+  */
+typedef struct can_pcan_latency_t_ {    /* latency statistics: */
+    uint64_t count;                     /**<  number of confirmed transmissions */
+    uint64_t unmatched;                 /**<  number of echo frames w/o a pending write */
+    uint32_t min;                       /**<  shortest latency in [usec] */
+    uint32_t avg;                       /**<  average latency in [usec] */
+    uint32_t max;                       /**<  longest latency in [usec] */
+} can_pcan_latency_t;
+
+/** @brief Queuing latency of a priority class (software transmit queue)
+  */
+typedef struct can_pcan_queuing_t_ {    /* queuing latency: */
+    uint64_t count;                     /**<  number of messages handed to the driver */
+    uint32_t min;                       /**<  shortest time in the queue in [usec] */
+    uint32_t avg;                       /**<  average time in the queue in [usec] */
+    uint32_t max;                       /**<  longest time in the queue in [usec] */
+} can_pcan_queuing_t;
+
+/** @brief Timing statistics of a cyclic message (cyclic scheduler)
+  */
+typedef struct can_pcan_cyclic_t_ {     /* cyclic message: */
+    uint64_t sent;                      /**<  number of transmissions */
+    uint64_t missed;                    /**<  number of missed deadlines (skipped periods or transmitter busy) */
+    uint32_t period;                    /**<  period in [usec] */
+    uint32_t avg;                       /**<  average lateness to the deadline in [usec] */
+    uint32_t max;                       /**<  largest lateness to the deadline in [usec] */
+} can_pcan_cyclic_t;
+
+/** @brief Identifier mapping of a trace replay
+  */
+typedef struct can_pcan_remap_t_ {      /* identifier mapping: */
+    uint32_t from;                      /**<  identifier in the trace file */
+    uint32_t to;                        /**<  identifier sent instead */
+} can_pcan_remap_t;
+
+/** @brief Options of a trace replay (can_replay)
+  */
+typedef struct can_pcan_replay_t_ {     /* replay options: */
+    uint32_t speed;                     /**<  speed in [percent] of real time (0 = as fast as possible) */
+    uint8_t  exclude;                   /**<  records with one of these flags are not sent (CANTRC_FLAG_*) */
+    uint8_t  reserved[3];               /**<  (zero) */
+    uint32_t count;                     /**<  number of identifiers in the pass list (0 = all identifiers) */
+    uint32_t ids[PCAN_REPLAY_IDS];      /**<  identifiers to be sent (w/o regard of the format) */
+    uint32_t remaps;                    /**<  number of remapped identifiers */
+    can_pcan_remap_t remap[PCAN_REPLAY_REMAPS];  /**<  identifier mapping (after the pass list) */
+} can_pcan_replay_t;
+
+/** @brief Timing statistics of a trace replay (can_replay)
+  */
+typedef struct can_pcan_replay_stats_t_ {  /* replay statistics: */
+    uint64_t records;                   /**<  number of records read from the trace file */
+    uint64_t skipped;                   /**<  number of records not sent (pass list, exclude flags, status and echo) */
+    uint64_t sent;                      /**<  number of messages sent */
+    uint64_t failed;                    /**<  number of messages not sent (transmitter busy) */
+    uint64_t stalls;                    /**<  number of times the read-ahead buffer ran empty */
+    uint64_t elapsed;                   /**<  duration of the replay in [usec] */
+    uint32_t min;                       /**<  smallest lateness to the deadline in [usec] */
+    uint32_t avg;                       /**<  average lateness to the deadline in [usec] */
+    uint32_t max;                       /**<  largest lateness to the deadline in [usec] */
+    uint32_t reserved;                  /**<  (zero) */
+    uint64_t histogram[PCAN_LATENCY_BINS];  /**<  lateness in [2^n, 2^(n+1)) usec (bin 0 from 0 usec) */
+} can_pcan_replay_stats_t;
+
+/** @brief Attached channel (from the snapshot taken by PCAN_ATTACHED_CHANNELS)
+  */
+typedef struct can_pcan_channel_t_ {    /* attached channel: */
+    int32_t  channel;                   /**<  channel no. (PCAN channel handle) */
+    uint8_t  device_type;               /**<  kind of PCAN device (PCAN_USB, etc.) */
+    uint8_t  controller;                /**<  CAN controller number */
+    uint32_t features;                  /**<  device features (FEATURE_*) */
+    uint32_t device_id;                 /**<  device number */
+    uint32_t condition;                 /**<  channel condition when taken (PCAN_CHANNEL_*) */
+} can_pcan_channel_t;
+
 #ifdef __cplusplus
 }
 #endif
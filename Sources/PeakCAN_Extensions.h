@@ -0,0 +1,410 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (for PEAK-System PCAN Interfaces)
+ *
+ *  Copyright (c) 2005-2012 Uwe Vogt, UV Software, Friedrichshafen
+ *  Copyright (c) 2013-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of PCANBasic-Wrapper.
+ *
+ *  PCANBasic-Wrapper is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v2.0 (or any later version). You can
+ *  choose between one of them if you use PCANBasic-Wrapper in whole or in part.
+ *
+ *  (1) BSD 2-Clause "Simplified" License
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  PCANBasic-Wrapper IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF PCANBasic-Wrapper, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  (2) GNU General Public License v2.0 or later
+ *
+ *  PCANBasic-Wrapper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PCANBasic-Wrapper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with PCANBasic-Wrapper; if not, see <https://www.gnu.org/licenses/>.
+ */
+/** @addtogroup  can_api
+ *  @{
+ */
+#ifndef CANAPI_PEAKCAN_EXTENSIONS_H_INCLUDED
+#define CANAPI_PEAKCAN_EXTENSIONS_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*  -----------  includes  ------------------------------------------------
+ */
+
+#include "can_api.h"                    /* CAN API V3 interface */
+#include "PeakCAN_Defines.h"            /* PCAN specific defines */
+
+#include <stddef.h>                     /* C99 header for size_t */
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+/** @brief       maximum number of handles for can_select (cf. MAXIMUM_WAIT_OBJECTS)
+ */
+#define CANSELECT_MAX_HANDLES  64
+
+/** @brief       maximum number of messages per call of a reception callback
+ */
+#define CANCALLBACK_MAX_BATCH  1024
+
+/** @brief       maximum number of cyclic messages per CAN interface
+ */
+#define CANCYCLIC_MAX_MESSAGES  256
+
+/** @brief       version of the property snapshot (can_pcan_snapshot_t)
+ */
+#define PCAN_SNAPSHOT_VERSION  1
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+
+/** @brief       reception callback: called from the callback thread of the library
+ *               with up to 'batch_max' received messages at once.
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[in]   messages - pointer to an array of 'count' received messages
+ *  @param[in]   count    - number of messages (at least one)
+ *  @param[in]   context  - user context given to can_set_callback
+ */
+typedef void (*can_rcv_callback_t)(int handle, const can_message_t *messages, size_t count, void *context);
+
+/** @brief       property snapshot: status, counters, bit-rate and filters of a
+ *               CAN interface, taken in one call (PCANPROP_GET_SNAPSHOT).
+ *
+ *  @note        New members are only appended; 'version' and 'size' tell
+ *               the caller which of them were filled in.
+ */
+typedef struct can_pcan_snapshot_t_ {   /* property snapshot: */
+    uint16_t version;                   /**<  version of the structure (PCAN_SNAPSHOT_VERSION) */
+    uint16_t size;                      /**<  size of the structure in bytes */
+    uint8_t  status;                    /**<  status register (can_status_t) */
+    uint8_t  mode;                      /**<  operation mode (can_mode_t) */
+    uint16_t busload;                   /**<  bus load in [0.01 %] (0 if stopped) */
+    uint64_t time;                      /**<  time of the snapshot in [usec] (host clock) */
+    uint64_t tx;                        /**<  total number of sent messages */
+    uint64_t rx;                        /**<  total number of received messages */
+    uint64_t err;                       /**<  total number of received error frames */
+    can_bitrate_t bitrate;              /**<  active bit-rate of the CAN controller */
+    can_speed_t speed;                  /**<  active bus speed of the CAN controller */
+    uint64_t filter_11bit;              /**<  acceptance filter code and mask for 11-bit identifier */
+    uint64_t filter_29bit;              /**<  acceptance filter code and mask for 29-bit identifier */
+} can_pcan_snapshot_t;
+
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+/** @brief       reads up to 'max' messages from the message queue of the CAN
+ *               interface in one call. The CAN controller must be in operation
+ *               state 'running'.
+ *
+ *  @note        The function waits for the first message only; then it drains
+ *               the message queue until it is empty or 'max' messages are read.
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[out]  messages - pointer to an array of 'max' message buffers
+ *  @param[in]   max      - maximum number of messages to be read
+ *  @param[out]  count    - number of messages read into the array
+ *  @param[in]   timeout  - time to wait for the reception of a message:
+ *                              0 means the function returns immediately,
+ *                              65535 means blocking read, and any other
+ *                              value means the time to wait in milliseconds
+ *
+ *  @returns     0 if at least one message was read, or a negative value on error.
+ *
+ *  @retval      CANERR_NOTINIT   - library not initialized
+ *  @retval      CANERR_HANDLE    - invalid interface handle
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_ILLPARA   - illegal parameter (max = 0)
+ *  @retval      CANERR_OFFLINE   - interface not started
+ *  @retval      CANERR_RX_EMPTY  - message queue empty
+ *  @retval      others           - vendor-specific
+ */
+CANAPI int can_read_multi(int handle, can_message_t *messages, size_t max, size_t *count, uint16_t timeout);
+
+
+/** @brief       reads one message from the message queue of the CAN interface, like
+ *               can_read, and returns its time-stamp as a 64-bit integer in [nsec]
+ *               (the same time base as the time-stamp of can_read).
+ *
+ *  @note        The time-stamp is not converted into the 'struct timespec' of
+ *               the message, the time-stamp in the message is set to zero.
+ *
+ *  @note        Echo frames of transmitted messages (PCANPROP_SET_TX_ECHO) are
+ *               marked by the flag PCAN_MSGFLAG_ECHO; the other read functions
+ *               return them like received messages.
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[out]  message  - the message read from the message queue, if any
+ *  @param[out]  nsec     - the time-stamp of the message in [nsec]
+ *  @param[out]  flags    - message flags (PCAN_MSGFLAG_xyz), or NULL
+ *  @param[in]   timeout  - time to wait for the reception of a message:
+ *                              0 means the function returns immediately,
+ *                              65535 means blocking read, and any other
+ *                              value means the time to wait in milliseconds
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NOTINIT   - library not initialized
+ *  @retval      CANERR_HANDLE    - invalid interface handle
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_OFFLINE   - interface not started
+ *  @retval      CANERR_RX_EMPTY  - message queue empty
+ *  @retval      others           - vendor-specific
+ */
+CANAPI int can_read_ns(int handle, can_message_t *message, uint64_t *nsec, uint8_t *flags, uint16_t timeout);
+
+
+/** @brief       transmits up to 'n' messages over the CAN bus in one call. The CAN
+ *               controller must be in operation state 'running'.
+ *
+ *  @note        The function stops at the first message that cannot be queued
+ *               (e.g. transmit queue full); 'sent' tells how many messages were
+ *               transmitted, so the caller can resume with message 'sent'.
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[in]   messages - pointer to an array of 'n' messages to send
+ *  @param[in]   n        - number of messages to send
+ *  @param[out]  sent     - number of messages transmitted
+ *  @param[in]   timeout  - time to wait for the transmission of the messages:
+ *                              0 means the function returns immediately,
+ *                              65535 means blocking write, and any other
+ *                              value means the time to wait in milliseconds
+ *                              for the whole batch (not for each message)
+ *
+ *  @returns     0 if all messages were sent, or a negative value on error.
+ *
+ *  @retval      CANERR_NOTINIT   - library not initialized
+ *  @retval      CANERR_HANDLE    - invalid interface handle
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_ILLPARA   - illegal message at index 'sent'
+ *  @retval      CANERR_OFFLINE   - interface not started
+ *  @retval      CANERR_TX_BUSY   - transmitter busy (message 'sent' not queued)
+ *  @retval      others           - vendor-specific
+ */
+CANAPI int can_write_multi(int handle, const can_message_t *messages, size_t n, size_t *sent, uint16_t timeout);
+
+
+/** @brief       waits until one or more of the given CAN interfaces have received
+ *               messages. The CAN controllers must be in operation state 'running'.
+ *
+ *  @note        A reported interface should be read until its message queue is
+ *               empty (CANERR_RX_EMPTY), because a new message is signaled once.
+ *               An interface may be reported even if its messages have been read
+ *               in the meantime or were refused (e.g. by the filter list).
+ *
+ *  @param[in]   handles  - pointer to an array of 'n' handles of CAN interfaces
+ *  @param[in]   n        - number of handles (1 to CANSELECT_MAX_HANDLES)
+ *  @param[out]  ready    - pointer to an array of 'n' indexes into 'handles'
+ *  @param[out]  count    - number of indexes written into 'ready'
+ *  @param[in]   timeout  - time to wait for the reception of a message:
+ *                              0 means the function returns immediately,
+ *                              65535 means blocking wait, and any other
+ *                              value means the time to wait in milliseconds
+ *
+ *  @returns     0 if at least one interface is ready, or a negative value on error.
+ *
+ *  @retval      CANERR_NOTINIT   - library not initialized
+ *  @retval      CANERR_HANDLE    - invalid interface handle
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_ILLPARA   - illegal parameter (n = 0 or too many handles)
+ *  @retval      CANERR_OFFLINE   - interface not started
+ *  @retval      CANERR_RX_EMPTY  - time-out or signaled by can_kill
+ *  @retval      others           - vendor-specific
+ */
+CANAPI int can_select(const int *handles, size_t n, size_t *ready, size_t *count, uint16_t timeout);
+
+
+/** @brief       sets a reception callback for the CAN interface. A thread of the
+ *               library reads the received messages and hands them over to the
+ *               callback in batches of up to 'batch_max' messages.
+ *
+ *  @note        The callback thread runs while the CAN controller is in operation
+ *               state 'running'; it is stopped by can_reset and can_exit, and by
+ *               setting the callback to NULL. The thread is woken up by can_kill.
+ *
+ *  @note        Messages should not be read by can_read while a callback is set.
+ *               The function must not be called from within the callback.
+ *
+ *  @param[in]   handle    - handle of the CAN interface
+ *  @param[in]   callback  - pointer to the callback function, or NULL to remove it
+ *  @param[in]   context   - user context handed over to the callback
+ *  @param[in]   batch_max - maximum number of messages per call (1 to CANCALLBACK_MAX_BATCH)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NOTINIT   - library not initialized
+ *  @retval      CANERR_HANDLE    - invalid interface handle
+ *  @retval      CANERR_ILLPARA   - illegal parameter (batch_max)
+ *  @retval      CANERR_RESOURCE  - resource allocation failed
+ *  @retval      others           - vendor-specific
+ */
+CANAPI int can_set_callback(int handle, can_rcv_callback_t callback, void *context, size_t batch_max);
+
+
+/** @brief       adds a cyclic message to the scheduler of the CAN interface. The
+ *               message is transmitted every 'period' microseconds; the first
+ *               deadline is 'phase' microseconds after the start of the CAN
+ *               controller (or after the call, if it is already running).
+ *
+ *  @note        The deadlines are absolute, i.e. a late transmission does not
+ *               shift the following ones. Periods that could not be served in
+ *               time are skipped and counted as missed. Messages due at the same
+ *               time are written in one burst. The scheduler works on a time
+ *               grid of 250 microseconds, so the period should be a multiple.
+ *
+ *  @note        The scheduler thread runs while the CAN controller is in operation
+ *               state 'running'; it is stopped by can_reset and can_exit. The
+ *               cyclic messages are kept until removed or the interface is closed.
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[in]   message  - pointer to the message to be sent
+ *  @param[in]   period   - period in microseconds (at least 250)
+ *  @param[in]   phase    - offset of the first deadline in microseconds
+ *  @param[out]  index    - index of the cyclic message (0 to CANCYCLIC_MAX_MESSAGES-1)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NOTINIT   - library not initialized
+ *  @retval      CANERR_HANDLE    - invalid interface handle
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_ILLPARA   - illegal parameter (period or message)
+ *  @retval      CANERR_RESOURCE  - resource allocation failed or no free entry
+ *  @retval      others           - vendor-specific
+ */
+CANAPI int can_cyclic_add(int handle, const can_message_t *message, uint32_t period, uint32_t phase, int *index);
+
+
+/** @brief       replaces the identifier, flags and payload of a cyclic message.
+ *               The next transmission carries the new content; the deadlines
+ *               are not changed.
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[in]   index    - index of the cyclic message (from can_cyclic_add)
+ *  @param[in]   message  - pointer to the new message
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NOTINIT   - library not initialized
+ *  @retval      CANERR_HANDLE    - invalid interface handle
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_ILLPARA   - illegal parameter (index or message)
+ *  @retval      others           - vendor-specific
+ */
+CANAPI int can_cyclic_update(int handle, int index, const can_message_t *message);
+
+
+/** @brief       removes a cyclic message from the scheduler of the CAN interface.
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[in]   index    - index of the cyclic message (from can_cyclic_add)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NOTINIT   - library not initialized
+ *  @retval      CANERR_HANDLE    - invalid interface handle
+ *  @retval      CANERR_ILLPARA   - illegal parameter (index)
+ *  @retval      others           - vendor-specific
+ */
+CANAPI int can_cyclic_remove(int handle, int index);
+
+
+/** @brief       retrieves the timing statistics of a cyclic message, i.e. the
+ *               number of transmissions and missed deadlines, and the lateness
+ *               of the transmissions to their deadlines (jitter).
+ *
+ *  @note        The statistics are reset when the CAN controller is started.
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[in]   index    - index of the cyclic message (from can_cyclic_add)
+ *  @param[out]  stats    - pointer to a buffer for the statistics
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NOTINIT   - library not initialized
+ *  @retval      CANERR_HANDLE    - invalid interface handle
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_ILLPARA   - illegal parameter (index)
+ *  @retval      others           - vendor-specific
+ */
+CANAPI int can_cyclic_stats(int handle, int index, can_pcan_cyclic_t *stats);
+
+
+/** @brief       replays a trace file onto the CAN interface. The messages are sent
+ *               at absolute deadlines relative to the time-stamp of the first
+ *               record (scaled by the replay speed), so the timing error of one
+ *               message does not add up over the trace file.
+ *
+ *  @note        Supported are binary trace files (PeakCAN_Tracefile.h), CSV
+ *               trace files of the trace file recorder, and the text written
+ *               by can_moni in its default format (hexadecimal identifier and
+ *               data, time-stamps 'zero' or 'absolute'). Other lines of a text
+ *               file are ignored. The trace file is read by a separate thread
+ *               into a read-ahead buffer.
+ *
+ *  @note        The function blocks until the end of the trace file, or until
+ *               the CAN interface is signaled by can_kill or stopped.
+ *
+ *  @param[in]   handle   - handle of the CAN interface
+ *  @param[in]   file     - name of the trace file
+ *  @param[in]   options  - replay speed, identifier pass list and mapping
+ *  @param[out]  stats    - pointer to a buffer for the timing statistics (optional)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NOTINIT   - library not initialized
+ *  @retval      CANERR_HANDLE    - invalid interface handle
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_ILLPARA   - illegal parameter (options)
+ *  @retval      CANERR_OFFLINE   - interface not started
+ *  @retval      CANERR_RESOURCE  - file not found or out of memory (errno is set)
+ *  @retval      CANERR_FATAL     - the trace file is corrupted
+ *  @retval      others           - vendor-specific
+ */
+CANAPI int can_replay(int handle, const char *file, const can_pcan_replay_t *options, can_pcan_replay_stats_t *stats);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CANAPI_PEAKCAN_EXTENSIONS_H_INCLUDED */
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de, Homepage: https://www.uv-software.de/
+ */
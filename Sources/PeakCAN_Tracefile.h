@@ -0,0 +1,344 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (for PEAK-System PCAN Interfaces)
+ *
+ *  Copyright (c) 2005-2012 Uwe Vogt, UV Software, Friedrichshafen
+ *  Copyright (c) 2013-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of PCANBasic-Wrapper.
+ *
+ *  PCANBasic-Wrapper is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v2.0 (or any later version). You can
+ *  choose between one of them if you use PCANBasic-Wrapper in whole or in part.
+ *
+ *  (1) BSD 2-Clause "Simplified" License
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  PCANBasic-Wrapper IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF PCANBasic-Wrapper, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  (2) GNU General Public License v2.0 or later
+ *
+ *  PCANBasic-Wrapper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PCANBasic-Wrapper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with PCANBasic-Wrapper; if not, see <https://www.gnu.org/licenses/>.
+ */
+/** @addtogroup  can_api
+ *  @{
+ */
+#ifndef CANAPI_PEAKCAN_TRACEFILE_H_INCLUDED
+#define CANAPI_PEAKCAN_TRACEFILE_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*  -----------  includes  ------------------------------------------------
+ */
+
+#include "can_api.h"                    /* CAN API V3 interface */
+#include "PeakCAN_Defines.h"            /* PCAN specific defines */
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+/** @name  Binary Trace File
+ *  @brief Layout of a binary trace file (CANPARA_TRACE_TYPE_BINARY)
+ *
+ *  A binary trace file starts with a file header (can_trc_header_t). All
+ *  integers are in host byte order.
+ *
+ *  - Version 1.0 (CANTRC_VERSION_FIXED): the header is followed by records
+ *    of fixed size (can_trc_record_t).
+ *  - Version 2.0 (CANTRC_VERSION_COMPACT, mode CANPARA_TRACE_MODE_COMPRESSED):
+ *    the header is followed by blocks. A block header (can_trc_block_t) is
+ *    followed by 'size' bytes of payload, which are 'length' bytes of encoded
+ *    records after decompression (codec PCAN_TRACE_CODEC_*).
+ *
+ *  An encoded record (compact format):
+ *  - tag:   1 byte, bit 0-3 = DLC, bit 4 = identifier from the dictionary,
+ *           bit 5 = flags byte follows, bit 6 = XTD and bit 7 = TX flag
+ *  - flags: 1 byte, CANTRC_FLAG_* (only with bit 5 of the tag, then bit 6
+ *           and 7 of the tag are zero)
+ *  - time:  varint, the difference to the time-stamp of the previous record
+ *           (the first record to 'nsec' of the block header), zig-zag encoded
+ *           and shifted left by one: bit 0 = 0 in [usec], bit 0 = 1 in [nsec]
+ *  - id:    1 byte index into the identifier dictionary (bit 4 of the tag),
+ *           or the identifier as varint, which is then appended to the
+ *           dictionary (up to CANTRC_DICT_SIZE entries)
+ *  - data:  payload of the length of the DLC (none for a remote frame)
+ *
+ *  A varint holds 7 bits per byte, least significant group first, bit 7
+ *  set in all bytes but the last. The time-stamp base and the dictionary
+ *  start anew with each block, so a block can be decoded on its own.
+ *
+ *  When a file of version 2.0 is closed, the blocks are followed by an index
+ *  block (codec CANTRC_CODEC_INDEX) with one entry per block (can_trc_index_t)
+ *  and a trailer (can_trc_trailer_t) at the very end of the file. An entry
+ *  holds the file offset and the time range of a block and a Bloom filter of
+ *  the identifiers in the block (3 bits per identifier). A file without index
+ *  (e.g. when the program was killed) can still be read sequentially.
+ *  @{ */
+#define CANTRC_MAGIC            "PCANTRC"  /**< magic string of a binary trace file */
+#define CANTRC_VERSION_FIXED     0x0100U   /**< version 1.0: records of fixed size */
+#define CANTRC_VERSION_COMPACT   0x0200U   /**< version 2.0: blocks of variable-length records */
+#define CANTRC_DICT_SIZE           256U    /**< max. number of identifiers in the dictionary of a block */
+#define CANTRC_BLOCK_SIZE       0x10000U   /**< max. length of a block (encoded records) in [byte] */
+#define CANTRC_TAG_DLC             0x0FU   /**< tag: data length code */
+#define CANTRC_TAG_DICT            0x10U   /**< tag: identifier from the dictionary */
+#define CANTRC_TAG_FLAGS           0x20U   /**< tag: flags byte follows */
+#define CANTRC_TAG_XTD             0x40U   /**< tag: extended format */
+#define CANTRC_TAG_TX              0x80U   /**< tag: transmitted message */
+#define CANTRC_CODEC_INDEX         0xFFU   /**< block header of the index (instead of PCAN_TRACE_CODEC_*) */
+#define CANTRC_INDEX_MAGIC      "PCANIDX"  /**< magic string of the index trailer */
+#define CANTRC_BLOOM_BITS          512U    /**< size of the Bloom filter of a block in [bit] */
+#define CANTRC_QUERY_IDS            16U    /**< max. number of identifiers in a query */
+/** @} */
+
+/** @name  Record Flags
+ *  @brief Flags of a trace record (can_trc_record_t)
+ *  @{ */
+#define CANTRC_FLAG_XTD            0x01U   /**< extended format */
+#define CANTRC_FLAG_RTR            0x02U   /**< remote frame */
+#define CANTRC_FLAG_FDF            0x04U   /**< CAN FD format */
+#define CANTRC_FLAG_BRS            0x08U   /**< bit-rate switching */
+#define CANTRC_FLAG_ESI            0x10U   /**< error state indicator */
+#define CANTRC_FLAG_STS            0x20U   /**< status message */
+#define CANTRC_FLAG_ECH            0x40U   /**< echo of a transmitted frame */
+#define CANTRC_FLAG_TX             0x80U   /**< transmitted message (can_write) */
+/** @} */
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+
+/** @brief       binary trace file: file header (80 bytes)
+ */
+typedef struct can_trc_header_t_ {     /* file header: */
+    char magic[8];                      /**<  CANTRC_MAGIC */
+    uint16_t version;                   /**<  version of the file format (CANTRC_VERSION_*) */
+    uint16_t hdr_size;                  /**<  size of the header in [byte] */
+    uint16_t rec_size;                  /**<  size of a record in [byte] (0 = variable) */
+    uint8_t  can_mode;                  /**<  operation mode of the CAN channel */
+    uint8_t  time_mode;                 /**<  time base of the time-stamps (PCAN_TIME_MONOTONIC or PCAN_TIME_REALTIME) */
+    uint64_t start;                     /**<  start of the trace session (wall-clock) in [usec] */
+    uint32_t board;                     /**<  PCAN channel handle */
+    uint32_t segment;                   /**<  segment number (0 = not segmented) */
+    char device[48];                    /**<  name of the CAN channel */
+} can_trc_header_t;
+
+/** @brief       binary trace file: record (80 bytes, version 1.0)
+ */
+typedef struct can_trc_record_t_ {     /* record: */
+    uint64_t nsec;                      /**<  time-stamp in [nsec] */
+    uint32_t id;                        /**<  CAN identifier */
+    uint8_t  flags;                     /**<  CANTRC_FLAG_* */
+    uint8_t  dlc;                       /**<  data length code */
+    uint8_t  len;                       /**<  data length in [byte] */
+    uint8_t  reserved;                  /**<  (zero) */
+    uint8_t  data[CANFD_MAX_LEN];       /**<  payload (zero-padded) */
+} can_trc_record_t;
+
+/** @brief       binary trace file: block header (24 bytes, version 2.0)
+ */
+typedef struct can_trc_block_t_ {      /* block header: */
+    uint32_t size;                      /**<  size of the payload in the file in [byte] */
+    uint32_t length;                    /**<  length of the encoded records in [byte] */
+    uint32_t count;                     /**<  number of records in the block */
+    uint8_t  codec;                     /**<  compression of the payload (PCAN_TRACE_CODEC_*) */
+    uint8_t  reserved[3];               /**<  (zero) */
+    uint64_t nsec;                      /**<  time-stamp of the first record in [nsec] */
+} can_trc_block_t;
+
+/** @brief       binary trace file: index entry of a block (96 bytes, version 2.0)
+ */
+typedef struct can_trc_index_t_ {      /* index entry: */
+    uint64_t offset;                    /**<  file offset of the block header */
+    uint64_t first;                     /**<  smallest time-stamp in the block in [nsec] */
+    uint64_t last;                      /**<  largest time-stamp in the block in [nsec] */
+    uint32_t count;                     /**<  number of records in the block */
+    uint32_t reserved;                  /**<  (zero) */
+    uint8_t  bloom[CANTRC_BLOOM_BITS / 8U];  /**<  Bloom filter of the identifiers in the block */
+} can_trc_index_t;
+
+/** @brief       binary trace file: index trailer (24 bytes, version 2.0)
+ */
+typedef struct can_trc_trailer_t_ {    /* index trailer: */
+    uint64_t offset;                    /**<  file offset of the index block */
+    uint32_t count;                     /**<  number of index entries */
+    uint32_t reserved;                  /**<  (zero) */
+    char magic[8];                      /**<  CANTRC_INDEX_MAGIC */
+} can_trc_trailer_t;
+
+/** @brief       trace file query: time range and identifiers
+ */
+typedef struct can_trc_query_t_ {      /* query: */
+    uint64_t from;                      /**<  time-stamps from (inclusive) in [nsec] */
+    uint64_t until;                     /**<  time-stamps until (inclusive) in [nsec] */
+    uint32_t count;                     /**<  number of identifiers (0 = all identifiers) */
+    uint32_t ids[CANTRC_QUERY_IDS];     /**<  identifiers (w/o regard of the format) */
+} can_trc_query_t;
+
+/** @brief       trace file statistics (since the last query)
+ */
+typedef struct can_trc_stats_t_ {      /* statistics: */
+    uint32_t blocks;                    /**<  number of blocks in the index (0 = no index) */
+    uint32_t read;                      /**<  number of blocks read */
+    uint32_t skipped;                   /**<  number of blocks skipped by the index */
+    uint32_t reserved;                  /**<  (zero) */
+    uint64_t records;                   /**<  number of records decoded */
+    uint64_t matched;                   /**<  number of records returned */
+} can_trc_stats_t;
+
+/** @brief       trace file reader (opaque)
+ */
+typedef struct can_trc_reader_t_ can_trc_reader_t;
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+/** @brief       opens a binary trace file for reading (version 1.0 and 2.0).
+ *
+ *  @note        A segmented trace session writes one file per segment; each
+ *               of them is opened on its own. The index of a compact trace
+ *               file is loaded, if any.
+ *
+ *  @param[in]   file     - name of the trace file
+ *  @param[out]  reader   - pointer to a trace file reader
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_RESOURCE  - file not found or out of memory (errno is set)
+ *  @retval      CANERR_ILLPARA   - not a binary trace file or unknown version
+ */
+CANAPI int can_trc_open(const char *file, can_trc_reader_t **reader);
+
+
+/** @brief       closes a trace file and releases the trace file reader.
+ *
+ *  @param[in]   reader   - trace file reader (from can_trc_open)
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ */
+CANAPI int can_trc_close(can_trc_reader_t *reader);
+
+
+/** @brief       returns the file header of a trace file.
+ *
+ *  @param[in]   reader   - trace file reader (from can_trc_open)
+ *  @param[out]  header   - pointer to a buffer for the file header
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ */
+CANAPI int can_trc_header(const can_trc_reader_t *reader, can_trc_header_t *header);
+
+
+/** @brief       reads the next record from a trace file. A record of a compact
+ *               trace file is decoded into the fixed-size representation.
+ *
+ *  @note        A block that was not completely written (e.g. when the program
+ *               was killed) ends the trace file. With a query (can_trc_query)
+ *               only matching records are read.
+ *
+ *  @param[in]   reader   - trace file reader (from can_trc_open)
+ *  @param[out]  record   - pointer to a buffer for the record
+ *
+ *  @returns     0 if a record was read, or a negative value on error.
+ *
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_RX_EMPTY  - end of the trace file
+ *  @retval      CANERR_FATAL     - the trace file is corrupted
+ */
+CANAPI int can_trc_read(can_trc_reader_t *reader, can_trc_record_t *record);
+
+
+/** @brief       sets a query and rewinds the trace file. Thereafter only records
+ *               within the time range and with one of the identifiers are read.
+ *
+ *  @note        With the index of a compact trace file the reader seeks to the
+ *               first block of the time range (binary search), skips all blocks
+ *               whose time range or Bloom filter excludes the query, and stops
+ *               after the last block of the time range. Without an index the
+ *               whole trace file is read and filtered.
+ *
+ *  @param[in]   reader   - trace file reader (from can_trc_open)
+ *  @param[in]   query    - pointer to a query, or NULL to read all records
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ *  @retval      CANERR_ILLPARA   - too many identifiers in the query
+ *  @retval      CANERR_FATAL     - the trace file could not be rewound
+ */
+CANAPI int can_trc_query(can_trc_reader_t *reader, const can_trc_query_t *query);
+
+
+/** @brief       returns statistics of the trace file reader since the last query
+ *               (resp. since the trace file was opened).
+ *
+ *  @param[in]   reader   - trace file reader (from can_trc_open)
+ *  @param[out]  stats    - pointer to a buffer for the statistics
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ */
+CANAPI int can_trc_stats(const can_trc_reader_t *reader, can_trc_stats_t *stats);
+
+
+/** @brief       converts a trace record into a CAN API V3 message. The time-stamp
+ *               of the message is taken from the time-stamp of the record.
+ *
+ *  @param[in]   record   - pointer to a trace record
+ *  @param[out]  message  - pointer to a message buffer
+ *
+ *  @returns     0 if successful, or a negative value on error.
+ *
+ *  @retval      CANERR_NULLPTR   - null-pointer assignment
+ */
+CANAPI int can_trc_message(const can_trc_record_t *record, can_message_t *message);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CANAPI_PEAKCAN_TRACEFILE_H_INCLUDED */
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de, Homepage: https://www.uv-software.de/
+ */
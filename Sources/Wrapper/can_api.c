@@ -61,6 +61,10 @@
 #define PLATFORM  "x64"
 #elif defined(_WIN32)
 #define PLATFORM  "x86"
+#elif defined(__linux__)
+#define PLATFORM  "Linux"
+#elif defined(__APPLE__)
+#define PLATFORM  "macOS"
 #else
 #error Platform not supported
 #endif
@@ -70,12 +74,19 @@
 #include "can_defs.h"
 #include "can_api.h"
 #include "can_btr.h"
+#include "PeakCAN_Extensions.h"
+#include "can_port.h"
+#include "can_trc.h"
+#include "can_rpl.h"
 
 #if defined(_WIN32) || defined(_WIN64)
 #include <windows.h>
 #include "PCANBasic.h"
 #else
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <poll.h>
 #include <sys/select.h>
 #if defined(__APPLE__)
 #include "PCBUSB.h"
@@ -84,8 +95,12 @@
 #endif
 #endif
 #include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
 #include <string.h>
 #include <assert.h>
+#include <math.h>
+#include <time.h>
 
 /*  -----------  options  ------------------------------------------------
  */
@@ -109,12 +124,18 @@ static void _finalizer() {
 /*  -----------  defines  ------------------------------------------------
  */
 #ifndef CAN_MAX_HANDLES
-#define CAN_MAX_HANDLES         (16)    // maximum number of open handles
+#define CAN_MAX_HANDLES         (16)    // maximum number of open handles (default)
 #endif
+#define CAN_LIMIT_HANDLES       (0xFFFF) // upper limit for the number of handles
 #define INVALID_HANDLE          (-1)
-#define IS_HANDLE_VALID(hnd)    ((0 <= (hnd)) && ((hnd) < CAN_MAX_HANDLES))
+#define IS_HANDLE_VALID(hnd)    ((unsigned int)(hnd) < (unsigned int)num_handles)
 #define IS_HANDLE_OPENED(hnd)   (can[(hnd)].board != PCAN_NONEBUS)
 #define IS_CHANNEL_VALID(ch)    ((0 <= (ch)) && ((ch) <= 0xFFFF))
+#define IS_CHANNEL_PNP(ch)      (((ch) < 0x21) || (0x31 < (ch)))  // not ISA or Dongle
+#define STATUS_SET(hnd,bits)    (void)port_atomic_or8(&can[(hnd)].status.byte, (uint8_t)(bits))
+#define STATUS_CLR(hnd,bits)    (void)port_atomic_and8(&can[(hnd)].status.byte, (uint8_t)~(bits))
+#define STATUS_PUT(hnd,bits,on) do { if (on) STATUS_SET(hnd, bits); else STATUS_CLR(hnd, bits); } while (0)
+#define STATUS_GET(hnd)         port_atomic_load8(&can[(hnd)].status.byte)
 #ifndef DLC2LEN
 #define DLC2LEN(x)              dlc_table[((x) < 16) ? (x) : 15]
 #endif
@@ -148,6 +169,63 @@ static void _finalizer() {
 #define DEV_VENDOR              PCAN_LIB_VENDOR
 #define DEV_DLLNAME             PCAN_LIB_BASIC
 #define NUM_CHANNELS            PCAN_BOARDS
+#define RX_REFUSED              (+1)    // message read, but refused by user
+#define RX_ECHO                 (+2)    // message read, echo of a transmitted frame
+#define TX_BACKOFF_MIN          (50U)   // first back-off of a blocking write in [usec]
+#define TX_BACKOFF_MAX          (1000U) // last back-off of a blocking write in [usec]
+#define BUSLOAD_SLOTS           (10)    // number of time slots of the bus-load window
+#define BUSLOAD_SLOT_USEC       (100000U)  // duration of one time slot in [usec]
+#define RCVQ_MAX_SIZE           (0x100000U)  // maximum number of messages in the receive queue
+#define RCVQ_RETRY_USEC         (1000U) // delay of the drain thread after a read error in [usec]
+#define RCVQ_POLL_MSEC          (100U)  // longest wait of the drain thread for a receive event in [msec]
+#define TRMQ_MAX_SIZE           (0x10000U)  // maximum number of messages in the transmit queue
+#define TRMQ_AHEAD_USEC         (1000U) // bus time handed to the PCAN transmit queue in advance [usec]
+#define TRMQ_WAIT_INFINITE      (0xFFFFFFFFU)  // feeder thread waits for a new message
+#define TRMQ_ACTIVE(hnd)        (can[(hnd)].write == trmq_write)  // messages are queued (and booked by the feeder thread)
+#define CYCLIC_TICK_USEC        (250U)  // time grid of the cyclic scheduler in [usec]
+#define CYCLIC_WHEEL0_BITS      (8)     // slots of the timer wheel: level 0 (2^8 ticks)
+#define CYCLIC_WHEELN_BITS      (6)     //   level 1 and 2 (2^6 slots each, i.e. up to 2^20 ticks)
+#define CYCLIC_WHEEL0_SIZE      (1U << CYCLIC_WHEEL0_BITS)
+#define CYCLIC_WHEELN_SIZE      (1U << CYCLIC_WHEELN_BITS)
+#define CYCLIC_WHEEL_SLOTS      (CYCLIC_WHEEL0_SIZE + 2U * CYCLIC_WHEELN_SIZE)
+#define CYCLIC_WHEEL_RANGE      (1ull << (CYCLIC_WHEEL0_BITS + 2 * CYCLIC_WHEELN_BITS))
+#define CYCLIC_NONE             (-1)    // end of a slot list resp. not in the wheel
+#define CYCLIC_WAIT_INFINITE    (0xFFFFFFFFU)  // scheduler thread waits for a new message
+#define TRACE_RING_SIZE         (4096U) // number of records in the capture ring (power of two)
+#define TRACE_BUFFER_SIZE       (0x10000U)  // write buffer of the writer thread in [byte]
+#define TRACE_LINE_MAX          (320U)  // longest line of a CSV trace file in [byte]
+#define TRACE_POLL_USEC         (10000U)  // delay of the writer thread when the ring is empty in [usec]
+#define TRACE_FLUSH_USEC        (100000U) // maximum age of a record in the write buffer in [usec]
+#define TRACE_BLOCK_USEC        (1000000U)  // maximum age of a block of a compact trace file in [usec]
+#define TRACE_MODE_OPTIONS      (CANPARA_TRACE_MODE_OVERWRITE | CANPARA_TRACE_MODE_SEGMENTED | \
+                                 CANPARA_TRACE_MODE_PREFIX_DATE | CANPARA_TRACE_MODE_PREFIX_TIME | \
+                                 CANPARA_TRACE_MODE_OUTPUT_LEN)
+#define TRACE_COMPACT(conf)     (((conf)->type == CANPARA_TRACE_TYPE_BINARY) && ((conf)->mode & CANPARA_TRACE_MODE_COMPRESSED))
+#define TRACE_ACTIVE(hnd)       ((can[(hnd)].trace != NULL) && port_atomic_load32(&can[(hnd)].trace->active))
+#if defined(_WIN32) || defined(_WIN64)
+#define TRACE_PATH_SEP          "\\"
+#define TRACE_HOME_ENV          "USERPROFILE"
+#else
+#define TRACE_PATH_SEP          "/"
+#define TRACE_HOME_ENV          "HOME"
+#endif
+#if defined(_WIN32) || defined(_WIN64)
+#define REPLAY_SPIN_USEC        (2000U) // busy-wait before a deadline of the trace replay in [usec]
+#else
+#define REPLAY_SPIN_USEC        (200U)  // busy-wait before a deadline of the trace replay in [usec]
+#endif
+#define REPLAY_SLEEP_USEC       (100000U)  // longest sleep of the trace replay (to look for a kill) in [usec]
+#define REPLAY_POLL_USEC        (100U)  // delay of the trace replay when the read-ahead buffer is empty in [usec]
+#define REPLAY_TX_TIMEOUT       (100U)  // time-out of a write of the trace replay in [msec]
+#define RXCB_WAIT_MSEC          (100U)  // wait of the callback thread before it looks again in [msec]
+#define ECHO_PENDING            (256U)  // number of writes awaiting their echo frame (power of two)
+#define ECHO_WINDOW             (8U)    // number of pending writes searched for an echo frame
+#define ECHO_NONE               (0xFFFFFFFFU)  // pending write consumed or canceled
+#define TIMEMAP_WINDOW_USEC     (100000U)  // sampling window of the host clock mapping in [usec]
+#define TIMEMAP_WEIGHT          (1.0 / 256.0)  // weight of a new sample in the regression
+#define TIMEMAP_MAX_SKEW        (0.001) // plausible drift of the device clock (1000 ppm)
+#define FLIST_STD_WORDS         (0x800U / 32U)  // size of the 11-bit identifier bitmap in words
+#define ATTACHED_MAX            (64)    // maximum number of attached channels in the snapshot
 
 /*  -----------  types  --------------------------------------------------
  */
@@ -162,19 +240,270 @@ typedef struct {                        // message filtering:
     uint64_t mask;                      //   acceptance mask
 }   can_filter_t;
 
+typedef struct {                        // 29-bit identifier range:
+    uint32_t first;                     //   first identifier of the range
+    uint32_t last;                      //   last identifier of the range
+}   can_range_t;
+
+typedef struct {                        // acceptance filter list (compiled):
+    uint32_t std[FLIST_STD_WORDS];      //   bitmap of accepted 11-bit identifiers
+    uint32_t count;                     //   number of identifier ranges set by the user
+    uint32_t num_xtd;                   //   number of disjoint 29-bit identifier ranges
+    can_range_t *xtd;                   //   sorted 29-bit identifier ranges (same block)
+    int programmed;                     //   hardware filter set from the list
+}   can_filterlist_t;
+
+typedef struct {                        // applied configuration (last full restart):
+    int valid;                          //   controller initialized with these settings
+    uint16_t btr0btr1;                  //   btr0btr1 value (CAN 2.0)
+    char string[PCAN_MAX_BUFFER_SIZE];  //   bit-rate string (CAN FD)
+    uint8_t mode;                       //   operation mode (listen-only, error frames)
+    can_filter_t filter;                //   acceptance filter
+    int echo;                           //   echo frames of transmitted messages
+}   can_applied_t;
+
+typedef struct {                        // restart counters:
+    uint64_t full;                      //   restarts with reinitialization
+    uint64_t fast;                      //   restarts by resuming the controller
+}   can_restarts_t;
+
+typedef struct {                        // attached channels (snapshot):
+    can_pcan_channel_t channel[ATTACHED_MAX];  //   condition, features, etc. per channel
+    int count;                          //   number of attached channels
+    int valid;                          //   snapshot taken and not invalidated
+    int supported;                      //   PCAN_ATTACHED_CHANNELS supported by the driver
+}   can_attached_t;
+
 typedef struct {                        // frame counters:
     uint64_t tx;                        //   number of transmitted CAN frames
     uint64_t rx;                        //   number of received CAN frames
     uint64_t err;                       //   number of receiced error frames
 }   can_counter_t;
 
+typedef struct {                        // blocking write statistics:
+    uint64_t time;                      //   total time waited in [usec]
+    uint64_t count;                     //   number of writes that waited
+    uint32_t max;                       //   longest time waited in [usec]
+}   can_waiting_t;
+
+typedef struct {                        // bus-load time slot:
+    uint64_t slot;                      //   number of the time slot
+    uint64_t busy;                      //   bus busy time in [psec]
+}   can_timeslot_t;
+
+typedef struct {                        // bus-load measurement:
+    uint32_t nominal;                   //   time of one nominal bit in [psec]
+    uint32_t data;                      //   time of one data phase bit in [psec]
+    uint64_t start;                     //   start of the measurement in [usec]
+    can_timeslot_t window[BUSLOAD_SLOTS];  //   sliding window of time slots
+}   can_busload_t;
+
+typedef struct {                        // queued message (receive queue):
+    can_message_t msg;                  //   the message
+    uint64_t nsec;                      //   its time-stamp in [nsec]
+    uint8_t echo;                       //   echo of a transmitted frame
+}   can_rcventry_t;
+
+typedef struct PORT_ALIGNED {           // software receive queue (SPSC ring):
+    struct PORT_ALIGNED {               //   producer (drain thread):
+        volatile uint32_t head;         //     index of the next message to be written
+        volatile uint32_t high;         //     maximum number of messages in the queue
+        volatile uint64_t ovfl;         //     number of messages dropped (queue full)
+        volatile uint32_t error;        //     last read error (0 = none)
+    }   put;
+    struct PORT_ALIGNED {               //   consumer (can_read):
+        volatile uint32_t tail;         //     index of the next message to be read
+    }   get;
+    can_rcventry_t *buffer;             //   message buffer (preallocated)
+    uint32_t size;                      //   number of messages (power of two)
+    volatile uint32_t running;          //   drain thread is running
+    port_thread_t thread;               //   drain thread
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE event;                       //   signals new messages to can_read
+#else
+    int stop[2];                        //   pipe to stop the drain thread
+#endif
+}   can_rcvqueue_t;
+
+typedef struct {                        // queued message (transmit queue):
+    uint32_t prio;                      //   arbitration priority (lower value wins)
+    uint64_t seq;                       //   sequence number (FIFO within a priority)
+    uint64_t time;                      //   time of the write call in [usec]
+    can_message_t msg;                  //   the message
+}   can_trmentry_t;
+
+typedef struct {                        // queuing latency of a priority class:
+    uint64_t count;                     //   number of messages handed to the driver
+    uint64_t sum;                       //   sum of all latencies in [usec]
+    uint32_t min;                       //   shortest latency in [usec]
+    uint32_t max;                       //   longest latency in [usec]
+}   can_trmstats_t;
+
+typedef struct PORT_ALIGNED {           // software transmit queue (priority heap):
+    port_mutex_t lock;                  //   protects the heap and the statistics
+    can_trmentry_t *heap;               //   binary min-heap (preallocated)
+    uint32_t size;                      //   maximum number of messages
+    uint32_t count;                     //   number of messages in the heap
+    uint32_t high;                      //   maximum number of messages in the queue
+    int inflight;                       //   one message taken out by the feeder thread
+    uint64_t ovfl;                      //   number of writes refused (queue full)
+    uint64_t dropped;                   //   number of messages dropped (write error)
+    uint64_t seq;                       //   next sequence number
+    uint64_t horizon;                   //   estimated end of the frames handed to the driver [usec]
+    int (*write)(int handle, const can_message_t *msg);  //   write function (PCAN transmit queue)
+    can_trmstats_t stats[PCAN_TRMQ_CLASSES];  //   queuing latency per priority class
+    volatile uint32_t running;          //   feeder thread is running
+    port_thread_t thread;               //   feeder thread
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE event;                       //   signals new messages to the feeder thread
+#else
+    int wake[2];                        //   pipe to wake up the feeder thread
+#endif
+}   can_trmqueue_t;
+
+typedef struct {                        // cyclic message:
+    int used;                           //   entry in use
+    int slot;                           //   slot of the timer wheel (or CYCLIC_NONE)
+    int next, prev;                     //   neighbors in the slot list (or CYCLIC_NONE)
+    uint32_t period;                    //   period in [usec]
+    uint32_t phase;                     //   first deadline after the start in [usec]
+    uint64_t deadline;                  //   next deadline (host clock) in [usec]
+    can_message_t msg;                  //   the message
+    uint64_t sent;                      //   number of transmissions
+    uint64_t missed;                    //   number of missed deadlines
+    uint64_t sum;                       //   sum of all latenesses in [usec]
+    uint32_t max;                       //   largest lateness in [usec]
+    uint32_t serial;                    //   serial number (to tell a re-used entry)
+}   can_cycentry_t;
+
+typedef struct {                        // cyclic message due:
+    int index;                          //   entry index
+    uint32_t serial;                    //   serial number of the entry
+    uint64_t deadline;                  //   its deadline (host clock) in [usec]
+    can_message_t msg;                  //   copy of the message to be written
+    uint64_t late;                      //   lateness when written in [usec]
+    int rc;                             //   result of the write
+}   can_cycdue_t;
+
+typedef struct PORT_ALIGNED {           // cyclic scheduler (hierarchical timer wheel):
+    port_mutex_t lock;                  //   protects the entries and the wheel
+    can_cycentry_t entry[CANCYCLIC_MAX_MESSAGES];  //   cyclic messages
+    int wheel[CYCLIC_WHEEL_SLOTS];      //   slot lists of the levels 0, 1 and 2
+    uint64_t tick;                      //   next tick to be processed
+    int count;                          //   number of cyclic messages
+    uint32_t serial;                    //   serial number of the last entry added
+    can_cycdue_t due[CANCYCLIC_MAX_MESSAGES];  //   messages due in the current burst
+    volatile uint32_t running;          //   scheduler thread is running
+    port_thread_t thread;               //   scheduler thread
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE event;                       //   signals changes to the scheduler thread
+#else
+    int wake[2];                        //   pipe to wake up the scheduler thread
+#endif
+}   can_cyclic_t;
+
+typedef struct {                        // trace file settings:
+    char folder[CANPROP_MAX_STRING_LENGTH+1];  //   folder of the trace files (as set)
+    uint8_t type;                       //   trace file type (CANPARA_TRACE_TYPE_*)
+    uint16_t mode;                      //   trace file mode (CANPARA_TRACE_MODE_*)
+    uint16_t size;                      //   size of a trace file resp. segment in [10KB]
+    uint8_t codec;                      //   block compression of a compact trace file (PCAN_TRACE_CODEC_*)
+}   can_traceconf_t;
+
+typedef struct {                        // slot of the capture ring:
+    volatile uint32_t seq;              //   sequence number (free resp. published)
+    uint32_t session;                   //   trace session of the record
+    can_trc_record_t rec;               //   the record
+}   can_trcslot_t;
+
+typedef struct PORT_ALIGNED {           // trace file recorder (MPSC ring and writer thread):
+    struct PORT_ALIGNED {               //   producers (can_read, can_write, scheduler thread):
+        volatile uint32_t head;         //     index of the next slot to be claimed
+        volatile uint64_t dropped;      //     number of records dropped (ring full)
+    }   put;
+    struct PORT_ALIGNED {               //   consumer (writer thread):
+        uint32_t tail;                  //     index of the next slot to be written
+    }   get;
+    can_trcslot_t ring[TRACE_RING_SIZE];  //   capture ring
+    volatile uint32_t active;           //   capture is on
+    volatile uint32_t session;          //   number of the current trace session
+    volatile uint32_t running;          //   writer thread is running
+    port_thread_t thread;               //   writer thread
+    can_traceconf_t conf;               //   settings of the trace session
+    can_trc_header_t header;            //   header of a binary trace file
+    char base[CANPROP_MAX_STRING_LENGTH+1];  //   path and file name w/o segment number and extension
+    char file[CANPROP_MAX_STRING_LENGTH+1];  //   name of the current trace file
+    port_mutex_t lock;                  //   protects the file name (changed with a new segment)
+    FILE *fp;                           //   current trace file (NULL = closed)
+    uint64_t limit;                     //   size of a trace file resp. segment in [byte]
+    uint64_t offset;                    //   size of the current trace file (incl. write buffer)
+    uint32_t segment;                   //   number of the current segment (0 = not segmented)
+    uint64_t flushed;                   //   time of the last write in [usec]
+    uint64_t sealed;                    //   time of the last block (compact trace file) in [usec]
+    trc_encoder_t encoder;              //   encoder of a compact trace file (version 2.0)
+    trc_index_t index;                  //   index of the current segment (compact trace file)
+    size_t fill;                        //   number of bytes in the write buffer
+    char buffer[TRACE_BUFFER_SIZE];     //   write buffer (one large sequential write)
+}   can_recorder_t;
+
+typedef struct {                        // pending write:
+    volatile uint32_t key;              //   identifier | (xtd << 31), or ECHO_NONE
+    uint64_t time;                      //   time of the write call in [usec]
+}   can_pending_t;
+
+typedef struct PORT_ALIGNED {           // transmit confirmation (echo frames):
+    can_pending_t pending[ECHO_PENDING];  //   writes awaiting their echo frame
+    volatile uint32_t head;             //   index of the next pending write (writers)
+    volatile uint32_t tail;             //   index of the oldest pending write (reader)
+    int64_t offset;                     //   offset of the time-stamps to the host clock in [usec]
+    int synced;                         //   offset has been determined
+    volatile uint64_t count;            //   number of confirmed transmissions
+    volatile uint64_t sum;              //   sum of all latencies in [usec]
+    volatile uint64_t unmatched;        //   echo frames w/o a pending write
+    volatile uint32_t min;              //   shortest latency in [usec]
+    volatile uint32_t max;              //   longest latency in [usec]
+    volatile uint64_t histogram[PCAN_LATENCY_BINS];  //   latencies in [2^n, 2^(n+1)) usec
+}   can_echo_t;
+
+typedef struct {                        // host clock mapping (linear regression):
+    uint8_t mode;                       //   time-stamp mode (PCAN_TIME_*)
+    int started;                        //   first sample taken
+    int fitted;                         //   at least one window closed
+    uint64_t last;                      //   device time of the last sample in [usec]
+    int64_t base;                       //   host minus device time of the first sample in [usec]
+    uint64_t window;                    //   start of the sampling window (device time) in [usec]
+    uint64_t low_dev;                   //   device time of the window minimum in [usec]
+    int64_t low;                        //   smallest host minus device time in the window
+    uint64_t ref;                       //   device time of the regression origin in [usec]
+    double s, sx, sy, sxx, sxy;         //   weighted sums of the regression
+    double a, b;                        //   offset (at origin) and skew of the fit
+    double var;                         //   variance of the residuals in [usec^2]
+    int64_t real;                       //   wall-clock minus monotonic time in [usec]
+    volatile uint32_t skew;             //   skew in [ppb] (int32_t, atomic)
+    volatile uint32_t jitter;           //   residual jitter in [nsec] (atomic)
+}   can_timemap_t;
+
+typedef struct {                        // reception callback:
+    can_rcv_callback_t func;            //   callback function
+    void *context;                      //   user context of the callback
+    size_t batch;                       //   maximum number of messages per call
+    can_message_t *buffer;              //   message buffer (preallocated)
+    volatile uint32_t running;          //   callback thread is running
+    port_thread_t thread;               //   callback thread
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE event;                       //   wake-up of the callback thread
+#else
+    int wake[2];                        //   wake-up pipe of the callback thread
+#endif
+}   can_callback_t;
+
 typedef struct {                        // error code capture:
     uint8_t lec;                        //   last error code
     uint8_t rx_err;                     //   receive error counter
     uint8_t tx_err;                     //   transmit error counter
 }   can_error_t;
 
-typedef struct {                        // PCAN interface:
+typedef struct PORT_ALIGNED {           // PCAN interface (one cache line or more):
     TPCANHandle board;                  //   board hardware channel handle
     BYTE  brd_type;                     //   board type (none PnP hardware)
     DWORD brd_port;                     //   board parameter: I/O port address
@@ -183,35 +512,132 @@ typedef struct {                        // PCAN interface:
     HANDLE event;                       //   event handle for blocking read
 #else
     int   fdes;                         //   file descriptor for blocking read
+    int   wakeup[2];                    //   self-pipe to wake up a blocking read
 #endif
     can_mode_t mode;                    //   operation mode of the CAN channel
+    int (*read)(int handle, can_message_t *msg, uint64_t *nsec, can_counter_t *counter);  //   read function (op-mode)
+    int (*write)(int handle, const can_message_t *msg);  //   write function (op-mode)
+    BYTE refuse;                        //   message types refused (op-mode)
     can_filter_t filter;                //   message filtering settings
-    can_status_t status;                //   8-bit status register
+    can_filterlist_t *flist;            //   acceptance filter list, if any
+    volatile can_status_t status;       //   8-bit status register (atomic)
     can_error_t error;                  //   error code capture
-    can_counter_t counters;             //   statistical counters
+    volatile can_counter_t counters;    //   statistical counters (atomic)
+    volatile can_waiting_t tx_wait;     //   blocking write statistics (atomic)
+    volatile can_busload_t busload;     //   bus-load measurement (atomic)
+    uint32_t rcvq_size;                 //   size of the software receive queue (0 = off)
+    can_rcvqueue_t *rcvq;               //   software receive queue, if any
+    uint32_t trmq_size;                 //   size of the software transmit queue (0 = off)
+    can_trmqueue_t *trmq;               //   software transmit queue, if any
+    can_cyclic_t *cyclic;               //   cyclic scheduler, if any
+    can_callback_t *rxcb;               //   reception callback, if any
+    can_traceconf_t trace_conf;         //   trace file settings
+    can_recorder_t *trace;              //   trace file recorder, if any
+    int trace_vendor;                   //   PCANBasic trace session active
+    can_echo_t *echo;                   //   transmit confirmation, if enabled
+    can_timemap_t timemap;              //   host clock mapping of the time-stamps
+    can_applied_t applied;              //   configuration of the last full restart
+    can_restarts_t restarts;            //   full vs. fast restarts
+    volatile uint32_t signaled;         //   incremented by can_kill (atomic)
 }   can_interface_t;
 
 /*  -----------  prototypes  ---------------------------------------------
  */
-static void var_init(void);             // initialize all variables
+static int var_init(void);              // initialize all variables
 static int all_closed(void);            // check if all handles closed
 
+static int handle_of(TPCANHandle board);  // board to handle (or -1)
+
 static int exit_channel(int handle);    // teardown a single channel
 static int kill_channel(int handle);    // signal a single channel
+static int wakeup_close(int handle);    // close event handle resp. self-pipe
 
 static void can_message(const TPCANMsg *pcan_msg, can_message_t *msg);
 static void can_message_fd(const TPCANMsgFD *pcan_msg, can_message_t *msg);
 static void can_message_sts(can_status_t status, can_error_t error, can_message_t *msg);
-static void can_timestamp(TPCANTimestamp timestamp, can_message_t *msg);
-static void can_timestamp_fd(TPCANTimestampFD timestamp, can_message_t *msg);
+static int read_message(int handle, can_message_t *msg, uint64_t *nsec, uint16_t timeout);
+static void can_timestamp(uint64_t nsec, can_message_t *msg);
+static uint64_t pcan_nsec(TPCANTimestamp timestamp);
+static uint64_t pcan_nsec_fd(TPCANTimestampFD timestamp);
+
+static int pcan_write_std(int handle, const can_message_t *msg);
+static int pcan_write_fd(int handle, const can_message_t *msg);
+static int pcan_write_error(int handle, TPCANStatus sts, uint32_t pending);
+static int pcan_write_blocking(int handle, const can_message_t *msg, uint16_t timeout);
+static int pcan_check_message(int handle, const can_message_t *msg);
+static int pcan_read_std(int handle, can_message_t *msg, uint64_t *nsec, can_counter_t *counter);
+static int pcan_read_fd(int handle, can_message_t *msg, uint64_t *nsec, can_counter_t *counter);
+static void pcan_specialize(int handle);  // read/write functions of the op-mode
+static int pcan_wait_event(int handle, uint16_t timeout);
+
+static int rcvq_start(int handle);      // start the drain thread
+static void rcvq_stop(int handle);      // stop the drain thread
+static void rcvq_free(int handle);      // release the receive queue
+static int rcvq_read(int handle, can_message_t *msg, uint64_t *nsec, can_counter_t *counter);
+static int rcvq_wait(int handle, uint16_t timeout);
+
+static int trmq_start(int handle);      // start the feeder thread
+static void trmq_stop(int handle);      // stop the feeder thread
+static void trmq_free(int handle);      // release the transmit queue
+static int trmq_write(int handle, const can_message_t *msg);
+
+static int cyclic_alloc(int handle);    // allocate the cyclic scheduler
+static int cyclic_start(int handle);    // start the scheduler thread
+static void cyclic_stop(int handle);    // stop the scheduler thread
+static void cyclic_free(int handle);    // release the cyclic scheduler
+static uint64_t cyclic_align(uint64_t usec);  // deadline on the tick grid
+static void cyclic_insert(can_cyclic_t *cyclic, int index);
+static void cyclic_unlink(can_cyclic_t *cyclic, int index);
+static void cyclic_signal(can_cyclic_t *cyclic);
+
+static int trace_start(int handle);     // open the trace file and start the writer thread
+static void trace_stop(int handle);     // stop the writer thread and close the trace file
+static void trace_free(int handle);     // release the trace file recorder
+static int trace_vendor(int handle, int on);  // PCANBasic trace session
+static void trace_capture(can_recorder_t *trace, const can_message_t *msg, uint64_t nsec, uint8_t dir);
+static uint64_t trace_clock(int handle);  // host time of a transmitted message in [nsec]
+static uint64_t trace_stamp(int handle, uint64_t nsec);  // host time of a received message in [nsec]
+
+static int replay_wait(int handle, uint64_t deadline, uint32_t signaled);
+
+static int rxcb_start(int handle);      // start the callback thread
+static void rxcb_stop(int handle);      // stop the callback thread
+static void rxcb_wait(int handle);      // wait for messages or a stop
+static void rxcb_free(int handle);      // release the reception callback
+
+static void echo_reset(int handle);    // reset the latency statistics
+static uint32_t echo_pending(int handle, const can_message_t *msg);
+static void echo_confirm(int handle, const can_message_t *msg, uint64_t nsec);
+
+static void timemap_reset(int handle);  // reset the host clock mapping
+static void timemap_sample(can_timemap_t *tm, uint64_t device, uint64_t host);
+static uint64_t timemap_apply(int handle, uint64_t nsec);
+
+static void busload_reset(int handle, const can_bitrate_t *bitrate);
+static uint64_t busload_frame(int handle, const can_message_t *msg);
+static void busload_account(int handle, uint64_t busy);
+static uint16_t busload_get(int handle);
+static void tx_account(int handle, const can_message_t *msgs, size_t n, uint64_t busy);
 
 static int pcan_error(TPCANStatus);     // PCAN specific errors
 static int pcan_compatibility(void);    // PCAN compatibility check
 
 static TPCANStatus pcan_capability(TPCANHandle board, can_mode_t *capability);
+static int pcan_restart(int handle, uint16_t btr0btr1, const char *string);
+static int pcan_unchanged(int handle, uint16_t btr0btr1, const char *string);
+static TPCANStatus pcan_resume(int handle);
+static void pcan_features(DWORD features, can_mode_t *capability);
 static TPCANStatus pcan_get_filter(int handle, uint64_t *filter, filtering_t mode);
 static TPCANStatus pcan_set_filter(int handle, uint64_t filter, filtering_t mode);
 static TPCANStatus pcan_reset_filter(int handle);
+static int pcan_snapshot(int handle, can_pcan_snapshot_t *snapshot);
+
+static int flist_set(int handle, const can_pcan_filter_t *ranges, size_t n);
+static void flist_free(int handle);
+
+static int attached_refresh(void);      // take a snapshot of attached channels
+static const can_pcan_channel_t *attached_lookup(TPCANHandle board);
+static int attached_next(int index);    // next listed entry in can_boards[]
 
 static int lib_parameter(uint16_t param, void *value, size_t nbyte);
 static int drv_parameter(int handle, uint16_t param, void *value, size_t nbyte);
@@ -258,8 +684,14 @@ can_board_t can_boards[NUM_CHANNELS+1] = {  // list of supported CAN channels
 static const uint8_t dlc_table[16] = {  // DLC to length
     0,1,2,3,4,5,6,7,8,12,16,20,24,32,48,64
 };
-static can_interface_t can[CAN_MAX_HANDLES];  // interface handles
+static can_interface_t *can = NULL;     // interface handles (dynamic)
+static int num_handles = 0;             // number of allocated handles
+static int max_handles = CAN_MAX_HANDLES;  // configured number of handles
+static int *free_handles = NULL;        // stack of unused handles
+static int num_free = 0;                // number of unused handles
+static uint16_t board_index[0x10000];   // board to handle + 1 (0 = unused)
 static int init = 0;                    // initialization flag
+static can_attached_t attached = {0};   // snapshot of attached channels
 
 /*  -----------  functions  ----------------------------------------------
  */
@@ -269,26 +701,34 @@ int can_test(int32_t board, uint8_t mode, const void *param, int *result)
     TPCANStatus sts;                    // represents a status
     DWORD condition;                    // channel condition
     can_mode_t capa;                    // channel capability
+    const can_pcan_channel_t *entry = NULL;  // channel in the snapshot
     int used = 0;                       // own used channel
-    int i;                              // loop variable
+    int rc;                             // return value
 
     if (!IS_CHANNEL_VALID(board)) {     // PCAN handle is of type WORD!
         return pcan_error(PCAN_ERROR_ILLCLIENT);
     }
     if (!init) {                        // if not initialized:
-        var_init();                     //   initialize all variables
+        if ((rc = var_init()) != CANERR_NOERROR)
+            return rc;                  //   initialize all variables
         init = 1;                       //   set initialization flag
     }
-    // get channel condition to check for availability
-    if ((sts = CAN_GetValue((TPCANHandle)board, PCAN_CHANNEL_CONDITION,
-                           (void*)&condition, sizeof(condition))) != PCAN_ERROR_OK)
+    // get channel condition from the snapshot of attached channels (taken once)
+    if (!attached.valid)
+        (void)attached_refresh();
+    if (attached.supported && IS_CHANNEL_PNP(board)) {
+        if ((entry = attached_lookup((TPCANHandle)board)) != NULL)
+            condition = (DWORD)entry->condition;
+        else
+            condition = PCAN_CHANNEL_UNAVAILABLE;
+    }
+    // or ask the driver for channel condition to check for availability
+    else if ((sts = CAN_GetValue((TPCANHandle)board, PCAN_CHANNEL_CONDITION,
+                                (void*)&condition, sizeof(condition))) != PCAN_ERROR_OK)
         return pcan_error(sts);
-    for (i = 0; i < CAN_MAX_HANDLES; i++) {
-        if (can[i].board == (TPCANHandle)board) { // me, myself and I!
-            condition = PCAN_CHANNEL_OCCUPIED;
-            used = 1;
-            break;
-        }
+    if (handle_of((TPCANHandle)board) != INVALID_HANDLE) { // me, myself and I!
+        condition = PCAN_CHANNEL_OCCUPIED;
+        used = 1;
     }
     // check if the CAN channel is available
     if (result) {
@@ -304,8 +744,10 @@ int can_test(int32_t board, uint8_t mode, const void *param, int *result)
     // check given operation mode against the operation capability
     if (((condition == PCAN_CHANNEL_AVAILABLE) || (condition == PCAN_CHANNEL_PCANVIEW)) ||
        (/*(condition == PCAN_CHANNEL_OCCUPIED) ||*/ used)) {   // FIXME: issue TC07_47_9w - returns PCAN_ERROR_INITIALIZE if channel used by another process
-        // get operation capability from CAN board
-        if ((sts = pcan_capability((TPCANHandle)board, &capa)) != PCAN_ERROR_OK)
+        // get operation capability from the snapshot or from CAN board
+        if (entry)
+            pcan_features((DWORD)entry->features, &capa);
+        else if ((sts = pcan_capability((TPCANHandle)board, &capa)) != PCAN_ERROR_OK)
             return pcan_error(sts);
         // check given operation mode against the operation capability
         if ((mode & ~capa.byte) != 0)
@@ -339,20 +781,16 @@ int can_init(int32_t board, uint8_t mode, const void *param)
         return pcan_error(PCAN_ERROR_ILLCLIENT);
     }
     if (!init) {                        // if not initialized:
-        var_init();                     //   initialize all variables
+        if ((rc = var_init()) != CANERR_NOERROR)
+            return rc;                  //   initialize all variables
         init = 1;                       //   set initialization flag
     }
-    for (handle = 0; handle < CAN_MAX_HANDLES; handle++) {
-        if (can[handle].board == (TPCANHandle)board) // channel already in use
-            return CANERR_YETINIT;
-    }
-    for (handle = 0; handle < CAN_MAX_HANDLES; handle++) {
-        if (can[handle].board == PCAN_NONEBUS)  // get an unused handle, if any
-            break;
-    }
-    if (!IS_HANDLE_VALID(handle)) {     // no free handle found
+    if (handle_of((TPCANHandle)board) != INVALID_HANDLE) // channel already in use
+        return CANERR_YETINIT;
+    if (num_free <= 0) {                // no free handle found
         return CANERR_NOTINIT;
     }
+    handle = free_handles[num_free - 1];  // get an unused handle (top of stack)
     // check for minimum required library version
     if ((rc = pcan_compatibility()) != PCAN_ERROR_OK)
         return rc;
@@ -364,31 +802,44 @@ int can_init(int32_t board, uint8_t mode, const void *param)
     if (!(mode & CANMODE_FDOE) && ((mode & CANMODE_BRSE) || (mode & CANMODE_NISO)))
         return CANERR_ILLPARA;
 #if defined(_WIN32) || defined(_WIN64)
-    /* one event handle per channel */
+    /* one event handle per channel (note: a named event would be one kernel
+     * object shared by all channels, and even by all processes) */
     if ((can[handle].event = CreateEvent( // create an event handle
         NULL,                           //   default security attributes
         FALSE,                          //   auto-reset event
         FALSE,                          //   initial state is nonsignaled
-        TEXT("PCANBasic")               //   object name
+        NULL                            //   unnamed object
        )) == NULL) {
         return SYSERR_OFFSET - (int)GetLastError();
     }
+#else
+    /* one self-pipe per channel (to signal a blocking read) */
+    if (pipe(can[handle].wakeup) < 0) { // create a pipe
+        return SYSERR_OFFSET - errno;
+    }
+    (void)fcntl(can[handle].wakeup[0], F_SETFL, O_NONBLOCK);
+    (void)fcntl(can[handle].wakeup[1], F_SETFL, O_NONBLOCK);
 #endif
     /* to start the CAN controller initially in reset state, we have switch OFF
      * the receiver and the transmitter and then to call CAN_Initialize[FD]() */
     value = PCAN_PARAMETER_OFF;         // receiver OFF
     if ((sts = CAN_SetValue((TPCANHandle)board, PCAN_RECEIVE_STATUS,
-                           (void*)&value, sizeof(value))) != PCAN_ERROR_OK)
+                           (void*)&value, sizeof(value))) != PCAN_ERROR_OK) {
+        wakeup_close(handle);
         return pcan_error(sts);
+    }
     value = PCAN_PARAMETER_ON;          // transmitter OFF
     if ((sts = CAN_SetValue((TPCANHandle)board, PCAN_LISTEN_ONLY,
                            (void*)&value, sizeof(value))) != PCAN_ERROR_OK) {
+        wakeup_close(handle);
         return pcan_error(sts);
     }
     // initialize the CAN controller
     if ((mode & CANMODE_FDOE)) {        // CAN FD operation mode?
-        if ((sts = CAN_InitializeFD((TPCANHandle)board, BIT_RATE_DEFAULT)) != PCAN_ERROR_OK)
+        if ((sts = CAN_InitializeFD((TPCANHandle)board, BIT_RATE_DEFAULT)) != PCAN_ERROR_OK) {
+            wakeup_close(handle);
             return pcan_error(sts);
+        }
     }
     else {                              // CAN 2.0 operation mode
         if (param) {                    //   parameter for non-plug'n'play devices
@@ -396,11 +847,15 @@ int can_init(int32_t board, uint8_t mode, const void *param)
             port = (DWORD)((struct _pcan_param*)param)->port;
             irq  =  (WORD)((struct _pcan_param*)param)->irq;
         }
-        if ((sts = CAN_Initialize((TPCANHandle)board, BTR0BTR1_DEFAULT, type, port, irq)) != PCAN_ERROR_OK)
+        if ((sts = CAN_Initialize((TPCANHandle)board, BTR0BTR1_DEFAULT, type, port, irq)) != PCAN_ERROR_OK) {
+            wakeup_close(handle);
             return pcan_error(sts);
+        }
     }
     // store the handle and the operation mode
     can[handle].board = (TPCANHandle)board;  // handle of the CAN channel
+    board_index[(TPCANHandle)board] = (uint16_t)(handle + 1);
+    num_free--;                         // handle is in use now
     if (param) {                        // non-plug'n'play devices:
         can[handle].brd_type =  (BYTE)((struct _pcan_param*)param)->type;
         can[handle].brd_port = (DWORD)((struct _pcan_param*)param)->port;
@@ -408,6 +863,24 @@ int can_init(int32_t board, uint8_t mode, const void *param)
     }
     can[handle].mode.byte = mode;       // store selected operation mode
     can[handle].status.byte = CANSTAT_RESET; // CAN controller not started yet
+    can[handle].applied.valid = 0;      // first start with reinitialization
+    can[handle].restarts.full = 0ull;
+    can[handle].restarts.fast = 0ull;
+    can[handle].timemap.mode = PCAN_TIME_DEVICE;
+    // trace file settings (the default folder is the current working directory)
+#if defined(_WIN32) || defined(_WIN64)
+    value = GetCurrentDirectoryA((DWORD)sizeof(can[handle].trace_conf.folder), can[handle].trace_conf.folder);
+    if ((value == 0) || (value >= (DWORD)sizeof(can[handle].trace_conf.folder)))
+        can[handle].trace_conf.folder[0] = '\0';
+#else
+    if (getcwd(can[handle].trace_conf.folder, sizeof(can[handle].trace_conf.folder)) == NULL)
+        can[handle].trace_conf.folder[0] = '\0';
+#endif
+    can[handle].trace_conf.type = CANPARA_TRACE_TYPE_BINARY;
+    can[handle].trace_conf.mode = CANPARA_TRACE_MODE_DEFAULT;
+    can[handle].trace_conf.size = CANPARA_TRACE_SIZE_DEFAULT;
+    can[handle].trace_conf.codec = PCAN_TRACE_CODEC_LZ4;
+    attached.valid = 0;                 // channel condition has changed
     return handle;                      // return the handle
 }
 
@@ -419,6 +892,11 @@ static int exit_channel(int handle)
         return CANERR_HANDLE;
     if (!IS_HANDLE_OPENED(handle))      // must be an open handle
         return CANERR_HANDLE;
+    rxcb_stop(handle);                  // stop the callback thread, if any
+    rcvq_stop(handle);                  // stop the drain thread, if any
+    cyclic_stop(handle);                // stop the scheduler thread, if any
+    trmq_stop(handle);                  // stop the feeder thread, if any
+    trace_stop(handle);                 // close the trace file, if any
     if (!can[handle].status.can_stopped) { // if running then go bus off
         /* note: here we should turn off the receiver and the transmitter,
          *       but after CAN_Uninitialize we are really (bus) OFF! */
@@ -426,16 +904,24 @@ static int exit_channel(int handle)
     }
     if ((sts = CAN_Uninitialize(can[handle].board)) != PCAN_ERROR_OK)
         return pcan_error(sts);
+    can[handle].trace_vendor = 0;       // note: PCANBasic stops its tracing
+    attached.valid = 0;                 // channel condition has changed
+    rcvq_free(handle);                  // release the receive queue, if any
+    can[handle].rcvq_size = 0u;
+    trmq_free(handle);                  // release the transmit queue, if any
+    cyclic_free(handle);                // release the cyclic scheduler, if any
+    can[handle].trmq_size = 0u;
+    flist_free(handle);                 // release the filter list, if any
+    rxcb_free(handle);                  // release the callback, if any
+    trace_free(handle);                 // release the trace file recorder, if any
+    port_aligned_free(can[handle].echo);  // release the echo statistics, if any
+    can[handle].echo = NULL;
 
-    can[handle].status.byte |= CANSTAT_RESET;  // CAN controller in INIT state
+    STATUS_SET(handle, CANSTAT_RESET);  // CAN controller in INIT state
+    board_index[can[handle].board] = 0u;
     can[handle].board = PCAN_NONEBUS; // handle can be used again
-#if defined(_WIN32) || defined(_WIN64)
-    if (can[handle].event != NULL) {  // close event handle, if any
-        if (!CloseHandle(can[handle].event))
-            return SYSERR_OFFSET - (int)GetLastError();
-    }
-#endif
-    return CANERR_NOERROR;
+    free_handles[num_free++] = handle;
+    return wakeup_close(handle);        // close event handle resp. self-pipe
 }
 
 EXPORT
@@ -451,7 +937,7 @@ int can_exit(int handle)
             return rc;
     }
     else {
-        for (i = 0; i < CAN_MAX_HANDLES; i++) {
+        for (i = 0; i < num_handles; i++) {
             (void)exit_channel(i);      // close all open handles
         }
     }
@@ -468,10 +954,41 @@ static int kill_channel(int handle)
         return CANERR_HANDLE;
     if (!IS_HANDLE_OPENED(handle))      // must be an open handle
         return CANERR_HANDLE;
+    (void)port_atomic_add32(&can[handle].signaled, 1U);  // abort a blocking write
 #if defined(_WIN32) || defined(_WIN64)
+    if (can[handle].rcvq != NULL)
+        if (!SetEvent(can[handle].rcvq->event))  // signal receive queue
+            return SYSERR_OFFSET - (int)GetLastError();
     if (can[handle].event != NULL)
         if (!SetEvent(can[handle].event))  // signal event object
             return SYSERR_OFFSET - (int)GetLastError();
+#else
+    if (can[handle].wakeup[1] >= 0) {
+        const char signal = 1;          // signal self-pipe
+        if ((write(can[handle].wakeup[1], &signal, 1) < 0) && (errno != EAGAIN))
+            return SYSERR_OFFSET - errno;
+    }
+#endif
+    return CANERR_NOERROR;
+}
+
+static int wakeup_close(int handle)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    if (can[handle].event != NULL) {    // close event handle, if any
+        HANDLE event = can[handle].event;
+        can[handle].event = NULL;
+        if (!CloseHandle(event))
+            return SYSERR_OFFSET - (int)GetLastError();
+    }
+#else
+    can[handle].fdes = -1;              // owned by the PCAN driver
+    if (can[handle].wakeup[0] >= 0) {   // close the self-pipe, if any
+        (void)close(can[handle].wakeup[0]);
+        (void)close(can[handle].wakeup[1]);
+        can[handle].wakeup[0] = -1;
+        can[handle].wakeup[1] = -1;
+    }
 #endif
     return CANERR_NOERROR;
 }
@@ -489,7 +1006,7 @@ int can_kill(int handle)
             return rc;
     }
     else {
-        for (i = 0; i < CAN_MAX_HANDLES; i++) {
+        for (i = 0; i < num_handles; i++) {
             (void)kill_channel(i);      // signal all open handles
         }
     }
@@ -499,10 +1016,9 @@ int can_kill(int handle)
 EXPORT
 int can_start(int handle, const can_bitrate_t *bitrate)
 {
-    TPCANStatus sts;                    // represents a status
     uint16_t btr0btr1 = BTR0BTR1_DEFAULT;  // btr0btr1 value
     char string[PCAN_MAX_BUFFER_SIZE];  // bit-rate string
-    DWORD value;                        // parameter value
+    int rc;                             // return value
 
     strcpy(string, "");                 // empty string
 
@@ -557,83 +1073,75 @@ int can_start(int handle, const can_bitrate_t *bitrate)
             return CANERR_BAUDRATE;
     }
     // start the CAN controller
-    /* note: to (re-)start the CAN controller, we have to reinitialize it */
-    if ((sts = CAN_Reset(can[handle].board)) != PCAN_ERROR_OK)
-        return pcan_error(sts);
-    if ((sts = CAN_Uninitialize(can[handle].board)) != PCAN_ERROR_OK)
-        return pcan_error(sts);
-    /* note: the receiver is automatically switched ON by CAN_Initialize[FD]() */
-    if (can[handle].mode.fdoe) {        // CAN FD operation mode?
-        if ((sts = CAN_InitializeFD(can[handle].board, string)) != PCAN_ERROR_OK)
-            return pcan_error(sts);
+    /* note: a full restart is only required when the configuration has changed */
+    if (pcan_unchanged(handle, btr0btr1, string) &&
+        (pcan_resume(handle) == PCAN_ERROR_OK)) {
+        can[handle].restarts.fast++;
     }
-    else {                              // CAN 2.0 operation mode!
-        if ((sts = CAN_Initialize(can[handle].board, btr0btr1,
-                                  can[handle].brd_type, can[handle].brd_port,
-                                  can[handle].brd_irq)) != PCAN_ERROR_OK)
-            return pcan_error(sts);
+    else {
+        if ((rc = pcan_restart(handle, btr0btr1, string)) != CANERR_NOERROR)
+            return rc;
+        can[handle].restarts.full++;
     }
-#if defined(_WIN32) || defined(_WIN64)
-    // set event handle for blocking read
-    // TODO: check if we have to create a new event handle
-    if ((sts = CAN_SetValue(can[handle].board, PCAN_RECEIVE_EVENT,
-                           (void*)&can[handle].event,
-                            sizeof(can[handle].event))) != PCAN_ERROR_OK) {
-        CAN_Uninitialize(can[handle].board);
-        return pcan_error(sts);
+    // select the read and write functions for the operation mode
+    pcan_specialize(handle);
+    // clear old status, errors and counters (still stopped)
+    can[handle].status.byte = CANSTAT_RESET;
+    can[handle].error.lec = 0x00u;
+    can[handle].error.rx_err = 0u;
+    can[handle].error.tx_err = 0u;
+    port_atomic_store64(&can[handle].counters.tx, 0ull);
+    port_atomic_store64(&can[handle].counters.rx, 0ull);
+    port_atomic_store64(&can[handle].counters.err, 0ull);
+    port_atomic_store64(&can[handle].tx_wait.time, 0ull);
+    port_atomic_store64(&can[handle].tx_wait.count, 0ull);
+    can[handle].tx_wait.max = 0u;
+    busload_reset(handle, bitrate);
+    // reset the latency statistics, if echo frames are selected
+    if (can[handle].echo != NULL)
+        echo_reset(handle);
+    // restart the host clock mapping (device time-stamps may restart)
+    timemap_reset(handle);
+    // start the drain thread if a software receive queue is selected
+    if (can[handle].rcvq_size) {
+        if ((rc = rcvq_start(handle)) != CANERR_NOERROR) {
+            CAN_Uninitialize(can[handle].board);
+            can[handle].applied.valid = 0;
+            return rc;
+        }
     }
-#endif
-    // set listen-only mode if selected
-    value = (can[handle].mode.mon) ? PCAN_PARAMETER_ON : PCAN_PARAMETER_OFF;
-    if ((sts = CAN_SetValue(can[handle].board, PCAN_LISTEN_ONLY,
-                           (void*)&value, sizeof(value))) != PCAN_ERROR_OK) {
-        CAN_Uninitialize(can[handle].board);
-        return pcan_error(sts);
+    // start the callback thread if a reception callback is set
+    if (can[handle].rxcb != NULL) {
+        if ((rc = rxcb_start(handle)) != CANERR_NOERROR) {
+            rcvq_stop(handle);
+            CAN_Uninitialize(can[handle].board);
+            can[handle].applied.valid = 0;
+            return rc;
+        }
     }
-    // enable error frame reception if selected
-    value = (can[handle].mode.err) ? PCAN_PARAMETER_ON : PCAN_PARAMETER_OFF;
-    if ((sts = CAN_SetValue(can[handle].board, PCAN_ALLOW_ERROR_FRAMES,
-                           (void*)&value, sizeof(value))) != PCAN_ERROR_OK) {
-        CAN_Uninitialize(can[handle].board);
-        return pcan_error(sts);
+    // start the feeder thread if a software transmit queue is selected
+    if (can[handle].trmq_size) {
+        if ((rc = trmq_start(handle)) != CANERR_NOERROR) {
+            rxcb_stop(handle);
+            rcvq_stop(handle);
+            CAN_Uninitialize(can[handle].board);
+            can[handle].applied.valid = 0;
+            return rc;
+        }
     }
-    // set acceptance filter as selected
-    switch(can[handle].filter.mode) {
-        case FILTER_STD:                // 11-bit identifier
-            if ((sts = CAN_SetValue(can[handle].board, PCAN_ACCEPTANCE_FILTER_11BIT,
-                                   (void*)&can[handle].filter.mask,
-                                    sizeof(UINT64))) != PCAN_ERROR_OK) {
-                CAN_Uninitialize(can[handle].board);
-                return pcan_error(sts);
-            }
-            break;
-        case FILTER_XTD:                // 29-bit identifier
-            if ((sts = CAN_SetValue(can[handle].board, PCAN_ACCEPTANCE_FILTER_29BIT,
-                                   (void*)&can[handle].filter.mask,
-                                    sizeof(UINT64))) != PCAN_ERROR_OK) {
-                CAN_Uninitialize(can[handle].board);
-                return pcan_error(sts);
-            }
-            break;
-        default:                        // no filtering
-            value = PCAN_FILTER_OPEN;
-            if ((sts = CAN_SetValue(can[handle].board, PCAN_MESSAGE_FILTER,
-                                   (void*)&value, sizeof(value))) != PCAN_ERROR_OK) {
-                CAN_Uninitialize(can[handle].board);
-                return pcan_error(sts);
-            }
-            break;
+    // start the scheduler thread if cyclic messages are set
+    if (can[handle].cyclic != NULL) {
+        if ((rc = cyclic_start(handle)) != CANERR_NOERROR) {
+            trmq_stop(handle);
+            rxcb_stop(handle);
+            rcvq_stop(handle);
+            CAN_Uninitialize(can[handle].board);
+            can[handle].applied.valid = 0;
+            return rc;
+        }
     }
-    // clear old status, errors and counters
-    can[handle].status.byte = 0x00u;
-    can[handle].error.lec = 0x00u;
-    can[handle].error.rx_err = 0u;
-    can[handle].error.tx_err = 0u;
-    can[handle].counters.tx = 0ull;
-    can[handle].counters.rx = 0ull;
-    can[handle].counters.err = 0ull;
     // CAN controller started!
-    can[handle].status.can_stopped = 0;
+    STATUS_CLR(handle, CANSTAT_RESET);
     return CANERR_NOERROR;
 }
 
@@ -667,18 +1175,19 @@ int can_reset(int handle)
     if ((sts = CAN_SetValue(can[handle].board, PCAN_LISTEN_ONLY,
                            (void*)&value, sizeof(value))) != PCAN_ERROR_OK)
         return pcan_error(sts);
+    rxcb_stop(handle);                  //   callback thread off
+    rcvq_stop(handle);                  //   drain thread off
+    cyclic_stop(handle);                //   scheduler thread off
+    trmq_stop(handle);                  //   feeder thread off
     // CAN controller stopped!
-    can[handle].status.can_stopped = 1;
+    STATUS_SET(handle, CANSTAT_RESET);
     return CANERR_NOERROR;
 }
 
 EXPORT
 int can_write(int handle, const can_message_t *msg, uint16_t timeout)
 {
-    TPCANStatus sts;                    // represents a status
-    TPCANMsg can_msg;                   // the message (CAN 2.0)
-    TPCANMsgFD can_msg_fd;              // the message (CAN FD)
-    (void)timeout;
+    int rc;                             // return value
 
     if (!init)                          // must be initialized
         return CANERR_NOTINIT;
@@ -691,86 +1200,30 @@ int can_write(int handle, const can_message_t *msg, uint16_t timeout)
     if (can[handle].status.can_stopped) // must be running
         return CANERR_OFFLINE;
 
-    if (msg->id > (uint32_t)(msg->xtd ? CAN_MAX_XTD_ID : CAN_MAX_STD_ID))
-        return CANERR_ILLPARA;          // invalid identifier
-    if (msg->xtd && can[handle].mode.nxtd)
-        return CANERR_ILLPARA;          // suppress extended frames
-    if (msg->rtr && can[handle].mode.nrtr)
-        return CANERR_ILLPARA;          // suppress remote frames
-    if (msg->fdf && !can[handle].mode.fdoe)
-        return CANERR_ILLPARA;          // long frames only with CAN FD
-    if (msg->brs && !can[handle].mode.brse)
-        return CANERR_ILLPARA;          // fast frames only with CAN FD
-    if (msg->brs && !msg->fdf)
-        return CANERR_ILLPARA;          // bit-rate switching only with CAN FD
-    if (msg->sts)
-        return CANERR_ILLPARA;          // error frames cannot be sent
-
-    if (!can[handle].mode.fdoe) {
-        if (msg->dlc > CAN_MAX_LEN)     //   data length 0 .. 8
-            return CANERR_ILLPARA;
-        if (msg->xtd)                   //   29-bit identifier
-            can_msg.MSGTYPE = PCAN_MESSAGE_EXTENDED;
-        else                            //   11-bit identifier
-            can_msg.MSGTYPE = PCAN_MESSAGE_STANDARD;
-        if (msg->rtr)                   //   request a message
-            can_msg.MSGTYPE |= PCAN_MESSAGE_RTR;
-        can_msg.ID = (DWORD)(msg->id);
-        can_msg.LEN = (BYTE)(msg->dlc);
-        memcpy(can_msg.DATA, msg->data, msg->dlc);
-        // CAN 2.0: transmit the message
-        sts = CAN_Write(can[handle].board, &can_msg);
-    }
-    else {
-        if (msg->dlc > CANFD_MAX_DLC)   //   data length 0 .. 0Fh
-            return CANERR_ILLPARA;
-        if (msg->xtd)                   //   29-bit identifier
-            can_msg_fd.MSGTYPE = PCAN_MESSAGE_EXTENDED;
-        else                            //   11-bit identifier
-            can_msg_fd.MSGTYPE = PCAN_MESSAGE_STANDARD;
-        if (msg->rtr)                   //   request a message
-            can_msg_fd.MSGTYPE |= PCAN_MESSAGE_RTR;
-        if (msg->fdf)                   //   CAN FD format
-            can_msg_fd.MSGTYPE |= PCAN_MESSAGE_FD;
-        if (msg->brs && can[handle].mode.brse) //   bit-rate switching
-            can_msg_fd.MSGTYPE |= PCAN_MESSAGE_BRS;
-        can_msg_fd.ID = (DWORD)(msg->id);
-        can_msg_fd.DLC = (BYTE)(msg->dlc);
-        memcpy(can_msg_fd.DATA, msg->data, DLC2LEN(msg->dlc));
-        // CAN FD: transmit the message
-        sts = CAN_WriteFD(can[handle].board, &can_msg_fd);
-    }
-    // check for errors
-    if (sts != PCAN_ERROR_OK) {
-        if ((sts & PCAN_ERROR_QXMTFULL)) {  // transmit queue full?
-            can[handle].status.transmitter_busy = 1;
-            return CANERR_TX_BUSY;      //     transmitter busy
-        }
-        if ((sts & PCAN_ERROR_XMTFULL)) {  // transmission pending?
-            can[handle].status.transmitter_busy = 1;
-            return CANERR_TX_BUSY;      //     transmitter busy
-        }
-        return pcan_error(sts);         //   PCAN specific error
+    // transmit the message (wait for the transmit queue, if required)
+    if ((rc = pcan_write_blocking(handle, msg, timeout)) == CANERR_TX_BUSY) {
+        STATUS_SET(handle, CANSTAT_TX_BUSY);
+        return CANERR_TX_BUSY;          //   transmitter busy
     }
+    if (rc != CANERR_NOERROR)
+        return rc;                      //   something went wrong
+    STATUS_CLR(handle, CANSTAT_TX_BUSY);
     // message transmitted: increment transmit counter
-    can[handle].status.transmitter_busy = 0;
-    can[handle].counters.tx++;
+    /* note: a queued message is booked by the feeder thread when it is handed over */
+    if (!TRMQ_ACTIVE(handle))
+        tx_account(handle, msg, 1U, busload_frame(handle, msg));
     return CANERR_NOERROR;
 }
 
 EXPORT
-int can_read(int handle, can_message_t *msg, uint16_t timeout)
+int can_write_multi(int handle, const can_message_t *messages, size_t n, size_t *sent, uint16_t timeout)
 {
-    TPCANStatus sts;                    // represents a status
-    TPCANMsg can_msg;                   // the message (CAN 2.0)
-    TPCANTimestamp timestamp;           // time stamp (CAN 2.0)
-    TPCANMsgFD can_msg_fd;              // the message (CAN FD)
-    TPCANTimestampFD timestamp_fd;      // time stamp (CAN FD)
-
-    memset(&can_msg, 0, sizeof(TPCANMsg));
-    memset(&timestamp, 0, sizeof(TPCANTimestamp));
-    memset(&can_msg_fd, 0, sizeof(TPCANMsgFD));
-    memset(&timestamp_fd, 0, sizeof(TPCANTimestampFD));
+    size_t i = 0;                       // number of messages sent
+    uint64_t busy = 0ull;               // bus busy time in [psec]
+    uint64_t start = 0ull;              // start of the batch in [usec]
+    uint64_t elapsed;                   // time spent in [msec]
+    uint16_t remaining = timeout;       // remaining time-out in [msec]
+    int rc = CANERR_NOERROR;            // return value
 
     if (!init)                          // must be initialized
         return CANERR_NOTINIT;
@@ -778,175 +1231,603 @@ int can_read(int handle, can_message_t *msg, uint16_t timeout)
         return CANERR_HANDLE;
     if (!IS_HANDLE_OPENED(handle))      // must be an open handle
         return CANERR_HANDLE;
-    if (msg == NULL)                    // check for null-pointer
+    if (((messages == NULL) && (n > 0)) || (sent == NULL)) // check for null-pointer
         return CANERR_NULLPTR;
     if (can[handle].status.can_stopped) // must be running
         return CANERR_OFFLINE;
 
-    memset(msg, 0, sizeof(can_message_t));
-    msg->id = 0xFFFFFFFFu;
-    msg->sts = 1;
-repeat:
-    // try to read a message
-    if (!can[handle].mode.fdoe)
-        sts = CAN_Read(can[handle].board, &can_msg, &timestamp);
-    else
-        sts = CAN_ReadFD(can[handle].board, &can_msg_fd, &timestamp_fd);
-    if (sts == PCAN_ERROR_QRCVEMPTY) {
-#if defined(_WIN32) || defined(_WIN64)
-        // blocking read or polling
-        if (timeout > 0) {
-            switch (WaitForSingleObject(can[handle].event,
-                                      (timeout != CANREAD_INFINITE) ? (DWORD)timeout : INFINITE)) {
-            case WAIT_OBJECT_0:
-                break;                  //   one or more messages received
-            case WAIT_TIMEOUT:
-                break;                  //   time-out, but look for old messages
-            default:
-                return CANERR_FATAL;    //   function failed!
-            }
-            if (!can[handle].mode.fdoe)
-                sts = CAN_Read(can[handle].board, &can_msg, &timestamp);
-            else
-                sts = CAN_ReadFD(can[handle].board, &can_msg_fd, &timestamp_fd);
-            if (sts == PCAN_ERROR_QRCVEMPTY) {
-                can[handle].status.receiver_empty = 1;
-                return CANERR_RX_EMPTY; //   receiver empty
-            }
-        }
-        else {
-            can[handle].status.receiver_empty = 1;
-            return CANERR_RX_EMPTY;     //   receiver empty
-        }
-#endif
-    }
-    // check for errors
-    if ((sts & PCAN_ERROR_OVERRUN)) {
-        can[handle].status.message_lost = 1;
-        /* note: at least one message got lost, but we have a message */
-    }
-    if ((sts & PCAN_ERROR_QOVERRUN)) {
-        can[handle].status.queue_overrun = 1;
-        /* note: queue has overrun, but we have a message */
-    }
-    if ((sts & PCAN_ERROR_QRCVEMPTY)) {  // receice queue empty?
-        can[handle].status.receiver_empty = 1;
-        if ((sts & 0xFF00u))  // TODO: explain this
-            return pcan_error(sts);      //   something went wrong
-        else
-            return CANERR_RX_EMPTY;     //   receiver empty!
-    }
-    // convert PCAN message to CAN API message
-    // TODO: move this into separate functions if possible
-    if (!can[handle].mode.fdoe) {       // CAN 2.0 message:
-        if ((can_msg.MSGTYPE & PCAN_MESSAGE_EXTENDED) && can[handle].mode.nxtd)
-            goto repeat;                //   refuse extended frames
-        if ((can_msg.MSGTYPE & PCAN_MESSAGE_RTR) && can[handle].mode.nrtr)
-            goto repeat;                //   refuse remote frames
-        if ((can_msg.MSGTYPE & PCAN_MESSAGE_STATUS)) {
-            // update status register from status frame
-            can[handle].status.bus_off = ((can_msg.DATA[3] & PCAN_ERROR_BUSOFF) != PCAN_ERROR_OK) ? 1 : 0;
-            can[handle].status.warning_level = ((can_msg.DATA[3] & PCAN_ERROR_BUSHEAVY) != PCAN_ERROR_OK) ? 1 : 0;
-            // refuse status message if suppressed by user
-            if (!can[handle].mode.err)
-                goto repeat;
-            // status message: ID=000h, DLC=4 (status, lec, rx errors, tx errors)
-            can_message_sts(can[handle].status, can[handle].error, msg);
-            can[handle].counters.err++;
-        }
-        else if ((can_msg.MSGTYPE & PCAN_MESSAGE_ERRFRAME))  {
-            // update error and status register from error frame
-            can[handle].error.lec = (uint8_t)can_msg.ID;
-            can[handle].error.rx_err = can_msg.DATA[2];
-            can[handle].error.tx_err = can_msg.DATA[3];
-            can[handle].status.bus_error = can[handle].error.lec ? 1 : 0;
-            // refuse status message if suppressed by user
-            if (!can[handle].mode.err)
-                goto repeat;
-            // status message: ID=000h, DLC=4 (status, lec, rx errors, tx errors)
-            can_message_sts(can[handle].status, can[handle].error, msg);
-            can[handle].counters.err++;
-        }
-        else {
-            // decode PEAK CAN 2.0 message and increment receive counter
-            can_message(&can_msg, msg);
-            can[handle].counters.rx++;
-        }
-        // time-stamp in nanoseconds since start of Windows
-        can_timestamp(timestamp, msg);
-    }
-    else {                              // CAN FD message:
-        if ((can_msg_fd.MSGTYPE & PCAN_MESSAGE_EXTENDED) && can[handle].mode.nxtd)
-            goto repeat;                //   refuse extended frames
-        if ((can_msg_fd.MSGTYPE & PCAN_MESSAGE_RTR) && can[handle].mode.nrtr)
-            goto repeat;                //   refuse remote frames (n/a w/ fdoe)
-        if ((can_msg_fd.MSGTYPE & PCAN_MESSAGE_STATUS)) {
-            // update status register from status frame
-            can[handle].status.bus_off = ((can_msg_fd.DATA[3] & PCAN_ERROR_BUSOFF) != PCAN_ERROR_OK) ? 1 : 0;
-            can[handle].status.warning_level = ((can_msg_fd.DATA[3] & PCAN_ERROR_BUSWARNING) != PCAN_ERROR_OK) ? 1 : 0;
-            // refuse status message if suppressed by user
-            if (!can[handle].mode.err)
-                goto repeat;
-            // status message: ID=000h, DLC=4 (status, lec, rx errors, tx errors)
-            can_message_sts(can[handle].status, can[handle].error, msg);
-            can[handle].counters.err++;
-        }
-        else if ((can_msg_fd.MSGTYPE & PCAN_MESSAGE_ERRFRAME)) {
-            // update error and status register from error frame
-            can[handle].error.lec = (uint8_t)can_msg_fd.ID;
-            can[handle].error.rx_err = can_msg_fd.DATA[2];
-            can[handle].error.tx_err = can_msg_fd.DATA[3];
-            can[handle].status.bus_error = can[handle].error.lec ? 1 : 0;
-            // refuse status message if suppressed by user
-            if (!can[handle].mode.err)
-                goto repeat;
-            // status message: ID=000h, DLC=4 (status, lec, rx errors, tx errors)
-            can_message_sts(can[handle].status, can[handle].error, msg);
-            can[handle].counters.err++;
-        }
-        else {
-            // decode PEAK CAN FD message and increment receive counter
-            can_message_fd(&can_msg_fd, msg);
-            can[handle].counters.rx++;
+    if ((timeout != CANWRITE_INFINITE) && (timeout > 0U))
+        start = port_clock_usec();
+
+    // transmit the messages until the transmit queue is full (after time-out)
+    /* note: the time-out covers the whole batch, i.e. each message gets the time left */
+    while (i < n) {
+        if ((timeout != CANWRITE_INFINITE) && (timeout > 0U)) {
+            elapsed = (port_clock_usec() - start) / 1000ull;
+            remaining = (elapsed < (uint64_t)timeout) ? (uint16_t)((uint64_t)timeout - elapsed) : 0U;
         }
-        // time-stamp in nanoseconds since start of Windows
-        can_timestamp_fd(timestamp_fd, msg);
+        if ((rc = pcan_write_blocking(handle, &messages[i], remaining)) != CANERR_NOERROR)
+            break;
+        busy += busload_frame(handle, &messages[i++]);
     }
-    // one message read from receive queue
-    can[handle].status.receiver_empty = 0;
-    return CANERR_NOERROR;
+    // update counter, bus-load and status register (once per batch)
+    /* note: queued messages are booked by the feeder thread when handed over */
+    STATUS_PUT(handle, CANSTAT_TX_BUSY, rc == CANERR_TX_BUSY);
+    if ((i > 0) && !TRMQ_ACTIVE(handle))
+        tx_account(handle, messages, i, busy);
+    *sent = i;
+    return rc;
 }
 
 EXPORT
-int can_status(int handle, uint8_t *status)
+int can_select(const int *handles, size_t n, size_t *ready, size_t *count, uint16_t timeout)
 {
-    TPCANStatus sts;                    // represents a status
-
+    uint32_t signaled[CANSELECT_MAX_HANDLES];  // signal counters at start
+    uint64_t start = 0ull;              // start of the wait in [usec]
+    uint64_t elapsed;                   // time waited in [msec]
+    uint32_t remaining = 0U;            // remaining time-out in [msec]
+    size_t i, k = 0;                    // loop variable, ready count
+    int handle;                         // handle of the CAN interface
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE events[CANSELECT_MAX_HANDLES];  // events to wait for
+    DWORD result;                       // wait result
+#else
+    struct pollfd fds[2 * CANSELECT_MAX_HANDLES];  // file descriptors to wait for
+    char signal;
+    int nfds;
+#endif
     if (!init)                          // must be initialized
         return CANERR_NOTINIT;
-    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
-        return CANERR_HANDLE;
-    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
-        return CANERR_HANDLE;
+    if ((handles == NULL) || (ready == NULL) || (count == NULL)) // check for null-pointer
+        return CANERR_NULLPTR;
+    if ((n == 0) || (n > CANSELECT_MAX_HANDLES)) // 1 to 64 handles
+        return CANERR_ILLPARA;
+    for (i = 0; i < n; i++) {
+        handle = handles[i];
+        if (!IS_HANDLE_VALID(handle))   // must be a valid handle
+            return CANERR_HANDLE;
+        if (!IS_HANDLE_OPENED(handle))  // must be an open handle
+            return CANERR_HANDLE;
+        if (can[handle].status.can_stopped) // must be running
+            return CANERR_OFFLINE;
+        signaled[i] = port_atomic_load32(&can[handle].signaled);
+#if defined(_WIN32) || defined(_WIN64)
+        // note: the drain thread waits for the PCAN receive event, if any
+        events[i] = (can[handle].rcvq != NULL) ? can[handle].rcvq->event : can[handle].event;
+#endif
+    }
+    if (timeout != CANREAD_INFINITE)
+        start = port_clock_usec();
 
-    // TODO: check if running condition is required
-    if (!can[handle].status.can_stopped) { // if running get bus status
-        // get status from device
+    /* note: the PCAN receive events are edge-triggered, i.e. a handle is reported
+     *       once for new messages; it should be read until its queue is empty */
+    for (;;) {
+        // software receive queues with messages are ready immediately
+        for (i = 0; i < n; i++) {
+            handle = handles[i];
+            if ((can[handle].rcvq != NULL) &&
+                (can[handle].rcvq->get.tail != port_atomic_load32(&can[handle].rcvq->put.head)))
+                ready[k++] = i;
+        }
+        if (k > 0)
+            break;
+        for (i = 0; i < n; i++)
+            if (port_atomic_load32(&can[handles[i]].signaled) != signaled[i])
+                break;
+        if (i < n)
+            break;                      //   signaled by can_kill
+        if (timeout != CANREAD_INFINITE) {
+            if ((elapsed = (port_clock_usec() - start) / 1000ull) >= (uint64_t)timeout)
+                break;                  //   time-out
+            remaining = (uint32_t)timeout - (uint32_t)elapsed;
+        }
+#if defined(_WIN32) || defined(_WIN64)
+        result = WaitForMultipleObjects((DWORD)n, events, FALSE,
+                                        (timeout != CANREAD_INFINITE) ? (DWORD)remaining : INFINITE);
+        if (result == WAIT_TIMEOUT)
+            continue;                   //   time-out, but look for old messages
+        if (result >= (WAIT_OBJECT_0 + (DWORD)n))
+            return CANERR_FATAL;        //   function failed!
+        // the first signaled event has been reset, collect the others
+        for (i = (size_t)(result - WAIT_OBJECT_0); i < n; i++) {
+            if ((i == (size_t)(result - WAIT_OBJECT_0)) ||
+                (WaitForSingleObject(events[i], 0) == WAIT_OBJECT_0)) {
+                // note: an event set by can_kill is not reported as ready
+                if ((can[handles[i]].rcvq == NULL) &&
+                    (port_atomic_load32(&can[handles[i]].signaled) == signaled[i]))
+                    ready[k++] = i;     //   one or more messages received
+            }
+        }
+#else
+        for (i = 0, nfds = 0; i < n; i++) {
+            handle = handles[i];
+            // note: the drain thread signals the self-pipe, if any
+            fds[nfds].fd = (can[handle].rcvq == NULL) ? can[handle].fdes : -1;
+            fds[nfds].events = POLLIN;
+            fds[nfds++].revents = 0;
+            fds[nfds].fd = can[handle].wakeup[0];
+            fds[nfds].events = POLLIN;
+            fds[nfds++].revents = 0;
+        }
+        switch (poll(fds, (nfds_t)nfds, (timeout != CANREAD_INFINITE) ? (int)remaining : -1)) {
+        case -1:
+            if (errno != EINTR)
+                return CANERR_FATAL;    //   function failed!
+            break;                      //   interrupted, but look for old messages
+        case 0:
+            break;                      //   time-out, but look for old messages
+        default:
+            for (i = 0; i < n; i++) {
+                if ((fds[2 * i + 1].revents & POLLIN)) {
+                    while (read(can[handles[i]].wakeup[0], &signal, 1) > 0)
+                        ;               //   drain the pipe
+                }
+                if ((fds[2 * i].revents & POLLIN))
+                    ready[k++] = i;     //   one or more messages received
+            }
+            break;
+        }
+#endif
+        // note: software receive queues are checked on the next turn
+        if (k > 0)
+            break;
+    }
+    *count = k;
+    return (k > 0) ? CANERR_NOERROR : CANERR_RX_EMPTY;
+}
+
+EXPORT
+int can_set_callback(int handle, can_rcv_callback_t callback, void *context, size_t batch_max)
+{
+    can_callback_t *rxcb;               // reception callback
+    int rc;                             // return value
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if ((callback != NULL) && ((batch_max == 0) || (batch_max > CANCALLBACK_MAX_BATCH)))
+        return CANERR_ILLPARA;
+
+    // stop the callback thread and release the callback, if any
+    rxcb_stop(handle);
+    rxcb_free(handle);
+    if (callback == NULL)
+        return CANERR_NOERROR;
+    // set the new callback (the thread runs while the CAN controller is started)
+    if ((rxcb = (can_callback_t*)port_aligned_alloc(sizeof(can_callback_t))) == NULL)
+        return CANERR_RESOURCE;
+    if ((rxcb->buffer = (can_message_t*)port_aligned_alloc(batch_max * sizeof(can_message_t))) == NULL) {
+        port_aligned_free(rxcb);
+        return CANERR_RESOURCE;
+    }
+#if defined(_WIN32) || defined(_WIN64)
+    if ((rxcb->event = CreateEvent(NULL, FALSE, FALSE, NULL)) == NULL) {
+        rc = SYSERR_OFFSET - (int)GetLastError();
+        port_aligned_free(rxcb->buffer);
+        port_aligned_free(rxcb);
+        return rc;
+    }
+#else
+    if (pipe(rxcb->wake) < 0) {
+        rc = SYSERR_OFFSET - errno;
+        port_aligned_free(rxcb->buffer);
+        port_aligned_free(rxcb);
+        return rc;
+    }
+    (void)fcntl(rxcb->wake[0], F_SETFL, O_NONBLOCK);
+    (void)fcntl(rxcb->wake[1], F_SETFL, O_NONBLOCK);
+#endif
+    rxcb->func = callback;
+    rxcb->context = context;
+    rxcb->batch = batch_max;
+    rxcb->running = 0u;
+    can[handle].rxcb = rxcb;
+    if (!can[handle].status.can_stopped) {
+        if ((rc = rxcb_start(handle)) != CANERR_NOERROR) {
+            rxcb_free(handle);
+            return rc;
+        }
+    }
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_cyclic_add(int handle, const can_message_t *message, uint32_t period, uint32_t phase, int *index)
+{
+    can_cyclic_t *cyclic;               // cyclic scheduler
+    can_cycentry_t *entry;              // the cyclic message
+    int i, rc;                          // entry index, return value
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if ((message == NULL) || (index == NULL)) // check for null-pointer
+        return CANERR_NULLPTR;
+    if (period < CYCLIC_TICK_USEC)      // at least one tick
+        return CANERR_ILLPARA;
+    if ((rc = pcan_check_message(handle, message)) != CANERR_NOERROR)
+        return rc;
+
+    // allocate the scheduler with the first cyclic message
+    if ((can[handle].cyclic == NULL) && ((rc = cyclic_alloc(handle)) != CANERR_NOERROR))
+        return rc;
+    cyclic = can[handle].cyclic;
+    // take a free entry and put it into the timer wheel, if running
+    port_mutex_lock(&cyclic->lock);
+    for (i = 0; (i < CANCYCLIC_MAX_MESSAGES) && cyclic->entry[i].used; i++)
+        ;
+    if (i >= CANCYCLIC_MAX_MESSAGES) {
+        port_mutex_unlock(&cyclic->lock);
+        return CANERR_RESOURCE;         //   table full
+    }
+    entry = &cyclic->entry[i];
+    memset(entry, 0, sizeof(can_cycentry_t));
+    entry->used = 1;
+    entry->slot = entry->next = entry->prev = CYCLIC_NONE;
+    entry->period = period;
+    entry->phase = phase;
+    entry->serial = ++cyclic->serial;
+    memcpy(&entry->msg, message, sizeof(can_message_t));
+    cyclic->count++;
+    if (port_atomic_load32(&cyclic->running)) {
+        entry->deadline = cyclic_align(port_clock_usec() + (uint64_t)phase);
+        cyclic_insert(cyclic, i);
+    }
+    port_mutex_unlock(&cyclic->lock);
+    // wake up the scheduler thread, or start it (first cyclic message)
+    if (!can[handle].status.can_stopped) {
+        if (port_atomic_load32(&cyclic->running))
+            cyclic_signal(cyclic);
+        else if ((rc = cyclic_start(handle)) != CANERR_NOERROR) {
+            port_mutex_lock(&cyclic->lock);
+            entry->used = 0;
+            cyclic->count--;
+            port_mutex_unlock(&cyclic->lock);
+            return rc;
+        }
+    }
+    *index = i;
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_cyclic_update(int handle, int index, const can_message_t *message)
+{
+    can_cyclic_t *cyclic;               // cyclic scheduler
+    int rc;                             // return value
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if (message == NULL)                // check for null-pointer
+        return CANERR_NULLPTR;
+    if (((cyclic = can[handle].cyclic) == NULL) || (index < 0) || (index >= CANCYCLIC_MAX_MESSAGES))
+        return CANERR_ILLPARA;
+    if ((rc = pcan_check_message(handle, message)) != CANERR_NOERROR)
+        return rc;
+
+    // replace the message in place (the deadline is kept)
+    port_mutex_lock(&cyclic->lock);
+    if (!cyclic->entry[index].used) {
+        port_mutex_unlock(&cyclic->lock);
+        return CANERR_ILLPARA;
+    }
+    memcpy(&cyclic->entry[index].msg, message, sizeof(can_message_t));
+    port_mutex_unlock(&cyclic->lock);
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_cyclic_remove(int handle, int index)
+{
+    can_cyclic_t *cyclic;               // cyclic scheduler
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if (((cyclic = can[handle].cyclic) == NULL) || (index < 0) || (index >= CANCYCLIC_MAX_MESSAGES))
+        return CANERR_ILLPARA;
+
+    // take the entry out of the timer wheel
+    /* note: the scheduler thread wakes up once more for nothing, that's all */
+    port_mutex_lock(&cyclic->lock);
+    if (!cyclic->entry[index].used) {
+        port_mutex_unlock(&cyclic->lock);
+        return CANERR_ILLPARA;
+    }
+    cyclic_unlink(cyclic, index);
+    cyclic->entry[index].used = 0;
+    cyclic->count--;
+    port_mutex_unlock(&cyclic->lock);
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_cyclic_stats(int handle, int index, can_pcan_cyclic_t *stats)
+{
+    can_cyclic_t *cyclic;               // cyclic scheduler
+    can_cycentry_t *entry;              // the cyclic message
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if (stats == NULL)                  // check for null-pointer
+        return CANERR_NULLPTR;
+    if (((cyclic = can[handle].cyclic) == NULL) || (index < 0) || (index >= CANCYCLIC_MAX_MESSAGES))
+        return CANERR_ILLPARA;
+
+    port_mutex_lock(&cyclic->lock);
+    if (!(entry = &cyclic->entry[index])->used) {
+        port_mutex_unlock(&cyclic->lock);
+        return CANERR_ILLPARA;
+    }
+    stats->sent = entry->sent;
+    stats->missed = entry->missed;
+    stats->period = entry->period;
+    stats->avg = entry->sent ? (uint32_t)(entry->sum / entry->sent) : 0U;
+    stats->max = entry->max;
+    port_mutex_unlock(&cyclic->lock);
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_replay(int handle, const char *file, const can_pcan_replay_t *options, can_pcan_replay_stats_t *stats)
+{
+    can_pcan_replay_stats_t result;     // replay statistics
+    rpl_reader_t *reader = NULL;        // trace file reader (read-ahead)
+    rpl_entry_t entry;                  // the next message and its time-stamp
+    uint64_t start = 0ull;              // host time of the first message in [usec]
+    uint64_t base = 0ull;               // time-stamp of the first message in [nsec]
+    uint64_t deadline = 0ull;           // deadline of the message in [usec]
+    uint64_t due;                       // time-stamp of the message on the host clock in [usec]
+    uint64_t late;                      // lateness to the deadline in [usec]
+    uint64_t sum = 0ull;                // sum of the lateness in [usec]
+    uint64_t begin;                     // start of the replay in [usec]
+    uint32_t signaled;                  // signal counter at start
+    uint32_t bin;                       // histogram bin
+    int first = 1, stalled = 0;         // first message, buffer ran empty
+    int rc = CANERR_NOERROR, res;       // return values
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if ((file == NULL) || (options == NULL))  // check for null-pointer
+        return CANERR_NULLPTR;
+    if (can[handle].status.can_stopped) // must be running
+        return CANERR_OFFLINE;
+    if ((options->speed != 0U) && (options->speed < PCAN_REPLAY_SPEED_MIN))
+        return CANERR_ILLPARA;
+    if ((options->count > PCAN_REPLAY_IDS) || (options->remaps > PCAN_REPLAY_REMAPS))
+        return CANERR_ILLPARA;
+
+    // open the trace file and fill the read-ahead buffer
+    if ((res = rpl_open(file, options, &reader)) != CANERR_NOERROR)
+        return res;
+    memset(&result, 0, sizeof(can_pcan_replay_stats_t));
+    signaled = port_atomic_load32(&can[handle].signaled);
+    begin = port_clock_usec();
+    for (;;) {
+        if (port_atomic_load32(&can[handle].signaled) != signaled)
+            break;                      //   signaled by can_kill
+        if (can[handle].status.can_stopped)
+            break;                      //   stopped by can_reset
+        // the next message from the read-ahead buffer (until the end of the file)
+        if ((res = rpl_next(reader, &entry)) == RPL_PENDING) {
+            if (!stalled)
+                result.stalls++;
+            stalled = 1;
+            port_sleep_usec(REPLAY_POLL_USEC);
+            continue;
+        }
+        stalled = 0;
+        if (res != RPL_MESSAGE) {
+            rc = (res != CANERR_RX_EMPTY) ? res : CANERR_NOERROR;
+            break;
+        }
+        // absolute deadline: relative to the first message and scaled by the speed
+        /* note: the deadline is not set before the previous one, so a time-stamp
+         *       out of order is sent immediately and the others stay on time */
+        if (options->speed != 0U) {
+            if (first) {
+                start = port_clock_usec();
+                base = entry.nsec;
+                first = 0;
+            }
+            due = start + ((entry.nsec > base) ? ((entry.nsec - base) / (10ull * (uint64_t)options->speed)) : 0ull);
+            if (due > deadline)
+                deadline = due;
+            if (replay_wait(handle, deadline, signaled) != 0)
+                break;                  //   signaled or stopped
+        }
+        if (can_write(handle, &entry.msg, REPLAY_TX_TIMEOUT) != CANERR_NOERROR) {
+            result.failed++;
+            continue;
+        }
+        result.sent++;
+        // timing error: lateness to the deadline when the write returns
+        if (options->speed != 0U) {
+            late = port_clock_usec() - deadline;
+            if (late > (uint64_t)UINT32_MAX)
+                late = (uint64_t)UINT32_MAX;
+            if ((result.sent == 1ull) || ((uint32_t)late < result.min))
+                result.min = (uint32_t)late;
+            if ((uint32_t)late > result.max)
+                result.max = (uint32_t)late;
+            sum += late;
+            for (bin = 0U; (bin < (PCAN_LATENCY_BINS - 1U)) && (late >= (2ull << bin)); bin++)
+                ;
+            result.histogram[bin]++;
+        }
+    }
+    result.elapsed = port_clock_usec() - begin;
+    result.avg = ((options->speed != 0U) && result.sent) ? (uint32_t)(sum / result.sent) : 0U;
+    rpl_counts(reader, &result.records, &result.skipped);
+    rpl_close(reader);
+    if (stats)
+        memcpy(stats, &result, sizeof(can_pcan_replay_stats_t));
+    return rc;
+}
+
+EXPORT
+int can_read(int handle, can_message_t *msg, uint16_t timeout)
+{
+    uint64_t nsec;                      // time-stamp in [nsec]
+    int rc;                             // return value
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if (msg == NULL)                    // check for null-pointer
+        return CANERR_NULLPTR;
+    if (can[handle].status.can_stopped) // must be running
+        return CANERR_OFFLINE;
+
+    // read a message and convert its time-stamp into a 'struct timespec'
+    if ((rc = read_message(handle, msg, &nsec, timeout)) == RX_ECHO)
+        rc = CANERR_NOERROR;            //   note: echo frames are not marked here
+    if (rc == CANERR_NOERROR)
+        can_timestamp(nsec, msg);
+    return rc;
+}
+
+EXPORT
+int can_read_ns(int handle, can_message_t *msg, uint64_t *nsec, uint8_t *flags, uint16_t timeout)
+{
+    int rc;                             // return value
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if ((msg == NULL) || (nsec == NULL)) // check for null-pointer
+        return CANERR_NULLPTR;
+    if (can[handle].status.can_stopped) // must be running
+        return CANERR_OFFLINE;
+
+    // read a message and take its time-stamp as an integer (no division)
+    if (((rc = read_message(handle, msg, nsec, timeout)) == CANERR_NOERROR) || (rc == RX_ECHO)) {
+        msg->timestamp.tv_sec = 0;      //   note: not converted
+        msg->timestamp.tv_nsec = 0;
+        if (flags != NULL)              //   message flags, if wanted
+            *flags = (rc == RX_ECHO) ? PCAN_MSGFLAG_ECHO : 0U;
+        rc = CANERR_NOERROR;
+    }
+    return rc;
+}
+
+EXPORT
+int can_read_multi(int handle, can_message_t *messages, size_t max, size_t *count, uint16_t timeout)
+{
+    can_counter_t counter = {0ull, 0ull, 0ull};  // counter increments
+    int waited = 0;                     // time-out already consumed
+    size_t n = 0;                       // number of messages read
+    uint64_t nsec;                      // time-stamp in [nsec]
+    uint64_t busy = 0ull;               // bus busy time in [psec]
+    int rc;                             // return value
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+    if ((messages == NULL) || (count == NULL)) // check for null-pointer
+        return CANERR_NULLPTR;
+    if (max == 0)                       // at least one message buffer
+        return CANERR_ILLPARA;
+    if (can[handle].status.can_stopped) // must be running
+        return CANERR_OFFLINE;
+
+    // drain the message queue (wait for the first message only)
+    do {
+        rc = rcvq_read(handle, &messages[n], &nsec, &counter);
+        if ((rc == CANERR_NOERROR) || (rc == RX_ECHO)) {  // one message read
+            if (rc != RX_ECHO)          //   note: echo frames are counted by can_write
+                busy += busload_frame(handle, &messages[n]);
+            if (TRACE_ACTIVE(handle))   //   trace session active
+                trace_capture(can[handle].trace, &messages[n], trace_stamp(handle, nsec), (rc == RX_ECHO) ? CANTRC_FLAG_ECH : 0U);
+            can_timestamp(nsec, &messages[n]);
+            n++;
+            rc = CANERR_NOERROR;
+        }
+        else if (rc == RX_REFUSED)      // message refused by user
+            waited = 0;
+        else if ((rc == CANERR_RX_EMPTY) && (n == 0) && (timeout > 0) && !waited) {
+            // blocking read or polling
+            if ((rc = rcvq_wait(handle, timeout)) != CANERR_NOERROR)
+                break;                  //   function failed!
+            waited = 1;
+            rc = RX_REFUSED;            //   look again
+        }
+    } while (((rc == CANERR_NOERROR) || (rc == RX_REFUSED)) && (n < max));
+    // update counters, bus-load and status register (once per batch)
+    if (busy)
+        busload_account(handle, busy);
+    if (counter.rx)
+        (void)port_atomic_add64(&can[handle].counters.rx, counter.rx);
+    if (counter.err)
+        (void)port_atomic_add64(&can[handle].counters.err, counter.err);
+    STATUS_PUT(handle, CANSTAT_RX_EMPTY, n == 0);
+    *count = n;
+    return (n > 0) ? CANERR_NOERROR : rc;
+}
+
+EXPORT
+int can_status(int handle, uint8_t *status)
+{
+    TPCANStatus sts;                    // represents a status
+
+    if (!init)                          // must be initialized
+        return CANERR_NOTINIT;
+    if (!IS_HANDLE_VALID(handle))       // must be a valid handle
+        return CANERR_HANDLE;
+    if (!IS_HANDLE_OPENED(handle))      // must be an open handle
+        return CANERR_HANDLE;
+
+    // TODO: check if running condition is required
+    if (!can[handle].status.can_stopped) { // if running get bus status
+        // get status from device
         sts = CAN_GetStatus(can[handle].board);
         if ((sts & ~(PCAN_ERROR_ANYBUSERR |
                    PCAN_ERROR_OVERRUN | PCAN_ERROR_QOVERRUN |
                    PCAN_ERROR_XMTFULL | PCAN_ERROR_QXMTFULL)))
             return pcan_error(sts);
         // update status-register (some are latched)
-        can[handle].status.bus_off = ((sts & PCAN_ERROR_BUSOFF) != PCAN_ERROR_OK) ? 1 : 0;
-        can[handle].status.bus_error = can[handle].error.lec ? 1 : 0;  // last eror code from error code capture (ECC)
-        can[handle].status.warning_level = ((sts & (PCAN_ERROR_BUSWARNING/*PCAN_ERROR_BUSHEAVY*/)) != PCAN_ERROR_OK) ? 1 : 0;
-        can[handle].status.transmitter_busy |= ((sts & (PCAN_ERROR_XMTFULL | PCAN_ERROR_QXMTFULL)) != PCAN_ERROR_OK) ? 1 : 0;
-        can[handle].status.message_lost |= ((sts & PCAN_ERROR_OVERRUN) != PCAN_ERROR_OK) ? 1 : 0;
-        can[handle].status.queue_overrun |= ((sts & PCAN_ERROR_QOVERRUN) != PCAN_ERROR_OK) ? 1 : 0;
+        STATUS_PUT(handle, CANSTAT_BOFF, (sts & PCAN_ERROR_BUSOFF) != PCAN_ERROR_OK);
+        STATUS_PUT(handle, CANSTAT_BERR, can[handle].error.lec);  // last eror code from error code capture (ECC)
+        STATUS_PUT(handle, CANSTAT_EWRN, (sts & (PCAN_ERROR_BUSWARNING/*PCAN_ERROR_BUSHEAVY*/)) != PCAN_ERROR_OK);
+        if ((sts & (PCAN_ERROR_XMTFULL | PCAN_ERROR_QXMTFULL)) != PCAN_ERROR_OK)
+            STATUS_SET(handle, CANSTAT_TX_BUSY);
+        if ((sts & PCAN_ERROR_OVERRUN) != PCAN_ERROR_OK)
+            STATUS_SET(handle, CANSTAT_MSG_LST);
+        if ((sts & PCAN_ERROR_QOVERRUN) != PCAN_ERROR_OK)
+            STATUS_SET(handle, CANSTAT_QUE_OVR);
     }
     if (status)                         // status-register
-        *status = can[handle].status.byte;
+        *status = STATUS_GET(handle);
     return CANERR_NOERROR;
 }
 
@@ -954,7 +1835,7 @@ EXPORT
 int can_busload(int handle, uint8_t *load, uint8_t *status)
 {
     int rc = CANERR_FATAL;              // return value
-    float busLoad = 0.0;                // bus-load (in [percent])
+    uint16_t busLoad = 0u;              // bus-load (in [0.01 percent])
 
     if (!init)                          // must be initialized
         return CANERR_NOTINIT;
@@ -964,10 +1845,10 @@ int can_busload(int handle, uint8_t *load, uint8_t *status)
         return CANERR_HANDLE;
 
     if (!can[handle].status.can_stopped) { // if running get bus load
-        (void)busLoad; //  TODO: measure bus load
+        busLoad = busload_get(handle);
     }
     if (load)                           // bus-load (in [percent])
-        *load = (uint8_t)busLoad;
+        *load = (uint8_t)(busLoad / 100u);
     // get status-register from device
     rc = can_status(handle, status);
 #if (OPTION_CANAPI_RETVALS == OPTION_DISABLED)
@@ -1110,11 +1991,29 @@ char *can_firmware(int handle)
 
 /*  -----------  local functions  ----------------------------------------
  */
-static void var_init(void)
+static int var_init(void)
 {
     int i;
 
-    for (i = 0; i < CAN_MAX_HANDLES; i++) {
+    // (re-)allocate the handle table, if the number of handles has changed
+    if ((can == NULL) || (num_handles != max_handles)) {
+        if (can != NULL)
+            port_aligned_free(can);
+        if (free_handles != NULL)
+            free(free_handles);
+        num_handles = 0;
+        num_free = 0;
+        if ((can = (can_interface_t*)port_aligned_alloc((size_t)max_handles * sizeof(can_interface_t))) == NULL)
+            return CANERR_RESOURCE;
+        if ((free_handles = (int*)malloc((size_t)max_handles * sizeof(int))) == NULL) {
+            port_aligned_free(can);
+            can = NULL;
+            return CANERR_RESOURCE;
+        }
+        num_handles = max_handles;
+    }
+    memset(board_index, 0, sizeof(board_index));
+    for (i = 0; i < num_handles; i++) {
         memset(&can[i], 0, sizeof(can_interface_t));
         can[i].board = PCAN_NONEBUS;
         can[i].brd_type = 0u;
@@ -1124,36 +2023,62 @@ static void var_init(void)
         can[i].event = NULL;
 #else
         can[i].fdes = -1;
+        can[i].wakeup[0] = -1;
+        can[i].wakeup[1] = -1;
 #endif
         can[i].mode.byte = CANMODE_DEFAULT;
+        can[i].read = pcan_read_std;
+        can[i].write = pcan_write_std;
+        can[i].refuse = 0x00U;
         can[i].status.byte = CANSTAT_RESET;
         can[i].filter.mode = FILTER_OFF;
+        can[i].flist = NULL;
         can[i].error.lec = 0x00u;
         can[i].error.rx_err = 0u;
         can[i].error.tx_err = 0u;
         can[i].counters.tx = 0ull;
         can[i].counters.rx = 0ull;
         can[i].counters.err = 0ull;
+        can[i].rcvq_size = 0u;
+        can[i].rcvq = NULL;
+        can[i].trmq_size = 0u;
+        can[i].trmq = NULL;
+        can[i].cyclic = NULL;
+        can[i].rxcb = NULL;
+        can[i].trace = NULL;
+        can[i].trace_vendor = 0;
+        can[i].echo = NULL;
+        can[i].applied.valid = 0;
+        can[i].restarts.full = 0ull;
+        can[i].restarts.fast = 0ull;
+        can[i].timemap.mode = PCAN_TIME_DEVICE;
+        // note: lowest handle on top of the stack
+        free_handles[num_handles - 1 - i] = i;
     }
+    num_free = num_handles;
+    return CANERR_NOERROR;
 }
 
 static int all_closed(void)
 {
-    int handle;
-
     if (!init)
         return 1;
-    for (handle = 0; handle < CAN_MAX_HANDLES; handle++) {
-        if (IS_HANDLE_OPENED(handle))
-            return 0;
-    }
-    return 1;
+    return (num_free == num_handles) ? 1 : 0;
+}
+
+static int handle_of(TPCANHandle board)
+{
+    // note: O(1) look-up (there are 65536 PCAN handles at most)
+    return (int)board_index[board] - 1;
 }
 
 static void can_message(const TPCANMsg *pcan_msg, can_message_t *msg)
 {
+    size_t len = (pcan_msg->LEN < CAN_MAX_LEN) ? (size_t)pcan_msg->LEN : (size_t)CAN_MAX_LEN;
+
     assert(msg);
     assert(pcan_msg);
+    memset(msg, 0, offsetof(can_message_t, dlc));  // note: incl. the reserved flag
     msg->id = (int32_t)pcan_msg->ID;
     msg->xtd = (pcan_msg->MSGTYPE & PCAN_MESSAGE_EXTENDED) ? 1 : 0;
     msg->rtr = (pcan_msg->MSGTYPE & PCAN_MESSAGE_RTR) ? 1 : 0;
@@ -1162,13 +2087,17 @@ static void can_message(const TPCANMsg *pcan_msg, can_message_t *msg)
     msg->esi = 0;
     msg->sts = 0;
     msg->dlc = (uint8_t)pcan_msg->LEN;
-    memcpy(msg->data, pcan_msg->DATA, CAN_MAX_LEN);
+    memset(msg->data, 0, sizeof(msg->data));  // note: fixed size, cheaper than clearing the tail
+    memcpy(msg->data, pcan_msg->DATA, len);
 }
 
 static void can_message_fd(const TPCANMsgFD *pcan_msg, can_message_t *msg)
 {
+    size_t len = (size_t)DLC2LEN(pcan_msg->DLC);
+
     assert(msg);
     assert(pcan_msg);
+    memset(msg, 0, offsetof(can_message_t, dlc));  // note: incl. the reserved flag
     msg->id = (int32_t)pcan_msg->ID;
     msg->xtd = (pcan_msg->MSGTYPE & PCAN_MESSAGE_EXTENDED) ? 1 : 0;
     msg->rtr = (pcan_msg->MSGTYPE & PCAN_MESSAGE_RTR) ? 1 : 0;
@@ -1177,12 +2106,15 @@ static void can_message_fd(const TPCANMsgFD *pcan_msg, can_message_t *msg)
     msg->esi = 0;  // FIXME: ESI?
     msg->sts = 0;
     msg->dlc = (uint8_t)pcan_msg->DLC;
-    memcpy(msg->data, pcan_msg->DATA, CANFD_MAX_LEN);
+    memset(msg->data, 0, sizeof(msg->data));  // note: fixed size, cheaper than clearing the tail
+    memcpy(msg->data, pcan_msg->DATA, len);
 }
 
 static void can_message_sts(can_status_t status, can_error_t error, can_message_t *msg)
 {
     assert(msg);
+    memset(msg, 0, offsetof(can_message_t, dlc));  // note: incl. the reserved flag
+    memset(msg->data, 0x00, sizeof(msg->data));
     msg->id = (int32_t)0;
     msg->xtd = 0;
     msg->rtr = 0;
@@ -1197,37 +2129,2231 @@ static void can_message_sts(can_status_t status, can_error_t error, can_message_
     msg->data[4] = (uint8_t)error.tx_err;
 }
 
-static void can_timestamp(TPCANTimestamp timestamp, can_message_t *msg)
+static int read_message(int handle, can_message_t *msg, uint64_t *nsec, uint16_t timeout)
 {
+    can_counter_t counter = {0ull, 0ull, 0ull};  // counter increments
+    int rc;                             // return value
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
     assert(msg);
-    uint64_t msec = ((uint64_t)timestamp.millis_overflow << 32) + (uint64_t)timestamp.millis;
-    msg->timestamp.tv_sec = (time_t)(msec / 1000ull);
-    msg->timestamp.tv_nsec = ((((long)(msec % 1000ull)) * 1000L) + (long)timestamp.micros) * (long)1000;
+    assert(nsec);
+
+    msg->id = 0xFFFFFFFFu;              // note: only the decoded fields are written
+    msg->sts = 1;
+repeat:
+    // try to read a message
+    rc = rcvq_read(handle, msg, nsec, &counter);
+    if ((rc == CANERR_RX_EMPTY) && (timeout > 0)) {
+        // blocking read or polling
+        if ((rc = rcvq_wait(handle, timeout)) != CANERR_NOERROR)
+            return rc;                  //   function failed!
+        rc = rcvq_read(handle, msg, nsec, &counter);
+    }
+    if (rc == RX_REFUSED)               // message refused by user
+        goto repeat;
+    if (rc == CANERR_NOERROR)           // message on the bus
+        busload_account(handle, busload_frame(handle, msg));  // note: echo frames are counted by can_write
+    if (((rc == CANERR_NOERROR) || (rc == RX_ECHO)) && TRACE_ACTIVE(handle))  // trace session active
+        trace_capture(can[handle].trace, msg, trace_stamp(handle, *nsec), (rc == RX_ECHO) ? CANTRC_FLAG_ECH : 0U);
+    // update counters and status register
+    if (counter.rx)
+        (void)port_atomic_add64(&can[handle].counters.rx, counter.rx);
+    if (counter.err)
+        (void)port_atomic_add64(&can[handle].counters.err, counter.err);
+    STATUS_PUT(handle, CANSTAT_RX_EMPTY, rc == CANERR_RX_EMPTY);
+    return rc;
 }
 
-static void can_timestamp_fd(TPCANTimestampFD timestamp, can_message_t *msg)
+static void can_timestamp(uint64_t nsec, can_message_t *msg)
 {
     assert(msg);
-    msg->timestamp.tv_sec = (time_t)(timestamp / 1000000ull);
-    msg->timestamp.tv_nsec = (long)(timestamp % 1000000ull) * (long)1000;
+    /* note: one division by a constant (a multiply-high on 64-bit targets) */
+    uint64_t sec = nsec / 1000000000ull;
+    msg->timestamp.tv_sec = (time_t)sec;
+    msg->timestamp.tv_nsec = (long)(nsec - (sec * 1000000000ull));
 }
 
-#define PCAN_ERROR_MASK  (PCAN_ERROR_REGTEST | PCAN_ERROR_NODRIVER | PCAN_ERROR_HWINUSE | PCAN_ERROR_NETINUSE | \
-                          PCAN_ERROR_ILLHW | PCAN_ERROR_ILLHW | PCAN_ERROR_ILLCLIENT)
+static uint64_t pcan_nsec(TPCANTimestamp timestamp)
+{
+    uint64_t msec = ((uint64_t)timestamp.millis_overflow << 32) | (uint64_t)timestamp.millis;
+    return ((msec * 1000ull) + (uint64_t)timestamp.micros) * 1000ull;
+}
 
-static int pcan_error(TPCANStatus status)
+static uint64_t pcan_nsec_fd(TPCANTimestampFD timestamp)
 {
-    if ((status & PCAN_ERROR_XMTFULL)      == PCAN_ERROR_XMTFULL)       return CANERR_TX_BUSY;
-    if ((status & PCAN_ERROR_OVERRUN)      == PCAN_ERROR_OVERRUN)       return CANERR_MSG_LST;
-    if ((status & PCAN_ERROR_BUSOFF)       == PCAN_ERROR_BUSOFF)        return CANERR_BOFF;
-    if ((status & PCAN_ERROR_BUSPASSIVE)   == PCAN_ERROR_BUSPASSIVE)    return CANERR_EWRN;
-    if ((status & PCAN_ERROR_BUSHEAVY)     == PCAN_ERROR_BUSHEAVY)      return CANERR_BERR;
-    if ((status & PCAN_ERROR_BUSLIGHT)     == PCAN_ERROR_BUSLIGHT)      return CANERR_BERR;
-    if ((status & PCAN_ERROR_QRCVEMPTY)    == PCAN_ERROR_QRCVEMPTY)     return CANERR_RX_EMPTY;
-    if ((status & PCAN_ERROR_QOVERRUN)     == PCAN_ERROR_QOVERRUN)      return CANERR_QUE_OVR;
-    if ((status & PCAN_ERROR_QXMTFULL)     == PCAN_ERROR_QXMTFULL)      return CANERR_TX_BUSY;
-    if ((status & PCAN_ERROR_MASK)         == PCAN_ERROR_REGTEST)       return PCAN_ERR_REGTEST;
-    if ((status & PCAN_ERROR_MASK)         == PCAN_ERROR_NODRIVER)      return PCAN_ERR_NODRIVER;
+    return (uint64_t)timestamp * 1000ull;
+}
+
+static int pcan_write_std(int handle, const can_message_t *msg)
+{
+    TPCANStatus sts;                    // represents a status
+    TPCANMsg can_msg;                   // the message (CAN 2.0)
+    uint32_t pending = ECHO_NONE;       // pending write (echo frames)
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(msg);
+    assert(msg->dlc <= CAN_MAX_LEN);    // note: checked by pcan_check_message
+
+    can_msg.MSGTYPE = (msg->xtd ? PCAN_MESSAGE_EXTENDED : PCAN_MESSAGE_STANDARD)
+                    | (msg->rtr ? PCAN_MESSAGE_RTR : 0x00U);
+    can_msg.ID = (DWORD)(msg->id);
+    can_msg.LEN = (BYTE)(msg->dlc);
+    memcpy(can_msg.DATA, msg->data, msg->dlc);
+    // remember the time of the write call, if echo frames are enabled
+    if (can[handle].echo != NULL)
+        pending = echo_pending(handle, msg);
+    // CAN 2.0: transmit the message
+    if ((sts = CAN_Write(can[handle].board, &can_msg)) != PCAN_ERROR_OK)
+        return pcan_write_error(handle, sts, pending);
+    return CANERR_NOERROR;
+}
+
+static int pcan_write_fd(int handle, const can_message_t *msg)
+{
+    TPCANStatus sts;                    // represents a status
+    TPCANMsgFD can_msg_fd;              // the message (CAN FD)
+    uint32_t pending = ECHO_NONE;       // pending write (echo frames)
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(msg);
+    assert(msg->dlc <= CANFD_MAX_DLC);  // note: checked by pcan_check_message
+
+    can_msg_fd.MSGTYPE = (msg->xtd ? PCAN_MESSAGE_EXTENDED : PCAN_MESSAGE_STANDARD)
+                       | (msg->rtr ? PCAN_MESSAGE_RTR : 0x00U)
+                       | (msg->fdf ? PCAN_MESSAGE_FD : 0x00U)
+                       | (msg->brs ? PCAN_MESSAGE_BRS : 0x00U);
+    can_msg_fd.ID = (DWORD)(msg->id);
+    can_msg_fd.DLC = (BYTE)(msg->dlc);
+    memcpy(can_msg_fd.DATA, msg->data, DLC2LEN(msg->dlc));
+    // remember the time of the write call, if echo frames are enabled
+    if (can[handle].echo != NULL)
+        pending = echo_pending(handle, msg);
+    // CAN FD: transmit the message
+    if ((sts = CAN_WriteFD(can[handle].board, &can_msg_fd)) != PCAN_ERROR_OK)
+        return pcan_write_error(handle, sts, pending);
+    return CANERR_NOERROR;
+}
+
+static int pcan_write_error(int handle, TPCANStatus sts, uint32_t pending)
+{
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if (pending != ECHO_NONE)           // no echo frame will come
+        port_atomic_store32(&can[handle].echo->pending[pending].key, ECHO_NONE);
+    if ((sts & PCAN_ERROR_QXMTFULL))    // transmit queue full?
+        return CANERR_TX_BUSY;          //   transmitter busy
+    if ((sts & PCAN_ERROR_XMTFULL))     // transmission pending?
+        return CANERR_TX_BUSY;          //   transmitter busy
+    return pcan_error(sts);             // PCAN specific error
+}
+
+static int pcan_check_message(int handle, const can_message_t *msg)
+{
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(msg);
+
+    /* note: the one check of a message to be sent, done before it is written
+     *       or queued (the write functions and the feeder thread rely on it) */
+    if (msg->id > (uint32_t)(msg->xtd ? CAN_MAX_XTD_ID : CAN_MAX_STD_ID))
+        return CANERR_ILLPARA;          // invalid identifier
+    if (msg->xtd && can[handle].mode.nxtd)
+        return CANERR_ILLPARA;          // suppress extended frames
+    if (msg->rtr && can[handle].mode.nrtr)
+        return CANERR_ILLPARA;          // suppress remote frames
+    if (msg->sts)
+        return CANERR_ILLPARA;          // error frames cannot be sent
+    if (!can[handle].mode.fdoe) {
+        if (msg->fdf || msg->brs)
+            return CANERR_ILLPARA;      // long and fast frames only with CAN FD
+        if (msg->dlc > CAN_MAX_LEN)
+            return CANERR_ILLPARA;      // data length 0 .. 8
+    }
+    else {
+        if (msg->brs && (!msg->fdf || !can[handle].mode.brse))
+            return CANERR_ILLPARA;      // fast frames only with bit-rate switching
+        if (msg->dlc > CANFD_MAX_DLC)
+            return CANERR_ILLPARA;      // data length 0 .. 0Fh
+    }
+    return CANERR_NOERROR;
+}
+
+static void pcan_specialize(int handle)
+{
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    /* note: the operation mode is fixed from can_init on, so the
+     *       CAN 2.0 or CAN FD decision is taken once and not per frame */
+    can[handle].read = !can[handle].mode.fdoe ? pcan_read_std : pcan_read_fd;
+    can[handle].write = !can[handle].mode.fdoe ? pcan_write_std : pcan_write_fd;
+    can[handle].refuse = (can[handle].mode.nxtd ? PCAN_MESSAGE_EXTENDED : 0x00U)
+                       | (can[handle].mode.nrtr ? PCAN_MESSAGE_RTR : 0x00U);
+    // with a software transmit queue the feeder thread calls the write function
+    if (can[handle].trmq_size)
+        can[handle].write = trmq_write;
+}
+
+static int pcan_write_blocking(int handle, const can_message_t *msg, uint16_t timeout)
+{
+    uint64_t start, now;                // time of the first attempt, current time
+    uint32_t backoff = TX_BACKOFF_MIN;  // back-off time in [usec]
+    uint32_t waited;                    // time waited in [usec]
+    uint32_t signaled;                  // signal counter at start
+    int rc;                             // return value
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    // check the message once (not on every retry)
+    if ((rc = pcan_check_message(handle, msg)) != CANERR_NOERROR)
+        return rc;
+    // try to transmit the message (no wait if the transmit queue is not full)
+    if (((rc = can[handle].write(handle, msg)) != CANERR_TX_BUSY) || (timeout == 0U))
+        return rc;
+    /* note: PCANBasic provides no event when the transmit queue is drained,
+     *       therefore we retry with an exponential back-off until time-out */
+    signaled = port_atomic_load32(&can[handle].signaled);
+    start = port_clock_usec();
+    do {
+        now = port_clock_usec();
+        if ((timeout != CANWRITE_INFINITE) &&
+            ((now - start) >= ((uint64_t)timeout * 1000ull)))
+            break;                      //   time-out
+        if (port_atomic_load32(&can[handle].signaled) != signaled)
+            break;                      //   aborted by can_kill
+        if (can[handle].status.can_stopped)
+            break;                      //   stopped by can_reset
+        if ((timeout != CANWRITE_INFINITE) &&
+            ((now - start + backoff) > ((uint64_t)timeout * 1000ull)))
+            port_sleep_usec((uint32_t)(((uint64_t)timeout * 1000ull) - (now - start)));
+        else
+            port_sleep_usec(backoff);
+        backoff = (backoff < (TX_BACKOFF_MAX / 2U)) ? (backoff * 2U) : TX_BACKOFF_MAX;
+    } while ((rc = can[handle].write(handle, msg)) == CANERR_TX_BUSY);
+    // update blocking write statistics
+    waited = (uint32_t)(port_clock_usec() - start);
+    (void)port_atomic_add64(&can[handle].tx_wait.time, (uint64_t)waited);
+    (void)port_atomic_add64(&can[handle].tx_wait.count, 1ull);
+    port_atomic_max32(&can[handle].tx_wait.max, waited);
+    return rc;
+}
+
+PORT_INLINE int flist_accept(const can_filterlist_t *flist, DWORD id, int xtd)
+{
+    uint32_t lo, hi, mid;               // binary search
+
+    if (!xtd)                           // 11-bit identifier: one bit test
+        return (id < 0x800U) && (flist->std[id >> 5] & (1UL << (id & 0x1FU)));
+    // 29-bit identifier: search the sorted, disjoint ranges
+    for (lo = 0U, hi = flist->num_xtd; lo < hi; ) {
+        mid = lo + ((hi - lo) >> 1);
+        if (id < flist->xtd[mid].first)
+            hi = mid;
+        else if (id > flist->xtd[mid].last)
+            lo = mid + 1U;
+        else
+            return 1;
+    }
+    return 0;
+}
+
+static int pcan_read_std(int handle, can_message_t *msg, uint64_t *nsec, can_counter_t *counter)
+{
+    TPCANStatus sts;                    // represents a status
+    TPCANMsg can_msg;                   // the message (CAN 2.0)
+    TPCANTimestamp timestamp;           // time stamp (CAN 2.0)
+    int rc = CANERR_NOERROR;            // return value (RX_ECHO for an echo frame)
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(msg);
+    assert(nsec);
+    assert(counter);
+
+    // try to read a message
+    sts = CAN_Read(can[handle].board, &can_msg, &timestamp);
+    // check for errors
+    if ((sts & PCAN_ERROR_OVERRUN)) {
+        STATUS_SET(handle, CANSTAT_MSG_LST);
+        /* note: at least one message got lost, but we have a message */
+    }
+    if ((sts & PCAN_ERROR_QOVERRUN)) {
+        STATUS_SET(handle, CANSTAT_QUE_OVR);
+        /* note: queue has overrun, but we have a message */
+    }
+    if ((sts & PCAN_ERROR_QRCVEMPTY)) {  // receice queue empty?
+        if ((sts & 0xFF00u))  // TODO: explain this
+            return pcan_error(sts);      //   something went wrong
+        else
+            return CANERR_RX_EMPTY;     //   receiver empty!
+    }
+    // convert PEAK CAN 2.0 message to CAN API message
+    if ((can_msg.MSGTYPE & can[handle].refuse))
+        return RX_REFUSED;              // refuse extended or remote frames
+    if ((can_msg.MSGTYPE & PCAN_MESSAGE_STATUS)) {
+        // update status register from status frame
+        STATUS_PUT(handle, CANSTAT_BOFF, (can_msg.DATA[3] & PCAN_ERROR_BUSOFF) != PCAN_ERROR_OK);
+        STATUS_PUT(handle, CANSTAT_EWRN, (can_msg.DATA[3] & PCAN_ERROR_BUSHEAVY) != PCAN_ERROR_OK);
+        // refuse status message if suppressed by user
+        if (!can[handle].mode.err)
+            return RX_REFUSED;
+        // status message: ID=000h, DLC=4 (status, lec, rx errors, tx errors)
+        can_message_sts(can[handle].status, can[handle].error, msg);
+        counter->err++;
+    }
+    else if ((can_msg.MSGTYPE & PCAN_MESSAGE_ERRFRAME))  {
+        // update error and status register from error frame
+        can[handle].error.lec = (uint8_t)can_msg.ID;
+        can[handle].error.rx_err = can_msg.DATA[2];
+        can[handle].error.tx_err = can_msg.DATA[3];
+        STATUS_PUT(handle, CANSTAT_BERR, can[handle].error.lec);
+        // refuse status message if suppressed by user
+        if (!can[handle].mode.err)
+            return RX_REFUSED;
+        // status message: ID=000h, DLC=4 (status, lec, rx errors, tx errors)
+        can_message_sts(can[handle].status, can[handle].error, msg);
+        counter->err++;
+    }
+    else if ((can_msg.MSGTYPE & PCAN_MESSAGE_ECHO)) {
+        // decode PEAK CAN 2.0 message (echo frame, not counted)
+        can_message(&can_msg, msg);
+        rc = RX_ECHO;
+    }
+    else if (can[handle].flist && !flist_accept(can[handle].flist, can_msg.ID,
+                                               (can_msg.MSGTYPE & PCAN_MESSAGE_EXTENDED))) {
+        return RX_REFUSED;              // refuse identifiers not in the list
+    }
+    else {
+        // decode PEAK CAN 2.0 message and increment receive counter
+        can_message(&can_msg, msg);
+        counter->rx++;
+    }
+    // time-stamp in nanoseconds since start of Windows
+    *nsec = pcan_nsec(timestamp);
+    // echo frame: transmit confirmation with the time-stamp of the transmission
+    if ((rc == RX_ECHO) && (can[handle].echo != NULL))
+        echo_confirm(handle, msg, *nsec);
+    // map the time-stamp onto the host clock, if selected
+    if (can[handle].timemap.mode != PCAN_TIME_DEVICE)
+        *nsec = timemap_apply(handle, *nsec);
+    /* note: the time-stamp of the message is set by the caller, if needed */
+    return rc;
+}
+
+static int pcan_read_fd(int handle, can_message_t *msg, uint64_t *nsec, can_counter_t *counter)
+{
+    TPCANStatus sts;                    // represents a status
+    TPCANMsgFD can_msg_fd;              // the message (CAN FD)
+    TPCANTimestampFD timestamp_fd;      // time stamp (CAN FD)
+    int rc = CANERR_NOERROR;            // return value (RX_ECHO for an echo frame)
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(msg);
+    assert(nsec);
+    assert(counter);
+
+    // try to read a message
+    sts = CAN_ReadFD(can[handle].board, &can_msg_fd, &timestamp_fd);
+    // check for errors
+    if ((sts & PCAN_ERROR_OVERRUN)) {
+        STATUS_SET(handle, CANSTAT_MSG_LST);
+        /* note: at least one message got lost, but we have a message */
+    }
+    if ((sts & PCAN_ERROR_QOVERRUN)) {
+        STATUS_SET(handle, CANSTAT_QUE_OVR);
+        /* note: queue has overrun, but we have a message */
+    }
+    if ((sts & PCAN_ERROR_QRCVEMPTY)) {  // receice queue empty?
+        if ((sts & 0xFF00u))  // TODO: explain this
+            return pcan_error(sts);      //   something went wrong
+        else
+            return CANERR_RX_EMPTY;     //   receiver empty!
+    }
+    // convert PEAK CAN FD message to CAN API message
+    if ((can_msg_fd.MSGTYPE & can[handle].refuse))
+        return RX_REFUSED;              // refuse extended or remote frames
+    if ((can_msg_fd.MSGTYPE & PCAN_MESSAGE_STATUS)) {
+        // update status register from status frame
+        STATUS_PUT(handle, CANSTAT_BOFF, (can_msg_fd.DATA[3] & PCAN_ERROR_BUSOFF) != PCAN_ERROR_OK);
+        STATUS_PUT(handle, CANSTAT_EWRN, (can_msg_fd.DATA[3] & PCAN_ERROR_BUSWARNING) != PCAN_ERROR_OK);
+        // refuse status message if suppressed by user
+        if (!can[handle].mode.err)
+            return RX_REFUSED;
+        // status message: ID=000h, DLC=4 (status, lec, rx errors, tx errors)
+        can_message_sts(can[handle].status, can[handle].error, msg);
+        counter->err++;
+    }
+    else if ((can_msg_fd.MSGTYPE & PCAN_MESSAGE_ERRFRAME)) {
+        // update error and status register from error frame
+        can[handle].error.lec = (uint8_t)can_msg_fd.ID;
+        can[handle].error.rx_err = can_msg_fd.DATA[2];
+        can[handle].error.tx_err = can_msg_fd.DATA[3];
+        STATUS_PUT(handle, CANSTAT_BERR, can[handle].error.lec);
+        // refuse status message if suppressed by user
+        if (!can[handle].mode.err)
+            return RX_REFUSED;
+        // status message: ID=000h, DLC=4 (status, lec, rx errors, tx errors)
+        can_message_sts(can[handle].status, can[handle].error, msg);
+        counter->err++;
+    }
+    else if ((can_msg_fd.MSGTYPE & PCAN_MESSAGE_ECHO)) {
+        // decode PEAK CAN FD message (echo frame, not counted)
+        can_message_fd(&can_msg_fd, msg);
+        rc = RX_ECHO;
+    }
+    else if (can[handle].flist && !flist_accept(can[handle].flist, can_msg_fd.ID,
+                                               (can_msg_fd.MSGTYPE & PCAN_MESSAGE_EXTENDED))) {
+        return RX_REFUSED;              // refuse identifiers not in the list
+    }
+    else {
+        // decode PEAK CAN FD message and increment receive counter
+        can_message_fd(&can_msg_fd, msg);
+        counter->rx++;
+    }
+    // time-stamp in nanoseconds since start of Windows
+    *nsec = pcan_nsec_fd(timestamp_fd);
+    // echo frame: transmit confirmation with the time-stamp of the transmission
+    if ((rc == RX_ECHO) && (can[handle].echo != NULL))
+        echo_confirm(handle, msg, *nsec);
+    // map the time-stamp onto the host clock, if selected
+    if (can[handle].timemap.mode != PCAN_TIME_DEVICE)
+        *nsec = timemap_apply(handle, *nsec);
+    /* note: the time-stamp of the message is set by the caller, if needed */
+    return rc;
+}
+
+static int pcan_wait_event(int handle, uint16_t timeout)
+{
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+#if defined(_WIN32) || defined(_WIN64)
+    switch (WaitForSingleObject(can[handle].event,
+                              (timeout != CANREAD_INFINITE) ? (DWORD)timeout : INFINITE)) {
+    case WAIT_OBJECT_0:
+        break;                          //   one or more messages received
+    case WAIT_TIMEOUT:
+        break;                          //   time-out, but look for old messages
+    default:
+        return CANERR_FATAL;            //   function failed!
+    }
+#else
+    struct pollfd fds[2];
+    char signal;
+
+    fds[0].fd = can[handle].fdes;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = can[handle].wakeup[0];
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    switch (poll(fds, 2, (timeout != CANREAD_INFINITE) ? (int)timeout : -1)) {
+    case -1:
+        if (errno != EINTR)
+            return CANERR_FATAL;        //   function failed!
+        break;                          //   interrupted, but look for old messages
+    case 0:
+        break;                          //   time-out, but look for old messages
+    default:
+        if ((fds[1].revents & POLLIN)) {
+            while (read(can[handle].wakeup[0], &signal, 1) > 0)
+                ;                       //   signaled by can_kill, drain the pipe
+        }
+        break;                          //   one or more messages received
+    }
+#endif
+    return CANERR_NOERROR;
+}
+
+static PORT_THREAD(rcvq_drain, arg)
+{
+    int handle = (int)(intptr_t)arg;    // handle of the CAN channel
+    can_rcvqueue_t *rcvq = can[handle].rcvq;
+    can_counter_t counter = {0ull, 0ull, 0ull};  // note: counted by can_read
+    can_rcventry_t *entry;              // queued message
+    can_message_t msg;                  // the message
+    uint64_t nsec;                      // its time-stamp in [nsec]
+    uint32_t head, tail;                // queue indexes
+    char signal;                        // new messages in the queue
+    int rc;                             // return value
+#if !defined(_WIN32) && !defined(_WIN64)
+    struct pollfd fds[2];
+    char dummy;
+#endif
+
+    while (port_atomic_load32(&rcvq->running)) {
+        // move all messages from the PCAN receive queue into the software receive queue
+        signal = 0;
+        do {
+            if (((rc = can[handle].read(handle, &msg, &nsec, &counter)) != CANERR_NOERROR) && (rc != RX_ECHO))
+                continue;               //   empty, refused or an error
+            head = rcvq->put.head;
+            tail = port_atomic_load32(&rcvq->get.tail);
+            if ((head - tail) >= rcvq->size) {
+                (void)port_atomic_add64(&rcvq->put.ovfl, 1ull);
+                STATUS_SET(handle, CANSTAT_QUE_OVR);
+                continue;               //   queue full, message dropped
+            }
+            entry = &rcvq->buffer[head & (rcvq->size - 1u)];
+            memcpy(&entry->msg, &msg, sizeof(can_message_t));
+            entry->nsec = nsec;
+            entry->echo = (rc == RX_ECHO) ? 1u : 0u;
+            port_atomic_store32(&rcvq->put.head, head + 1u);
+            if ((head + 1u - tail) > rcvq->put.high)
+                rcvq->put.high = head + 1u - tail;
+            signal = 1;
+        } while ((rc == CANERR_NOERROR) || (rc == RX_ECHO) || (rc == RX_REFUSED));
+        // keep a read error for can_read (it is reported when the queue is empty)
+        if ((rc != CANERR_RX_EMPTY) && (port_atomic_load32(&rcvq->put.error) != (uint32_t)rc)) {
+            port_atomic_store32(&rcvq->put.error, (uint32_t)rc);
+            signal = 1;
+        }
+        // signal new messages (or a read error) to a blocking read
+#if defined(_WIN32) || defined(_WIN64)
+        if (signal)
+            (void)SetEvent(rcvq->event);
+#else
+        if (signal)
+            (void)write(can[handle].wakeup[1], &signal, 1);
+#endif
+        if (rc != CANERR_RX_EMPTY) {    // note: don't spin on a read error
+            port_sleep_usec(RCVQ_RETRY_USEC);
+            continue;                   //   retry w/o waiting for the receive event
+        }
+        // wait for new messages in the PCAN receive queue (or to be stopped)
+        /* note: a driver error (e.g. device removed) may not signal the receive event,
+         *       therefore the PCAN receive queue is read at least every RCVQ_POLL_MSEC */
+#if defined(_WIN32) || defined(_WIN64)
+        (void)WaitForSingleObject(can[handle].event, (DWORD)RCVQ_POLL_MSEC);
+#else
+        fds[0].fd = can[handle].fdes;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = rcvq->stop[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        if ((poll(fds, 2, (int)RCVQ_POLL_MSEC) > 0) && (fds[1].revents & POLLIN)) {
+            while (read(rcvq->stop[0], &dummy, 1) > 0)
+                ;                       //   stopped by rcvq_stop, drain the pipe
+        }
+#endif
+    }
+    return PORT_THREAD_EXIT;
+}
+
+static int rcvq_start(int handle)
+{
+    can_rcvqueue_t *rcvq;               // software receive queue
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(can[handle].rcvq_size);
+
+    // (re-)allocate the receive queue, if the size has changed
+    if ((can[handle].rcvq != NULL) && (can[handle].rcvq->size != can[handle].rcvq_size))
+        rcvq_free(handle);
+    if ((rcvq = can[handle].rcvq) == NULL) {
+        if ((rcvq = (can_rcvqueue_t*)port_aligned_alloc(sizeof(can_rcvqueue_t))) == NULL)
+            return CANERR_RESOURCE;
+        if ((rcvq->buffer = (can_rcventry_t*)port_aligned_alloc((size_t)can[handle].rcvq_size * sizeof(can_rcventry_t))) == NULL) {
+            port_aligned_free(rcvq);
+            return CANERR_RESOURCE;
+        }
+        rcvq->size = can[handle].rcvq_size;
+#if defined(_WIN32) || defined(_WIN64)
+        if ((rcvq->event = CreateEvent(NULL, FALSE, FALSE, NULL)) == NULL) {
+            port_aligned_free(rcvq->buffer);
+            port_aligned_free(rcvq);
+            return SYSERR_OFFSET - (int)GetLastError();
+        }
+#else
+        if (pipe(rcvq->stop) < 0) {
+            port_aligned_free(rcvq->buffer);
+            port_aligned_free(rcvq);
+            return SYSERR_OFFSET - errno;
+        }
+        (void)fcntl(rcvq->stop[0], F_SETFL, O_NONBLOCK);
+        (void)fcntl(rcvq->stop[1], F_SETFL, O_NONBLOCK);
+#endif
+        can[handle].rcvq = rcvq;
+    }
+    // start with an empty queue and the drain thread
+    rcvq->put.head = 0u;
+    rcvq->put.high = 0u;
+    rcvq->put.ovfl = 0ull;
+    rcvq->put.error = 0u;
+    rcvq->get.tail = 0u;
+    port_atomic_store32(&rcvq->running, 1u);
+    if (port_thread_create(&rcvq->thread, rcvq_drain, (void*)(intptr_t)handle) != 0) {
+        port_atomic_store32(&rcvq->running, 0u);
+        return CANERR_RESOURCE;
+    }
+    return CANERR_NOERROR;
+}
+
+static void rcvq_stop(int handle)
+{
+    can_rcvqueue_t *rcvq = can[handle].rcvq;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if ((rcvq == NULL) || !port_atomic_load32(&rcvq->running))
+        return;
+    // stop the drain thread and wait for its termination
+    port_atomic_store32(&rcvq->running, 0u);
+#if defined(_WIN32) || defined(_WIN64)
+    (void)SetEvent(can[handle].event);
+#else
+    {
+        const char signal = 1;          // signal the stop-pipe
+        (void)write(rcvq->stop[1], &signal, 1);
+    }
+#endif
+    port_thread_join(rcvq->thread);
+}
+
+static void rcvq_free(int handle)
+{
+    can_rcvqueue_t *rcvq = can[handle].rcvq;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if (rcvq == NULL)
+        return;
+    rcvq_stop(handle);
+#if defined(_WIN32) || defined(_WIN64)
+    (void)CloseHandle(rcvq->event);
+#else
+    (void)close(rcvq->stop[0]);
+    (void)close(rcvq->stop[1]);
+#endif
+    port_aligned_free(rcvq->buffer);
+    port_aligned_free(rcvq);
+    can[handle].rcvq = NULL;
+}
+
+static int rcvq_read(int handle, can_message_t *msg, uint64_t *nsec, can_counter_t *counter)
+{
+    can_rcvqueue_t *rcvq = can[handle].rcvq;
+    can_rcventry_t *entry;              // queued message
+    uint32_t tail;                      // queue index
+    uint32_t error;                     // last read error
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(msg);
+    assert(nsec);
+    assert(counter);
+
+    // w/o a software receive queue read from the PCAN receive queue
+    if (rcvq == NULL)
+        return can[handle].read(handle, msg, nsec, counter);
+    /* note: single consumer, i.e. one reading thread per handle */
+    tail = rcvq->get.tail;
+    if (tail == port_atomic_load32(&rcvq->put.head)) {
+        // report a read error of the drain thread (once), as a direct read would do
+        if (((error = port_atomic_load32(&rcvq->put.error)) != 0u) &&
+            port_atomic_cas32(&rcvq->put.error, error, 0u))
+            return (int)(int32_t)error;
+        return CANERR_RX_EMPTY;         //   receiver empty!
+    }
+    entry = &rcvq->buffer[tail & (rcvq->size - 1u)];
+    memcpy(msg, &entry->msg, sizeof(can_message_t));
+    *nsec = entry->nsec;
+    port_atomic_store32(&rcvq->get.tail, tail + 1u);
+    if (entry->echo)                    // note: echo frames are not counted
+        return RX_ECHO;
+    if (msg->sts)                       // count error frames and messages
+        counter->err++;
+    else
+        counter->rx++;
+    return CANERR_NOERROR;
+}
+
+static int rcvq_wait(int handle, uint16_t timeout)
+{
+    can_rcvqueue_t *rcvq = can[handle].rcvq;
+    uint64_t start = 0ull;              // start of the wait in [usec]
+    uint64_t elapsed;                   // time waited in [msec]
+    uint32_t signaled;                  // signal counter at start
+    uint32_t remaining = 0U;            // remaining time-out in [msec]
+#if !defined(_WIN32) && !defined(_WIN64)
+    struct pollfd fds;
+    char signal;
+#endif
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    // w/o a software receive queue wait for the PCAN receive event
+    if (rcvq == NULL)
+        return pcan_wait_event(handle, timeout);
+    // otherwise wait for a signal from the drain thread (or from can_kill)
+    /* note: a signal may be outdated, i.e. the message has been read already,
+     *       therefore we wait until the queue is not empty or on time-out */
+    signaled = port_atomic_load32(&can[handle].signaled);
+    if (timeout != CANREAD_INFINITE)
+        start = port_clock_usec();
+    while ((rcvq->get.tail == port_atomic_load32(&rcvq->put.head)) &&
+           !port_atomic_load32(&rcvq->put.error)) {
+        if (port_atomic_load32(&can[handle].signaled) != signaled)
+            break;                      //   signaled by can_kill
+        if (timeout != CANREAD_INFINITE) {
+            if ((elapsed = (port_clock_usec() - start) / 1000ull) >= (uint64_t)timeout)
+                break;                  //   time-out
+            remaining = (uint32_t)timeout - (uint32_t)elapsed;
+        }
+#if defined(_WIN32) || defined(_WIN64)
+        switch (WaitForSingleObject(rcvq->event,
+                                  (timeout != CANREAD_INFINITE) ? (DWORD)remaining : INFINITE)) {
+        case WAIT_OBJECT_0:
+            break;                      //   one or more messages received
+        case WAIT_TIMEOUT:
+            break;                      //   time-out, but look for old messages
+        default:
+            return CANERR_FATAL;        //   function failed!
+        }
+#else
+        fds.fd = can[handle].wakeup[0];
+        fds.events = POLLIN;
+        fds.revents = 0;
+        switch (poll(&fds, 1, (timeout != CANREAD_INFINITE) ? (int)remaining : -1)) {
+        case -1:
+            if (errno != EINTR)
+                return CANERR_FATAL;    //   function failed!
+            break;                      //   interrupted, but look for old messages
+        case 0:
+            break;                      //   time-out, but look for old messages
+        default:
+            while (read(can[handle].wakeup[0], &signal, 1) > 0)
+                ;                       //   drain the pipe
+            break;                      //   one or more messages received
+        }
+#endif
+    }
+    return CANERR_NOERROR;
+}
+
+PORT_INLINE uint32_t trmq_priority(const can_message_t *msg)
+{
+    /* note: CAN arbitration compares the base identifier first, then a standard
+     *       frame wins over an extended one (IDE bit), then the identifier
+     *       extension, and finally a data frame wins over a remote frame */
+    if (!msg->xtd)
+        return ((msg->id & 0x7FFU) << 20) | (msg->rtr ? 1U : 0U);
+    return (((msg->id >> 18) & 0x7FFU) << 20) | (1U << 19)
+         | ((msg->id & 0x3FFFFU) << 1) | (msg->rtr ? 1U : 0U);
+}
+
+PORT_INLINE int trmq_before(const can_trmentry_t *a, const can_trmentry_t *b)
+{
+    return (a->prio < b->prio) || ((a->prio == b->prio) && (a->seq < b->seq));
+}
+
+static void trmq_push(can_trmqueue_t *trmq, const can_trmentry_t *entry)
+{
+    uint32_t i, parent;                 // heap indexes
+
+    // sift up from the end of the heap
+    for (i = trmq->count++; i > 0U; i = parent) {
+        parent = (i - 1U) >> 1;
+        if (!trmq_before(entry, &trmq->heap[parent]))
+            break;
+        trmq->heap[i] = trmq->heap[parent];
+    }
+    trmq->heap[i] = *entry;
+}
+
+static void trmq_pop(can_trmqueue_t *trmq, can_trmentry_t *entry)
+{
+    can_trmentry_t *last;               // last entry of the heap
+    uint32_t i, child;                  // heap indexes
+
+    assert(trmq->count > 0U);
+    *entry = trmq->heap[0];
+    last = &trmq->heap[--trmq->count];
+    // sift the last entry down from the top of the heap
+    for (i = 0U; (child = (i << 1) + 1U) < trmq->count; i = child) {
+        if (((child + 1U) < trmq->count) && trmq_before(&trmq->heap[child + 1U], &trmq->heap[child]))
+            child++;
+        if (!trmq_before(&trmq->heap[child], last))
+            break;
+        trmq->heap[i] = trmq->heap[child];
+    }
+    trmq->heap[i] = *last;
+}
+
+static void trmq_sleep(can_trmqueue_t *trmq, uint32_t usec)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)WaitForSingleObject(trmq->event, (usec != TRMQ_WAIT_INFINITE) ? (DWORD)((usec + 999U) / 1000U) : INFINITE);
+#else
+    struct pollfd fds;
+    char dummy;
+
+    fds.fd = trmq->wake[0];
+    fds.events = POLLIN;
+    fds.revents = 0;
+    if ((poll(&fds, 1, (usec != TRMQ_WAIT_INFINITE) ? (int)((usec + 999U) / 1000U) : -1) > 0) &&
+        (fds.revents & POLLIN)) {
+        while (read(trmq->wake[0], &dummy, 1) > 0)
+            ;                           //   drain the pipe
+    }
+#endif
+}
+
+static void trmq_signal(can_trmqueue_t *trmq)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)SetEvent(trmq->event);
+#else
+    const char signal = 1;              // signal the wake-pipe
+    (void)write(trmq->wake[1], &signal, 1);
+#endif
+}
+
+static PORT_THREAD(trmq_feed, arg)
+{
+    int handle = (int)(intptr_t)arg;    // handle of the CAN channel
+    can_trmqueue_t *trmq = can[handle].trmq;
+    can_trmstats_t *stats;              // statistics of the priority class
+    can_trmentry_t entry;               // the message to be sent
+    uint32_t backoff = TX_BACKOFF_MIN;  // back-off time in [usec]
+    uint32_t delay, latency;            // time to wait, queuing latency in [usec]
+    uint64_t now;                       // current time in [usec]
+    uint64_t busy;                      // bus busy time in [psec]
+    int rc;                             // return value
+
+    while (port_atomic_load32(&trmq->running)) {
+        // take the message with the highest priority, if the driver can take it
+        /* note: PCANBasic tells nothing about its transmit queue, therefore the
+         *       bus time of the frames handed over is estimated and limited to
+         *       TRMQ_AHEAD_USEC, so that urgent messages are not queued behind */
+        port_mutex_lock(&trmq->lock);
+        now = port_clock_usec();
+        if (trmq->count == 0U)
+            delay = TRMQ_WAIT_INFINITE;
+        else if (trmq->horizon > (now + TRMQ_AHEAD_USEC))
+            delay = (uint32_t)(trmq->horizon - now - TRMQ_AHEAD_USEC);
+        else {
+            trmq_pop(trmq, &entry);
+            trmq->inflight = 1;
+            delay = 0U;
+        }
+        port_mutex_unlock(&trmq->lock);
+        if (delay) {
+            trmq_sleep(trmq, delay);
+            continue;
+        }
+        // hand the message over to the PCAN transmit queue
+        rc = trmq->write(handle, &entry.msg);
+        now = port_clock_usec();
+        busy = busload_frame(handle, &entry.msg);
+        port_mutex_lock(&trmq->lock);
+        trmq->inflight = 0;
+        if (rc == CANERR_TX_BUSY)       // transmit queue full: put it back
+            trmq_push(trmq, &entry);    //   note: it keeps its sequence number
+        else if (rc == CANERR_NOERROR) {
+            trmq->horizon = ((trmq->horizon > now) ? trmq->horizon : now)
+                          + (busy / 1000000ull);
+            latency = ((now - entry.time) < (uint64_t)UINT32_MAX) ? (uint32_t)(now - entry.time) : UINT32_MAX;
+            stats = &trmq->stats[(entry.prio >> 28) & (PCAN_TRMQ_CLASSES - 1U)];
+            if (!stats->count || (latency < stats->min))
+                stats->min = latency;
+            if (latency > stats->max)
+                stats->max = latency;
+            stats->sum += (uint64_t)latency;
+            stats->count++;
+        }
+        else                            // any other error: the message is dropped
+            trmq->dropped++;            //   note: counted, it has been checked
+        port_mutex_unlock(&trmq->lock);
+        // message handed over: transmit counter, bus-load and trace (now, not when queued)
+        if (rc == CANERR_NOERROR)
+            tx_account(handle, &entry.msg, 1U, busy);
+        if (rc == CANERR_TX_BUSY) {
+            trmq_sleep(trmq, backoff);
+            backoff = (backoff < (TX_BACKOFF_MAX / 2U)) ? (backoff * 2U) : TX_BACKOFF_MAX;
+        }
+        else
+            backoff = TX_BACKOFF_MIN;
+    }
+    return PORT_THREAD_EXIT;
+}
+
+static int trmq_start(int handle)
+{
+    can_trmqueue_t *trmq;               // software transmit queue
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(can[handle].trmq_size);
+
+    // (re-)allocate the transmit queue, if the size has changed
+    if ((can[handle].trmq != NULL) && (can[handle].trmq->size != can[handle].trmq_size))
+        trmq_free(handle);
+    if ((trmq = can[handle].trmq) == NULL) {
+        if ((trmq = (can_trmqueue_t*)port_aligned_alloc(sizeof(can_trmqueue_t))) == NULL)
+            return CANERR_RESOURCE;
+        if ((trmq->heap = (can_trmentry_t*)port_aligned_alloc((size_t)can[handle].trmq_size * sizeof(can_trmentry_t))) == NULL) {
+            port_aligned_free(trmq);
+            return CANERR_RESOURCE;
+        }
+        trmq->size = can[handle].trmq_size;
+#if defined(_WIN32) || defined(_WIN64)
+        if ((trmq->event = CreateEvent(NULL, FALSE, FALSE, NULL)) == NULL) {
+            port_aligned_free(trmq->heap);
+            port_aligned_free(trmq);
+            return SYSERR_OFFSET - (int)GetLastError();
+        }
+#else
+        if (pipe(trmq->wake) < 0) {
+            port_aligned_free(trmq->heap);
+            port_aligned_free(trmq);
+            return SYSERR_OFFSET - errno;
+        }
+        (void)fcntl(trmq->wake[0], F_SETFL, O_NONBLOCK);
+        (void)fcntl(trmq->wake[1], F_SETFL, O_NONBLOCK);
+#endif
+        (void)port_mutex_init(&trmq->lock);
+        can[handle].trmq = trmq;
+    }
+    // start with an empty queue and the feeder thread
+    trmq->count = 0U;
+    trmq->high = 0U;
+    trmq->inflight = 0;
+    trmq->ovfl = 0ull;
+    trmq->dropped = 0ull;
+    trmq->seq = 0ull;
+    trmq->horizon = 0ull;
+    trmq->write = !can[handle].mode.fdoe ? pcan_write_std : pcan_write_fd;
+    memset(trmq->stats, 0, sizeof(trmq->stats));
+    port_atomic_store32(&trmq->running, 1u);
+    if (port_thread_create(&trmq->thread, trmq_feed, (void*)(intptr_t)handle) != 0) {
+        port_atomic_store32(&trmq->running, 0u);
+        return CANERR_RESOURCE;
+    }
+    return CANERR_NOERROR;
+}
+
+static void trmq_stop(int handle)
+{
+    can_trmqueue_t *trmq = can[handle].trmq;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if ((trmq == NULL) || !port_atomic_load32(&trmq->running))
+        return;
+    // stop the feeder thread and wait for its termination
+    /* note: messages still in the queue are discarded by the next can_start */
+    port_atomic_store32(&trmq->running, 0u);
+    trmq_signal(trmq);
+    port_thread_join(trmq->thread);
+}
+
+static void trmq_free(int handle)
+{
+    can_trmqueue_t *trmq = can[handle].trmq;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if (trmq == NULL)
+        return;
+    trmq_stop(handle);
+#if defined(_WIN32) || defined(_WIN64)
+    (void)CloseHandle(trmq->event);
+#else
+    (void)close(trmq->wake[0]);
+    (void)close(trmq->wake[1]);
+#endif
+    port_mutex_destroy(&trmq->lock);
+    port_aligned_free(trmq->heap);
+    port_aligned_free(trmq);
+    can[handle].trmq = NULL;
+}
+
+static int trmq_write(int handle, const can_message_t *msg)
+{
+    can_trmqueue_t *trmq = can[handle].trmq;
+    can_trmentry_t entry;               // the queued message
+    uint32_t count;                     // number of queued messages
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(trmq);
+    assert(msg);
+
+    /* note: the message has been checked by pcan_write_blocking */
+    entry.prio = trmq_priority(msg);
+    entry.time = port_clock_usec();
+    memcpy(&entry.msg, msg, sizeof(can_message_t));
+    // insert the message into the heap (ordered by priority, then FIFO)
+    port_mutex_lock(&trmq->lock);
+    if ((trmq->count + (uint32_t)trmq->inflight) >= trmq->size) {
+        trmq->ovfl++;
+        port_mutex_unlock(&trmq->lock);
+        return CANERR_TX_BUSY;          //   queue full
+    }
+    entry.seq = trmq->seq++;
+    trmq_push(trmq, &entry);
+    if ((count = trmq->count + (uint32_t)trmq->inflight) > trmq->high)
+        trmq->high = count;
+    count = trmq->count;
+    port_mutex_unlock(&trmq->lock);
+    // wake up the feeder thread, if the queue was empty
+    if (count == 1U)
+        trmq_signal(trmq);
+    return CANERR_NOERROR;
+}
+
+static uint64_t cyclic_align(uint64_t usec)
+{
+    // note: deadlines on the tick grid are served without rounding
+    return ((usec + CYCLIC_TICK_USEC - 1U) / CYCLIC_TICK_USEC) * CYCLIC_TICK_USEC;
+}
+
+static void cyclic_unlink(can_cyclic_t *cyclic, int index)
+{
+    can_cycentry_t *entry = &cyclic->entry[index];
+
+    if (entry->slot == CYCLIC_NONE)
+        return;
+    if (entry->prev != CYCLIC_NONE)
+        cyclic->entry[entry->prev].next = entry->next;
+    else
+        cyclic->wheel[entry->slot] = entry->next;
+    if (entry->next != CYCLIC_NONE)
+        cyclic->entry[entry->next].prev = entry->prev;
+    entry->slot = entry->next = entry->prev = CYCLIC_NONE;
+}
+
+static void cyclic_insert(can_cyclic_t *cyclic, int index)
+{
+    can_cycentry_t *entry = &cyclic->entry[index];
+    uint64_t expires, delta;            // expiry tick, ticks from now
+    int slot;                           // slot of the timer wheel
+
+    // the entry expires with the first tick at or after its deadline
+    expires = (entry->deadline + CYCLIC_TICK_USEC - 1U) / CYCLIC_TICK_USEC;
+    if (expires < cyclic->tick)
+        expires = cyclic->tick;         //   overdue: served with the next tick
+    delta = expires - cyclic->tick;
+    /* note: an entry on a higher level is cascaded down when the lower levels
+     *       have turned around, beyond the range it is re-inserted on the top */
+    if (delta < CYCLIC_WHEEL0_SIZE)
+        slot = (int)(expires & (CYCLIC_WHEEL0_SIZE - 1U));
+    else if (delta < (CYCLIC_WHEEL0_SIZE * CYCLIC_WHEELN_SIZE))
+        slot = (int)(CYCLIC_WHEEL0_SIZE + ((expires >> CYCLIC_WHEEL0_BITS) & (CYCLIC_WHEELN_SIZE - 1U)));
+    else {
+        if (delta >= CYCLIC_WHEEL_RANGE)
+            expires = cyclic->tick + CYCLIC_WHEEL_RANGE - 1U;
+        slot = (int)(CYCLIC_WHEEL0_SIZE + CYCLIC_WHEELN_SIZE
+                   + ((expires >> (CYCLIC_WHEEL0_BITS + CYCLIC_WHEELN_BITS)) & (CYCLIC_WHEELN_SIZE - 1U)));
+    }
+    entry->slot = slot;
+    entry->prev = CYCLIC_NONE;
+    entry->next = cyclic->wheel[slot];
+    if (entry->next != CYCLIC_NONE)
+        cyclic->entry[entry->next].prev = index;
+    cyclic->wheel[slot] = index;
+}
+
+static void cyclic_cascade(can_cyclic_t *cyclic, int slot)
+{
+    int index;                          // entry index
+
+    while ((index = cyclic->wheel[slot]) != CYCLIC_NONE) {
+        cyclic_unlink(cyclic, index);
+        cyclic_insert(cyclic, index);
+    }
+}
+
+static int cyclic_expire(can_cyclic_t *cyclic, uint64_t now)
+{
+    uint64_t last = now / CYCLIC_TICK_USEC;  // last tick begun
+    unsigned int level1;                // slot index on level 1
+    int i, n = 0;                       // entry index, number of entries due
+
+    // after a long break, e.g. system suspend, the wheel is rebuilt
+    if (last >= (cyclic->tick + CYCLIC_WHEEL_RANGE)) {
+        cyclic->tick = last;
+        for (i = 0; i < CANCYCLIC_MAX_MESSAGES; i++) {
+            if (cyclic->entry[i].slot != CYCLIC_NONE) {
+                cyclic_unlink(cyclic, i);
+                cyclic_insert(cyclic, i);
+            }
+        }
+    }
+    // process all ticks up to now and collect the entries due
+    for (; cyclic->tick <= last; cyclic->tick++) {
+        if ((cyclic->tick & (CYCLIC_WHEEL0_SIZE - 1U)) == 0U) {
+            level1 = (unsigned int)(cyclic->tick >> CYCLIC_WHEEL0_BITS) & (CYCLIC_WHEELN_SIZE - 1U);
+            if (level1 == 0U)
+                cyclic_cascade(cyclic, (int)(CYCLIC_WHEEL0_SIZE + CYCLIC_WHEELN_SIZE
+                             + ((cyclic->tick >> (CYCLIC_WHEEL0_BITS + CYCLIC_WHEELN_BITS)) & (CYCLIC_WHEELN_SIZE - 1U))));
+            cyclic_cascade(cyclic, (int)(CYCLIC_WHEEL0_SIZE + level1));
+        }
+        while ((i = cyclic->wheel[cyclic->tick & (CYCLIC_WHEEL0_SIZE - 1U)]) != CYCLIC_NONE) {
+            cyclic_unlink(cyclic, i);
+            cyclic->due[n++].index = i;
+        }
+    }
+    return n;
+}
+
+static uint32_t cyclic_delay(can_cyclic_t *cyclic, uint64_t now)
+{
+    uint64_t tick;                      // tick to be looked at
+    uint64_t wake;                      // time to wake up in [usec]
+
+    if (cyclic->count == 0)
+        return CYCLIC_WAIT_INFINITE;
+    // look for the next occupied slot until the lower level turns around
+    /* note: then entries of the higher levels may be cascaded down */
+    for (tick = cyclic->tick; tick & (CYCLIC_WHEEL0_SIZE - 1U); tick++)
+        if (cyclic->wheel[tick & (CYCLIC_WHEEL0_SIZE - 1U)] != CYCLIC_NONE)
+            break;
+    wake = tick * CYCLIC_TICK_USEC;
+    return (wake > now) ? (uint32_t)(wake - now) : 0U;
+}
+
+static void cyclic_sleep(can_cyclic_t *cyclic, uint32_t usec)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    /* note: the timer resolution of Windows is a millisecond (at best) */
+    (void)WaitForSingleObject(cyclic->event, (usec != CYCLIC_WAIT_INFINITE) ? (DWORD)((usec + 999U) / 1000U) : INFINITE);
+#else
+    struct timeval tv;
+    fd_set rdfs;
+    char dummy;
+
+    FD_ZERO(&rdfs);
+    FD_SET(cyclic->wake[0], &rdfs);
+    tv.tv_sec = (time_t)(usec / 1000000U);
+    tv.tv_usec = (suseconds_t)(usec % 1000000U);
+    if (select(cyclic->wake[0] + 1, &rdfs, NULL, NULL, (usec != CYCLIC_WAIT_INFINITE) ? &tv : NULL) > 0) {
+        while (read(cyclic->wake[0], &dummy, 1) > 0)
+            ;                           //   drain the pipe
+    }
+#endif
+}
+
+static void cyclic_signal(can_cyclic_t *cyclic)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)SetEvent(cyclic->event);
+#else
+    const char signal = 1;              // signal the wake-pipe
+    (void)write(cyclic->wake[1], &signal, 1);
+#endif
+}
+
+static PORT_THREAD(cyclic_run, arg)
+{
+    int handle = (int)(intptr_t)arg;    // handle of the CAN channel
+    can_cyclic_t *cyclic = can[handle].cyclic;
+    can_cycentry_t *entry;              // the cyclic message
+    can_cycdue_t *due;                  // the message due
+    uint64_t now;                       // current time in [usec]
+    uint64_t skipped;                   // number of skipped periods
+    uint64_t busy;                      // bus busy time in [psec]
+    uint64_t sent;                      // number of messages sent
+    uint32_t delay;                     // time to wait in [usec]
+    int n, k, full;                     // entries due, loop variable, busy flag
+
+    while (port_atomic_load32(&cyclic->running)) {
+        // collect all messages due up to now and schedule their next deadline
+        port_mutex_lock(&cyclic->lock);
+        now = port_clock_usec();
+        n = cyclic_expire(cyclic, now);
+        for (k = 0; k < n; k++) {
+            due = &cyclic->due[k];
+            entry = &cyclic->entry[due->index];
+            due->serial = entry->serial;
+            due->deadline = entry->deadline;
+            memcpy(&due->msg, &entry->msg, sizeof(can_message_t));
+            // next deadline is absolute, periods already passed are skipped
+            entry->deadline += (uint64_t)entry->period;
+            if (entry->deadline <= now) {
+                skipped = (now - entry->deadline) / (uint64_t)entry->period + 1ull;
+                entry->deadline += skipped * (uint64_t)entry->period;
+                entry->missed += skipped;
+            }
+            cyclic_insert(cyclic, due->index);
+        }
+        port_mutex_unlock(&cyclic->lock);
+        // write them in one burst (w/o holding the lock)
+        if (n > 0) {
+            busy = sent = 0ull;
+            full = 0;
+            for (k = 0; k < n; k++) {
+                due = &cyclic->due[k];
+                if ((due->rc = can[handle].write(handle, &due->msg)) == CANERR_NOERROR) {
+                    now = port_clock_usec();
+                    due->late = (now > due->deadline) ? (now - due->deadline) : 0ull;
+                    busy += busload_frame(handle, &due->msg);
+                    sent++;
+                    if (TRACE_ACTIVE(handle) && !TRMQ_ACTIVE(handle))  // note: queued messages are traced by the feeder thread
+                        trace_capture(can[handle].trace, &due->msg, trace_clock(handle), CANTRC_FLAG_TX);
+                }
+                else
+                    /* note: the message is not repeated, its deadline has passed */
+                    full |= (due->rc == CANERR_TX_BUSY);
+            }
+            // update the statistics of the entries (unless removed meanwhile)
+            port_mutex_lock(&cyclic->lock);
+            for (k = 0; k < n; k++) {
+                due = &cyclic->due[k];
+                entry = &cyclic->entry[due->index];
+                if (!entry->used || (entry->serial != due->serial))
+                    continue;
+                if (due->rc == CANERR_NOERROR) {
+                    if (due->late > (uint64_t)entry->max)
+                        entry->max = (due->late < (uint64_t)UINT32_MAX) ? (uint32_t)due->late : UINT32_MAX;
+                    entry->sum += due->late;
+                    entry->sent++;
+                }
+                else
+                    entry->missed++;
+            }
+            port_mutex_unlock(&cyclic->lock);
+            // update counter, bus-load and status register (once per burst)
+            STATUS_PUT(handle, CANSTAT_TX_BUSY, full);
+            if ((sent > 0ull) && !TRMQ_ACTIVE(handle)) {
+                (void)port_atomic_add64(&can[handle].counters.tx, sent);
+                busload_account(handle, busy);
+            }
+        }
+        port_mutex_lock(&cyclic->lock);
+        delay = cyclic_delay(cyclic, port_clock_usec());
+        port_mutex_unlock(&cyclic->lock);
+        if (delay)
+            cyclic_sleep(cyclic, delay);
+    }
+    return PORT_THREAD_EXIT;
+}
+
+static int cyclic_alloc(int handle)
+{
+    can_cyclic_t *cyclic;               // cyclic scheduler
+    int i;                              // loop variable
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(can[handle].cyclic == NULL);
+
+    if ((cyclic = (can_cyclic_t*)port_aligned_alloc(sizeof(can_cyclic_t))) == NULL)
+        return CANERR_RESOURCE;
+    memset(cyclic, 0, sizeof(can_cyclic_t));
+    for (i = 0; i < CANCYCLIC_MAX_MESSAGES; i++)
+        cyclic->entry[i].slot = CYCLIC_NONE;
+    for (i = 0; i < (int)CYCLIC_WHEEL_SLOTS; i++)
+        cyclic->wheel[i] = CYCLIC_NONE;
+#if defined(_WIN32) || defined(_WIN64)
+    if ((cyclic->event = CreateEvent(NULL, FALSE, FALSE, NULL)) == NULL) {
+        port_aligned_free(cyclic);
+        return SYSERR_OFFSET - (int)GetLastError();
+    }
+#else
+    if (pipe(cyclic->wake) < 0) {
+        port_aligned_free(cyclic);
+        return SYSERR_OFFSET - errno;
+    }
+    (void)fcntl(cyclic->wake[0], F_SETFL, O_NONBLOCK);
+    (void)fcntl(cyclic->wake[1], F_SETFL, O_NONBLOCK);
+#endif
+    (void)port_mutex_init(&cyclic->lock);
+    can[handle].cyclic = cyclic;
+    return CANERR_NOERROR;
+}
+
+static int cyclic_start(int handle)
+{
+    can_cyclic_t *cyclic = can[handle].cyclic;
+    can_cycentry_t *entry;              // the cyclic message
+    uint64_t now;                       // current time in [usec]
+    int i;                              // loop variable
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(cyclic);
+
+    // rebuild the timer wheel: first deadlines relative to the start
+    port_mutex_lock(&cyclic->lock);
+    now = port_clock_usec();
+    cyclic->tick = now / CYCLIC_TICK_USEC;
+    for (i = 0; i < (int)CYCLIC_WHEEL_SLOTS; i++)
+        cyclic->wheel[i] = CYCLIC_NONE;
+    for (i = 0; i < CANCYCLIC_MAX_MESSAGES; i++) {
+        entry = &cyclic->entry[i];
+        entry->slot = entry->next = entry->prev = CYCLIC_NONE;
+        if (!entry->used)
+            continue;
+        entry->deadline = cyclic_align(now + (uint64_t)entry->phase);
+        entry->sent = entry->missed = entry->sum = 0ull;
+        entry->max = 0U;
+        cyclic_insert(cyclic, i);
+    }
+    port_mutex_unlock(&cyclic->lock);
+    // start the scheduler thread
+    port_atomic_store32(&cyclic->running, 1u);
+    if (port_thread_create(&cyclic->thread, cyclic_run, (void*)(intptr_t)handle) != 0) {
+        port_atomic_store32(&cyclic->running, 0u);
+        return CANERR_RESOURCE;
+    }
+    return CANERR_NOERROR;
+}
+
+static void cyclic_stop(int handle)
+{
+    can_cyclic_t *cyclic = can[handle].cyclic;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if ((cyclic == NULL) || !port_atomic_load32(&cyclic->running))
+        return;
+    // stop the scheduler thread and wait for its termination
+    /* note: the cyclic messages are kept for the next can_start */
+    port_atomic_store32(&cyclic->running, 0u);
+    cyclic_signal(cyclic);
+    port_thread_join(cyclic->thread);
+}
+
+static void cyclic_free(int handle)
+{
+    can_cyclic_t *cyclic = can[handle].cyclic;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if (cyclic == NULL)
+        return;
+    cyclic_stop(handle);
+#if defined(_WIN32) || defined(_WIN64)
+    (void)CloseHandle(cyclic->event);
+#else
+    (void)close(cyclic->wake[0]);
+    (void)close(cyclic->wake[1]);
+#endif
+    port_mutex_destroy(&cyclic->lock);
+    port_aligned_free(cyclic);
+    can[handle].cyclic = NULL;
+}
+
+static PORT_THREAD(rxcb_dispatch, arg)
+{
+    int handle = (int)(intptr_t)arg;    // handle of the CAN channel
+    can_callback_t *rxcb = can[handle].rxcb;
+    size_t count;                       // number of messages read
+    int rc;                             // return value
+
+    while (port_atomic_load32(&rxcb->running)) {
+        // read all pending messages and hand them over in one call
+        count = 0;
+        rc = can_read_multi(handle, rxcb->buffer, rxcb->batch, &count, 0U);
+        if (count > 0)
+            rxcb->func(handle, rxcb->buffer, count, rxcb->context);
+        else if (rc == CANERR_RX_EMPTY)  // wait for messages (or to be stopped)
+            rxcb_wait(handle);
+        else                            // note: don't spin on a read error
+            port_sleep_usec(RCVQ_RETRY_USEC);
+    }
+    return PORT_THREAD_EXIT;
+}
+
+static void rxcb_wait(int handle)
+{
+    can_callback_t *rxcb = can[handle].rxcb;
+
+    /* note: the callback thread has its own wake-up, a can_kill would
+     *       abort every other waiter on the channel; the wait is bounded,
+     *       because a concurrent can_read could take the receive event */
+#if defined(_WIN32) || defined(_WIN64)
+    HANDLE events[2];
+
+    events[0] = (can[handle].rcvq != NULL) ? can[handle].rcvq->event : can[handle].event;
+    events[1] = rxcb->event;
+    (void)WaitForMultipleObjects(2, events, FALSE, (DWORD)RXCB_WAIT_MSEC);
+#else
+    struct pollfd fds[2];
+    char dummy;
+
+    // note: the drain thread signals the self-pipe, if any
+    fds[0].fd = (can[handle].rcvq != NULL) ? can[handle].wakeup[0] : can[handle].fdes;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    fds[1].fd = rxcb->wake[0];
+    fds[1].events = POLLIN;
+    fds[1].revents = 0;
+    if (poll(fds, 2, (int)RXCB_WAIT_MSEC) > 0) {
+        if ((can[handle].rcvq != NULL) && (fds[0].revents & POLLIN)) {
+            while (read(can[handle].wakeup[0], &dummy, 1) > 0)
+                ;                       //   drain the pipe
+        }
+        if ((fds[1].revents & POLLIN)) {
+            while (read(rxcb->wake[0], &dummy, 1) > 0)
+                ;                       //   drain the pipe
+        }
+    }
+#endif
+}
+
+static int replay_wait(int handle, uint64_t deadline, uint32_t signaled)
+{
+    uint64_t now;                       // current time in [usec]
+    uint64_t delay;                     // time to sleep in [usec]
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    // sleep until shortly before the deadline, then busy-wait
+    /* note: the resolution of a sleep is about a millisecond (Windows) resp.
+     *       some ten microseconds (POSIX), the deadline is kept by spinning */
+    while ((now = port_clock_usec()) < deadline) {
+        if (port_atomic_load32(&can[handle].signaled) != signaled)
+            return 1;                   //   signaled by can_kill
+        if (can[handle].status.can_stopped)
+            return 1;                   //   stopped by can_reset
+        if ((deadline - now) > REPLAY_SPIN_USEC) {
+            delay = deadline - now - REPLAY_SPIN_USEC;
+            port_sleep_usec((delay < REPLAY_SLEEP_USEC) ? (uint32_t)delay : REPLAY_SLEEP_USEC);
+        }
+    }
+    return 0;
+}
+
+static int rxcb_start(int handle)
+{
+    can_callback_t *rxcb = can[handle].rxcb;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(rxcb);
+
+    if (port_atomic_load32(&rxcb->running))
+        return CANERR_NOERROR;
+    port_atomic_store32(&rxcb->running, 1u);
+    if (port_thread_create(&rxcb->thread, rxcb_dispatch, (void*)(intptr_t)handle) != 0) {
+        port_atomic_store32(&rxcb->running, 0u);
+        return CANERR_RESOURCE;
+    }
+    return CANERR_NOERROR;
+}
+
+static void rxcb_stop(int handle)
+{
+    can_callback_t *rxcb = can[handle].rxcb;
+#if !defined(_WIN32) && !defined(_WIN64)
+    const char signal = 1;              // signal the wake-pipe
+#endif
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if ((rxcb == NULL) || !port_atomic_load32(&rxcb->running))
+        return;
+    // stop the callback thread (wake up its wait) and wait for its termination
+    port_atomic_store32(&rxcb->running, 0u);
+#if defined(_WIN32) || defined(_WIN64)
+    (void)SetEvent(rxcb->event);
+#else
+    (void)write(rxcb->wake[1], &signal, 1);
+#endif
+    port_thread_join(rxcb->thread);
+}
+
+static void rxcb_free(int handle)
+{
+    can_callback_t *rxcb = can[handle].rxcb;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if (rxcb == NULL)
+        return;
+    rxcb_stop(handle);
+#if defined(_WIN32) || defined(_WIN64)
+    (void)CloseHandle(rxcb->event);
+#else
+    (void)close(rxcb->wake[0]);
+    (void)close(rxcb->wake[1]);
+#endif
+    port_aligned_free(rxcb->buffer);
+    port_aligned_free(rxcb);
+    can[handle].rxcb = NULL;
+}
+
+static void trace_capture(can_recorder_t *trace, const can_message_t *msg, uint64_t nsec, uint8_t dir)
+{
+    can_trcslot_t *slot;                // slot of the capture ring
+    uint32_t pos;                       // index of the slot
+    int32_t diff;                       // sequence number minus index
+    uint8_t len;                        // data length
+
+    // claim a slot (lock-free, multiple producers)
+    /* note: the reception path never waits for the writer thread,
+     *       when the capture ring is full the record is dropped */
+    pos = port_atomic_load32(&trace->put.head);
+    for (;;) {
+        slot = &trace->ring[pos & (TRACE_RING_SIZE - 1U)];
+        diff = (int32_t)(port_atomic_load32(&slot->seq) - pos);
+        if (diff == 0) {
+            if (port_atomic_cas32(&trace->put.head, pos, pos + 1U))
+                break;                  //   slot claimed
+        }
+        else if (diff < 0) {
+            (void)port_atomic_add64(&trace->put.dropped, 1ull);
+            return;                     //   ring full
+        }
+        pos = port_atomic_load32(&trace->put.head);
+    }
+    // fill in the record and publish it
+    len = msg->rtr ? 0U : DLC2LEN(msg->dlc);
+    slot->session = port_atomic_load32(&trace->session);
+    slot->rec.nsec = nsec;
+    slot->rec.id = msg->id;
+    slot->rec.flags = dir;
+    slot->rec.flags |= msg->xtd ? CANTRC_FLAG_XTD : 0U;
+    slot->rec.flags |= msg->rtr ? CANTRC_FLAG_RTR : 0U;
+    slot->rec.flags |= msg->fdf ? CANTRC_FLAG_FDF : 0U;
+    slot->rec.flags |= msg->brs ? CANTRC_FLAG_BRS : 0U;
+    slot->rec.flags |= msg->esi ? CANTRC_FLAG_ESI : 0U;
+    slot->rec.flags |= msg->sts ? CANTRC_FLAG_STS : 0U;
+    slot->rec.dlc = msg->dlc;
+    slot->rec.len = len;
+    slot->rec.reserved = 0U;
+    memcpy(slot->rec.data, msg->data, len);
+    memset(&slot->rec.data[len], 0, CANFD_MAX_LEN - len);
+    port_atomic_store32(&slot->seq, pos + 1U);
+}
+
+static uint64_t trace_clock(int handle)
+{
+    // note: a transmitted message is recorded with the host time of the write call
+    return ((can[handle].timemap.mode == PCAN_TIME_REALTIME) ? port_clock_real_usec() : port_clock_usec()) * 1000ull;
+}
+
+static uint64_t trace_stamp(int handle, uint64_t nsec)
+{
+    // note: a received message is recorded on the same time base as a transmitted one,
+    //       i.e. a device time-stamp is mapped onto the host monotonic clock
+    return (can[handle].timemap.mode == PCAN_TIME_DEVICE) ? timemap_apply(handle, nsec) : nsec;
+}
+
+static int trace_folder(const char *folder, char *path, size_t size)
+{
+    const char *home = NULL;            // home directory
+    size_t n;                           // length of the path
+
+    // expand a leading '~' to the home directory
+    if ((folder[0] == '~') && ((folder[1] == '\0') || (folder[1] == '/') || (folder[1] == '\\')) &&
+        ((home = getenv(TRACE_HOME_ENV)) != NULL))
+        folder++;
+    if ((n = (size_t)snprintf(path, size, "%s%s", home ? home : "", folder)) >= size)
+        return CANERR_ILLPARA;
+    // append a path separator, if required
+    if ((n > 0) && (path[n - 1] != '/') && (path[n - 1] != '\\')) {
+        if ((n + 1) >= size)
+            return CANERR_ILLPARA;
+        strcat(path, TRACE_PATH_SEP);
+    }
+    return CANERR_NOERROR;
+}
+
+static void trace_flush(can_recorder_t *trace)
+{
+    // one large sequential write (the trace file is unbuffered)
+    if ((trace->fp != NULL) && (trace->fill > 0)) {
+        if (fwrite(trace->buffer, 1, trace->fill, trace->fp) != trace->fill) {
+            (void)fclose(trace->fp);    //   write error: end of the trace
+            trace->fp = NULL;
+        }
+    }
+    trace->fill = 0;
+    trace->flushed = port_clock_usec();
+}
+
+static void trace_append(can_recorder_t *trace, const void *data, size_t size)
+{
+    if ((trace->fill + size) > TRACE_BUFFER_SIZE)
+        trace_flush(trace);
+    memcpy(&trace->buffer[trace->fill], data, size);
+    trace->fill += size;
+    trace->offset += (uint64_t)size;
+}
+
+static int trace_open(can_recorder_t *trace)
+{
+    const char *ext = (trace->conf.type == CANPARA_TRACE_TYPE_LOGGER) ? ".csv" : ".dat";
+    char file[CANPROP_MAX_STRING_LENGTH+1];  // name of the trace file
+    char line[TRACE_LINE_MAX];          // header line (CSV)
+    int n;                              // length of the file name
+
+    assert(trace->fp == NULL);          // just to make sure
+
+    // file name: <folder><prefix><channel>[_<segment>].<ext>
+    if (trace->segment)
+        n = snprintf(file, sizeof(file), "%s_%03u%s", trace->base, trace->segment, ext);
+    else
+        n = snprintf(file, sizeof(file), "%s%s", trace->base, ext);
+    if ((n < 0) || ((size_t)n >= sizeof(file)))
+        return CANERR_ILLPARA;
+    /* note: the trace file is always (re-)created, i.e. mode OVERWRITE */
+    if ((trace->fp = fopen(file, "wb")) == NULL)
+        return CANERR_RESOURCE;         //   errno is set by fopen
+    port_mutex_lock(&trace->lock);      // note: the file name can be read at any time
+    memcpy(trace->file, file, sizeof(trace->file));
+    port_mutex_unlock(&trace->lock);
+    (void)setvbuf(trace->fp, NULL, _IONBF, 0);
+    trace->offset = 0ull;
+    trc_index_reset(&trace->index);
+    // write the file header into the write buffer
+    if (trace->conf.type == CANPARA_TRACE_TYPE_LOGGER) {
+        n = snprintf(line, sizeof(line), "Time,Dir,Id,Flags,%s,Data\n",
+                     (trace->conf.mode & CANPARA_TRACE_MODE_OUTPUT_LEN) ? "Length" : "DLC");
+        trace_append(trace, line, (size_t)n);
+    }
+    else {
+        trace->header.segment = trace->segment;
+        trace_append(trace, &trace->header, sizeof(can_trc_header_t));
+    }
+    return CANERR_NOERROR;
+}
+
+static size_t trace_csv(const can_recorder_t *trace, const can_trc_record_t *rec, char *line)
+{
+    uint8_t flags = rec->flags;         // record flags
+    size_t n;                           // length of the line
+    uint8_t i;                          // loop variable
+
+    // time-stamp, direction and identifier
+    n = (size_t)sprintf(line, "%llu.%09u,%s,%0*X,",
+                        (unsigned long long)(rec->nsec / 1000000000ull), (unsigned int)(rec->nsec % 1000000000ull),
+                        (flags & CANTRC_FLAG_TX) ? "Tx" : ((flags & CANTRC_FLAG_ECH) ? "Ec" : "Rx"),
+                        (flags & CANTRC_FLAG_XTD) ? 8 : 3, (unsigned int)rec->id);
+    // flags (like the message formatter) and length
+    if (!(flags & CANTRC_FLAG_STS)) {
+        line[n++] = (flags & CANTRC_FLAG_XTD) ? 'X' : 'S';
+        line[n++] = (flags & CANTRC_FLAG_FDF) ? 'F' : '-';
+        line[n++] = (flags & CANTRC_FLAG_BRS) ? 'B' : '-';
+        line[n++] = (flags & CANTRC_FLAG_ESI) ? 'E' : '-';
+        line[n++] = (flags & CANTRC_FLAG_RTR) ? 'R' : '-';
+    }
+    else {
+        memcpy(&line[n], "Error", 5);
+        n += 5;
+    }
+    n += (size_t)sprintf(&line[n], ",%u,", (trace->conf.mode & CANPARA_TRACE_MODE_OUTPUT_LEN) ?
+                         (unsigned int)rec->len : (unsigned int)rec->dlc);
+    // data bytes
+    for (i = 0; i < rec->len; i++)
+        n += (size_t)sprintf(&line[n], (i > 0) ? " %02X" : "%02X", rec->data[i]);
+    line[n++] = '\n';
+    return n;
+}
+
+static void trace_close(can_recorder_t *trace)
+{
+    can_trc_block_t block;              // header of the index block
+    can_trc_trailer_t trailer;          // index trailer
+    uint64_t offset = trace->offset;    // file offset of the index block
+    uint32_t i;                         // loop variable
+
+    // compact trace file: the index of the segment is appended (if complete)
+    if ((trace->fp != NULL) && TRACE_COMPACT(&trace->conf) &&
+        (trace->index.count > 0U) && !trace->index.lost) {
+        trc_index_seal(&trace->index, offset, &block, &trailer);
+        trace_append(trace, &block, sizeof(can_trc_block_t));
+        for (i = 0U; i < trace->index.count; i++)
+            trace_append(trace, &trace->index.entries[i], sizeof(can_trc_index_t));
+        trace_append(trace, &trailer, sizeof(can_trc_trailer_t));
+    }
+    trace_flush(trace);
+    if (trace->fp != NULL) {
+        (void)fclose(trace->fp);
+        trace->fp = NULL;
+    }
+}
+
+static int trace_room(can_recorder_t *trace, size_t size)
+{
+    // size limit: next segment or end of a single trace file
+    /* note: records and blocks are not split, a binary trace file of n * 10KB
+     *       ends exactly at its size limit (header and records of 80 bytes);
+     *       a compact trace file keeps room for the index of its blocks */
+    if (TRACE_COMPACT(&trace->conf))
+        size += trc_index_size(trace->index.count + 1U);
+    if ((trace->offset + (uint64_t)size) > trace->limit) {
+        trace_close(trace);
+        if (!trace->segment)
+            return 0;
+        trace->segment++;
+        if (trace_open(trace) != CANERR_NOERROR)
+            return 0;
+    }
+    return 1;
+}
+
+static void trace_block(can_recorder_t *trace)
+{
+    const void *block;                  // block header and records
+    size_t size;                        // size of the block
+
+    // compact trace file: the block is compressed and written as a whole
+    /* note: a block fits into the write buffer and into an empty segment */
+    if (((size = trc_finish(&trace->encoder, &block)) > 0) && (trace->fp != NULL)) {
+        if (trace_room(trace, size)) {
+            (void)trc_index_add(&trace->index, &trace->encoder.index, trace->offset);
+            trace_append(trace, block, size);
+        }
+    }
+    trace->sealed = port_clock_usec();
+}
+
+static void trace_put(can_recorder_t *trace, const can_trc_record_t *rec)
+{
+    char line[TRACE_LINE_MAX];          // formatted record (CSV)
+    const void *data = rec;             // the record
+    size_t size = sizeof(can_trc_record_t); // size of the record
+
+    if (trace->fp == NULL)              // size limit reached or write error
+        return;
+    if (TRACE_COMPACT(&trace->conf)) {
+        // compact trace file: the record is encoded into the current block
+        if (trc_encode(&trace->encoder, rec) != 0) {
+            trace_block(trace);         //   block full: write it
+            (void)trc_encode(&trace->encoder, rec);
+        }
+        return;
+    }
+    if (trace->conf.type == CANPARA_TRACE_TYPE_LOGGER) {
+        size = trace_csv(trace, rec, line);
+        data = line;
+    }
+    if (trace_room(trace, size))
+        trace_append(trace, data, size);
+}
+
+static uint32_t trace_drain(can_recorder_t *trace)
+{
+    uint32_t session = port_atomic_load32(&trace->session);
+    can_trcslot_t *slot;                // slot of the capture ring
+    uint32_t n = 0U;                    // number of records taken
+
+    // take all published records (single consumer)
+    for (;;) {
+        slot = &trace->ring[trace->get.tail & (TRACE_RING_SIZE - 1U)];
+        if (port_atomic_load32(&slot->seq) != (trace->get.tail + 1U))
+            break;                      //   no more records
+        /* note: a record of a former session can be published late */
+        if (slot->session == session)
+            trace_put(trace, &slot->rec);
+        port_atomic_store32(&slot->seq, trace->get.tail + TRACE_RING_SIZE);
+        trace->get.tail++;
+        n++;
+    }
+    return n;
+}
+
+static PORT_THREAD(trace_writer, arg)
+{
+    can_recorder_t *trace = (can_recorder_t*)arg;
+    uint32_t running;                   // writer thread is running
+    uint32_t n;                         // number of records taken
+
+    do {
+        // note: the records of a stopped session are drained once more
+        running = port_atomic_load32(&trace->running);
+        n = trace_drain(trace);
+        if ((trc_pending(&trace->encoder) > 0U) &&
+            (!running || ((port_clock_usec() - trace->sealed) >= TRACE_BLOCK_USEC)))
+            trace_block(trace);
+        if ((trace->fill > 0) &&
+            (!running || ((port_clock_usec() - trace->flushed) >= TRACE_FLUSH_USEC)))
+            trace_flush(trace);
+        if (running && (n == 0U))
+            port_sleep_usec(TRACE_POLL_USEC);
+    } while (running);
+    trace_close(trace);
+    return PORT_THREAD_EXIT;
+}
+
+static int trace_start(int handle)
+{
+    can_recorder_t *trace = can[handle].trace;
+    char path[CANPROP_MAX_STRING_LENGTH+1];  // folder with path separator
+    char prefix[20] = "";               // date and time prefix
+    const char *name = NULL;            // name of the channel
+    char channel[16];                   // name of the channel (unlisted)
+    struct tm tm;                       // start of the session (local time)
+    time_t now;                         // start of the session
+    size_t capacity;                    // max. length of a block (compact trace file)
+    uint32_t i;                         // loop variable
+    int n, rc;                          // length of the base name, return value
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    // allocate the recorder with the first trace session
+    /* note: the recorder is kept until the channel is closed, a producer
+     *       could still be in the capture ring when a session is stopped */
+    if (trace == NULL) {
+        if ((trace = (can_recorder_t*)port_aligned_alloc(sizeof(can_recorder_t))) == NULL)
+            return CANERR_RESOURCE;
+        memset(trace, 0, sizeof(can_recorder_t));
+        for (i = 0U; i < TRACE_RING_SIZE; i++)
+            trace->ring[i].seq = i;
+        (void)port_mutex_init(&trace->lock);
+        can[handle].trace = trace;
+    }
+    assert(!port_atomic_load32(&trace->running));
+    // settings of the trace session
+    memcpy(&trace->conf, &can[handle].trace_conf, sizeof(can_traceconf_t));
+    trace->limit = (uint64_t)trace->conf.size * (uint64_t)CANPARA_TRACE_SIZE_10KB;
+    trace->segment = (trace->conf.mode & CANPARA_TRACE_MODE_SEGMENTED) ? 1U : 0U;
+    trace->fill = 0;
+    trace->flushed = port_clock_usec();
+    // encoder of a compact trace file (a block fits into the write buffer and an empty segment)
+    capacity = TRACE_BUFFER_SIZE - sizeof(can_trc_block_t);
+    if ((uint64_t)capacity > (trace->limit - sizeof(can_trc_header_t) - sizeof(can_trc_block_t) - trc_index_size(1U)))
+        capacity = (size_t)(trace->limit - sizeof(can_trc_header_t) - sizeof(can_trc_block_t) - trc_index_size(1U));
+    trc_encoder_init(&trace->encoder, trace->conf.codec, capacity);
+    trace->sealed = trace->flushed;
+    for (i = 0U; (i < NUM_CHANNELS) && (can_boards[i].type != EOF); i++) {
+        if ((TPCANHandle)can_boards[i].type == can[handle].board) {
+            name = can_boards[i].name;
+            break;
+        }
+    }
+    if (name == NULL) {
+        (void)snprintf(channel, sizeof(channel), "PCAN-%04X", (unsigned int)can[handle].board);
+        name = channel;
+    }
+    // base name: <folder><yyyymmdd_><hhmmss_><channel>
+    now = time(NULL);
+#if defined(_WIN32) || defined(_WIN64)
+    (void)localtime_s(&tm, &now);
+#else
+    (void)localtime_r(&now, &tm);
+#endif
+    (void)strftime(prefix, sizeof(prefix), (trace->conf.mode & CANPARA_TRACE_MODE_PREFIX_DATE) ?
+                   ((trace->conf.mode & CANPARA_TRACE_MODE_PREFIX_TIME) ? "%Y%m%d_%H%M%S_" : "%Y%m%d_") :
+                   ((trace->conf.mode & CANPARA_TRACE_MODE_PREFIX_TIME) ? "%H%M%S_" : ""), &tm);
+    if ((rc = trace_folder(trace->conf.folder, path, sizeof(path))) != CANERR_NOERROR)
+        return rc;
+    n = snprintf(trace->base, sizeof(trace->base), "%s%s%s", path, prefix, name);
+    if ((n < 0) || ((size_t)n >= sizeof(trace->base)))
+        return CANERR_ILLPARA;
+    // header of a binary trace file
+    memset(&trace->header, 0, sizeof(can_trc_header_t));
+    strncpy(trace->header.magic, CANTRC_MAGIC, sizeof(trace->header.magic));
+    trace->header.version = TRACE_COMPACT(&trace->conf) ? CANTRC_VERSION_COMPACT : CANTRC_VERSION_FIXED;
+    trace->header.hdr_size = (uint16_t)sizeof(can_trc_header_t);
+    trace->header.rec_size = TRACE_COMPACT(&trace->conf) ? 0U : (uint16_t)sizeof(can_trc_record_t);
+    trace->header.can_mode = can[handle].mode.byte;
+    trace->header.time_mode = (can[handle].timemap.mode != PCAN_TIME_DEVICE) ? can[handle].timemap.mode : PCAN_TIME_MONOTONIC;
+    trace->header.start = port_clock_real_usec();
+    trace->header.board = (uint32_t)can[handle].board;
+    strncpy(trace->header.device, name, sizeof(trace->header.device) - 1);
+    // create the (first) trace file
+    if ((rc = trace_open(trace)) != CANERR_NOERROR)
+        return rc;
+    // start the capture and the writer thread
+    (void)port_atomic_add32(&trace->session, 1U);
+    port_atomic_store32(&trace->active, 1u);
+    port_atomic_store32(&trace->running, 1u);
+    if (port_thread_create(&trace->thread, trace_writer, (void*)trace) != 0) {
+        port_atomic_store32(&trace->running, 0u);
+        port_atomic_store32(&trace->active, 0u);
+        (void)fclose(trace->fp);
+        trace->fp = NULL;
+        return CANERR_RESOURCE;
+    }
+    return CANERR_NOERROR;
+}
+
+static void trace_stop(int handle)
+{
+    can_recorder_t *trace = can[handle].trace;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if ((trace == NULL) || !port_atomic_load32(&trace->running))
+        return;
+    // stop the capture and wait for the writer thread (it drains the ring and closes the file)
+    port_atomic_store32(&trace->active, 0u);
+    port_atomic_store32(&trace->running, 0u);
+    port_thread_join(trace->thread);
+}
+
+static void trace_free(int handle)
+{
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    if (can[handle].trace == NULL)
+        return;
+    trace_stop(handle);
+    trc_index_free(&can[handle].trace->index);
+    port_mutex_destroy(&can[handle].trace->lock);
+    port_aligned_free(can[handle].trace);
+    can[handle].trace = NULL;
+}
+
+static int trace_vendor(int handle, int on)
+{
+#if defined(PCAN_TRACE_LOCATION)
+    char path[CANPROP_MAX_STRING_LENGTH+1];  // folder of the trace files
+    uint64_t size;                      // size of a trace file in [byte]
+    DWORD value;                        // parameter value
+    TPCANStatus sts;                    // represents a status
+    int rc;                             // return value
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    // the PCANBasic trace: folder, size in [MB] (1 to 100) and options
+    /* note: the CANPARA_TRACE_MODE_* options are the PCANBasic TRACE_FILE_* flags */
+    if (on) {
+        if ((rc = trace_folder(can[handle].trace_conf.folder, path, sizeof(path))) != CANERR_NOERROR)
+            return rc;
+        if ((sts = CAN_SetValue(can[handle].board, PCAN_TRACE_LOCATION,
+                               (void*)path, (DWORD)sizeof(path))) != PCAN_ERROR_OK)
+            return pcan_error(sts);
+        size = (uint64_t)can[handle].trace_conf.size * (uint64_t)CANPARA_TRACE_SIZE_10KB;
+        value = (DWORD)((size + 0xFFFFFull) >> 20);
+        value = (value < 1U) ? 1U : (value > 100U) ? 100U : value;
+        if ((sts = CAN_SetValue(can[handle].board, PCAN_TRACE_SIZE,
+                               (void*)&value, sizeof(value))) != PCAN_ERROR_OK)
+            return pcan_error(sts);
+        value = (DWORD)(can[handle].trace_conf.mode & TRACE_MODE_OPTIONS);
+        if ((sts = CAN_SetValue(can[handle].board, PCAN_TRACE_CONFIGURE,
+                               (void*)&value, sizeof(value))) != PCAN_ERROR_OK)
+            return pcan_error(sts);
+    }
+    value = on ? PCAN_PARAMETER_ON : PCAN_PARAMETER_OFF;
+    if ((sts = CAN_SetValue(can[handle].board, PCAN_TRACE_STATUS,
+                           (void*)&value, sizeof(value))) != PCAN_ERROR_OK)
+        return pcan_error(sts);
+    can[handle].trace_vendor = on;
+    return CANERR_NOERROR;
+#else
+    (void)handle;
+    (void)on;
+    return CANERR_NOTSUPP;
+#endif
+}
+
+static void echo_reset(int handle)
+{
+    can_echo_t *echo = can[handle].echo;
+    uint32_t i;                         // loop variable
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(echo);
+
+    // note: called by can_start, i.e. no write or read in progress
+    for (i = 0U; i < ECHO_PENDING; i++)
+        echo->pending[i].key = ECHO_NONE;
+    echo->head = echo->tail = 0U;
+    echo->offset = 0;
+    echo->synced = 0;
+    port_atomic_store64(&echo->count, 0ull);
+    port_atomic_store64(&echo->sum, 0ull);
+    port_atomic_store64(&echo->unmatched, 0ull);
+    port_atomic_store32(&echo->min, 0U);
+    port_atomic_store32(&echo->max, 0U);
+    for (i = 0U; i < PCAN_LATENCY_BINS; i++)
+        port_atomic_store64(&echo->histogram[i], 0ull);
+}
+
+static uint32_t echo_pending(int handle, const can_message_t *msg)
+{
+    can_echo_t *echo = can[handle].echo;
+    uint32_t index;                     // index of the pending write
+
+    // note: writes of several threads claim their entries atomically;
+    //       when all entries are taken, the write is not measured
+    if ((port_atomic_load32(&echo->head) - port_atomic_load32(&echo->tail)) >= ECHO_PENDING)
+        return ECHO_NONE;
+    index = port_atomic_add32(&echo->head, 1U) & (ECHO_PENDING - 1U);
+    echo->pending[index].time = port_clock_usec();
+    port_atomic_store32(&echo->pending[index].key, msg->id | ((uint32_t)msg->xtd << 31));
+    return index;
+}
+
+static void echo_confirm(int handle, const can_message_t *msg, uint64_t nsec)
+{
+    can_echo_t *echo = can[handle].echo;
+    uint32_t key = msg->id | ((uint32_t)msg->xtd << 31);
+    uint32_t head = port_atomic_load32(&echo->head);
+    uint32_t tail = echo->tail;
+    uint32_t i, bin;                    // index and histogram bin
+    uint64_t stamp, latency;            // time-stamp and latency in [usec]
+    int64_t offset;                     // host clock minus time-stamp
+
+    /* note: the time-stamp of the echo frame is mapped to the host clock by the
+     *       smallest offset seen so far, i.e. the latency is measured from the
+     *       write call to the time the frame was on the bus (only one reader) */
+    stamp = nsec / 1000ull;
+    offset = (int64_t)port_clock_usec() - (int64_t)stamp;
+    if (!echo->synced || (offset < echo->offset)) {
+        echo->offset = offset;
+        echo->synced = 1;
+    }
+    // search the pending writes for the frame (usually the oldest one)
+    for (i = tail; i != head; i++)
+        if (port_atomic_load32(&echo->pending[i & (ECHO_PENDING - 1U)].key) == key)
+            break;
+    if (i == head) {
+        (void)port_atomic_add64(&echo->unmatched, 1ull);
+    }
+    else {
+        latency = (uint64_t)((int64_t)stamp + echo->offset);
+        latency = (latency > echo->pending[i & (ECHO_PENDING - 1U)].time) ?
+                  (latency - echo->pending[i & (ECHO_PENDING - 1U)].time) : 0ull;
+        if (latency > (uint64_t)UINT32_MAX)
+            latency = (uint64_t)UINT32_MAX;
+        port_atomic_store32(&echo->pending[i & (ECHO_PENDING - 1U)].key, ECHO_NONE);
+        // update the latency statistics
+        if (!port_atomic_load64(&echo->count) || ((uint32_t)latency < echo->min))
+            port_atomic_store32(&echo->min, (uint32_t)latency);
+        (void)port_atomic_max32(&echo->max, (uint32_t)latency);
+        (void)port_atomic_add64(&echo->sum, latency);
+        (void)port_atomic_add64(&echo->count, 1ull);
+        for (bin = 0U; (bin < (PCAN_LATENCY_BINS - 1U)) && (latency >= (2ull << bin)); bin++)
+            ;
+        (void)port_atomic_add64(&echo->histogram[bin], 1ull);
+    }
+    // release consumed entries and entries far behind the confirmed one
+    /* note: writes of several threads may be out of order by a few entries,
+     *       but an entry more than ECHO_WINDOW behind will not be confirmed */
+    while ((tail != head) && ((port_atomic_load32(&echo->pending[tail & (ECHO_PENDING - 1U)].key) == ECHO_NONE) ||
+                              ((i != head) && ((int32_t)(i - tail) > (int32_t)ECHO_WINDOW))))
+        tail++;
+    port_atomic_store32(&echo->tail, tail);
+}
+
+static void timemap_reset(int handle)
+{
+    can_timemap_t *tm = &can[handle].timemap;
+    uint8_t mode = tm->mode;            // keep the selected mode
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    // note: called by can_start, i.e. no read in progress
+    memset(tm, 0, sizeof(can_timemap_t));
+    tm->mode = mode;
+}
+
+static void timemap_sample(can_timemap_t *tm, uint64_t device, uint64_t host)
+{
+    int64_t delay;                      // host minus device time (relative to the first sample)
+    double dx, r, k, det;               // distance to the origin, residual, forgetting, determinant
+
+    assert(tm);
+
+    // first sample or the device clock has been restarted
+    if (!tm->started || (device < tm->last)) {
+        uint8_t mode = tm->mode;
+        memset(tm, 0, sizeof(can_timemap_t));
+        tm->mode = mode;
+        tm->started = 1;
+        tm->base = (int64_t)(host - device);
+        tm->window = device;
+        tm->low = INT64_MAX;
+        tm->real = (int64_t)(port_clock_real_usec() - port_clock_usec());
+    }
+    tm->last = device;
+    /* note: the host time is taken when the message is read, i.e. it is late by
+     *       the reception latency, so only the smallest delay of a window is used */
+    delay = (int64_t)(host - device) - tm->base;
+    if (delay < tm->low) {
+        tm->low = delay;
+        tm->low_dev = device;
+    }
+    if ((device - tm->window) < (uint64_t)TIMEMAP_WINDOW_USEC)
+        return;
+    // window closed: add its minimum to the regression (exponential forgetting)
+    if (!tm->fitted) {
+        tm->ref = tm->low_dev;
+        tm->s = 1.0;
+        tm->sx = tm->sxx = tm->sxy = 0.0;
+        tm->sy = (double)tm->low;
+        tm->a = (double)tm->low;
+        tm->b = 0.0;
+        tm->fitted = 1;
+    }
+    else {
+        dx = (double)(int64_t)(tm->low_dev - tm->ref);
+        r = (double)tm->low - (tm->a + tm->b * dx);
+        tm->var += ((r * r) - tm->var) / 16.0;
+        // forget old samples and move the origin to the new sample
+        k = 1.0 - TIMEMAP_WEIGHT;
+        tm->s *= k; tm->sx *= k; tm->sy *= k; tm->sxx *= k; tm->sxy *= k;
+        tm->sxx += (dx * dx * tm->s) - (2.0 * dx * tm->sx);
+        tm->sxy -= dx * tm->sy;
+        tm->sx -= dx * tm->s;
+        tm->s += 1.0;
+        tm->sy += (double)tm->low;
+        tm->ref = tm->low_dev;
+        // least squares fit: delay = a + b * (device - ref)
+        det = (tm->s * tm->sxx) - (tm->sx * tm->sx);
+        if (det > 0.0) {
+            tm->b = ((tm->s * tm->sxy) - (tm->sx * tm->sy)) / det;
+            if (tm->b > TIMEMAP_MAX_SKEW)
+                tm->b = TIMEMAP_MAX_SKEW;
+            if (tm->b < -TIMEMAP_MAX_SKEW)
+                tm->b = -TIMEMAP_MAX_SKEW;
+        }
+        tm->a = (tm->sy - (tm->b * tm->sx)) / tm->s;
+        port_atomic_store32(&tm->skew, (uint32_t)(int32_t)(tm->b * 1000000000.0));
+        port_atomic_store32(&tm->jitter, (uint32_t)(sqrt(tm->var) * 1000.0));
+    }
+    // offset of the wall-clock to the monotonic clock (may be adjusted)
+    tm->real = (int64_t)(port_clock_real_usec() - port_clock_usec());
+    tm->window = device;
+    tm->low = INT64_MAX;
+}
+
+static uint64_t timemap_apply(int handle, uint64_t nsec)
+{
+    can_timemap_t *tm = &can[handle].timemap;
+    uint64_t device;                    // device time-stamp in [usec]
+    int64_t host;                       // host time in [nsec]
+    double offset;                      // fitted offset in [usec]
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    device = nsec / 1000ull;
+    timemap_sample(tm, device, port_clock_usec());
+    if (tm->fitted)
+        offset = tm->a + (tm->b * (double)(int64_t)(device - tm->ref));
+    else
+        offset = (double)tm->low;       // smallest delay so far
+    host = ((int64_t)device + tm->base + ((tm->mode == PCAN_TIME_REALTIME) ? tm->real : 0LL)) * 1000LL
+         + (int64_t)(offset * 1000.0);
+    return (host > 0LL) ? (uint64_t)host : 0ull;
+}
+
+static void busload_reset(int handle, const can_bitrate_t *bitrate)
+{
+    can_speed_t speed;                  // transmission speed
+    int i;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(bitrate);
+
+    /* note: the bit-rate has been checked by can_start */
+    memset(&speed, 0, sizeof(can_speed_t));
+    (void)btr_bitrate2speed(bitrate, &speed);
+    /* note: a bit time in [psec] fits into 32 bits for 1kbps and above */
+    can[handle].busload.nominal = ((speed.nominal.speed >= 1.0e3f) && (speed.nominal.speed <= 1.0e9f)) ?
+                                  (uint32_t)(1.0e12f / speed.nominal.speed) : 0u;
+    can[handle].busload.data = (can[handle].mode.brse && (speed.data.speed >= 1.0e3f) && (speed.data.speed <= 1.0e9f)) ?
+                               (uint32_t)(1.0e12f / speed.data.speed) : can[handle].busload.nominal;
+    for (i = 0; i < BUSLOAD_SLOTS; i++) {
+        port_atomic_store64(&can[handle].busload.window[i].slot, 0ull);
+        port_atomic_store64(&can[handle].busload.window[i].busy, 0ull);
+    }
+    port_atomic_store64(&can[handle].busload.start, port_clock_usec());
+}
+
+static uint64_t busload_frame(int handle, const can_message_t *msg)
+{
+    uint32_t len = 0U;                  // length of the payload
+    uint32_t arb, dat;                  // bits in arbitration phase and data phase
+    uint32_t crc;                       // length of the CRC (CAN FD)
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(msg);
+
+    if (msg->sts)                       // status message (no frame)
+        return 0ull;
+    /* note: frame length with worst-case bit-stuffing, incl. 3 bits intermission */
+    if (!msg->fdf) {                    // CAN 2.0 frame:
+        /* (1) bits = g + 8n + 13 + floor((g + 8n - 1) / 4) with g = 34 (11-bit) or 54 (29-bit) */
+        if (!msg->rtr)
+            len = (msg->dlc < 8U) ? (uint32_t)msg->dlc : 8U;
+        arb = (msg->xtd ? 54U : 34U) + (len * 8U);
+        return (uint64_t)(arb + 13U + ((arb - 1U) / 4U)) * (uint64_t)can[handle].busload.nominal;
+    }
+    /* CAN FD frame:
+     * (2) nominal bits: SOF up to BRS with stuff bits, ACK slot and delimiter, EOF, intermission
+     * (3) data bits: ESI, DLC and payload with stuff bits, stuff count and CRC with fixed stuff bits, CRC delimiter
+     */
+    len = (uint32_t)DLC2LEN(msg->dlc);
+    arb = msg->xtd ? 36U : 17U;
+    arb += ((arb - 1U) / 4U) + 12U;
+    dat = 5U + (len * 8U);
+    dat += (dat - 1U) / 4U;
+    crc = (len <= 16U) ? 17U : 21U;
+    dat += 4U + crc + ((4U + crc + 3U) / 4U) + 1U;
+    return ((uint64_t)arb * (uint64_t)can[handle].busload.nominal)
+         + ((uint64_t)dat * (uint64_t)(msg->brs ? can[handle].busload.data : can[handle].busload.nominal));
+}
+
+static void busload_account(int handle, uint64_t busy)
+{
+    uint64_t slot, last;                // current and recorded time slot
+    volatile can_timeslot_t *window;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    slot = port_clock_usec() / BUSLOAD_SLOT_USEC;
+    window = &can[handle].busload.window[slot % BUSLOAD_SLOTS];
+    /* note: the first one entering a new time slot clears it (a frame accounted by
+     *       another thread in between is lost, what is tolerable for a bus-load) */
+    if ((last = port_atomic_load64(&window->slot)) != slot) {
+        if (port_atomic_cas64(&window->slot, last, slot))
+            port_atomic_store64(&window->busy, 0ull);
+    }
+    (void)port_atomic_add64(&window->busy, busy);
+}
+
+static void tx_account(int handle, const can_message_t *msgs, size_t n, uint64_t busy)
+{
+    uint64_t nsec;                      // time-stamp of the trace records
+    size_t i;                           // loop variable
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(msgs);
+
+    // messages handed to the PCAN transmit queue: transmit counter, bus-load and trace
+    (void)port_atomic_add64(&can[handle].counters.tx, (uint64_t)n);
+    busload_account(handle, busy);
+    if (TRACE_ACTIVE(handle)) {         // trace session active
+        nsec = trace_clock(handle);     //   note: one time-stamp per batch
+        for (i = 0; i < n; i++)
+            trace_capture(can[handle].trace, &msgs[i], nsec, CANTRC_FLAG_TX);
+    }
+}
+
+static uint16_t busload_get(int handle)
+{
+    uint64_t now, slot, last;           // current time and time slots
+    uint64_t busy = 0ull;               // bus busy time in [psec]
+    uint64_t elapsed;                   // duration of the window in [usec]
+    uint64_t load;                      // bus-load in [0.01 percent]
+    int i;
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    now = port_clock_usec();
+    slot = now / BUSLOAD_SLOT_USEC;
+    for (i = 0; i < BUSLOAD_SLOTS; i++) {
+        last = port_atomic_load64(&can[handle].busload.window[i].slot);
+        if ((last <= slot) && ((slot - last) < (uint64_t)BUSLOAD_SLOTS))
+            busy += port_atomic_load64(&can[handle].busload.window[i].busy);
+    }
+    /* note: the window consists of the current time slot (in progress) and the
+     *       preceding time slots, but not before the measurement has started */
+    elapsed = ((uint64_t)(BUSLOAD_SLOTS - 1) * BUSLOAD_SLOT_USEC) + (now % BUSLOAD_SLOT_USEC);
+    if (elapsed > (now - port_atomic_load64(&can[handle].busload.start)))
+        elapsed = now - port_atomic_load64(&can[handle].busload.start);
+    if (elapsed == 0ull)
+        return 0u;
+    /* (4) load = busy [psec] / (elapsed [usec] * 10^6) * 10^4 [0.01 percent] */
+    load = busy / (elapsed * 100ull);
+    return (uint16_t)((load < 10000ull) ? load : 10000ull);
+}
+
+#define PCAN_ERROR_MASK  (PCAN_ERROR_REGTEST | PCAN_ERROR_NODRIVER | PCAN_ERROR_HWINUSE | PCAN_ERROR_NETINUSE | \
+                          PCAN_ERROR_ILLHW | PCAN_ERROR_ILLHW | PCAN_ERROR_ILLCLIENT)
+
+static int pcan_error(TPCANStatus status)
+{
+    if ((status & PCAN_ERROR_XMTFULL)      == PCAN_ERROR_XMTFULL)       return CANERR_TX_BUSY;
+    if ((status & PCAN_ERROR_OVERRUN)      == PCAN_ERROR_OVERRUN)       return CANERR_MSG_LST;
+    if ((status & PCAN_ERROR_BUSOFF)       == PCAN_ERROR_BUSOFF)        return CANERR_BOFF;
+    if ((status & PCAN_ERROR_BUSPASSIVE)   == PCAN_ERROR_BUSPASSIVE)    return CANERR_EWRN;
+    if ((status & PCAN_ERROR_BUSHEAVY)     == PCAN_ERROR_BUSHEAVY)      return CANERR_BERR;
+    if ((status & PCAN_ERROR_BUSLIGHT)     == PCAN_ERROR_BUSLIGHT)      return CANERR_BERR;
+    if ((status & PCAN_ERROR_QRCVEMPTY)    == PCAN_ERROR_QRCVEMPTY)     return CANERR_RX_EMPTY;
+    if ((status & PCAN_ERROR_QOVERRUN)     == PCAN_ERROR_QOVERRUN)      return CANERR_QUE_OVR;
+    if ((status & PCAN_ERROR_QXMTFULL)     == PCAN_ERROR_QXMTFULL)      return CANERR_TX_BUSY;
+    if ((status & PCAN_ERROR_MASK)         == PCAN_ERROR_REGTEST)       return PCAN_ERR_REGTEST;
+    if ((status & PCAN_ERROR_MASK)         == PCAN_ERROR_NODRIVER)      return PCAN_ERR_NODRIVER;
     if ((status & PCAN_ERROR_MASK)         == PCAN_ERROR_HWINUSE)       return PCAN_ERR_HWINUSE;
     if ((status & PCAN_ERROR_MASK)         == PCAN_ERROR_NETINUSE)      return PCAN_ERR_NETINUSE;
     if ((status & PCAN_ERROR_MASK)         == PCAN_ERROR_ILLHW)         return PCAN_ERR_ILLHW;
@@ -1281,6 +4407,16 @@ static TPCANStatus pcan_capability(TPCANHandle board, can_mode_t *capability)
                             (void*)&features, sizeof(features))) != PCAN_ERROR_OK)
         return sts;
     // determine the channel capabilities
+    pcan_features(features, capability);
+
+    return PCAN_ERROR_OK;
+}
+
+static void pcan_features(DWORD features, can_mode_t *capability)
+{
+    assert(capability);                 // just to make sure
+    capability->byte = 0x00u;
+
     capability->fdoe = (features & FEATURE_FD_CAPABLE) ? 1 : 0;
     capability->brse = (features & FEATURE_FD_CAPABLE) ? 1 : 0;
     capability->niso = 0; // this can not be determined (FIXME)
@@ -1294,7 +4430,157 @@ static TPCANStatus pcan_capability(TPCANHandle board, can_mode_t *capability)
 #endif
     capability->err = 1;  // PCAN_ALLOW_ERROR_FRAMES available since version 4.2.0
     capability->mon = 1;  // PCAN_LISTEN_ONLY available since version 1.0.0
+}
+
+static int pcan_restart(int handle, uint16_t btr0btr1, const char *string)
+{
+    TPCANStatus sts;                    // represents a status
+    DWORD value;                        // parameter value
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(string);
+
+    /* note: to (re-)start the CAN controller, we have to reinitialize it */
+    can[handle].applied.valid = 0;
+    if ((sts = CAN_Reset(can[handle].board)) != PCAN_ERROR_OK)
+        return pcan_error(sts);
+    if ((sts = CAN_Uninitialize(can[handle].board)) != PCAN_ERROR_OK)
+        return pcan_error(sts);
+    /* note: the receiver is automatically switched ON by CAN_Initialize[FD]() */
+    if (can[handle].mode.fdoe) {        // CAN FD operation mode?
+        if ((sts = CAN_InitializeFD(can[handle].board, (TPCANBitrateFD)string)) != PCAN_ERROR_OK)
+            return pcan_error(sts);
+    }
+    else {                              // CAN 2.0 operation mode!
+        if ((sts = CAN_Initialize(can[handle].board, btr0btr1,
+                                  can[handle].brd_type, can[handle].brd_port,
+                                  can[handle].brd_irq)) != PCAN_ERROR_OK)
+            return pcan_error(sts);
+    }
+#if defined(_WIN32) || defined(_WIN64)
+    // set event handle for blocking read
+    // TODO: check if we have to create a new event handle
+    if ((sts = CAN_SetValue(can[handle].board, PCAN_RECEIVE_EVENT,
+                           (void*)&can[handle].event,
+                            sizeof(can[handle].event))) != PCAN_ERROR_OK) {
+        CAN_Uninitialize(can[handle].board);
+        return pcan_error(sts);
+    }
+#else
+    // get file descriptor for blocking read
+    if ((sts = CAN_GetValue(can[handle].board, PCAN_RECEIVE_EVENT,
+                           (void*)&can[handle].fdes,
+                            sizeof(can[handle].fdes))) != PCAN_ERROR_OK) {
+        CAN_Uninitialize(can[handle].board);
+        return pcan_error(sts);
+    }
+#endif
+    // set listen-only mode if selected
+    value = (can[handle].mode.mon) ? PCAN_PARAMETER_ON : PCAN_PARAMETER_OFF;
+    if ((sts = CAN_SetValue(can[handle].board, PCAN_LISTEN_ONLY,
+                           (void*)&value, sizeof(value))) != PCAN_ERROR_OK) {
+        CAN_Uninitialize(can[handle].board);
+        return pcan_error(sts);
+    }
+    // enable error frame reception if selected
+    value = (can[handle].mode.err) ? PCAN_PARAMETER_ON : PCAN_PARAMETER_OFF;
+    if ((sts = CAN_SetValue(can[handle].board, PCAN_ALLOW_ERROR_FRAMES,
+                           (void*)&value, sizeof(value))) != PCAN_ERROR_OK) {
+        CAN_Uninitialize(can[handle].board);
+        return pcan_error(sts);
+    }
+    // set acceptance filter as selected
+    switch(can[handle].filter.mode) {
+        case FILTER_STD:                // 11-bit identifier
+            if ((sts = CAN_SetValue(can[handle].board, PCAN_ACCEPTANCE_FILTER_11BIT,
+                                   (void*)&can[handle].filter.mask,
+                                    sizeof(UINT64))) != PCAN_ERROR_OK) {
+                CAN_Uninitialize(can[handle].board);
+                return pcan_error(sts);
+            }
+            break;
+        case FILTER_XTD:                // 29-bit identifier
+            if ((sts = CAN_SetValue(can[handle].board, PCAN_ACCEPTANCE_FILTER_29BIT,
+                                   (void*)&can[handle].filter.mask,
+                                    sizeof(UINT64))) != PCAN_ERROR_OK) {
+                CAN_Uninitialize(can[handle].board);
+                return pcan_error(sts);
+            }
+            break;
+        default:                        // no filtering
+            value = PCAN_FILTER_OPEN;
+            if ((sts = CAN_SetValue(can[handle].board, PCAN_MESSAGE_FILTER,
+                                   (void*)&value, sizeof(value))) != PCAN_ERROR_OK) {
+                CAN_Uninitialize(can[handle].board);
+                return pcan_error(sts);
+            }
+            break;
+    }
+    // enable echo frames of transmitted messages, if selected
+    if (can[handle].echo != NULL) {
+        value = PCAN_PARAMETER_ON;
+        if ((sts = CAN_SetValue(can[handle].board, PCAN_ALLOW_ECHO_FRAMES,
+                               (void*)&value, sizeof(value))) != PCAN_ERROR_OK) {
+            CAN_Uninitialize(can[handle].board);
+            return pcan_error(sts);
+        }
+    }
+    // remember the configuration for a fast restart
+    can[handle].applied.btr0btr1 = btr0btr1;
+    strncpy(can[handle].applied.string, string, PCAN_MAX_BUFFER_SIZE);
+    can[handle].applied.string[PCAN_MAX_BUFFER_SIZE - 1] = '\0';
+    can[handle].applied.mode = can[handle].mode.byte;
+    can[handle].applied.filter = can[handle].filter;
+    can[handle].applied.echo = (can[handle].echo != NULL) ? 1 : 0;
+    can[handle].applied.valid = 1;
+    return CANERR_NOERROR;
+}
+
+static int pcan_unchanged(int handle, uint16_t btr0btr1, const char *string)
+{
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(string);
+
+    // the controller must have been initialized by a full restart
+    if (!can[handle].applied.valid)
+        return 0;
+    // bus off requires a reinitialization of the controller
+    if ((STATUS_GET(handle) & CANSTAT_BOFF) ||
+        (CAN_GetStatus(can[handle].board) & PCAN_ERROR_BUSOFF))
+        return 0;
+    // compare the configuration with the one applied by the last full restart
+    if (can[handle].mode.fdoe) {
+        if (strcmp(string, can[handle].applied.string) != 0)
+            return 0;
+    }
+    else if (btr0btr1 != can[handle].applied.btr0btr1)
+        return 0;
+    if ((can[handle].mode.byte != can[handle].applied.mode) ||
+        (can[handle].filter.mode != can[handle].applied.filter.mode) ||
+        (can[handle].filter.mask != can[handle].applied.filter.mask) ||
+        ((can[handle].echo != NULL) != (can[handle].applied.echo != 0)))
+        return 0;
+    return 1;
+}
+
+static TPCANStatus pcan_resume(int handle)
+{
+    TPCANStatus sts;                    // represents a status
+    DWORD value;                        // parameter value
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
 
+    /* note: the queues are cleared as by a reinitialization */
+    if ((sts = CAN_Reset(can[handle].board)) != PCAN_ERROR_OK)
+        return sts;
+    value = (can[handle].mode.mon) ? PCAN_PARAMETER_ON : PCAN_PARAMETER_OFF;
+    if ((sts = CAN_SetValue(can[handle].board, PCAN_LISTEN_ONLY,
+                           (void*)&value, sizeof(value))) != PCAN_ERROR_OK)
+        return sts;                     //   transmitter on (unless listen-only)
+    value = PCAN_PARAMETER_ON;
+    if ((sts = CAN_SetValue(can[handle].board, PCAN_RECEIVE_STATUS,
+                           (void*)&value, sizeof(value))) != PCAN_ERROR_OK)
+        return sts;                     //   receiver on
     return PCAN_ERROR_OK;
 }
 
@@ -1370,39 +4656,262 @@ static TPCANStatus pcan_set_filter(int handle, uint64_t filter, filtering_t mode
             sts = pcan_reset_filter(handle);
             break;
     }
-    return sts;
+    return sts;
+}
+
+static TPCANStatus pcan_reset_filter(int handle)
+{
+    TPCANStatus sts;                    // represents a status
+    uint8_t filter = PCAN_FILTER_OPEN;  // filter mode (accept all)
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+#if defined(__linux__)
+    UINT64 value = 0x0ull;              // PCAN filter value
+
+    // note: it seems that the hardware filter is not resetted by 'PCAN_MESSAGE_FILTER' := 'PCAN_FILTER_OPEN'
+    switch (can[handle].filter.mode) {
+        case FILTER_STD:                // 11-bit identifier
+            value = (FILTER_RESET_VALUE ^ FILTER_STD_XOR_MASK);   // SJA100 has inverted masks bits!
+            (void)CAN_SetValue(can[handle].board, PCAN_ACCEPTANCE_FILTER_11BIT, (void*)&value, sizeof(value));
+            break;
+        case FILTER_XTD:                // 29-bit identifier
+            value = (FILTER_RESET_VALUE ^ FILTER_XTD_XOR_MASK);   // SJA100 has inverted masks bits!
+            (void)CAN_SetValue(can[handle].board, PCAN_ACCEPTANCE_FILTER_29BIT, (void*)&value, sizeof(value));
+            break;
+        default:                        // no filtering
+            break;
+    }
+#endif
+    // reset the filter value to device
+    if ((sts = CAN_SetValue(can[handle].board, (BYTE)PCAN_MESSAGE_FILTER,
+                           (void*)&filter, (DWORD)sizeof(uint8_t))) == PCAN_ERROR_OK) {
+        can[handle].filter.mode = FILTER_OFF;
+    }
+    return sts;
+}
+
+static int pcan_snapshot(int handle, can_pcan_snapshot_t *snapshot)
+{
+    int rc;                             // return value
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+    assert(snapshot);
+
+    memset(snapshot, 0, sizeof(can_pcan_snapshot_t));
+    snapshot->version = (uint16_t)PCAN_SNAPSHOT_VERSION;
+    snapshot->size = (uint16_t)sizeof(can_pcan_snapshot_t);
+
+    // bit-rate from the configuration of the last full restart (w/o driver call)
+    if (can[handle].applied.valid) {
+        if (!can[handle].mode.fdoe)
+            rc = btr_sja10002bitrate(can[handle].applied.btr0btr1, &snapshot->bitrate);
+        else {
+            bool data = false, sam = false;  // no further usage
+            rc = btr_string2bitrate(can[handle].applied.string, &snapshot->bitrate, &data, &sam);
+        }
+        if (rc == CANERR_NOERROR)
+            rc = btr_bitrate2speed(&snapshot->bitrate, &snapshot->speed);
+        if (rc != CANERR_NOERROR)
+            return rc;
+    }
+    // or from the device, if the controller has never been started
+    else if (((rc = can_bitrate(handle, &snapshot->bitrate, &snapshot->speed)) != CANERR_NOERROR) &&
+             (rc != CANERR_OFFLINE))
+        return rc;
+    // status register from the device (one call, only if running)
+    if ((rc = can_status(handle, &snapshot->status)) != CANERR_NOERROR)
+        return rc;
+    // counters and bus load right after the status (no driver calls)
+    snapshot->time = port_clock_usec();
+    snapshot->tx = port_atomic_load64(&can[handle].counters.tx);
+    snapshot->rx = port_atomic_load64(&can[handle].counters.rx);
+    snapshot->err = port_atomic_load64(&can[handle].counters.err);
+    snapshot->busload = !can[handle].status.can_stopped ? busload_get(handle) : 0u;
+    snapshot->mode = can[handle].mode.byte;
+    // acceptance filters as written to the device (there is only one filter for both modes)
+    snapshot->filter_11bit = (can[handle].filter.mode == FILTER_STD) ?
+                             (can[handle].filter.mask ^ FILTER_STD_XOR_MASK) : FILTER_RESET_VALUE;
+    snapshot->filter_29bit = (can[handle].filter.mode == FILTER_XTD) ?
+                             (can[handle].filter.mask ^ FILTER_XTD_XOR_MASK) : FILTER_RESET_VALUE;
+    return CANERR_NOERROR;
+}
+
+static int flist_compare(const void *lhs, const void *rhs)
+{
+    const can_range_t *a = (const can_range_t*)lhs;
+    const can_range_t *b = (const can_range_t*)rhs;
+
+    return (a->first < b->first) ? -1 : (a->first > b->first) ? 1 : 0;
+}
+
+static uint32_t flist_mask(uint32_t mask, uint32_t ref, uint32_t first, uint32_t last)
+{
+    uint32_t diff = first ^ last;       // bits that change within the range
+
+    // note: all bits below the highest changing bit take any value
+    diff |= diff >> 1; diff |= diff >> 2; diff |= diff >> 4;
+    diff |= diff >> 8; diff |= diff >> 16;
+    return mask & ~diff & ~(first ^ ref);
+}
+
+static int flist_set(int handle, const can_pcan_filter_t *ranges, size_t n)
+{
+    can_filterlist_t *flist = NULL;     // compiled filter list
+    uint32_t std_mask = 0x7FFU, xtd_mask = 0x1FFFFFFFU;  // enclosing filter masks
+    uint32_t std_code = 0U, xtd_code = 0U;  // enclosing filter codes
+    uint32_t num_set = 0U;              // number of 11-bit ranges set
+    uint32_t num_std = 0U, num_xtd = 0U;  // number of ranges per format
+    uint32_t id;                        // identifier
+    size_t i, j;                        // loop variables
+    TPCANStatus sts;                    // represents a status
+
+    assert(IS_HANDLE_VALID(handle));    // just to make sure
+
+    // check the identifier ranges
+    for (i = 0U; i < n; i++) {
+        if (ranges[i].first > ranges[i].last)
+            return CANERR_ILLPARA;
+        if (!ranges[i].xtd && (ranges[i].last > CAN_MAX_STD_ID))
+            return CANERR_ILLPARA;
+        if (ranges[i].xtd && ((ranges[i].last > CAN_MAX_XTD_ID) || can[handle].mode.nxtd))
+            return CANERR_ILLPARA;
+        if (ranges[i].xtd)
+            num_xtd++;
+        else
+            num_std++;
+    }
+    // compile the list: 11-bit bitmap, sorted and merged 29-bit ranges
+    if (n > 0U) {
+        if ((flist = (can_filterlist_t*)calloc(1U, sizeof(can_filterlist_t) +
+                                               (size_t)num_xtd * sizeof(can_range_t))) == NULL)
+            return CANERR_RESOURCE;
+        flist->count = (uint32_t)n;
+        flist->xtd = (can_range_t*)(flist + 1);
+        for (i = 0U; i < n; i++) {
+            if (!ranges[i].xtd) {
+                for (id = ranges[i].first; id <= ranges[i].last; id++)
+                    flist->std[id >> 5] |= (uint32_t)(1UL << (id & 0x1FU));
+                if (!num_set++)
+                    std_code = ranges[i].first;
+                std_mask = flist_mask(std_mask, std_code, ranges[i].first, ranges[i].last);
+            }
+            else {
+                flist->xtd[flist->num_xtd].first = ranges[i].first;
+                flist->xtd[flist->num_xtd].last = ranges[i].last;
+                if (!flist->num_xtd++)
+                    xtd_code = ranges[i].first;
+                xtd_mask = flist_mask(xtd_mask, xtd_code, ranges[i].first, ranges[i].last);
+            }
+        }
+        if (flist->num_xtd > 1U) {
+            qsort(flist->xtd, flist->num_xtd, sizeof(can_range_t), flist_compare);
+            for (i = 0U, j = 1U; j < flist->num_xtd; j++) {
+                if (flist->xtd[j].first <= flist->xtd[i].last + 1U) {
+                    if (flist->xtd[j].last > flist->xtd[i].last)
+                        flist->xtd[i].last = flist->xtd[j].last;
+                }
+                else
+                    flist->xtd[++i] = flist->xtd[j];
+            }
+            flist->num_xtd = (uint32_t)i + 1U;
+        }
+    }
+    // program the tightest enclosing code and mask into the hardware filter
+    // note: there is only one filter for both formats, so a mixed list is
+    //       evaluated in software only (the hardware filter is opened)
+    sts = PCAN_ERROR_OK;
+    if (num_std && !num_xtd)
+        sts = pcan_set_filter(handle, ((uint64_t)(std_code & std_mask) << 32) | (uint64_t)std_mask, FILTER_STD);
+    else if (num_xtd && !num_std)
+        sts = pcan_set_filter(handle, ((uint64_t)(xtd_code & xtd_mask) << 32) | (uint64_t)xtd_mask, FILTER_XTD);
+    else if ((num_std && num_xtd) || (can[handle].flist && can[handle].flist->programmed))
+        sts = pcan_reset_filter(handle);
+    if (sts != PCAN_ERROR_OK) {
+        free(flist);
+        return pcan_error(sts);
+    }
+    if (flist)
+        flist->programmed = (num_std && !num_xtd) || (num_xtd && !num_std);
+    free(can[handle].flist);
+    can[handle].flist = flist;
+    return CANERR_NOERROR;
 }
 
-static TPCANStatus pcan_reset_filter(int handle)
+static void flist_free(int handle)
 {
-    TPCANStatus sts;                    // represents a status
-    uint8_t filter = PCAN_FILTER_OPEN;  // filter mode (accept all)
-
     assert(IS_HANDLE_VALID(handle));    // just to make sure
 
-#if defined(__linux__)
-    UINT64 value = 0x0ull;              // PCAN filter value
+    free(can[handle].flist);
+    can[handle].flist = NULL;
+}
 
-    // note: it seems that the hardware filter is not resetted by 'PCAN_MESSAGE_FILTER' := 'PCAN_FILTER_OPEN'
-    switch (can[handle].filter.mode) {
-        case FILTER_STD:                // 11-bit identifier
-            value = (FILTER_RESET_VALUE ^ FILTER_STD_XOR_MASK);   // SJA100 has inverted masks bits!
-            (void)CAN_SetValue(can[handle].board, PCAN_ACCEPTANCE_FILTER_11BIT, (void*)&value, sizeof(value));
-            break;
-        case FILTER_XTD:                // 29-bit identifier
-            value = (FILTER_RESET_VALUE ^ FILTER_XTD_XOR_MASK);   // SJA100 has inverted masks bits!
-            (void)CAN_SetValue(can[handle].board, PCAN_ACCEPTANCE_FILTER_29BIT, (void*)&value, sizeof(value));
-            break;
-        default:                        // no filtering
-            break;
+/*  - - - - - -  attached channels (snapshot)  - - - - - - - - - - - - - -
+ */
+static int attached_refresh(void)
+{
+#if defined(PCAN_ATTACHED_CHANNELS)
+    TPCANChannelInformation info[ATTACHED_MAX];  // channel information
+    TPCANStatus sts;                    // represents a status
+    DWORD count = 0;                    // number of attached channels
+    DWORD i;                            // loop variable
+
+    attached.valid = 1;                 // don't ask again until invalidated
+    attached.supported = 0;
+    attached.count = 0;
+    // two queries instead of one round trip per channel (condition and features)
+    if ((sts = CAN_GetValue(PCAN_NONEBUS, PCAN_ATTACHED_CHANNELS_COUNT,
+                            (void*)&count, sizeof(count))) != PCAN_ERROR_OK)
+        return pcan_error(sts);
+    if (count > (DWORD)ATTACHED_MAX)
+        return CANERR_RESOURCE;
+    memset(info, 0, sizeof(info));
+    /* note: the whole buffer is passed in case a channel was attached in between */
+    if ((count > 0U) &&
+        (sts = CAN_GetValue(PCAN_NONEBUS, PCAN_ATTACHED_CHANNELS,
+                            (void*)info, sizeof(info))) != PCAN_ERROR_OK)
+        return pcan_error(sts);
+    for (i = 0U; i < count; i++) {
+        if (info[i].channel_handle == PCAN_NONEBUS)
+            continue;                   // detached in between
+        attached.channel[attached.count].channel = (int32_t)info[i].channel_handle;
+        attached.channel[attached.count].device_type = (uint8_t)info[i].device_type;
+        attached.channel[attached.count].controller = (uint8_t)info[i].controller_number;
+        attached.channel[attached.count].features = (uint32_t)info[i].device_features;
+        attached.channel[attached.count].device_id = (uint32_t)info[i].device_id;
+        attached.channel[attached.count].condition = (uint32_t)info[i].channel_condition;
+        attached.count++;
     }
+    attached.supported = 1;
+    return CANERR_NOERROR;
+#else
+    attached.valid = 1;                 // probe each channel instead
+    attached.supported = 0;
+    attached.count = 0;
+    return CANERR_NOTSUPP;
 #endif
-    // reset the filter value to device
-    if ((sts = CAN_SetValue(can[handle].board, (BYTE)PCAN_MESSAGE_FILTER,
-                           (void*)&filter, (DWORD)sizeof(uint8_t))) == PCAN_ERROR_OK) {
-        can[handle].filter.mode = FILTER_OFF;
+}
+
+static const can_pcan_channel_t *attached_lookup(TPCANHandle board)
+{
+    int i;                              // loop variable
+
+    for (i = 0; i < attached.count; i++) {
+        if (attached.channel[i].channel == (int32_t)board)
+            return &attached.channel[i];
     }
-    return sts;
+    return NULL;
+}
+
+static int attached_next(int index)
+{
+    // skip entries of the interface list which are not attached (if known)
+    while ((0 <= index) && (index < NUM_CHANNELS) && (can_boards[index].type != EOF)) {
+        if (!attached.supported || attached_lookup((TPCANHandle)can_boards[index].type))
+            break;
+        index++;
+    }
+    return index;
 }
 
 /*  - - - - - -  CAN API V3 properties  - - - - - - - - - - - - - - - - -
@@ -1416,7 +4925,9 @@ static int lib_parameter(uint16_t param, void *value, size_t nbyte)
     if (value == NULL) {                // check for null-pointer
         if ((param != CANPROP_SET_FIRST_CHANNEL) &&
             (param != CANPROP_SET_NEXT_CHANNEL) &&
-            (param != CANPROP_SET_FILTER_RESET))
+            (param != CANPROP_SET_FILTER_RESET) &&
+            (param != PCANPROP_SET_FILTER_LIST) &&
+            (param != PCANPROP_SET_REFRESH_CHANNELS))
             return CANERR_NULLPTR;
     }
     // query or modify a CAN library property
@@ -1481,13 +4992,14 @@ static int lib_parameter(uint16_t param, void *value, size_t nbyte)
         }
         break;
     case CANPROP_SET_FIRST_CHANNEL:     // set index to the first entry in the interface list (NULL)
-        idx_board = 0;
+        (void)attached_refresh();       // note: new snapshot of attached channels
+        idx_board = attached_next(0);
         rc = (can_boards[idx_board].type != EOF) ? CANERR_NOERROR : CANERR_RESOURCE;
         break;
     case CANPROP_SET_NEXT_CHANNEL:      // set index to the next entry in the interface list (NULL)
         if ((0 <= idx_board) && (idx_board < NUM_CHANNELS)) {
             if (can_boards[idx_board].type != EOF)
-                idx_board++;
+                idx_board = attached_next(idx_board + 1);
             rc = (can_boards[idx_board].type != EOF) ? CANERR_NOERROR : CANERR_RESOURCE;
         }
         else
@@ -1551,6 +5063,45 @@ static int lib_parameter(uint16_t param, void *value, size_t nbyte)
                 rc = CANERR_RESOURCE;
         }
         break;
+    case PCANPROP_GET_MAX_HANDLES:      // maximum number of open handles (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            *(uint32_t*)value = (uint32_t)max_handles;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_SET_MAX_HANDLES:      // set maximum number of open handles (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            if ((0U < *(uint32_t*)value) && (*(uint32_t*)value <= CAN_LIMIT_HANDLES)) {
+                if (all_closed()) {
+                    // note: the handle table is reallocated by the next can_init
+                    max_handles = (int)*(uint32_t*)value;
+                    init = 0;
+                    rc = CANERR_NOERROR;
+                }
+                else
+                    rc = CANERR_YETINIT;
+            }
+            else
+                rc = CANERR_ILLPARA;
+        }
+        break;
+    case PCANPROP_SET_REFRESH_CHANNELS: // take a new snapshot of the attached channels (NULL)
+        rc = attached_refresh();
+        break;
+    case PCANPROP_GET_CHANNEL_INFO:     // get snapshot data at actual index in the interface list (can_pcan_channel_t)
+        if (nbyte >= sizeof(can_pcan_channel_t)) {
+            if (!attached.supported)
+                rc = CANERR_NOTSUPP;
+            else if ((0 <= idx_board) && (idx_board < NUM_CHANNELS) &&
+                     (can_boards[idx_board].type != EOF) &&
+                     (attached_lookup((TPCANHandle)can_boards[idx_board].type) != NULL)) {
+                memcpy(value, attached_lookup((TPCANHandle)can_boards[idx_board].type), sizeof(can_pcan_channel_t));
+                rc = CANERR_NOERROR;
+            }
+            else
+                rc = CANERR_RESOURCE;
+        }
+        break;
     case CANPROP_GET_DEVICE_TYPE:       // device type of the CAN interface (int32_t)
     case CANPROP_GET_DEVICE_NAME:       // device name of the CAN interface (char[])
     case CANPROP_GET_OP_CAPABILITY:     // supported operation modes of the CAN controller (uint8_t)
@@ -1568,11 +5119,46 @@ static int lib_parameter(uint16_t param, void *value, size_t nbyte)
     case CANPROP_GET_RCV_QUEUE_SIZE:    // maximum number of message the receive queue can hold (uint32_t)
     case CANPROP_GET_RCV_QUEUE_HIGH:    // maximum number of message the receive queue has hold (uint32_t)
     case CANPROP_GET_RCV_QUEUE_OVFL:    // overflow counter of the receive queue (uint64_t)
+    case CANPROP_GET_TRM_QUEUE_SIZE:    // maximum number of message the transmit queue can hold (uint32_t)
+    case CANPROP_GET_TRM_QUEUE_HIGH:    // maximum number of message the transmit queue has hold (uint32_t)
+    case CANPROP_GET_TRM_QUEUE_OVFL:    // overflow counter of the transmit queue (uint64_t)
     case CANPROP_GET_FILTER_11BIT:      // acceptance filter code and mask for 11-bit identifier (uint64_t)
     case CANPROP_GET_FILTER_29BIT:      // acceptance filter code and mask for 29-bit identifier (uint64_t)
     case CANPROP_SET_FILTER_11BIT:      // set value for acceptance filter code and mask for 11-bit identifier (uint64_t)
     case CANPROP_SET_FILTER_29BIT:      // set value for acceptance filter code and mask for 29-bit identifier (uint64_t)
     case CANPROP_SET_FILTER_RESET:      // reset acceptance filter code and mask to default values (NULL)
+    case PCANPROP_GET_TX_WAIT_TIME:     // total time writes waited for the transmit queue in [usec] (uint64_t)
+    case PCANPROP_GET_TX_WAIT_MAX:      // longest time a write waited for the transmit queue in [usec] (uint32_t)
+    case PCANPROP_GET_TX_WAIT_COUNT:    // number of writes that had to wait for the transmit queue (uint64_t)
+    case PCANPROP_SET_RCV_QUEUE_SIZE:   // set size of the software receive queue, if stopped (uint32_t)
+    case PCANPROP_SET_FILTER_LIST:      // set software acceptance filter list, if stopped (can_pcan_filter_t[])
+    case PCANPROP_GET_FILTER_COUNT:     // number of identifier ranges in the acceptance filter list (uint32_t)
+    case PCANPROP_SET_TX_ECHO:          // receive echo frames of transmitted messages, if stopped (uint8_t)
+    case PCANPROP_GET_TX_LATENCY:       // write-to-bus latency statistics (can_pcan_latency_t)
+    case PCANPROP_GET_TX_LATENCY_HIST:  // write-to-bus latency histogram (uint64_t[PCAN_LATENCY_BINS])
+    case PCANPROP_GET_RESTART_FULL:     // number of restarts with reinitialization of the controller (uint64_t)
+    case PCANPROP_GET_RESTART_FAST:     // number of restarts by resuming the controller (uint64_t)
+    case PCANPROP_GET_SNAPSHOT:         // status, counters, bit-rate and filters in one call (can_pcan_snapshot_t)
+    case PCANPROP_SET_TIME_MODE:        // time base of the time-stamps, if stopped (uint8_t)
+    case PCANPROP_GET_TIME_SKEW:        // skew of the device clock to the host clock in [ppb] (int32_t)
+    case PCANPROP_GET_TIME_JITTER:      // residual jitter of the host clock mapping in [nsec] (uint32_t)
+    case PCANPROP_SET_TRM_QUEUE_SIZE:   // set size of the software transmit queue, if stopped (uint32_t)
+    case PCANPROP_GET_TRM_QUEUE_LATENCY:  // queuing latency per priority class (can_pcan_queuing_t[])
+    case PCANPROP_GET_TRM_QUEUE_DROPPED:  // number of queued messages dropped on a write error (uint64_t)
+    case CANPROP_GET_TRACE_ACTIVE:      // trace file activation state: STOPPED/RUNNING (uint8_t)
+    case CANPROP_GET_TRACE_FOLDER:      // trace file folder location (directory only) (char[])
+    case CANPROP_GET_TRACE_TYPE:        // trace file type (for possible values see below) (uint8_t)
+    case CANPROP_GET_TRACE_MODE:        // trace file mode (for possible options see below) (uint16_t)
+    case CANPROP_GET_TRACE_SIZE:        // trace file segment size (in 10 KB steps, 0 = 100MB) (uint16_t)
+    case CANPROP_GET_TRACE_FILE:        // trace file name: directory + basename + extension (char[])
+    case CANPROP_SET_TRACE_ACTIVE:      // start/stop trace file logging with configured settings (uint8_t)
+    case CANPROP_SET_TRACE_FOLDER:      // set trace file folder location (directory only) (char[])
+    case CANPROP_SET_TRACE_TYPE:        // set trace file type (for possible values see below) (uint8_t)
+    case CANPROP_SET_TRACE_MODE:        // set trace file mode (for possible options see below) (uint16_t)
+    case CANPROP_SET_TRACE_SIZE:        // set trace file segment size (in 10 KB steps, 0 = 100MB) (uint16_t)
+    case PCANPROP_GET_TRACE_DROPPED:    // number of messages not traced (capture ring full) (uint64_t)
+    case PCANPROP_GET_TRACE_CODEC:      // block compression of a compact trace file (uint8_t)
+    case PCANPROP_SET_TRACE_CODEC:      // set block compression of a compact trace file (uint8_t)
         // note: a device parameter requires a valid handle.
         if (!init)
             rc = CANERR_NOTINIT;
@@ -1613,13 +5199,17 @@ static int drv_parameter(int handle, uint16_t param, void *value, size_t nbyte)
     uint8_t load = 0u;                  // bus load
     char str[MAX_LENGTH_HARDWARE_NAME+1];  // device name
     TPCANStatus sts;                    // represents a status
+    int bin;                            // histogram bin
+    int i;                              // priority class
 
     assert(IS_HANDLE_VALID(handle));    // just to make sure
 
     if (value == NULL) {                // check for null-pointer
         if ((param != CANPROP_SET_FIRST_CHANNEL) &&
             (param != CANPROP_SET_NEXT_CHANNEL) &&
-            (param != CANPROP_SET_FILTER_RESET))
+            (param != CANPROP_SET_FILTER_RESET) &&
+            (param != PCANPROP_SET_FILTER_LIST) &&
+            (param != PCANPROP_SET_REFRESH_CHANNELS))
             return CANERR_NULLPTR;
     }
     // query or modify a CAN interface property
@@ -1707,7 +5297,8 @@ static int drv_parameter(int handle, uint16_t param, void *value, size_t nbyte)
         if (nbyte >= sizeof(uint8_t)) {
             if (((rc = can_busload(handle, &load, NULL)) == CANERR_NOERROR) || (rc == CANERR_OFFLINE)) {
                 if (nbyte > sizeof(uint8_t))
-                    *(uint16_t*)value = (uint16_t)load * 100u;  // 0..10000 ==> 0.00%..100.00%
+                    *(uint16_t*)value = !can[handle].status.can_stopped ?
+                                        busload_get(handle) : 0u;  // 0..10000 ==> 0.00%..100.00%
                 else
                     *(uint8_t*)value = (uint8_t)load;           // 0..100% (note: legacy resolution)
                 rc = CANERR_NOERROR;
@@ -1733,27 +5324,164 @@ static int drv_parameter(int handle, uint16_t param, void *value, size_t nbyte)
         break;
     case CANPROP_GET_TX_COUNTER:        // total number of sent messages (uint64_t)
         if (nbyte >= sizeof(uint64_t)) {
-            *(uint64_t*)value = (uint64_t)can[handle].counters.tx;
+            *(uint64_t*)value = port_atomic_load64(&can[handle].counters.tx);
             rc = CANERR_NOERROR;
         }
         break;
     case CANPROP_GET_RX_COUNTER:        // total number of reveiced messages (uint64_t)
         if (nbyte >= sizeof(uint64_t)) {
-            *(uint64_t*)value = (uint64_t)can[handle].counters.rx;
+            *(uint64_t*)value = port_atomic_load64(&can[handle].counters.rx);
             rc = CANERR_NOERROR;
         }
         break;
     case CANPROP_GET_ERR_COUNTER:       // total number of reveiced error frames (uint64_t)
         if (nbyte >= sizeof(uint64_t)) {
-            *(uint64_t*)value = (uint64_t)can[handle].counters.err;
+            *(uint64_t*)value = port_atomic_load64(&can[handle].counters.err);
             rc = CANERR_NOERROR;
         }
         break;
     case CANPROP_GET_RCV_QUEUE_SIZE:    // maximum number of message the receive queue can hold (uint32_t)
+        // note: cannot be determined for the PCAN receive queue
+        if (!can[handle].rcvq_size)
+            rc = CANERR_NOTSUPP;
+        else if (nbyte >= sizeof(uint32_t)) {
+            *(uint32_t*)value = (uint32_t)can[handle].rcvq_size;
+            rc = CANERR_NOERROR;
+        }
+        break;
     case CANPROP_GET_RCV_QUEUE_HIGH:    // maximum number of message the receive queue has hold (uint32_t)
+        // note: cannot be determined for the PCAN receive queue
+        if (!can[handle].rcvq_size)
+            rc = CANERR_NOTSUPP;
+        else if (nbyte >= sizeof(uint32_t)) {
+            *(uint32_t*)value = (can[handle].rcvq != NULL) ? port_atomic_load32(&can[handle].rcvq->put.high) : 0u;
+            rc = CANERR_NOERROR;
+        }
+        break;
     case CANPROP_GET_RCV_QUEUE_OVFL:    // overflow counter of the receive queue (uint64_t)
-        // note: cannot be determined
-        rc = CANERR_NOTSUPP;
+        // note: cannot be determined for the PCAN receive queue
+        if (!can[handle].rcvq_size)
+            rc = CANERR_NOTSUPP;
+        else if (nbyte >= sizeof(uint64_t)) {
+            *(uint64_t*)value = (can[handle].rcvq != NULL) ? port_atomic_load64(&can[handle].rcvq->put.ovfl) : 0ull;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_SET_RCV_QUEUE_SIZE:   // set size of the software receive queue, if stopped (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            if (!can[handle].status.can_stopped)
+                rc = CANERR_ONLINE;
+            else if (*(uint32_t*)value > RCVQ_MAX_SIZE)
+                rc = CANERR_ILLPARA;
+            else {
+                // note: the size is rounded up to a power of two
+                can[handle].rcvq_size = 0u;
+                if (*(uint32_t*)value > 0u)
+                    for (can[handle].rcvq_size = 1u; can[handle].rcvq_size < *(uint32_t*)value; can[handle].rcvq_size <<= 1)
+                        ;
+                rc = CANERR_NOERROR;
+            }
+        }
+        break;
+    case CANPROP_GET_TRM_QUEUE_SIZE:    // maximum number of message the transmit queue can hold (uint32_t)
+        // note: cannot be determined for the PCAN transmit queue
+        if (!can[handle].trmq_size)
+            rc = CANERR_NOTSUPP;
+        else if (nbyte >= sizeof(uint32_t)) {
+            *(uint32_t*)value = (uint32_t)can[handle].trmq_size;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case CANPROP_GET_TRM_QUEUE_HIGH:    // maximum number of message the transmit queue has hold (uint32_t)
+        // note: cannot be determined for the PCAN transmit queue
+        if (!can[handle].trmq_size)
+            rc = CANERR_NOTSUPP;
+        else if (nbyte >= sizeof(uint32_t)) {
+            *(uint32_t*)value = 0u;
+            if (can[handle].trmq != NULL) {
+                port_mutex_lock(&can[handle].trmq->lock);
+                *(uint32_t*)value = can[handle].trmq->high;
+                port_mutex_unlock(&can[handle].trmq->lock);
+            }
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case CANPROP_GET_TRM_QUEUE_OVFL:    // overflow counter of the transmit queue (uint64_t)
+        // note: cannot be determined for the PCAN transmit queue
+        if (!can[handle].trmq_size)
+            rc = CANERR_NOTSUPP;
+        else if (nbyte >= sizeof(uint64_t)) {
+            *(uint64_t*)value = 0ull;
+            if (can[handle].trmq != NULL) {
+                port_mutex_lock(&can[handle].trmq->lock);
+                *(uint64_t*)value = can[handle].trmq->ovfl;
+                port_mutex_unlock(&can[handle].trmq->lock);
+            }
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_SET_TRM_QUEUE_SIZE:   // set size of the software transmit queue, if stopped (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            if (!can[handle].status.can_stopped)
+                rc = CANERR_ONLINE;
+            else if (*(uint32_t*)value > TRMQ_MAX_SIZE)
+                rc = CANERR_ILLPARA;
+            else {
+                // note: the transmit queue is (re-)allocated by the next can_start
+                can[handle].trmq_size = *(uint32_t*)value;
+                rc = CANERR_NOERROR;
+            }
+        }
+        break;
+    case PCANPROP_GET_TRM_QUEUE_LATENCY:  // queuing latency per priority class (can_pcan_queuing_t[])
+        if (!can[handle].trmq_size)
+            rc = CANERR_NOTSUPP;
+        else if (nbyte >= (PCAN_TRMQ_CLASSES * sizeof(can_pcan_queuing_t))) {
+            can_pcan_queuing_t *queuing = (can_pcan_queuing_t*)value;
+            memset(queuing, 0, PCAN_TRMQ_CLASSES * sizeof(can_pcan_queuing_t));
+            if (can[handle].trmq != NULL) {
+                port_mutex_lock(&can[handle].trmq->lock);
+                for (i = 0; i < PCAN_TRMQ_CLASSES; i++) {
+                    queuing[i].count = can[handle].trmq->stats[i].count;
+                    queuing[i].min = can[handle].trmq->stats[i].min;
+                    queuing[i].max = can[handle].trmq->stats[i].max;
+                    queuing[i].avg = queuing[i].count ? (uint32_t)(can[handle].trmq->stats[i].sum / queuing[i].count) : 0U;
+                }
+                port_mutex_unlock(&can[handle].trmq->lock);
+            }
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_TRM_QUEUE_DROPPED:  // number of queued messages dropped on a write error (uint64_t)
+        if (!can[handle].trmq_size)
+            rc = CANERR_NOTSUPP;
+        else if (nbyte >= sizeof(uint64_t)) {
+            *(uint64_t*)value = 0ull;
+            if (can[handle].trmq != NULL) {
+                port_mutex_lock(&can[handle].trmq->lock);
+                *(uint64_t*)value = can[handle].trmq->dropped;
+                port_mutex_unlock(&can[handle].trmq->lock);
+            }
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_TX_WAIT_TIME:     // total time writes waited for the transmit queue in [usec] (uint64_t)
+        if (nbyte >= sizeof(uint64_t)) {
+            *(uint64_t*)value = port_atomic_load64(&can[handle].tx_wait.time);
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_TX_WAIT_MAX:      // longest time a write waited for the transmit queue in [usec] (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            *(uint32_t*)value = port_atomic_load32(&can[handle].tx_wait.max);
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_TX_WAIT_COUNT:    // number of writes that had to wait for the transmit queue (uint64_t)
+        if (nbyte >= sizeof(uint64_t)) {
+            *(uint64_t*)value = port_atomic_load64(&can[handle].tx_wait.count);
+            rc = CANERR_NOERROR;
+        }
         break;
     case CANPROP_GET_FILTER_11BIT:      // acceptance filter code and mask for 11-bit identifier (uint64_t)
         if (nbyte >= sizeof(uint64_t)) {
@@ -1811,14 +5539,256 @@ static int drv_parameter(int handle, uint16_t param, void *value, size_t nbyte)
     case CANPROP_SET_FILTER_RESET:      // reset acceptance filter code and mask to default values (NULL)
         if (can[handle].status.can_stopped) {
             // note: reset filter only if the CAN controller is in INIT mode
-            if ((sts = pcan_reset_filter(handle)) == PCAN_ERROR_OK)
+            if ((sts = pcan_reset_filter(handle)) == PCAN_ERROR_OK) {
+                flist_free(handle);     // note: the filter list too
                 rc = CANERR_NOERROR;
+            }
             else
                 rc = pcan_error(sts);
         }
         else
             rc = CANERR_ONLINE;
         break;
+    case PCANPROP_SET_FILTER_LIST:      // set software acceptance filter list, if stopped (can_pcan_filter_t[])
+        if ((value == NULL) || (nbyte == 0U)) {
+            if (can[handle].status.can_stopped)
+                rc = flist_set(handle, NULL, 0U);
+            else
+                rc = CANERR_ONLINE;
+        }
+        else if (!(nbyte % sizeof(can_pcan_filter_t))) {
+            // note: the list is compiled and programmed only if the CAN controller is in INIT mode
+            if (can[handle].status.can_stopped)
+                rc = flist_set(handle, (const can_pcan_filter_t*)value, nbyte / sizeof(can_pcan_filter_t));
+            else
+                rc = CANERR_ONLINE;
+        }
+        break;
+    case PCANPROP_GET_FILTER_COUNT:     // number of identifier ranges in the acceptance filter list (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            *(uint32_t*)value = (can[handle].flist != NULL) ? can[handle].flist->count : 0U;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_SET_TX_ECHO:          // receive echo frames of transmitted messages, if stopped (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            if (!can[handle].status.can_stopped)
+                rc = CANERR_ONLINE;
+            else if (*(uint8_t*)value && (can[handle].echo == NULL)) {
+                // note: echo frames are enabled by the next can_start
+                if ((can[handle].echo = (can_echo_t*)port_aligned_alloc(sizeof(can_echo_t))) != NULL)
+                    rc = CANERR_NOERROR;
+                else
+                    rc = CANERR_RESOURCE;
+            }
+            else if (!*(uint8_t*)value && (can[handle].echo != NULL)) {
+                // note: echo frames are turned off by the next can_start (re-initialization)
+                port_aligned_free(can[handle].echo);
+                can[handle].echo = NULL;
+                rc = CANERR_NOERROR;
+            }
+            else
+                rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_TX_LATENCY:       // write-to-bus latency statistics (can_pcan_latency_t)
+        if (can[handle].echo == NULL)
+            rc = CANERR_NOTSUPP;
+        else if (nbyte >= sizeof(can_pcan_latency_t)) {
+            can_pcan_latency_t *latency = (can_pcan_latency_t*)value;
+            latency->count = port_atomic_load64(&can[handle].echo->count);
+            latency->unmatched = port_atomic_load64(&can[handle].echo->unmatched);
+            latency->min = port_atomic_load32(&can[handle].echo->min);
+            latency->max = port_atomic_load32(&can[handle].echo->max);
+            latency->avg = latency->count ? (uint32_t)(port_atomic_load64(&can[handle].echo->sum) / latency->count) : 0U;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_TX_LATENCY_HIST:  // write-to-bus latency histogram (uint64_t[PCAN_LATENCY_BINS])
+        if (can[handle].echo == NULL)
+            rc = CANERR_NOTSUPP;
+        else if (nbyte >= (PCAN_LATENCY_BINS * sizeof(uint64_t))) {
+            for (bin = 0; bin < PCAN_LATENCY_BINS; bin++)
+                ((uint64_t*)value)[bin] = port_atomic_load64(&can[handle].echo->histogram[bin]);
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_RESTART_FULL:     // number of restarts with reinitialization of the controller (uint64_t)
+        if (nbyte >= sizeof(uint64_t)) {
+            *(uint64_t*)value = can[handle].restarts.full;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_RESTART_FAST:     // number of restarts by resuming the controller (uint64_t)
+        if (nbyte >= sizeof(uint64_t)) {
+            *(uint64_t*)value = can[handle].restarts.fast;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_SNAPSHOT:         // status, counters, bit-rate and filters in one call (can_pcan_snapshot_t)
+        if (nbyte >= sizeof(can_pcan_snapshot_t))
+            rc = pcan_snapshot(handle, (can_pcan_snapshot_t*)value);
+        break;
+    case PCANPROP_SET_TIME_MODE:        // time base of the time-stamps, if stopped (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            if (!can[handle].status.can_stopped)
+                rc = CANERR_ONLINE;
+            else if (*(uint8_t*)value > PCAN_TIME_REALTIME)
+                rc = CANERR_ILLPARA;
+            else {
+                // note: the mapping is restarted by the next can_start
+                can[handle].timemap.mode = *(uint8_t*)value;
+                rc = CANERR_NOERROR;
+            }
+        }
+        break;
+    case PCANPROP_GET_TIME_SKEW:        // skew of the device clock to the host clock in [ppb] (int32_t)
+        if (nbyte >= sizeof(int32_t)) {
+            *(int32_t*)value = (int32_t)port_atomic_load32(&can[handle].timemap.skew);
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_TIME_JITTER:      // residual jitter of the host clock mapping in [nsec] (uint32_t)
+        if (nbyte >= sizeof(uint32_t)) {
+            *(uint32_t*)value = port_atomic_load32(&can[handle].timemap.jitter);
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case CANPROP_GET_TRACE_ACTIVE:      // trace file activation state: STOPPED/RUNNING (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            *(uint8_t*)value = (TRACE_ACTIVE(handle) || can[handle].trace_vendor) ? CANPARA_TRACE_ON : CANPARA_TRACE_OFF;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case CANPROP_GET_TRACE_FOLDER:      // trace file folder location (directory only) (char[])
+        if (nbyte >= 1u) {
+            strncpy((char*)value, can[handle].trace_conf.folder, nbyte);
+            ((char*)value)[(nbyte - 1)] = '\0';
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case CANPROP_GET_TRACE_TYPE:        // trace file type (for possible values see below) (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            *(uint8_t*)value = can[handle].trace_conf.type;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case CANPROP_GET_TRACE_MODE:        // trace file mode (for possible options see below) (uint16_t)
+        if (nbyte >= sizeof(uint16_t)) {
+            *(uint16_t*)value = can[handle].trace_conf.mode;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case CANPROP_GET_TRACE_SIZE:        // trace file segment size (in 10 KB steps, 0 = 100MB) (uint16_t)
+        if (nbyte >= sizeof(uint16_t)) {
+            *(uint16_t*)value = can[handle].trace_conf.size;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case CANPROP_GET_TRACE_FILE:        // trace file name: directory + basename + extension (char[])
+        if (can[handle].trace_vendor)
+            rc = CANERR_NOTSUPP;        //   note: the file name is not known
+        else if (!TRACE_ACTIVE(handle))
+            rc = CANERR_RESOURCE;       //   no trace session
+        else if (nbyte >= 1u) {
+            // note: the writer thread changes the file name with a new segment
+            port_mutex_lock(&can[handle].trace->lock);
+            strncpy((char*)value, can[handle].trace->file, nbyte);
+            port_mutex_unlock(&can[handle].trace->lock);
+            ((char*)value)[(nbyte - 1)] = '\0';
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case CANPROP_SET_TRACE_ACTIVE:      // start/stop trace file logging with configured settings (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            if (*(uint8_t*)value != CANPARA_TRACE_OFF) {
+                if (TRACE_ACTIVE(handle) || can[handle].trace_vendor)
+                    rc = CANERR_RESOURCE;  //   already started
+                else if (can[handle].trace_conf.type == CANPARA_TRACE_TYPE_VENDOR)
+                    rc = trace_vendor(handle, 1);
+                else
+                    rc = trace_start(handle);
+            }
+            else {
+                if (can[handle].trace_vendor)
+                    rc = trace_vendor(handle, 0);
+                else {
+                    trace_stop(handle);
+                    rc = CANERR_NOERROR;
+                }
+            }
+        }
+        break;
+    case CANPROP_SET_TRACE_FOLDER:      // set trace file folder location (directory only) (char[])
+        /* note: the trace settings are taken by the next trace session */
+        if (nbyte >= 1u) {
+            if (nbyte > CANPROP_MAX_STRING_LENGTH)
+                nbyte = CANPROP_MAX_STRING_LENGTH;
+            strncpy(can[handle].trace_conf.folder, (const char*)value, nbyte);
+            can[handle].trace_conf.folder[nbyte] = '\0';
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case CANPROP_SET_TRACE_TYPE:        // set trace file type (for possible values see below) (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            switch (*(uint8_t*)value) {
+            case CANPARA_TRACE_TYPE_BINARY:
+            case CANPARA_TRACE_TYPE_LOGGER:
+            case CANPARA_TRACE_TYPE_VENDOR:
+                can[handle].trace_conf.type = *(uint8_t*)value;
+                rc = CANERR_NOERROR;
+                break;
+            default:
+                rc = CANERR_ILLPARA;
+                break;
+            }
+        }
+        break;
+    case CANPROP_SET_TRACE_MODE:        // set trace file mode (for possible options see below) (uint16_t)
+        if (nbyte >= sizeof(uint16_t)) {
+            /* note: appending to a trace file is not supported, the mode is always OVERWRITE;
+             *       a binary trace file is compressed by a compact record format */
+            if ((*(uint16_t*)value & ~(TRACE_MODE_OPTIONS | CANPARA_TRACE_MODE_COMPRESSED)) != 0U)
+                rc = CANERR_ILLPARA;
+            else {
+                can[handle].trace_conf.mode = *(uint16_t*)value | CANPARA_TRACE_MODE_OVERWRITE;
+                rc = CANERR_NOERROR;
+            }
+        }
+        break;
+    case CANPROP_SET_TRACE_SIZE:        // set trace file segment size (in 10 KB steps, 0 = 100MB) (uint16_t)
+        if (nbyte >= sizeof(uint16_t)) {
+            if (*(uint16_t*)value > CANPARA_TRACE_SIZE_LIMIT)
+                rc = CANERR_ILLPARA;
+            else {
+                can[handle].trace_conf.size = *(uint16_t*)value ? *(uint16_t*)value : CANPARA_TRACE_SIZE_DEFAULT;
+                rc = CANERR_NOERROR;
+            }
+        }
+        break;
+    case PCANPROP_GET_TRACE_DROPPED:    // number of messages not traced (capture ring full) (uint64_t)
+        if (nbyte >= sizeof(uint64_t)) {
+            *(uint64_t*)value = (can[handle].trace != NULL) ? port_atomic_load64(&can[handle].trace->put.dropped) : 0ull;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_GET_TRACE_CODEC:      // block compression of a compact trace file (uint8_t)
+        if (nbyte >= sizeof(uint8_t)) {
+            *(uint8_t*)value = can[handle].trace_conf.codec;
+            rc = CANERR_NOERROR;
+        }
+        break;
+    case PCANPROP_SET_TRACE_CODEC:      // set block compression of a compact trace file (uint8_t)
+        /* note: the codec is taken by the next trace session (type BINARY, mode COMPRESSED) */
+        if (nbyte >= sizeof(uint8_t)) {
+            if ((*(uint8_t*)value != PCAN_TRACE_CODEC_NONE) && (*(uint8_t*)value != PCAN_TRACE_CODEC_LZ4))
+                rc = CANERR_ILLPARA;
+            else {
+                can[handle].trace_conf.codec = *(uint8_t*)value;
+                rc = CANERR_NOERROR;
+            }
+        }
+        break;
     default:
         if ((CANPROP_GET_VENDOR_PROP <= param) &&  // get a vendor-specific property value (void*)
            (param < (CANPROP_GET_VENDOR_PROP + CANPROP_VENDOR_PROP_RANGE))) {
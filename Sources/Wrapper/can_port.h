@@ -0,0 +1,397 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (for PEAK-System PCAN Interfaces)
+ *
+ *  Copyright (c) 2005-2012 Uwe Vogt, UV Software, Friedrichshafen
+ *  Copyright (c) 2013-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of PCANBasic-Wrapper.
+ *
+ *  PCANBasic-Wrapper is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v2.0 (or any later version). You can
+ *  choose between one of them if you use PCANBasic-Wrapper in whole or in part.
+ *
+ *  (1) BSD 2-Clause "Simplified" License
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  PCANBasic-Wrapper IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF PCANBasic-Wrapper, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  (2) GNU General Public License v2.0 or later
+ *
+ *  PCANBasic-Wrapper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PCANBasic-Wrapper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with PCANBasic-Wrapper; if not, see <https://www.gnu.org/licenses/>.
+ */
+/** @addtogroup  can_api
+ *  @{
+ */
+#ifndef CAN_PORT_H_INCLUDED
+#define CAN_PORT_H_INCLUDED
+
+/*  -----------  includes  ------------------------------------------------
+ */
+
+#include <stdint.h>                     /* C99 header for sized integer types */
+#include <stddef.h>                     /* C99 header for size_t */
+#include <stdlib.h>                     /* C99 header for memory allocation */
+#include <string.h>                     /* C99 header for memset */
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <windows.h>
+#include <malloc.h>
+#else
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#endif
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+/* note: Microsoft C does not know 'inline' in C mode */
+#if defined(_MSC_VER) && !defined(__cplusplus)
+#define PORT_INLINE  static __inline
+#else
+#define PORT_INLINE  static inline
+#endif
+/* note: usage 'typedef struct PORT_ALIGNED { ... } type_t;' */
+#define PORT_CACHELINE  64
+#if defined(_MSC_VER)
+#define PORT_ALIGNED  __declspec(align(PORT_CACHELINE))
+#else
+#define PORT_ALIGNED  __attribute__((aligned(PORT_CACHELINE)))
+#endif
+/* note: usage 'static PORT_THREAD(name, arg) { ...; return PORT_THREAD_EXIT; }' */
+#if defined(_WIN32) || defined(_WIN64)
+#define PORT_THREAD(name,arg)  DWORD WINAPI name(LPVOID arg)
+#define PORT_THREAD_EXIT  0
+#else
+#define PORT_THREAD(name,arg)  void *name(void *arg)
+#define PORT_THREAD_EXIT  NULL
+#endif
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+#if defined(_WIN32) || defined(_WIN64)
+typedef HANDLE port_thread_t;
+typedef DWORD (WINAPI *port_thread_func_t)(LPVOID);
+typedef CRITICAL_SECTION port_mutex_t;
+#else
+typedef pthread_t port_thread_t;
+typedef void *(*port_thread_func_t)(void *);
+typedef pthread_mutex_t port_mutex_t;
+#endif
+
+
+/*  -----------  functions  ----------------------------------------------
+ */
+
+/*  monotonic clock in [usec] (not related to the wall-clock time)
+ */
+PORT_INLINE uint64_t port_clock_usec(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+
+    if (frequency.QuadPart == 0)
+        (void)QueryPerformanceFrequency(&frequency);
+    (void)QueryPerformanceCounter(&counter);
+    return (uint64_t)((counter.QuadPart / frequency.QuadPart) * 1000000LL)
+         + (uint64_t)(((counter.QuadPart % frequency.QuadPart) * 1000000LL) / frequency.QuadPart);
+#else
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000ULL) + ((uint64_t)now.tv_nsec / 1000ULL);
+#endif
+}
+
+/*  wall-clock time in [usec] since 1970-01-01 (UTC)
+ */
+PORT_INLINE uint64_t port_clock_real_usec(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    FILETIME now;                       /* 100 nsec since 1601-01-01 (Windows 8 or later) */
+
+    GetSystemTimePreciseAsFileTime(&now);
+    return ((((uint64_t)now.dwHighDateTime << 32) | (uint64_t)now.dwLowDateTime)
+         - 116444736000000000ULL) / 10ULL;
+#else
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_REALTIME, &now);
+    return ((uint64_t)now.tv_sec * 1000000ULL) + ((uint64_t)now.tv_nsec / 1000ULL);
+#endif
+}
+
+/*  suspend the calling thread for (at least) the given time in [usec]
+ */
+PORT_INLINE void port_sleep_usec(uint32_t usec)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    /* note: Windows sleeps in [msec] (and with a coarse resolution) */
+    Sleep((DWORD)((usec + 999U) / 1000U));
+#else
+    struct timespec delay;
+
+    delay.tv_sec = (time_t)(usec / 1000000U);
+    delay.tv_nsec = (long)(usec % 1000000U) * 1000L;
+    while ((nanosleep(&delay, &delay) < 0) && (errno == EINTR))
+        ;
+#endif
+}
+
+/*  allocate a zero-initialized memory block aligned to a cache line
+ */
+PORT_INLINE void *port_aligned_alloc(size_t size)
+{
+    void *ptr = NULL;
+
+#if defined(_WIN32) || defined(_WIN64)
+    ptr = _aligned_malloc(size, PORT_CACHELINE);
+#else
+    if (posix_memalign(&ptr, PORT_CACHELINE, size) != 0)
+        ptr = NULL;
+#endif
+    if (ptr != NULL)
+        memset(ptr, 0, size);
+    return ptr;
+}
+
+/*  release a memory block allocated by port_aligned_alloc
+ */
+PORT_INLINE void port_aligned_free(void *ptr)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+/*  create a thread (returns 0 on success or a system error code)
+ */
+PORT_INLINE int port_thread_create(port_thread_t *thread, port_thread_func_t func, void *arg)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    if ((*thread = CreateThread(NULL, 0, func, arg, 0, NULL)) == NULL)
+        return (int)GetLastError();
+    return 0;
+#else
+    return pthread_create(thread, NULL, func, arg);
+#endif
+}
+
+/*  wait for the termination of a thread and release it
+ */
+PORT_INLINE void port_thread_join(port_thread_t thread)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)WaitForSingleObject(thread, INFINITE);
+    (void)CloseHandle(thread);
+#else
+    (void)pthread_join(thread, NULL);
+#endif
+}
+
+/*  mutual exclusion (not recursive)
+ */
+PORT_INLINE int port_mutex_init(port_mutex_t *mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    InitializeCriticalSection(mutex);
+    return 0;
+#else
+    return pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+PORT_INLINE void port_mutex_destroy(port_mutex_t *mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    DeleteCriticalSection(mutex);
+#else
+    (void)pthread_mutex_destroy(mutex);
+#endif
+}
+
+PORT_INLINE void port_mutex_lock(port_mutex_t *mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    EnterCriticalSection(mutex);
+#else
+    (void)pthread_mutex_lock(mutex);
+#endif
+}
+
+PORT_INLINE void port_mutex_unlock(port_mutex_t *mutex)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    LeaveCriticalSection(mutex);
+#else
+    (void)pthread_mutex_unlock(mutex);
+#endif
+}
+
+/*  atomic operations (sequentially consistent)
+ *
+ *  note: status bits and counters of a channel are updated by the reception
+ *        and the transmission path concurrently (e.g. one RX thread and one
+ *        or more TX threads per handle), so a plain read-modify-write would
+ *        lose updates.
+ */
+PORT_INLINE uint8_t port_atomic_or8(volatile uint8_t *ptr, uint8_t mask)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (uint8_t)InterlockedOr8((volatile char*)ptr, (char)mask);
+#else
+    return __atomic_fetch_or(ptr, mask, __ATOMIC_SEQ_CST);
+#endif
+}
+
+PORT_INLINE uint8_t port_atomic_and8(volatile uint8_t *ptr, uint8_t mask)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (uint8_t)InterlockedAnd8((volatile char*)ptr, (char)mask);
+#else
+    return __atomic_fetch_and(ptr, mask, __ATOMIC_SEQ_CST);
+#endif
+}
+
+PORT_INLINE uint8_t port_atomic_load8(volatile uint8_t *ptr)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (uint8_t)InterlockedOr8((volatile char*)ptr, 0);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
+PORT_INLINE uint32_t port_atomic_add32(volatile uint32_t *ptr, uint32_t value)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (uint32_t)InterlockedExchangeAdd((volatile LONG*)ptr, (LONG)value);
+#else
+    return __atomic_fetch_add(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+PORT_INLINE uint32_t port_atomic_load32(volatile uint32_t *ptr)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (uint32_t)InterlockedCompareExchange((volatile LONG*)ptr, 0, 0);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
+PORT_INLINE void port_atomic_store32(volatile uint32_t *ptr, uint32_t value)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)InterlockedExchange((volatile LONG*)ptr, (LONG)value);
+#else
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+PORT_INLINE int port_atomic_cas32(volatile uint32_t *ptr, uint32_t expected, uint32_t desired)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (InterlockedCompareExchange((volatile LONG*)ptr, (LONG)desired, (LONG)expected) == (LONG)expected) ? 1 : 0;
+#else
+    return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? 1 : 0;
+#endif
+}
+
+/*  note: raises the value to the given maximum (and never lowers it) */
+PORT_INLINE void port_atomic_max32(volatile uint32_t *ptr, uint32_t value)
+{
+    uint32_t old = port_atomic_load32(ptr);
+
+    while (old < value) {
+#if defined(_WIN32) || defined(_WIN64)
+        LONG prev = InterlockedCompareExchange((volatile LONG*)ptr, (LONG)value, (LONG)old);
+        if ((uint32_t)prev == old)
+            break;
+        old = (uint32_t)prev;
+#else
+        if (__atomic_compare_exchange_n(ptr, &old, value, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+            break;
+#endif
+    }
+}
+
+PORT_INLINE uint64_t port_atomic_add64(volatile uint64_t *ptr, uint64_t value)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64*)ptr, (LONG64)value);
+#else
+    return __atomic_fetch_add(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/*  note: a plain 64-bit load is not atomic on 32-bit targets */
+PORT_INLINE uint64_t port_atomic_load64(volatile uint64_t *ptr)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64*)ptr, 0, 0);
+#else
+    return __atomic_load_n(ptr, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/*  note: returns non-zero if the value was replaced */
+PORT_INLINE int port_atomic_cas64(volatile uint64_t *ptr, uint64_t expected, uint64_t desired)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    return (InterlockedCompareExchange64((volatile LONG64*)ptr, (LONG64)desired, (LONG64)expected) == (LONG64)expected) ? 1 : 0;
+#else
+    return __atomic_compare_exchange_n(ptr, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST) ? 1 : 0;
+#endif
+}
+
+PORT_INLINE void port_atomic_store64(volatile uint64_t *ptr, uint64_t value)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    (void)InterlockedExchange64((volatile LONG64*)ptr, (LONG64)value);
+#else
+    __atomic_store_n(ptr, value, __ATOMIC_SEQ_CST);
+#endif
+}
+
+#endif /* CAN_PORT_H_INCLUDED */
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de, Homepage: https://www.uv-software.de/
+ */
@@ -0,0 +1,527 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (for PEAK-System PCAN Interfaces)
+ *
+ *  Copyright (c) 2005-2012 Uwe Vogt, UV Software, Friedrichshafen
+ *  Copyright (c) 2013-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of PCANBasic-Wrapper.
+ *
+ *  PCANBasic-Wrapper is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v2.0 (or any later version). You can
+ *  choose between one of them if you use PCANBasic-Wrapper in whole or in part.
+ *
+ *  (1) BSD 2-Clause "Simplified" License
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  PCANBasic-Wrapper IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF PCANBasic-Wrapper, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  (2) GNU General Public License v2.0 or later
+ *
+ *  PCANBasic-Wrapper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PCANBasic-Wrapper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with PCANBasic-Wrapper; if not, see <https://www.gnu.org/licenses/>.
+ */
+/** @addtogroup  can_api
+ *  @{
+ */
+#ifdef _MSC_VER
+//no Microsoft extensions please!
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 1
+#endif
+#endif
+
+/*  -----------  includes  -----------------------------------------------
+ */
+#include "can_defs.h"
+#include "can_port.h"
+#include "can_rpl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <assert.h>
+
+/*  -----------  defines  ------------------------------------------------
+ */
+#define TEXT_MONI               (0)     // text written by can_moni (default format)
+#define TEXT_CSV_DLC            (1)     // CSV trace file with a DLC column
+#define TEXT_CSV_LEN            (2)     // CSV trace file with a length column
+
+#define NSEC_PER_SEC            (1000000000ull)
+#define NSEC_PER_DAY            (86400ull * NSEC_PER_SEC)
+
+/*  -----------  types  --------------------------------------------------
+ */
+struct rpl_reader_t_ {                  // trace file reader (read-ahead):
+    struct PORT_ALIGNED {               //   producer (reader thread):
+        volatile uint32_t head;         //     index of the next entry to be written
+    }   put;
+    struct PORT_ALIGNED {               //   consumer (can_replay):
+        volatile uint32_t tail;         //     index of the next entry to be read
+    }   get;
+    rpl_entry_t ring[RPL_RING_SIZE];    //   read-ahead buffer
+    can_pcan_replay_t options;          //   pass list and identifier mapping
+    can_trc_reader_t *trc;              //   binary trace file (or NULL)
+    FILE *fp;                           //   text trace file (or NULL)
+    int format;                         //   format of the text trace file (TEXT_*)
+    uint64_t day;                       //   offset of time-stamps after midnight in [nsec]
+    uint64_t last;                      //   previous time-stamp of the text trace file in [nsec]
+    volatile uint64_t records;          //   number of records read
+    volatile uint64_t skipped;          //   number of records not sent
+    volatile uint32_t running;          //   reader thread shall run
+    volatile uint32_t done;             //   reader thread has finished
+    int status;                         //   result of the reader thread (CANERR_RX_EMPTY = end of file)
+    port_thread_t thread;               //   reader thread
+};
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+static PORT_THREAD(reader_thread, arg);
+static int read_record(rpl_reader_t *reader, can_trc_record_t *record);
+static int accept_record(const can_pcan_replay_t *options, const can_trc_record_t *record);
+static void remap_message(const can_pcan_replay_t *options, can_message_t *message);
+static int parse_moni(rpl_reader_t *reader, const char *line, can_trc_record_t *record);
+static int parse_csv(rpl_reader_t *reader, const char *line, can_trc_record_t *record);
+static int make_record(rpl_reader_t *reader, can_trc_record_t *record, uint64_t nsec, int tod, uint64_t id, uint64_t len);
+static const char *parse_number(const char *ptr, int base, uint64_t *value);
+static const char *parse_time(const char *ptr, uint64_t *nsec, int *tod);
+static const char *parse_flags(const char *ptr, uint8_t *flags);
+static uint8_t parse_data(const char *ptr, uint8_t len, uint8_t *data);
+static const char *skip_blanks(const char *ptr);
+static int is_delimiter(char c);
+
+/*  -----------  variables  ----------------------------------------------
+ */
+static const uint8_t dlc_table[16] = {  // DLC to length (CAN FD)
+    0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U, 8U, 12U, 16U, 20U, 24U, 32U, 48U, 64U
+};
+
+/*  -----------  functions  ----------------------------------------------
+ */
+int rpl_open(const char *file, const can_pcan_replay_t *options, rpl_reader_t **reader)
+{
+    rpl_reader_t *rpl;                  // trace file reader (read-ahead)
+    can_trc_query_t query;              // query of a binary trace file
+    int rc;                             // return value
+
+    assert(file);
+    assert(options);
+    assert(reader);
+
+    if ((rpl = (rpl_reader_t*)port_aligned_alloc(sizeof(rpl_reader_t))) == NULL)
+        return CANERR_RESOURCE;
+    memcpy(&rpl->options, options, sizeof(can_pcan_replay_t));
+    // binary trace file: the pass list is also a query (with an index only
+    // the blocks that could hold one of the identifiers are read)
+    if ((rc = can_trc_open(file, &rpl->trc)) == CANERR_NOERROR) {
+        if ((options->count > 0U) && (options->count <= CANTRC_QUERY_IDS)) {
+            memset(&query, 0, sizeof(can_trc_query_t));
+            query.until = UINT64_MAX;
+            query.count = options->count;
+            memcpy(query.ids, options->ids, (size_t)options->count * sizeof(uint32_t));
+            (void)can_trc_query(rpl->trc, &query);
+        }
+    }
+    // otherwise a text trace file (can_moni or CSV)
+    else if (rc == CANERR_ILLPARA) {
+        if ((rpl->fp = fopen(file, "r")) == NULL) {
+            port_aligned_free(rpl);
+            return CANERR_RESOURCE;     //   errno is set by fopen
+        }
+        rpl->format = TEXT_MONI;
+    }
+    else {
+        port_aligned_free(rpl);
+        return rc;
+    }
+    // start the reader thread and wait until the buffer is filled
+    port_atomic_store32(&rpl->running, 1U);
+    if (port_thread_create(&rpl->thread, reader_thread, (void*)rpl) != 0) {
+        if (rpl->trc)
+            (void)can_trc_close(rpl->trc);
+        if (rpl->fp)
+            (void)fclose(rpl->fp);
+        port_aligned_free(rpl);
+        return CANERR_RESOURCE;
+    }
+    while (!port_atomic_load32(&rpl->done) && (port_atomic_load32(&rpl->put.head) < RPL_RING_SIZE))
+        port_sleep_usec(RPL_POLL_USEC);
+    *reader = rpl;
+    return CANERR_NOERROR;
+}
+
+int rpl_next(rpl_reader_t *reader, rpl_entry_t *entry)
+{
+    uint32_t tail = reader->get.tail;   // index of the next entry
+
+    assert(reader);
+    assert(entry);
+
+    // the buffer is empty: pending, or the end of the file (or an error)
+    if (tail == port_atomic_load32(&reader->put.head)) {
+        if (!port_atomic_load32(&reader->done))
+            return RPL_PENDING;
+        /* note: the last entry could have been written before the reader thread finished */
+        if (tail == port_atomic_load32(&reader->put.head))
+            return reader->status;
+    }
+    memcpy(entry, &reader->ring[tail & (RPL_RING_SIZE - 1U)], sizeof(rpl_entry_t));
+    port_atomic_store32(&reader->get.tail, tail + 1U);
+    return RPL_MESSAGE;
+}
+
+void rpl_counts(rpl_reader_t *reader, uint64_t *records, uint64_t *skipped)
+{
+    assert(reader);
+    assert(records);
+    assert(skipped);
+
+    *records = port_atomic_load64(&reader->records);
+    *skipped = port_atomic_load64(&reader->skipped);
+}
+
+void rpl_close(rpl_reader_t *reader)
+{
+    assert(reader);
+
+    // stop the reader thread and close the trace file
+    port_atomic_store32(&reader->running, 0U);
+    port_thread_join(reader->thread);
+    if (reader->trc)
+        (void)can_trc_close(reader->trc);
+    if (reader->fp)
+        (void)fclose(reader->fp);
+    port_aligned_free(reader);
+}
+
+/*  -----------  local functions  ----------------------------------------
+ */
+
+static PORT_THREAD(reader_thread, arg)
+{
+    rpl_reader_t *reader = (rpl_reader_t*)arg;
+    can_trc_record_t record;            // record of the trace file
+    rpl_entry_t *entry;                 // entry of the read-ahead buffer
+    uint32_t head;                      // index of the next entry
+    int rc = CANERR_RX_EMPTY;           // result
+
+    while (port_atomic_load32(&reader->running)) {
+        // wait while the read-ahead buffer is full
+        head = reader->put.head;
+        if ((head - port_atomic_load32(&reader->get.tail)) >= RPL_RING_SIZE) {
+            port_sleep_usec(RPL_POLL_USEC);
+            continue;
+        }
+        // the next record from the trace file (until the end of the file)
+        if ((rc = read_record(reader, &record)) != CANERR_NOERROR)
+            break;
+        (void)port_atomic_add64(&reader->records, 1ull);
+        if (!accept_record(&reader->options, &record)) {
+            (void)port_atomic_add64(&reader->skipped, 1ull);
+            continue;
+        }
+        entry = &reader->ring[head & (RPL_RING_SIZE - 1U)];
+        entry->nsec = record.nsec;
+        (void)can_trc_message(&record, &entry->msg);
+        remap_message(&reader->options, &entry->msg);
+        port_atomic_store32(&reader->put.head, head + 1U);
+    }
+    reader->status = rc;
+    port_atomic_store32(&reader->done, 1U);
+    return PORT_THREAD_EXIT;
+}
+
+static int read_record(rpl_reader_t *reader, can_trc_record_t *record)
+{
+    char line[RPL_LINE_MAX];            // line of a text trace file
+
+    // binary trace file: CANERR_RX_EMPTY at the end of the file
+    if (reader->trc)
+        return can_trc_read(reader->trc, record);
+    // text trace file: lines that are not a message are ignored
+    while (fgets(line, (int)sizeof(line), reader->fp) != NULL) {
+        if (!strncmp(line, "Time,Dir,Id,Flags,", 18)) {
+            reader->format = strstr(line, ",Length,") ? TEXT_CSV_LEN : TEXT_CSV_DLC;
+            continue;
+        }
+        if ((reader->format == TEXT_MONI) ? parse_moni(reader, line, record) : parse_csv(reader, line, record))
+            return CANERR_NOERROR;
+    }
+    return ferror(reader->fp) ? CANERR_FATAL : CANERR_RX_EMPTY;
+}
+
+static int accept_record(const can_pcan_replay_t *options, const can_trc_record_t *record)
+{
+    uint32_t i;                         // loop variable
+
+    // status messages and echoed frames are never sent
+    if (record->flags & (CANTRC_FLAG_STS | CANTRC_FLAG_ECH | options->exclude))
+        return 0;
+    // pass list (w/o regard of the format)
+    if (options->count == 0U)
+        return 1;
+    for (i = 0U; i < options->count; i++) {
+        if (options->ids[i] == record->id)
+            return 1;
+    }
+    return 0;
+}
+
+static void remap_message(const can_pcan_replay_t *options, can_message_t *message)
+{
+    uint32_t i;                         // loop variable
+
+    for (i = 0U; i < options->remaps; i++) {
+        if (options->remap[i].from == message->id) {
+            message->id = options->remap[i].to;
+            if (message->id > CAN_MAX_STD_ID)
+                message->xtd = 1;       //   29-bit identifier required
+            break;
+        }
+    }
+}
+
+static int parse_moni(rpl_reader_t *reader, const char *line, can_trc_record_t *record)
+{
+    const char *ptr = skip_blanks(line);
+    const char *end;
+    uint64_t nsec, id, len, value;
+    int tod;
+
+    // e.g. "1        0.1234  123  S---- 8  11 22 33 44 55 66 77 88  .\"3DUfw."
+    memset(record, 0, sizeof(can_trc_record_t));
+    // counter (optional): a number followed by a blank
+    if (((end = parse_number(ptr, 10, &value)) != NULL) && ((*end == ' ') || (*end == '\t')))
+        ptr = skip_blanks(end);
+    // time-stamp: seconds or time of day, with fraction
+    if (((ptr = parse_time(ptr, &nsec, &tod)) == NULL) || ((*ptr != ' ') && (*ptr != '\t')))
+        return 0;
+    // identifier (hexadecimal), flags and length (decimal)
+    if (((end = parse_number(skip_blanks(ptr), 16, &id)) == NULL) || ((*end != ' ') && (*end != '\t')))
+        return 0;
+    if (((ptr = parse_flags(skip_blanks(end), &record->flags)) == NULL) || ((*ptr != ' ') && (*ptr != '\t')))
+        return 0;
+    if (((end = parse_number(skip_blanks(ptr), 10, &len)) == NULL) || !is_delimiter(*end))
+        return 0;
+    if (!make_record(reader, record, nsec, tod, id, len))
+        return 0;
+    // data bytes (all of them), the ASCII dump is ignored
+    if (!(record->flags & CANTRC_FLAG_RTR) && (parse_data(end, record->len, record->data) != record->len))
+        return 0;
+    return 1;
+}
+
+static int parse_csv(rpl_reader_t *reader, const char *line, can_trc_record_t *record)
+{
+    const char *ptr, *end;
+    uint64_t nsec, id, value;
+    uint8_t flags;
+    int tod;
+
+    // e.g. "12.345678901,Tx,123,S----,8,11 22 33 44 55 66 77 88"
+    memset(record, 0, sizeof(can_trc_record_t));
+    if (((ptr = parse_time(line, &nsec, &tod)) == NULL) || (*ptr++ != ','))
+        return 0;
+    if (!strncmp(ptr, "Tx,", 3))
+        flags = CANTRC_FLAG_TX;
+    else if (!strncmp(ptr, "Ec,", 3))
+        flags = CANTRC_FLAG_ECH;
+    else if (!strncmp(ptr, "Rx,", 3))
+        flags = 0U;
+    else
+        return 0;
+    if (((end = parse_number(ptr + 3, 16, &id)) == NULL) || (*end != ','))
+        return 0;
+    if (((ptr = parse_flags(end + 1, &record->flags)) == NULL) || (*ptr != ','))
+        return 0;
+    if (((end = parse_number(ptr + 1, 10, &value)) == NULL) || (*end != ','))
+        return 0;
+    record->flags |= flags;
+    // DLC column: converted into the length
+    if (reader->format == TEXT_CSV_DLC) {
+        if (value > (uint64_t)CANFD_MAX_DLC)
+            return 0;
+        record->dlc = (uint8_t)value;
+        value = (record->flags & CANTRC_FLAG_FDF) ? dlc_table[value] : ((value < CAN_MAX_LEN) ? value : CAN_MAX_LEN);
+    }
+    if (!make_record(reader, record, nsec, tod, id, value))
+        return 0;
+    // data bytes (as many as written)
+    if (!(record->flags & CANTRC_FLAG_RTR))
+        (void)parse_data(end + 1, record->len, record->data);
+    return 1;
+}
+
+static int make_record(rpl_reader_t *reader, can_trc_record_t *record, uint64_t nsec, int tod, uint64_t id, uint64_t len)
+{
+    uint8_t dlc;                        // data length code
+
+    // identifier and length must fit to the format
+    if (id > ((record->flags & CANTRC_FLAG_XTD) ? CAN_MAX_XTD_ID : CAN_MAX_STD_ID))
+        return 0;
+    if (record->flags & CANTRC_FLAG_FDF) {
+        for (dlc = 0U; (dlc < 16U) && (dlc_table[dlc] != len); dlc++);
+        if (dlc >= 16U)
+            return 0;
+    }
+    else if (len > CAN_MAX_LEN)
+        return 0;
+    else
+        dlc = (uint8_t)len;
+    if (!record->dlc)
+        record->dlc = dlc;
+    record->id = (uint32_t)id;
+    record->len = (record->flags & CANTRC_FLAG_RTR) ? 0U : (uint8_t)len;
+    // time of day: a day is added after midnight
+    if (tod && ((nsec + reader->day + (NSEC_PER_DAY / 2ull)) < reader->last))
+        reader->day += NSEC_PER_DAY;
+    record->nsec = tod ? (nsec + reader->day) : nsec;
+    reader->last = record->nsec;
+    return 1;
+}
+
+static const char *parse_number(const char *ptr, int base, uint64_t *value)
+{
+    char *end;                          // end of the number
+
+    // no blanks and no sign
+    if (!isxdigit((unsigned char)*ptr))
+        return NULL;
+    *value = (uint64_t)strtoull(ptr, &end, base);
+    return (end != ptr) ? end : NULL;
+}
+
+static const char *parse_time(const char *ptr, uint64_t *nsec, int *tod)
+{
+    uint64_t hh, mm, ss;                // hours, minutes and seconds
+    uint64_t frac = 0ull;               // fraction in [nsec]
+    uint64_t scale = NSEC_PER_SEC;      // weight of the next digit
+
+    // seconds (relative) or hh:mm:ss (time of day)
+    if ((ptr = parse_number(ptr, 10, &ss)) == NULL)
+        return NULL;
+    *tod = 0;
+    if (*ptr == ':') {
+        hh = ss;
+        if (((ptr = parse_number(ptr + 1, 10, &mm)) == NULL) || (*ptr != ':') ||
+            ((ptr = parse_number(ptr + 1, 10, &ss)) == NULL))
+            return NULL;
+        if ((hh > 23ull) || (mm > 59ull) || (ss > 60ull))
+            return NULL;
+        ss += (hh * 3600ull) + (mm * 60ull);
+        *tod = 1;
+    }
+    // fraction: any number of digits (scaled to nsec)
+    if (*ptr++ != '.')
+        return NULL;
+    if (!isdigit((unsigned char)*ptr))
+        return NULL;
+    for (; isdigit((unsigned char)*ptr); ptr++) {
+        if (scale > 1ull) {
+            scale /= 10ull;
+            frac += (uint64_t)(*ptr - '0') * scale;
+        }
+    }
+    *nsec = (ss * NSEC_PER_SEC) + frac;
+    return ptr;
+}
+
+static const char *parse_flags(const char *ptr, uint8_t *flags)
+{
+    // status message (CAN FD and CAN 2.0 format)
+    if (!strncmp(ptr, "Error", 5)) {
+        *flags = CANTRC_FLAG_STS;
+        return ptr + 5;
+    }
+    if (!strncmp(ptr, "E!", 2)) {
+        *flags = CANTRC_FLAG_STS;
+        return ptr + 2;
+    }
+    if ((ptr[0] != 'S') && (ptr[0] != 'X'))
+        return NULL;
+    *flags = (ptr[0] == 'X') ? CANTRC_FLAG_XTD : 0U;
+    // CAN 2.0 format: "S-" or "XR"
+    if ((ptr[1] != '\0') && is_delimiter(ptr[2])) {
+        if (ptr[1] == 'R')
+            *flags |= CANTRC_FLAG_RTR;
+        else if (ptr[1] != '-')
+            return NULL;
+        return ptr + 2;
+    }
+    // CAN FD format: "SFBER"
+    if ((ptr[1] != 'F') && (ptr[1] != '-')) return NULL;
+    if ((ptr[2] != 'B') && (ptr[2] != '-')) return NULL;
+    if ((ptr[3] != 'E') && (ptr[3] != '-')) return NULL;
+    if ((ptr[4] != 'R') && (ptr[4] != '-')) return NULL;
+    *flags |= (ptr[1] == 'F') ? CANTRC_FLAG_FDF : 0U;
+    *flags |= (ptr[2] == 'B') ? CANTRC_FLAG_BRS : 0U;
+    *flags |= (ptr[3] == 'E') ? CANTRC_FLAG_ESI : 0U;
+    *flags |= (ptr[4] == 'R') ? CANTRC_FLAG_RTR : 0U;
+    return ptr + 5;
+}
+
+static uint8_t parse_data(const char *ptr, uint8_t len, uint8_t *data)
+{
+    uint8_t i;                          // number of data bytes
+    int hi, lo;                         // nibbles
+
+    // two hex digits per byte, separated by blanks
+    for (i = 0U; i < len; i++) {
+        ptr = skip_blanks(ptr);
+        if (!isxdigit((unsigned char)ptr[0]) || !isxdigit((unsigned char)ptr[1]) || !is_delimiter(ptr[2]))
+            break;
+        hi = isdigit((unsigned char)ptr[0]) ? (ptr[0] - '0') : (toupper((unsigned char)ptr[0]) - 'A' + 10);
+        lo = isdigit((unsigned char)ptr[1]) ? (ptr[1] - '0') : (toupper((unsigned char)ptr[1]) - 'A' + 10);
+        data[i] = (uint8_t)((hi << 4) | lo);
+        ptr += 2;
+    }
+    return i;
+}
+
+static const char *skip_blanks(const char *ptr)
+{
+    while ((*ptr == ' ') || (*ptr == '\t'))
+        ptr++;
+    return ptr;
+}
+
+static int is_delimiter(char c)
+{
+    return (c == ' ') || (c == '\t') || (c == ',') || (c == '\r') || (c == '\n') || (c == '\0');
+}
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de, Homepage: https://www.uv-software.de/
+ */
@@ -0,0 +1,113 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (for PEAK-System PCAN Interfaces)
+ *
+ *  Copyright (c) 2005-2012 Uwe Vogt, UV Software, Friedrichshafen
+ *  Copyright (c) 2013-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of PCANBasic-Wrapper.
+ *
+ *  PCANBasic-Wrapper is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v2.0 (or any later version). You can
+ *  choose between one of them if you use PCANBasic-Wrapper in whole or in part.
+ *
+ *  (1) BSD 2-Clause "Simplified" License
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  PCANBasic-Wrapper IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF PCANBasic-Wrapper, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  (2) GNU General Public License v2.0 or later
+ *
+ *  PCANBasic-Wrapper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PCANBasic-Wrapper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with PCANBasic-Wrapper; if not, see <https://www.gnu.org/licenses/>.
+ */
+/** @addtogroup  can_api
+ *  @{
+ */
+#ifndef CAN_RPL_H_INCLUDED
+#define CAN_RPL_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*  -----------  includes  ------------------------------------------------
+ */
+
+#include "PeakCAN_Defines.h"            /* replay options */
+#include "PeakCAN_Tracefile.h"          /* binary trace file format */
+
+#include <stdint.h>                     /* C99 header for sized integer types */
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+#define RPL_RING_SIZE           (4096U) // size of the read-ahead buffer in [messages] (power of two)
+#define RPL_LINE_MAX            (1024U) // longest line of a text trace file in [char]
+#define RPL_POLL_USEC           (1000U) // delay of the reader thread when the buffer is full in [usec]
+
+#define RPL_MESSAGE             (1)     // a message was taken from the read-ahead buffer
+#define RPL_PENDING             (0)     // the read-ahead buffer is empty, but the file is not at its end
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+
+typedef struct {                        // entry of the read-ahead buffer:
+    uint64_t nsec;                      //   time-stamp of the record in [nsec]
+    can_message_t msg;                  //   the message to be sent (remapped)
+}   rpl_entry_t;
+
+typedef struct rpl_reader_t_ rpl_reader_t;
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+/*  - the trace file is read by a separate thread into a read-ahead buffer
+ *    (single producer, single consumer); records that shall not be sent
+ *    are skipped by the reader thread, identifiers are remapped there */
+extern int rpl_open(const char *file, const can_pcan_replay_t *options, rpl_reader_t **reader);
+extern int rpl_next(rpl_reader_t *reader, rpl_entry_t *entry);
+extern void rpl_counts(rpl_reader_t *reader, uint64_t *records, uint64_t *skipped);
+extern void rpl_close(rpl_reader_t *reader);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CAN_RPL_H_INCLUDED */
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de, Homepage: https://www.uv-software.de/
+ */
@@ -0,0 +1,894 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (for PEAK-System PCAN Interfaces)
+ *
+ *  Copyright (c) 2005-2012 Uwe Vogt, UV Software, Friedrichshafen
+ *  Copyright (c) 2013-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of PCANBasic-Wrapper.
+ *
+ *  PCANBasic-Wrapper is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v2.0 (or any later version). You can
+ *  choose between one of them if you use PCANBasic-Wrapper in whole or in part.
+ *
+ *  (1) BSD 2-Clause "Simplified" License
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  PCANBasic-Wrapper IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF PCANBasic-Wrapper, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  (2) GNU General Public License v2.0 or later
+ *
+ *  PCANBasic-Wrapper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PCANBasic-Wrapper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with PCANBasic-Wrapper; if not, see <https://www.gnu.org/licenses/>.
+ */
+/** @addtogroup  can_api
+ *  @{
+ */
+#ifdef _MSC_VER
+//no Microsoft extensions please!
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS 1
+#endif
+#endif
+
+/*  -----------  includes  -----------------------------------------------
+ */
+#include "can_defs.h"
+#include "can_trc.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/*  -----------  options  ------------------------------------------------
+ */
+#if (OPTION_CANAPI_PCBUSB_DYLIB != 0) || (OPTION_CANAPI_PCANBASIC_SO != 0)
+#define EXPORT  __attribute__((visibility("default")))
+#else
+#define EXPORT
+#endif
+
+/*  -----------  defines  ------------------------------------------------
+ */
+#define DICT_HASH(id)           (((uint32_t)(id) * 2654435761U) >> 23)  // 9-bit hash of an identifier
+#define LZ4_MIN_MATCH           (4U)    // shortest match
+#define LZ4_MF_LIMIT            (12U)   // the last match starts 12 bytes before the end
+#define LZ4_LAST_LITERALS       (5U)    // the last 5 bytes are literals
+#define LZ4_HASH(seq)           (((uint32_t)(seq) * 2654435761U) >> 20)  // 12-bit hash of 4 bytes
+#define LZ4_MAX_OFFSET          (0xFFFFU)  // farthest match
+#define BLOOM_HASH1(id)         ((uint32_t)(id) * 2654435761U)  // first hash of an identifier
+#define BLOOM_HASH2(id)         ((((uint32_t)(id) ^ ((uint32_t)(id) >> 15)) * 2246822519U) | 1U)
+#define BLOOM_BIT(h)            ((h) >> 23)  // 9-bit index into the Bloom filter
+#define BLOOM_HASHES            (3U)    // number of bits per identifier
+
+/*  -----------  types  --------------------------------------------------
+ */
+struct can_trc_reader_t_ {              // trace file reader:
+    FILE *fp;                           //   the trace file
+    can_trc_header_t header;            //   file header
+    can_trc_block_t block;              //   header of the current block (version 2.0)
+    uint32_t remaining;                 //   number of records left in the block
+    size_t pos;                         //   position of the next record in the block
+    uint64_t nsec;                      //   time-stamp of the previous record
+    uint32_t entries;                   //   number of identifiers in the dictionary
+    uint32_t ids[CANTRC_DICT_SIZE];     //   dictionary: identifiers
+    uint64_t offset;                    //   file offset of the next block
+    can_trc_index_t *index;             //   index entries (NULL = no index)
+    uint64_t *until;                    //   running maximum of the last time-stamps
+    uint64_t *since;                    //   running minimum of the first time-stamps (backwards)
+    uint32_t blocks;                    //   number of index entries
+    uint32_t next;                      //   next index entry (with a query)
+    int querying;                       //   a query is set
+    can_trc_query_t query;              //   the query
+    can_trc_stats_t stats;              //   statistics since the last query
+    uint8_t data[CANTRC_BLOCK_SIZE];    //   encoded records of the block
+    uint8_t buffer[CANTRC_BLOCK_SIZE];  //   compressed records of the block
+};
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+static size_t lz4_compress(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity, uint16_t *table);
+static int lz4_decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t length);
+static uint32_t lz4_read32(const uint8_t *ptr);
+static uint8_t *lz4_length(uint8_t *op, size_t length);
+static void load_index(can_trc_reader_t *reader);
+static int next_block(can_trc_reader_t *reader);
+static int read_block(can_trc_reader_t *reader);
+static int decode_varint(const can_trc_reader_t *reader, size_t *pos, uint64_t *value);
+static int decode_record(can_trc_reader_t *reader, can_trc_record_t *record);
+static int match_record(const can_trc_query_t *query, const can_trc_record_t *record);
+static int match_block(const can_trc_query_t *query, const can_trc_index_t *entry);
+static void bloom_add(uint8_t *bloom, uint32_t id);
+static int bloom_test(const uint8_t *bloom, uint32_t id);
+
+/*  -----------  variables  ----------------------------------------------
+ */
+static const uint8_t dlc_table[16] = {  // DLC to length (like the capture)
+    0,1,2,3,4,5,6,7,8,12,16,20,24,32,48,64
+};
+
+/*  -----------  functions  ----------------------------------------------
+ */
+
+void trc_encoder_init(trc_encoder_t *encoder, uint8_t codec, size_t capacity)
+{
+    assert(encoder);                    // just to make sure
+
+    // note: a block must hold at least one record and fits the buffer
+    if (capacity > CANTRC_BLOCK_SIZE)
+        capacity = CANTRC_BLOCK_SIZE;
+    assert(capacity >= TRC_RECORD_MAX);
+    encoder->codec = codec;
+    encoder->capacity = capacity;
+    memset(&encoder->block, 0, sizeof(can_trc_block_t));
+    encoder->nsec = 0ull;
+    encoder->entries = 0U;
+    memset(encoder->slots, 0, sizeof(encoder->slots));
+}
+
+int trc_encode(trc_encoder_t *encoder, const can_trc_record_t *record)
+{
+    uint8_t *ptr = &encoder->raw[sizeof(can_trc_block_t) + encoder->block.length];
+    uint8_t *start = ptr;               // begin of the encoded record
+    uint8_t tag, len;                   // tag and data length
+    uint32_t slot, index;               // dictionary slot and index
+    uint64_t value;                     // varint value
+    int64_t delta;                      // time difference in [nsec]
+
+    assert(encoder);                    // just to make sure
+    assert(record);
+
+    // a record is never split, the block is full before the record could overrun
+    if ((encoder->block.length + TRC_RECORD_MAX) > encoder->capacity)
+        return -1;
+    if (encoder->block.count == 0U) {
+        encoder->block.nsec = record->nsec;
+        encoder->nsec = record->nsec;
+        memset(&encoder->index, 0, sizeof(can_trc_index_t));
+        encoder->index.first = record->nsec;
+        encoder->index.last = record->nsec;
+    }
+    // identifier dictionary (open addressing, no removal within a block)
+    slot = DICT_HASH(record->id);
+    while ((encoder->slots[slot] != 0U) && (encoder->ids[encoder->slots[slot] - 1U] != record->id))
+        slot = (slot + 1U) & (TRC_DICT_HASH - 1U);
+    index = encoder->slots[slot];
+    // tag and flags (the XTD and TX flags are in the tag)
+    tag = record->dlc & CANTRC_TAG_DLC;
+    tag |= (index != 0U) ? CANTRC_TAG_DICT : 0U;
+    if ((record->flags & ~(CANTRC_FLAG_XTD | CANTRC_FLAG_TX)) != 0U) {
+        *ptr++ = tag | CANTRC_TAG_FLAGS;
+        *ptr++ = record->flags;
+    }
+    else {
+        tag |= (record->flags & CANTRC_FLAG_XTD) ? CANTRC_TAG_XTD : 0U;
+        tag |= (record->flags & CANTRC_FLAG_TX) ? CANTRC_TAG_TX : 0U;
+        *ptr++ = tag;
+    }
+    // time-stamp difference: zig-zag encoded, in [usec] if possible
+    /* note: all time-stamps are on the host clock, but a transmitted message is
+     *       stamped when written, i.e. a difference can be (slightly) negative */
+    delta = (int64_t)(record->nsec - encoder->nsec);
+    if ((delta % 1000) == 0) {
+        delta /= 1000;
+        value = (((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63)) << 1;
+    }
+    else
+        value = ((((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63)) << 1) | 1U;
+    while (value >= 0x80U) {
+        *ptr++ = (uint8_t)(value | 0x80U);
+        value >>= 7;
+    }
+    *ptr++ = (uint8_t)value;
+    encoder->nsec = record->nsec;
+    // identifier: dictionary index or varint (then added to the dictionary)
+    if (index != 0U)
+        *ptr++ = (uint8_t)(index - 1U);
+    else {
+        value = (uint64_t)record->id;
+        while (value >= 0x80U) {
+            *ptr++ = (uint8_t)(value | 0x80U);
+            value >>= 7;
+        }
+        *ptr++ = (uint8_t)value;
+        if (encoder->entries < CANTRC_DICT_SIZE) {
+            encoder->ids[encoder->entries++] = record->id;
+            encoder->slots[slot] = (uint16_t)encoder->entries;
+        }
+        bloom_add(encoder->index.bloom, record->id);  // note: once per identifier in the dictionary
+    }
+    // payload (the length is given by the DLC)
+    len = (record->flags & CANTRC_FLAG_RTR) ? 0U : dlc_table[record->dlc & CANTRC_TAG_DLC];
+    memcpy(ptr, record->data, len);
+    ptr += len;
+    encoder->block.length += (uint32_t)(ptr - start);
+    encoder->block.count++;
+    // index entry: time range of the block (the Bloom filter is updated above)
+    if (record->nsec < encoder->index.first)
+        encoder->index.first = record->nsec;
+    if (record->nsec > encoder->index.last)
+        encoder->index.last = record->nsec;
+    encoder->index.count++;
+    return 0;
+}
+
+uint32_t trc_pending(const trc_encoder_t *encoder)
+{
+    assert(encoder);                    // just to make sure
+
+    return encoder->block.count;
+}
+
+size_t trc_finish(trc_encoder_t *encoder, const void **block)
+{
+    uint8_t *ptr = encoder->raw;        // block header and stored records
+    size_t size;                        // size of the compressed records
+
+    assert(encoder);                    // just to make sure
+    assert(block);
+
+    if (encoder->block.count == 0U)
+        return 0;
+    // compress the block, if it saves space
+    encoder->block.size = encoder->block.length;
+    encoder->block.codec = PCAN_TRACE_CODEC_NONE;
+    if (encoder->codec == PCAN_TRACE_CODEC_LZ4) {
+        size = lz4_compress(&encoder->raw[sizeof(can_trc_block_t)], (size_t)encoder->block.length,
+                            &encoder->out[sizeof(can_trc_block_t)], (size_t)encoder->block.length - 1U,
+                            encoder->table);
+        if (size > 0) {
+            encoder->block.size = (uint32_t)size;
+            encoder->block.codec = PCAN_TRACE_CODEC_LZ4;
+            ptr = encoder->out;
+        }
+    }
+    memcpy(ptr, &encoder->block, sizeof(can_trc_block_t));
+    *block = (const void*)ptr;
+    size = sizeof(can_trc_block_t) + (size_t)encoder->block.size;
+    // the next block starts with an empty dictionary
+    /* note: the block and its index entry stay valid until the next record is encoded */
+    memset(&encoder->block, 0, sizeof(can_trc_block_t));
+    encoder->entries = 0U;
+    memset(encoder->slots, 0, sizeof(encoder->slots));
+    return size;
+}
+
+void trc_index_init(trc_index_t *index)
+{
+    assert(index);                      // just to make sure
+
+    memset(index, 0, sizeof(trc_index_t));
+}
+
+int trc_index_add(trc_index_t *index, const can_trc_index_t *entry, uint64_t offset)
+{
+    can_trc_index_t *entries;           // index entries
+    uint32_t capacity;                  // number of entries
+
+    assert(index);                      // just to make sure
+    assert(entry);
+
+    if (index->lost)                    // no index for this segment
+        return -1;
+    if (index->count >= index->capacity) {
+        capacity = (index->capacity > 0U) ? (index->capacity * 2U) : TRC_INDEX_CHUNK;
+        if ((entries = (can_trc_index_t*)realloc(index->entries, (size_t)capacity * sizeof(can_trc_index_t))) == NULL) {
+            index->lost = 1;            //   the segment can be read sequentially
+            return -1;
+        }
+        index->entries = entries;
+        index->capacity = capacity;
+    }
+    memcpy(&index->entries[index->count], entry, sizeof(can_trc_index_t));
+    index->entries[index->count].offset = offset;
+    index->count++;
+    return 0;
+}
+
+size_t trc_index_size(uint32_t count)
+{
+    return sizeof(can_trc_block_t) + ((size_t)count * sizeof(can_trc_index_t)) + sizeof(can_trc_trailer_t);
+}
+
+void trc_index_seal(const trc_index_t *index, uint64_t offset, can_trc_block_t *block, can_trc_trailer_t *trailer)
+{
+    assert(index);                      // just to make sure
+    assert(block);
+    assert(trailer);
+
+    // index block: header and entries at the given offset, followed by the trailer
+    memset(block, 0, sizeof(can_trc_block_t));
+    block->size = index->count * (uint32_t)sizeof(can_trc_index_t);
+    block->length = block->size;
+    block->count = index->count;
+    block->codec = CANTRC_CODEC_INDEX;
+    memset(trailer, 0, sizeof(can_trc_trailer_t));
+    trailer->offset = offset;
+    trailer->count = index->count;
+    memcpy(trailer->magic, CANTRC_INDEX_MAGIC, sizeof(trailer->magic));
+}
+
+void trc_index_reset(trc_index_t *index)
+{
+    assert(index);                      // just to make sure
+
+    index->count = 0U;
+    index->lost = 0;
+}
+
+void trc_index_free(trc_index_t *index)
+{
+    assert(index);                      // just to make sure
+
+    free(index->entries);
+    memset(index, 0, sizeof(trc_index_t));
+}
+
+EXPORT
+int can_trc_open(const char *file, can_trc_reader_t **reader)
+{
+    can_trc_reader_t *trc;              // trace file reader
+
+    if (!file || !reader)               // check for null-pointer
+        return CANERR_NULLPTR;
+
+    if ((trc = (can_trc_reader_t*)malloc(sizeof(can_trc_reader_t))) == NULL)
+        return CANERR_RESOURCE;
+    memset(trc, 0, sizeof(can_trc_reader_t));
+    if ((trc->fp = fopen(file, "rb")) == NULL) {
+        free(trc);
+        return CANERR_RESOURCE;         //   errno is set by fopen
+    }
+    // file header: magic string, version and sizes
+    if ((fread(&trc->header, 1, sizeof(can_trc_header_t), trc->fp) != sizeof(can_trc_header_t)) ||
+        (memcmp(trc->header.magic, CANTRC_MAGIC, sizeof(trc->header.magic)) != 0) ||
+        (trc->header.hdr_size < (uint16_t)sizeof(can_trc_header_t)) ||
+        ((trc->header.version == CANTRC_VERSION_FIXED) && (trc->header.rec_size != (uint16_t)sizeof(can_trc_record_t))) ||
+        ((trc->header.version != CANTRC_VERSION_FIXED) && (trc->header.version != CANTRC_VERSION_COMPACT)) ||
+        (fseek(trc->fp, (long)trc->header.hdr_size, SEEK_SET) != 0)) {
+        (void)fclose(trc->fp);
+        free(trc);
+        return CANERR_ILLPARA;
+    }
+    // index of a compact trace file, if any
+    if (trc->header.version == CANTRC_VERSION_COMPACT) {
+        load_index(trc);
+        if (fseek(trc->fp, (long)trc->header.hdr_size, SEEK_SET) != 0) {
+            (void)fclose(trc->fp);
+            free(trc->index);
+            free(trc);
+            return CANERR_ILLPARA;
+        }
+    }
+    trc->offset = (uint64_t)trc->header.hdr_size;
+    trc->stats.blocks = trc->blocks;
+    *reader = trc;
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_trc_close(can_trc_reader_t *reader)
+{
+    if (!reader)                        // check for null-pointer
+        return CANERR_NULLPTR;
+
+    (void)fclose(reader->fp);
+    free(reader->index);
+    free(reader);
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_trc_header(const can_trc_reader_t *reader, can_trc_header_t *header)
+{
+    if (!reader || !header)             // check for null-pointer
+        return CANERR_NULLPTR;
+
+    memcpy(header, &reader->header, sizeof(can_trc_header_t));
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_trc_read(can_trc_reader_t *reader, can_trc_record_t *record)
+{
+    int rc;                             // return value
+
+    if (!reader || !record)             // check for null-pointer
+        return CANERR_NULLPTR;
+
+    do {
+        // version 1.0: records of fixed size
+        if (reader->header.version == CANTRC_VERSION_FIXED) {
+            if (fread(record, 1, sizeof(can_trc_record_t), reader->fp) != sizeof(can_trc_record_t))
+                return CANERR_RX_EMPTY; //   end of file (or an incomplete record)
+            if ((record->dlc > CANFD_MAX_DLC) || (record->len > CANFD_MAX_LEN))
+                return CANERR_FATAL;
+        }
+        // version 2.0: blocks of variable-length records
+        else {
+            while (reader->remaining == 0U) {
+                if ((rc = next_block(reader)) != CANERR_NOERROR)
+                    return rc;
+            }
+            if ((rc = decode_record(reader, record)) != CANERR_NOERROR)
+                return rc;
+        }
+        reader->stats.records++;
+    } while (reader->querying && !match_record(&reader->query, record));
+    reader->stats.matched++;
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_trc_query(can_trc_reader_t *reader, const can_trc_query_t *query)
+{
+    uint32_t lo, hi, mid;               // binary search
+
+    if (!reader)                        // check for null-pointer
+        return CANERR_NULLPTR;
+    if (query && (query->count > CANTRC_QUERY_IDS))
+        return CANERR_ILLPARA;
+
+    // rewind the trace file and reset the statistics
+    if (fseek(reader->fp, (long)reader->header.hdr_size, SEEK_SET) != 0)
+        return CANERR_FATAL;
+    reader->offset = (uint64_t)reader->header.hdr_size;
+    reader->remaining = 0U;
+    reader->next = 0U;
+    memset(&reader->stats, 0, sizeof(can_trc_stats_t));
+    reader->stats.blocks = reader->blocks;
+    if (!query) {
+        reader->querying = 0;
+        return CANERR_NOERROR;
+    }
+    memcpy(&reader->query, query, sizeof(can_trc_query_t));
+    reader->querying = 1;
+    // first block with a time-stamp from the start of the time range (binary search)
+    /* note: the running maximum is ascending, even when the time-stamps are not */
+    lo = 0U;
+    hi = reader->blocks;
+    while (lo < hi) {
+        mid = lo + ((hi - lo) / 2U);
+        if (reader->until[mid] < query->from)
+            lo = mid + 1U;
+        else
+            hi = mid;
+    }
+    reader->next = lo;
+    reader->stats.skipped = lo;
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_trc_stats(const can_trc_reader_t *reader, can_trc_stats_t *stats)
+{
+    if (!reader || !stats)              // check for null-pointer
+        return CANERR_NULLPTR;
+
+    memcpy(stats, &reader->stats, sizeof(can_trc_stats_t));
+    return CANERR_NOERROR;
+}
+
+EXPORT
+int can_trc_message(const can_trc_record_t *record, can_message_t *message)
+{
+    uint8_t len;                        // data length
+
+    if (!record || !message)            // check for null-pointer
+        return CANERR_NULLPTR;
+
+    memset(message, 0, sizeof(can_message_t));
+    message->id = record->id;
+    message->xtd = (record->flags & CANTRC_FLAG_XTD) ? 1 : 0;
+    message->rtr = (record->flags & CANTRC_FLAG_RTR) ? 1 : 0;
+    message->fdf = (record->flags & CANTRC_FLAG_FDF) ? 1 : 0;
+    message->brs = (record->flags & CANTRC_FLAG_BRS) ? 1 : 0;
+    message->esi = (record->flags & CANTRC_FLAG_ESI) ? 1 : 0;
+    message->sts = (record->flags & CANTRC_FLAG_STS) ? 1 : 0;
+    message->dlc = record->dlc;
+    len = (record->len < CANFD_MAX_LEN) ? record->len : CANFD_MAX_LEN;
+    memcpy(message->data, record->data, len);
+    message->timestamp.tv_sec = (time_t)(record->nsec / 1000000000ull);
+    message->timestamp.tv_nsec = (long)(record->nsec % 1000000000ull);
+    return CANERR_NOERROR;
+}
+
+/*  -----------  local functions  ----------------------------------------
+ */
+
+static void load_index(can_trc_reader_t *reader)
+{
+    can_trc_trailer_t trailer;          // index trailer
+    can_trc_block_t block;              // header of the index block
+    long end;                           // offset of the trailer
+    uint32_t i;                         // loop variable
+
+    // trailer at the end of the file: offset of the index block and number of entries
+    /* note: a trace file without a valid index is read sequentially */
+    if ((fseek(reader->fp, -(long)sizeof(can_trc_trailer_t), SEEK_END) != 0) ||
+        ((end = ftell(reader->fp)) < 0L) ||
+        (fread(&trailer, 1, sizeof(can_trc_trailer_t), reader->fp) != sizeof(can_trc_trailer_t)) ||
+        (memcmp(trailer.magic, CANTRC_INDEX_MAGIC, sizeof(trailer.magic)) != 0) ||
+        (trailer.count == 0U) || (trailer.offset < (uint64_t)reader->header.hdr_size) ||
+        ((uint64_t)end != (trailer.offset + sizeof(can_trc_block_t) + ((uint64_t)trailer.count * sizeof(can_trc_index_t)))))
+        return;
+    if ((fseek(reader->fp, (long)trailer.offset, SEEK_SET) != 0) ||
+        (fread(&block, 1, sizeof(can_trc_block_t), reader->fp) != sizeof(can_trc_block_t)) ||
+        (block.codec != CANTRC_CODEC_INDEX) || (block.count != trailer.count))
+        return;
+    // index entries and the running extremes of their time ranges
+    if ((reader->index = (can_trc_index_t*)malloc((size_t)trailer.count * (sizeof(can_trc_index_t) + 2U * sizeof(uint64_t)))) == NULL)
+        return;
+    reader->until = (uint64_t*)&reader->index[trailer.count];
+    reader->since = &reader->until[trailer.count];
+    if (fread(reader->index, sizeof(can_trc_index_t), (size_t)trailer.count, reader->fp) != (size_t)trailer.count) {
+        free(reader->index);
+        reader->index = NULL;
+        return;
+    }
+    for (i = 0U; i < trailer.count; i++) {
+        if ((reader->index[i].offset < (uint64_t)reader->header.hdr_size) || (reader->index[i].offset >= trailer.offset)) {
+            free(reader->index);
+            reader->index = NULL;
+            return;
+        }
+        reader->until[i] = ((i > 0U) && (reader->until[i - 1U] > reader->index[i].last)) ? reader->until[i - 1U] : reader->index[i].last;
+    }
+    for (i = trailer.count; i > 0U; i--) {
+        reader->since[i - 1U] = ((i < trailer.count) && (reader->since[i] < reader->index[i - 1U].first)) ? reader->since[i] : reader->index[i - 1U].first;
+    }
+    reader->blocks = trailer.count;
+}
+
+static int next_block(can_trc_reader_t *reader)
+{
+    const can_trc_index_t *entry;       // index entry
+
+    // with a query and an index: the next block that could hold a matching record
+    if (reader->querying && (reader->index != NULL)) {
+        for (;;) {
+            if ((reader->next >= reader->blocks) || (reader->since[reader->next] > reader->query.until))
+                return CANERR_RX_EMPTY; //   no more blocks in the time range
+            entry = &reader->index[reader->next++];
+            if (match_block(&reader->query, entry))
+                break;
+            reader->stats.skipped++;
+        }
+        if (entry->offset != reader->offset) {
+            if (fseek(reader->fp, (long)entry->offset, SEEK_SET) != 0)
+                return CANERR_FATAL;
+            reader->offset = entry->offset;
+        }
+    }
+    return read_block(reader);
+}
+
+static int read_block(can_trc_reader_t *reader)
+{
+    can_trc_block_t *block = &reader->block;
+
+    // block header
+    /* note: a block that was not completely written ends the trace file */
+    if (fread(block, 1, sizeof(can_trc_block_t), reader->fp) != sizeof(can_trc_block_t))
+        return CANERR_RX_EMPTY;
+    if (block->codec == CANTRC_CODEC_INDEX)
+        return CANERR_RX_EMPTY;         //   the index follows the last block
+    if ((block->length > CANTRC_BLOCK_SIZE) || (block->size > CANTRC_BLOCK_SIZE) ||
+        ((block->codec == PCAN_TRACE_CODEC_NONE) && (block->size != block->length)) ||
+        ((block->codec != PCAN_TRACE_CODEC_NONE) && (block->codec != PCAN_TRACE_CODEC_LZ4)))
+        return CANERR_FATAL;
+    // payload: stored or compressed records
+    if (block->codec == PCAN_TRACE_CODEC_NONE) {
+        if (fread(reader->data, 1, (size_t)block->size, reader->fp) != (size_t)block->size)
+            return CANERR_RX_EMPTY;
+    }
+    else {
+        if (fread(reader->buffer, 1, (size_t)block->size, reader->fp) != (size_t)block->size)
+            return CANERR_RX_EMPTY;
+        if (lz4_decompress(reader->buffer, (size_t)block->size, reader->data, (size_t)block->length) < 0)
+            return CANERR_FATAL;
+    }
+    reader->offset += sizeof(can_trc_block_t) + (uint64_t)block->size;
+    reader->stats.read++;
+    reader->remaining = block->count;
+    reader->pos = 0;
+    reader->nsec = block->nsec;
+    reader->entries = 0U;
+    return CANERR_NOERROR;
+}
+
+static int decode_varint(const can_trc_reader_t *reader, size_t *pos, uint64_t *value)
+{
+    unsigned int shift = 0U;            // bit position of the group
+    uint8_t byte;                       // next byte
+
+    *value = 0ull;
+    do {
+        if ((*pos >= (size_t)reader->block.length) || (shift > 63U))
+            return -1;
+        byte = reader->data[(*pos)++];
+        *value |= (uint64_t)(byte & 0x7FU) << shift;
+        shift += 7U;
+    } while (byte & 0x80U);
+    return 0;
+}
+
+static int decode_record(can_trc_reader_t *reader, can_trc_record_t *record)
+{
+    size_t pos = reader->pos;           // read position
+    uint8_t tag, flags, len;            // tag, flags and data length
+    uint64_t value;                     // varint value
+    int64_t delta;                      // time difference
+
+    // tag and flags
+    if (pos >= (size_t)reader->block.length)
+        return CANERR_FATAL;
+    tag = reader->data[pos++];
+    if (tag & CANTRC_TAG_FLAGS) {
+        if (pos >= (size_t)reader->block.length)
+            return CANERR_FATAL;
+        flags = reader->data[pos++];
+    }
+    else {
+        flags = (tag & CANTRC_TAG_XTD) ? CANTRC_FLAG_XTD : 0U;
+        flags |= (tag & CANTRC_TAG_TX) ? CANTRC_FLAG_TX : 0U;
+    }
+    // time-stamp difference: zig-zag encoded, bit 0 = unit
+    if (decode_varint(reader, &pos, &value) < 0)
+        return CANERR_FATAL;
+    delta = (int64_t)((value >> 2) ^ (0ull - ((value >> 1) & 1ull)));
+    if (!(value & 1ull))
+        delta *= 1000;
+    reader->nsec += (uint64_t)delta;
+    // identifier: dictionary index or varint
+    if (tag & CANTRC_TAG_DICT) {
+        if ((pos >= (size_t)reader->block.length) || (reader->data[pos] >= reader->entries))
+            return CANERR_FATAL;
+        record->id = reader->ids[reader->data[pos++]];
+    }
+    else {
+        if ((decode_varint(reader, &pos, &value) < 0) || (value > 0xFFFFFFFFull))
+            return CANERR_FATAL;
+        record->id = (uint32_t)value;
+        if (reader->entries < CANTRC_DICT_SIZE)
+            reader->ids[reader->entries++] = record->id;
+    }
+    // payload
+    len = (flags & CANTRC_FLAG_RTR) ? 0U : dlc_table[tag & CANTRC_TAG_DLC];
+    if ((pos + len) > (size_t)reader->block.length)
+        return CANERR_FATAL;
+    record->nsec = reader->nsec;
+    record->flags = flags;
+    record->dlc = tag & CANTRC_TAG_DLC;
+    record->len = len;
+    record->reserved = 0U;
+    memcpy(record->data, &reader->data[pos], len);
+    memset(&record->data[len], 0, CANFD_MAX_LEN - len);
+    reader->pos = pos + len;
+    reader->remaining--;
+    return CANERR_NOERROR;
+}
+
+static int match_record(const can_trc_query_t *query, const can_trc_record_t *record)
+{
+    uint32_t i;                         // loop variable
+
+    if ((record->nsec < query->from) || (record->nsec > query->until))
+        return 0;
+    if (query->count == 0U)
+        return 1;
+    for (i = 0U; i < query->count; i++) {
+        if (query->ids[i] == record->id)
+            return 1;
+    }
+    return 0;
+}
+
+static int match_block(const can_trc_query_t *query, const can_trc_index_t *entry)
+{
+    uint32_t i;                         // loop variable
+
+    if ((entry->last < query->from) || (entry->first > query->until))
+        return 0;
+    if (query->count == 0U)
+        return 1;
+    for (i = 0U; i < query->count; i++) {
+        if (bloom_test(entry->bloom, query->ids[i]))
+            return 1;
+    }
+    return 0;
+}
+
+static void bloom_add(uint8_t *bloom, uint32_t id)
+{
+    uint32_t hash = BLOOM_HASH1(id);    // double hashing: h1 + i * h2
+    uint32_t step = BLOOM_HASH2(id);
+    uint32_t i, bit;
+
+    for (i = 0U; i < BLOOM_HASHES; i++, hash += step) {
+        bit = BLOOM_BIT(hash);
+        bloom[bit >> 3] |= (uint8_t)(1U << (bit & 7U));
+    }
+}
+
+static int bloom_test(const uint8_t *bloom, uint32_t id)
+{
+    uint32_t hash = BLOOM_HASH1(id);    // double hashing: h1 + i * h2
+    uint32_t step = BLOOM_HASH2(id);
+    uint32_t i, bit;
+
+    for (i = 0U; i < BLOOM_HASHES; i++, hash += step) {
+        bit = BLOOM_BIT(hash);
+        if (!(bloom[bit >> 3] & (1U << (bit & 7U))))
+            return 0;
+    }
+    return 1;
+}
+
+static uint32_t lz4_read32(const uint8_t *ptr)
+{
+    uint32_t value;                     // note: unaligned access
+
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+static uint8_t *lz4_length(uint8_t *op, size_t length)
+{
+    // length extension: bytes of 255 and a final byte below 255
+    while (length >= 255U) {
+        *op++ = 255U;
+        length -= 255U;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+static size_t lz4_compress(const uint8_t *src, size_t length, uint8_t *dst, size_t capacity, uint16_t *table)
+{
+    const uint8_t *ip = src;            // input position
+    const uint8_t *anchor = src;        // begin of the pending literals
+    const uint8_t *ref;                 // begin of the match
+    const uint8_t *end = src + length;  // end of the input
+    uint8_t *op = dst;                  // output position
+    uint8_t *token;                     // token of the sequence
+    size_t literals, match;             // number of literals and match length
+    uint32_t seq;                       // next 4 bytes
+
+    // LZ4 block format: sequences of literals and a match (offset and length)
+    /* note: the compressed block is only taken when it is smaller, so the
+     *       output is bounded by the capacity (the length minus one) */
+    assert(length <= (LZ4_MAX_OFFSET + 1U));
+    memset(table, 0, TRC_LZ4_HASH * sizeof(uint16_t));
+    if (length > LZ4_MF_LIMIT) {
+        while (ip < (end - LZ4_MF_LIMIT)) {
+            seq = lz4_read32(ip);
+            ref = src + table[LZ4_HASH(seq)];
+            table[LZ4_HASH(seq)] = (uint16_t)(ip - src);
+            if ((ref >= ip) || (lz4_read32(ref) != seq)) {
+                ip += 1 + ((ip - anchor) >> 6);  // skip faster on incompressible data
+                continue;
+            }
+            match = LZ4_MIN_MATCH;
+            while (((ip + match) < (end - LZ4_LAST_LITERALS)) && (ip[match] == ref[match]))
+                match++;
+            literals = (size_t)(ip - anchor);
+            if ((size_t)(op - dst) + 1U + (literals / 255U) + 1U + literals + 2U + (match / 255U) + 1U > capacity)
+                return 0;
+            token = op++;
+            *token = (literals >= 15U) ? 0xF0U : (uint8_t)(literals << 4);
+            if (literals >= 15U)
+                op = lz4_length(op, literals - 15U);
+            memcpy(op, anchor, literals);
+            op += literals;
+            *op++ = (uint8_t)((ip - ref) & 0xFFU);
+            *op++ = (uint8_t)((ip - ref) >> 8);
+            match -= LZ4_MIN_MATCH;
+            *token |= (match >= 15U) ? 0x0FU : (uint8_t)match;
+            if (match >= 15U)
+                op = lz4_length(op, match - 15U);
+            ip += match + LZ4_MIN_MATCH;
+            anchor = ip;
+        }
+    }
+    // last literals
+    literals = (size_t)(end - anchor);
+    if ((size_t)(op - dst) + 1U + (literals / 255U) + 1U + literals > capacity)
+        return 0;
+    token = op++;
+    *token = (literals >= 15U) ? 0xF0U : (uint8_t)(literals << 4);
+    if (literals >= 15U)
+        op = lz4_length(op, literals - 15U);
+    memcpy(op, anchor, literals);
+    op += literals;
+    return (size_t)(op - dst);
+}
+
+static int lz4_decompress(const uint8_t *src, size_t size, uint8_t *dst, size_t length)
+{
+    const uint8_t *ip = src;            // input position
+    const uint8_t *end = src + size;    // end of the input
+    uint8_t *op = dst;                  // output position
+    const uint8_t *ref;                 // begin of the match
+    size_t literals, match, offset;     // number of literals, match length and offset
+    uint8_t token, byte;                // token of the sequence and next byte
+
+    // note: all lengths and offsets are checked (the trace file could be corrupted)
+    for (;;) {
+        if (ip >= end)
+            return -1;
+        token = *ip++;
+        literals = (size_t)(token >> 4);
+        if (literals == 15U) {
+            do {
+                if (ip >= end)
+                    return -1;
+                byte = *ip++;
+                literals += byte;
+            } while (byte == 255U);
+        }
+        if ((literals > (size_t)(end - ip)) || (literals > (length - (size_t)(op - dst))))
+            return -1;
+        memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+        if (ip == end)                  // the last sequence has no match
+            break;
+        if ((end - ip) < 2)
+            return -1;
+        offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if ((offset == 0U) || (offset > (size_t)(op - dst)))
+            return -1;
+        match = (size_t)(token & 0x0FU);
+        if (match == 15U) {
+            do {
+                if (ip >= end)
+                    return -1;
+                byte = *ip++;
+                match += byte;
+            } while (byte == 255U);
+        }
+        match += LZ4_MIN_MATCH;
+        if (match > (length - (size_t)(op - dst)))
+            return -1;
+        for (ref = op - offset; match > 0U; match--)  // note: the match can overlap
+            *op++ = *ref++;
+    }
+    return ((size_t)(op - dst) == length) ? 0 : -1;
+}
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de, Homepage: https://www.uv-software.de/
+ */
@@ -0,0 +1,133 @@
+/*  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later */
+/*
+ *  CAN Interface API, Version 3 (for PEAK-System PCAN Interfaces)
+ *
+ *  Copyright (c) 2005-2012 Uwe Vogt, UV Software, Friedrichshafen
+ *  Copyright (c) 2013-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+ *  All rights reserved.
+ *
+ *  This file is part of PCANBasic-Wrapper.
+ *
+ *  PCANBasic-Wrapper is dual-licensed under the BSD 2-Clause "Simplified" License
+ *  and under the GNU General Public License v2.0 (or any later version). You can
+ *  choose between one of them if you use PCANBasic-Wrapper in whole or in part.
+ *
+ *  (1) BSD 2-Clause "Simplified" License
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *  1. Redistributions of source code must retain the above copyright notice, this
+ *     list of conditions and the following disclaimer.
+ *  2. Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ *  PCANBasic-Wrapper IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF PCANBasic-Wrapper, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *  (2) GNU General Public License v2.0 or later
+ *
+ *  PCANBasic-Wrapper is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  PCANBasic-Wrapper is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along
+ *  with PCANBasic-Wrapper; if not, see <https://www.gnu.org/licenses/>.
+ */
+/** @addtogroup  can_api
+ *  @{
+ */
+#ifndef CAN_TRC_H_INCLUDED
+#define CAN_TRC_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*  -----------  includes  ------------------------------------------------
+ */
+
+#include "PeakCAN_Tracefile.h"          /* binary trace file format */
+
+#include <stdint.h>                     /* C99 header for sized integer types */
+#include <stddef.h>                     /* C99 header for size_t */
+
+
+/*  -----------  defines  ------------------------------------------------
+ */
+
+#define TRC_RECORD_MAX          (2U + 10U + 5U + CANFD_MAX_LEN)  // longest encoded record in [byte]
+#define TRC_DICT_HASH           (512U)  // slots of the dictionary hash table (power of two)
+#define TRC_LZ4_HASH            (4096U) // slots of the LZ4 hash table (power of two)
+#define TRC_INDEX_CHUNK         (64U)   // initial number of index entries (doubled when full)
+
+
+/*  -----------  types  --------------------------------------------------
+ */
+
+typedef struct {                        // encoder of a compact trace file (version 2.0):
+    uint8_t codec;                      //   block compression (PCAN_TRACE_CODEC_*)
+    size_t capacity;                    //   max. length of a block in [byte]
+    can_trc_block_t block;              //   header of the current block
+    uint64_t nsec;                      //   time-stamp of the previous record
+    uint32_t entries;                   //   number of identifiers in the dictionary
+    uint32_t ids[CANTRC_DICT_SIZE];     //   dictionary: identifiers
+    uint16_t slots[TRC_DICT_HASH];      //   dictionary: hash table (index + 1, 0 = free)
+    uint16_t table[TRC_LZ4_HASH];       //   LZ4: last position of a 4-byte sequence
+    can_trc_index_t index;              //   index entry of the current block (w/o offset)
+    uint8_t raw[sizeof(can_trc_block_t) + CANTRC_BLOCK_SIZE];  //   block header and encoded records
+    uint8_t out[sizeof(can_trc_block_t) + CANTRC_BLOCK_SIZE];  //   block header and compressed records
+}   trc_encoder_t;
+
+typedef struct {                        // index of a compact trace file (one segment):
+    can_trc_index_t *entries;           //   index entries (one per block)
+    uint32_t count;                     //   number of index entries
+    uint32_t capacity;                  //   number of allocated entries
+    int lost;                           //   out of memory: no index for this segment
+}   trc_index_t;
+
+
+/*  -----------  prototypes  ---------------------------------------------
+ */
+
+/*  - the encoder is used by the writer thread of the trace file recorder only,
+ *    the reader (can_trc_*) is part of the interface (PeakCAN_Tracefile.h) */
+extern void trc_encoder_init(trc_encoder_t *encoder, uint8_t codec, size_t capacity);
+extern int trc_encode(trc_encoder_t *encoder, const can_trc_record_t *record);
+extern uint32_t trc_pending(const trc_encoder_t *encoder);
+extern size_t trc_finish(trc_encoder_t *encoder, const void **block);
+
+/*  - the index is collected while the blocks are written and appended to the
+ *    segment when it is closed (index block, entries and trailer) */
+extern void trc_index_init(trc_index_t *index);
+extern int trc_index_add(trc_index_t *index, const can_trc_index_t *entry, uint64_t offset);
+extern size_t trc_index_size(uint32_t count);
+extern void trc_index_seal(const trc_index_t *index, uint64_t offset, can_trc_block_t *block, can_trc_trailer_t *trailer);
+extern void trc_index_reset(trc_index_t *index);
+extern void trc_index_free(trc_index_t *index);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* CAN_TRC_H_INCLUDED */
+/** @}
+ */
+/*  ----------------------------------------------------------------------
+ *  Uwe Vogt,  UV Software,  Chausseestrasse 33 A,  10115 Berlin,  Germany
+ *  Tel.: +49-30-46799872,  Fax: +49-30-46799873,  Mobile: +49-170-3801903
+ *  E-Mail: uwe.vogt@uv-software.de, Homepage: https://www.uv-software.de/
+ */
@@ -71,11 +71,13 @@ typedef CPeakCAN  CCanDriver;
 #define FEATURE_BITRATE_FD_SAM       FEATURE_UNSUPPORTED
 #define FEATURE_BITRATE_SJA1000      FEATURE_SUPPORTED
 #define FEATURE_FILTERING            FEATURE_SUPPORTED
-#define FEATURE_TRACEFILE            FEATURE_UNSUPPORTED
+#define FEATURE_TRACEFILE            FEATURE_SUPPORTED
+#define FEATURE_TRACEFILE_SEGMENTED  FEATURE_SUPPORTED
+#define FEATURE_TRACEFILE_COMPRESSED FEATURE_SUPPORTED
 #define FEATURE_ERROR_FRAMES         FEATURE_SUPPORTED
 #define FEATURE_ERROR_CODE_CAPTURE   FEATURE_SUPPORTED
 #define FEATURE_BLOCKING_READ        FEATURE_SUPPORTED
-#define FEATURE_BLOCKING_WRITE       FEATURE_UNSUPPORTED
+#define FEATURE_BLOCKING_WRITE       FEATURE_SUPPORTED
 #define FEATURE_SIZE_RECEIVE_QUEUE   32767
 #define FEATURE_SIZE_TRANSMIT_QUEUE  32767
 
@@ -48,6 +48,7 @@
 //  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
 //
 #include "pch.h"
+#include "PeakCAN_Tracefile.h"
 
 #ifndef FEATURE_TRACEFILE
 #define FEATURE_TRACEFILE  FEATURE_UNSUPPORTED
@@ -57,6 +58,22 @@
 #warning FEATURE_TRACEFILE not set, default = FEATURE_UNSUPPORTED
 #endif
 #endif
+#ifndef FEATURE_TRACEFILE_SEGMENTED
+#define FEATURE_TRACEFILE_SEGMENTED  FEATURE_UNSUPPORTED
+#ifdef _MSC_VER
+#pragma message ( "FEATURE_TRACEFILE_SEGMENTED not set, default = FEATURE_UNSUPPORTED" )
+#else
+#warning FEATURE_TRACEFILE_SEGMENTED not set, default = FEATURE_UNSUPPORTED
+#endif
+#endif
+#ifndef FEATURE_TRACEFILE_COMPRESSED
+#define FEATURE_TRACEFILE_COMPRESSED  FEATURE_UNSUPPORTED
+#ifdef _MSC_VER
+#pragma message ( "FEATURE_TRACEFILE_COMPRESSED not set, default = FEATURE_UNSUPPORTED" )
+#else
+#warning FEATURE_TRACEFILE_COMPRESSED not set, default = FEATURE_UNSUPPORTED
+#endif
+#endif
 #if (FEATURE_TRACEFILE != FEATURE_UNSUPPORTED)
 
 #define NONWRITABLE_FOLDER  "/"
@@ -428,7 +445,7 @@ TEST_F(TraceFile, GTEST_TESTCASE(CheckOptionTraceMode, GTEST_ENABLED)) {
     counter.Increment();
     traceMode = CANPARA_TRACE_MODE_SEGMENTED;
     retVal = dut1.SetProperty(CANPROP_SET_TRACE_MODE, (void*)&traceMode, sizeof(traceMode));
-#if (0)
+#if (FEATURE_TRACEFILE_SEGMENTED != FEATURE_UNSUPPORTED)
     EXPECT_EQ(CCanApi::NoError, retVal);
     traceMode = UINT16_MAX;
     retVal = dut1.GetProperty(CANPROP_GET_TRACE_MODE, (void*)&traceMode, sizeof(traceMode));
@@ -445,7 +462,7 @@ TEST_F(TraceFile, GTEST_TESTCASE(CheckOptionTraceMode, GTEST_ENABLED)) {
     counter.Increment();
     traceMode = CANPARA_TRACE_MODE_COMPRESSED;
     retVal = dut1.SetProperty(CANPROP_SET_TRACE_MODE, (void*)&traceMode, sizeof(traceMode));
-#if (0)
+#if (FEATURE_TRACEFILE_COMPRESSED != FEATURE_UNSUPPORTED)
     EXPECT_EQ(CCanApi::NoError, retVal);
     traceMode = UINT16_MAX;
     retVal = dut1.GetProperty(CANPROP_GET_TRACE_MODE, (void*)&traceMode, sizeof(traceMode));
@@ -455,7 +472,7 @@ TEST_F(TraceFile, GTEST_TESTCASE(CheckOptionTraceMode, GTEST_ENABLED)) {
 #else
     EXPECT_EQ(CANPARA_TRACE_MODE_COMPRESSED | CANPARA_TRACE_MODE_OVERWRITE, traceMode);
 #endif
-else
+#else
     EXPECT_EQ(CCanApi::IllegalParameter, retVal);
 #endif
     // @- sub(5): with valid mode 0x02 (date prefix)
@@ -1533,6 +1550,96 @@ TEST_F(TraceFile, GTEST_TESTCASE(WithSizeLimitation, GTEST_ENABLED)) {
 TEST_F(TraceFile, GTEST_TESTCASE(WithFileSegmentation, GTEST_DISABLED)) {
 }
 
+// @gtest TCx4.19: Trace transmitted and received CAN messages on the same time base
+//
+// @expected: CANERR_NOERROR and the time-stamps of all records are on the host clock
+//
+TEST_F(TraceFile, GTEST_TESTCASE(TransmitAndReceiveTimeBase, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Return_t retVal;
+    can_trc_reader_t *reader = NULL;
+    can_trc_header_t header = {};
+    can_trc_record_t record = {};
+    uint8_t traceState;
+    uint8_t timeMode;
+    char string[CANPROP_MAX_STRING_LENGTH+1] = "";
+    int64_t delta, smallest = 0;
+    uint64_t previous = 0ull;
+    int records = 0, tx = 0;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- keep the device clock for the time-stamps of DUT1 (default)
+    timeMode = PCAN_TIME_DEVICE;
+    retVal = dut1.SetProperty(PCANPROP_SET_TIME_MODE, (void*)&timeMode, sizeof(timeMode));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- note: set trace file location to "TraceFiles" in current directory
+    strcpy(string, TRACEFILE_FOLDER);
+    retVal = dut1.SetProperty(CANPROP_SET_TRACE_FOLDER, (void*)string, sizeof(string));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- open trace file for DUT1 (default options)
+    traceState = CANPARA_TRACE_ON;
+    retVal = dut1.SetProperty(CANPROP_SET_TRACE_ACTIVE, (void*)&traceState, sizeof(traceState));
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.SetProperty() failed with error code " << retVal;
+    // @- remember the name of the trace file
+    string[0] = '\0';
+    retVal = dut1.GetProperty(CANPROP_GET_TRACE_FILE, (void*)string, CANPROP_MAX_STRING_LENGTH);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @test:
+    // @- send some frames to DUT2 and receive some frames from DUT2
+    int32_t frames = g_Options.GetNumberOfTestFrames();
+    EXPECT_EQ(frames, dut1.SendSomeFrames(dut2, frames));
+    EXPECT_EQ(frames, dut1.ReceiveSomeFrames(dut2, frames));
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- close trace file for DUT1
+    traceState = CANPARA_TRACE_OFF;
+    retVal = dut1.SetProperty(CANPROP_SET_TRACE_ACTIVE, (void*)&traceState, sizeof(traceState));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- the trace file is on the host monotonic clock
+    ASSERT_EQ(CANERR_NOERROR, can_trc_open(string, &reader)) << "[  ERROR!  ] cannot open " << string;
+    EXPECT_EQ(CANERR_NOERROR, can_trc_header(reader, &header));
+    EXPECT_EQ(PCAN_TIME_MONOTONIC, header.time_mode);
+    // @- transmitted and received messages are in the order of time (within 10ms)
+    while (can_trc_read(reader, &record) == CANERR_NOERROR) {
+        if (records++ > 0) {
+            delta = (int64_t)(record.nsec - previous);
+            if (delta < smallest)
+                smallest = delta;
+        }
+        if (record.flags & CANTRC_FLAG_TX)
+            tx++;
+        previous = record.nsec;
+    }
+    (void)can_trc_close(reader);
+    EXPECT_EQ(2 * frames, records);
+    EXPECT_EQ(frames, tx);
+    EXPECT_GT(smallest, -10000000LL);
+    // @post:
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
 #endif // FEATURE_TRACEFILE != FEATURE_UNSUPPORTED
 
 //  $Id: TCx4_TracefileRecorder.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
@@ -0,0 +1,197 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#include <thread>
+#include <vector>
+
+#define TEST_WRITERS  2
+
+class ConcurrentAccess : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // send frames (retry when the transmitter is busy), return the number of frames sent
+    static int32_t Writer(CCanDevice &dut, uint32_t id, int32_t frames) {
+        CANAPI_Message_t message = {};
+        CANAPI_Return_t retVal;
+        int32_t sent = 0;
+        message.id = id;
+        message.dlc = CAN_MAX_DLC;
+        while (sent < frames) {
+            message.data[0] = (uint8_t)((uint32_t)sent >> 0);
+            message.data[1] = (uint8_t)((uint32_t)sent >> 8);
+            message.data[2] = (uint8_t)((uint32_t)sent >> 16);
+            message.data[3] = (uint8_t)((uint32_t)sent >> 24);
+            retVal = dut.WriteMessage(message, TEST_WRITE_TIMEOUT);
+            if (retVal == CCanApi::NoError)
+                sent++;
+            else if (retVal != CCanApi::TransmitterBusy)
+                break;
+        }
+        return sent;
+    }
+    // receive frames until the expected number or a time-out, return the number of frames received
+    static int32_t Reader(CCanDevice &dut, int32_t frames) {
+        CANAPI_Message_t message = {};
+        CANAPI_Return_t retVal;
+        int32_t received = 0;
+        int32_t timeouts = 0;
+        while ((received < frames) && (timeouts < 8)) {
+            retVal = dut.ReadMessage(message, TEST_READ_TIMEOUT);
+            if (retVal == CCanApi::NoError) {
+                if (!message.sts)
+                    received++;
+                timeouts = 0;
+            } else if (retVal == CCanApi::ReceiverEmpty)
+                timeouts++;
+            else
+                break;
+        }
+        return received;
+    }
+};
+
+// @gtest TCx5.0: Concurrent reception and transmission on one handle (stress test)
+//
+// @expected: CANERR_NOERROR and exact frame counters
+//
+TEST_F(ConcurrentAccess, GTEST_TESTCASE(CountersUnderConcurrentLoad, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Status_t status = {};
+    CANAPI_Return_t retVal;
+    uint64_t counter;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    int32_t frames = g_Options.GetNumberOfTestFrames();
+    int32_t sent[TEST_WRITERS] = {};
+    int32_t echoed = 0;
+    int32_t received1 = 0;
+    int32_t received2 = 0;
+    std::vector<std::thread> threads;
+    // @- DUT1: one reader thread and TEST_WRITERS writer threads on the same handle
+    threads.push_back(std::thread([&]() { received1 = Reader(dut1, frames); }));
+    for (int i = 0; i < TEST_WRITERS; i++)
+        threads.push_back(std::thread([&, i]() { sent[i] = Writer(dut1, 0x100U + (uint32_t)i, frames); }));
+    // @- DUT2: one reader thread and one writer thread (counterpart)
+    threads.push_back(std::thread([&]() { received2 = Reader(dut2, frames * TEST_WRITERS); }));
+    threads.push_back(std::thread([&]() { echoed = Writer(dut2, 0x200U, frames); }));
+    for (auto &thread : threads)
+        thread.join();
+    // @- check that all frames have been sent and received
+    for (int i = 0; i < TEST_WRITERS; i++)
+        EXPECT_EQ(frames, sent[i]);
+    EXPECT_EQ(frames, echoed);
+    EXPECT_EQ(frames, received1);
+    EXPECT_EQ(frames * TEST_WRITERS, received2);
+    // @- check that the frame counters of DUT1 are exact (no lost updates)
+    retVal = dut1.GetProperty(CANPROP_GET_TX_COUNTER, (void*)&counter, sizeof(counter));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ((uint64_t)frames * TEST_WRITERS, counter);
+    retVal = dut1.GetProperty(CANPROP_GET_RX_COUNTER, (void*)&counter, sizeof(counter));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ((uint64_t)frames, counter);
+    // @- check that the frame counters of DUT2 are exact (no lost updates)
+    retVal = dut2.GetProperty(CANPROP_GET_TX_COUNTER, (void*)&counter, sizeof(counter));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ((uint64_t)frames, counter);
+    retVal = dut2.GetProperty(CANPROP_GET_RX_COUNTER, (void*)&counter, sizeof(counter));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ((uint64_t)frames * TEST_WRITERS, counter);
+    // @- get status of DUT1 and check to be in RUNNING state
+    retVal = dut1.GetStatus(status);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_FALSE(status.can_stopped);
+    EXPECT_FALSE(status.message_lost);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- get status of DUT1 and check to be in INIT state
+    retVal = dut1.GetStatus(status);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_TRUE(status.can_stopped);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCx5_ConcurrentAccess.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
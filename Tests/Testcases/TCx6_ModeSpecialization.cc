@@ -0,0 +1,299 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+#include "pch.h"
+
+#define FILL_BYTE  0xEEU
+
+class ModeSpecialization : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // compare a received message with the sent one (the payload beyond the length must be zero)
+    static void CheckMessage(const CANAPI_Message_t &trmMsg, const CANAPI_Message_t &rcvMsg) {
+        uint8_t length = CCanApi::Dlc2Len(trmMsg.dlc);
+        EXPECT_EQ(trmMsg.id, rcvMsg.id);
+        EXPECT_EQ(trmMsg.xtd, rcvMsg.xtd);
+        EXPECT_EQ(trmMsg.rtr, rcvMsg.rtr);
+        EXPECT_EQ(trmMsg.dlc, rcvMsg.dlc);
+        EXPECT_FALSE(rcvMsg.sts);
+#if (OPTION_CAN_2_0_ONLY == 0)
+        EXPECT_EQ(trmMsg.fdf, rcvMsg.fdf);
+        EXPECT_EQ(trmMsg.brs, rcvMsg.brs);
+#endif
+        if (!trmMsg.rtr)
+            EXPECT_EQ(0, memcmp(trmMsg.data, rcvMsg.data, length));
+        for (size_t i = (size_t)length; i < sizeof(rcvMsg.data); i++)
+            EXPECT_EQ(0x00U, rcvMsg.data[i]) << "[  ERROR!  ] data[" << i << "] not cleared";
+    }
+    // send a message from DUT2 and receive it by DUT1 into a filled buffer
+    static CANAPI_Return_t SendAndReceive(CCanDevice &dut1, CCanDevice &dut2, const CANAPI_Message_t &trmMsg, CANAPI_Message_t &rcvMsg) {
+        CANAPI_Return_t retVal = dut2.WriteMessage(trmMsg);
+        if (retVal != CCanApi::NoError)
+            return retVal;
+        memset(&rcvMsg, FILL_BYTE, sizeof(CANAPI_Message_t));
+        return dut1.ReadMessage(rcvMsg, TEST_READ_TIMEOUT);
+    }
+};
+
+// @gtest TCx6.0: Decoding of received messages in the configured operation mode
+//
+// @expected: CANERR_NOERROR and all fields decoded, the payload beyond the length cleared
+//
+TEST_F(ModeSpecialization, GTEST_TESTCASE(DecodeInConfiguredMode, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t trmMsg = {};
+    CANAPI_Message_t rcvMsg = {};
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    for (uint8_t i = 0U; i < CAN_MAX_LEN; i++)
+        trmMsg.data[i] = (uint8_t)(0x11U * (i + 1U));
+    // @- sub(1): standard frame with a short payload
+    trmMsg.id = 0x123U;
+    trmMsg.dlc = 3U;
+    retVal = SendAndReceive(dut1, dut2, trmMsg, rcvMsg);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    CheckMessage(trmMsg, rcvMsg);
+    // @- sub(2): extended frame with a full payload
+    trmMsg.id = 0x1ABCDEF0U;
+    trmMsg.xtd = 1;
+    trmMsg.dlc = CAN_MAX_DLC;
+    retVal = SendAndReceive(dut1, dut2, trmMsg, rcvMsg);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    CheckMessage(trmMsg, rcvMsg);
+    // @- sub(3): remote frame (no payload)
+    trmMsg.id = 0x456U;
+    trmMsg.xtd = 0;
+    trmMsg.rtr = 1;
+    trmMsg.dlc = 2U;
+    retVal = SendAndReceive(dut1, dut2, trmMsg, rcvMsg);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    CheckMessage(trmMsg, rcvMsg);
+    trmMsg.rtr = 0;
+#if (OPTION_CAN_2_0_ONLY == 0)
+    if (dut1.GetOpMode().fdoe && dut2.GetOpMode().fdoe) {
+        for (uint8_t i = 0U; i < CANFD_MAX_LEN; i++)
+            trmMsg.data[i] = (uint8_t)(i + 1U);
+        // @- sub(4): CAN FD frame with 12 bytes (CAN FD mode only)
+        trmMsg.id = 0x321U;
+        trmMsg.fdf = 1;
+        trmMsg.dlc = 9U;
+        retVal = SendAndReceive(dut1, dut2, trmMsg, rcvMsg);
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        CheckMessage(trmMsg, rcvMsg);
+        // @- sub(5): CAN FD frame with 64 bytes, bit-rate switching if enabled (CAN FD mode only)
+        trmMsg.brs = dut2.GetOpMode().brse ? 1 : 0;
+        trmMsg.dlc = CANFD_MAX_DLC;
+        retVal = SendAndReceive(dut1, dut2, trmMsg, rcvMsg);
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        CheckMessage(trmMsg, rcvMsg);
+        // @- sub(6): bit-rate switching without flag FDF is rejected
+        trmMsg.fdf = 0;
+        trmMsg.brs = 1;
+        trmMsg.dlc = CAN_MAX_DLC;
+        retVal = dut2.WriteMessage(trmMsg);
+        EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+        trmMsg.brs = 0;
+    } else {
+        // @- sub(4): CAN FD frame is rejected (CAN 2.0 mode only)
+        trmMsg.id = 0x321U;
+        trmMsg.fdf = 1;
+        trmMsg.dlc = CAN_MAX_DLC;
+        retVal = dut2.WriteMessage(trmMsg);
+        EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+        trmMsg.fdf = 0;
+        // @- sub(5): data length code above 8 is rejected (CAN 2.0 mode only)
+        trmMsg.dlc = CAN_MAX_DLC + 1U;
+        retVal = dut2.WriteMessage(trmMsg);
+        EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    }
+#endif
+    // @- nothing else received
+    retVal = dut1.ReadMessage(rcvMsg, 0U);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCx6.1: Suppression of extended and remote frames (operation mode bits NXTD and NRTR)
+//
+// @expected: CANERR_NOERROR and only standard data frames received, extended and remote frames cannot be sent
+//
+TEST_F(ModeSpecialization, GTEST_TESTCASE(SuppressExtendedAndRemoteFrames, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CANAPI_OpMode_t opCapa = { TEST_CANMODE };
+    CANAPI_OpMode_t opMode = { TEST_CANMODE };
+    CANAPI_Message_t trmMsg = {};
+    CANAPI_Message_t rcvMsg = {};
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- get operation capabilities from DUT1
+    retVal = dut1.GetOpCapabilities(opCapa);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1 again
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- check if suppressing extended and remote frames is supported
+    if (!opCapa.nxtd || !opCapa.nrtr)
+        GTEST_SKIP() << "Suppressing extended or remote frames is not supported by DUT1!";
+    // @- set operation mode bits NXTD and NRTR
+    opMode = dut1.GetOpMode();
+    opMode.nxtd = 1;
+    opMode.nrtr = 1;
+    dut1.SetOpMode(opMode);
+    // @- initialize DUT1 with bits NXTD and NRTR set
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- DUT1 cannot send extended or remote frames
+    trmMsg.id = 0x1ABCDEF0U;
+    trmMsg.xtd = 1;
+    trmMsg.dlc = CAN_MAX_DLC;
+    retVal = dut1.WriteMessage(trmMsg);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    trmMsg.id = 0x456U;
+    trmMsg.xtd = 0;
+    trmMsg.rtr = 1;
+    retVal = dut1.WriteMessage(trmMsg);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- DUT2 sends an extended, a remote and a standard frame
+    trmMsg.id = 0x1ABCDEF0U;
+    trmMsg.xtd = 1;
+    trmMsg.rtr = 0;
+    retVal = dut2.WriteMessage(trmMsg);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    trmMsg.id = 0x456U;
+    trmMsg.xtd = 0;
+    trmMsg.rtr = 1;
+    retVal = dut2.WriteMessage(trmMsg);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    trmMsg.id = 0x123U;
+    trmMsg.rtr = 0;
+    trmMsg.dlc = 5U;
+    memset(trmMsg.data, 0x5A, CAN_MAX_LEN);
+    retVal = dut2.WriteMessage(trmMsg);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- DUT1 receives the standard frame only
+    memset(&rcvMsg, FILL_BYTE, sizeof(CANAPI_Message_t));
+    retVal = dut1.ReadMessage(rcvMsg, TEST_READ_TIMEOUT);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    CheckMessage(trmMsg, rcvMsg);
+    retVal = dut1.ReadMessage(rcvMsg, TEST_READ_TIMEOUT);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCx6_ModeSpecialization.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
@@ -0,0 +1,209 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+#include "pch.h"
+#include "../../Sources/Wrapper/can_trc.h"
+
+#include <stdio.h>
+
+#define TEST_FRAMES  1000000
+#define TEST_FILE    "TCx7_TraceCompression.dat"
+
+class TraceCompression : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // synthetic bus loads
+    enum ELoad {
+        Periodic,   // CAN 2.0 at 1Mbit/s, 80% bus load: 48 periodic 11-bit identifiers, 8 data bytes
+        Short,      // CAN 2.0 at 1Mbit/s, 80% bus load: 20 29-bit identifiers, 2 data bytes
+        FdFrames,   // CAN FD at 500kbit/s:4Mbit/s, 80% bus load: 16 identifiers, 64 data bytes
+        Random      // random identifiers, lengths, payload and time-stamps (worst case)
+    };
+    static const char *Name(ELoad load) {
+        switch (load) {
+        case Periodic: return "CAN 2.0, 8 bytes, periodic";
+        case Short:    return "CAN 2.0, 2 bytes, 29-bit  ";
+        case FdFrames: return "CAN FD, 64 bytes          ";
+        default:       return "random (worst case)       ";
+        }
+    }
+    static uint32_t Next(uint32_t &seed) {
+        seed = seed * 1103515245U + 12345U;
+        return seed >> 8;
+    }
+    // the n-th frame of a synthetic bus load (time-stamps in [usec] as from the device)
+    static void Frame(ELoad load, uint32_t n, uint32_t &seed, uint64_t &nsec, can_trc_record_t &record) {
+        static const uint8_t length[16] = { 0,1,2,3,4,5,6,7,8,12,16,20,24,32,48,64 };
+        uint32_t rnd = Next(seed);
+        uint32_t slot;
+        memset(&record, 0, sizeof(can_trc_record_t));
+        switch (load) {
+        case Periodic:
+            slot = n % 48U;
+            record.id = 0x100U + slot;
+            record.flags = ((slot % 10U) == 0U) ? CANTRC_FLAG_TX : 0U;
+            record.dlc = 8U;
+            record.data[0] = (uint8_t)(n / 48U);
+            record.data[1] = (uint8_t)((n / 48U) >> 8);
+            record.data[2] = (uint8_t)(n / 10000U);
+            record.data[3] = (uint8_t)slot;
+            record.data[4] = (uint8_t)(0x20U + (rnd & 0x03U));
+            record.data[7] = 0xFFU;
+            nsec += (uint64_t)(146U + (rnd % 20U)) * 1000ull;
+            break;
+        case Short:
+            slot = n % 20U;
+            record.id = 0x18FEF000U + (slot << 8) + 0x21U;
+            record.flags = CANTRC_FLAG_XTD;
+            record.dlc = 2U;
+            record.data[0] = (uint8_t)(n / 20U);
+            record.data[1] = (uint8_t)(rnd & 0x0FU);
+            nsec += (uint64_t)(82U + (rnd % 10U)) * 1000ull;
+            break;
+        case FdFrames:
+            slot = n % 16U;
+            record.id = 0x400U + slot;
+            record.flags = CANTRC_FLAG_FDF | CANTRC_FLAG_BRS;
+            record.dlc = 15U;
+            record.data[0] = (uint8_t)(n / 16U);
+            for (int i = 1; i < 64; i++)
+                record.data[i] = (uint8_t)(slot + i + ((i < 8) ? (rnd & 0x07U) : 0U));
+            nsec += (uint64_t)(280U + (rnd % 40U)) * 1000ull;
+            break;
+        default:
+            record.id = rnd & 0x7FFU;
+            record.dlc = (uint8_t)(Next(seed) % 9U);
+            for (int i = 0; i < 8; i++)
+                record.data[i] = (uint8_t)Next(seed);
+            nsec += (uint64_t)(Next(seed) % 500000U);
+            break;
+        }
+        record.nsec = nsec;
+        record.len = length[record.dlc];
+        memset(&record.data[record.len], 0, CANFD_MAX_LEN - record.len);
+    }
+    // encode and write a synthetic bus load, read it back and compare
+    static bool Run(ELoad load, uint8_t codec, long &bytes, double &seconds) {
+        static trc_encoder_t encoder;
+        can_trc_reader_t *reader = NULL;
+        can_trc_header_t header = {};
+        can_trc_record_t record, expected;
+        const void *block;
+        size_t size;
+        uint32_t seed = 4711U, n;
+        uint64_t nsec = 0ull;
+        bool ok = true;
+        // @- write the trace file (file header, blocks of 64KB)
+        FILE *fp = fopen(TEST_FILE, "wb");
+        if (fp == NULL)
+            return false;
+        memcpy(header.magic, CANTRC_MAGIC, sizeof(header.magic));
+        header.version = CANTRC_VERSION_COMPACT;
+        header.hdr_size = (uint16_t)sizeof(can_trc_header_t);
+        struct timespec start = CTimer::GetTime();
+        (void)fwrite(&header, 1, sizeof(can_trc_header_t), fp);
+        trc_encoder_init(&encoder, codec, CANTRC_BLOCK_SIZE - sizeof(can_trc_block_t));
+        for (n = 0U; n < TEST_FRAMES; n++) {
+            Frame(load, n, seed, nsec, record);
+            if (trc_encode(&encoder, &record) != 0) {
+                size = trc_finish(&encoder, &block);
+                (void)fwrite(block, 1, size, fp);
+                (void)trc_encode(&encoder, &record);
+            }
+        }
+        if ((size = trc_finish(&encoder, &block)) > 0)
+            (void)fwrite(block, 1, size, fp);
+        bytes = ftell(fp);
+        (void)fclose(fp);
+        struct timespec stop = CTimer::GetTime();
+        seconds = CTimer::DiffTime(start, stop);
+        // @- read the trace file and compare the records
+        if (can_trc_open(TEST_FILE, &reader) != CANERR_NOERROR)
+            return false;
+        seed = 4711U;
+        nsec = 0ull;
+        for (n = 0U; ok && (n < TEST_FRAMES); n++) {
+            Frame(load, n, seed, nsec, expected);
+            ok = (can_trc_read(reader, &record) == CANERR_NOERROR) &&
+                 (memcmp(&record, &expected, sizeof(can_trc_record_t)) == 0);
+        }
+        if (ok)
+            ok = (can_trc_read(reader, &record) == CANERR_RX_EMPTY);
+        (void)can_trc_close(reader);
+        (void)remove(TEST_FILE);
+        return ok;
+    }
+};
+
+// @gtest TCx7.0: Compact binary trace format on synthetic bus loads (benchmark)
+//
+// @expected: CANERR_NOERROR (the throughput is reported, not checked)
+//
+TEST_F(TraceCompression, GTEST_TESTCASE(CompactFormatWithSyntheticLoads, GTEST_ENABLED)) {
+    const ELoad loads[] = { Periodic, Short, FdFrames, Random };
+    long stored, compressed;
+    double seconds;
+    // @test:
+    for (size_t i = 0; i < (sizeof(loads) / sizeof(loads[0])); i++) {
+        // @- sub(1): blocks stored as is
+        ASSERT_TRUE(Run(loads[i], PCAN_TRACE_CODEC_NONE, stored, seconds)) << "[  ERROR!  ] " << Name(loads[i]) << ": records differ";
+        std::cout << "[   INFO   ] " << Name(loads[i]) << " stored: " << ((double)stored / TEST_FRAMES) << " bytes/frame, "
+                  << ((double)stored / seconds / 1048576.0) << " MB/s, " << ((double)TEST_FRAMES / seconds) << " frames/s" << std::endl;
+        // @- sub(2): blocks compressed (LZ4)
+        ASSERT_TRUE(Run(loads[i], PCAN_TRACE_CODEC_LZ4, compressed, seconds)) << "[  ERROR!  ] " << Name(loads[i]) << ": records differ";
+        std::cout << "[   INFO   ] " << Name(loads[i]) << " LZ4:    " << ((double)compressed / TEST_FRAMES) << " bytes/frame, "
+                  << ((double)compressed / seconds / 1048576.0) << " MB/s, " << ((double)TEST_FRAMES / seconds) << " frames/s" << std::endl;
+        // @- a compact record is smaller than a fixed-size record and compression never grows a block
+        EXPECT_LT(stored, (long)(TEST_FRAMES * sizeof(can_trc_record_t)));
+        EXPECT_LE(compressed, stored);
+    }
+    // @end.
+}
+
+//  $Id: TCx7_TraceCompression.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
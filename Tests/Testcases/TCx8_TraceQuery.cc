@@ -0,0 +1,200 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+#include "pch.h"
+#include "../../Sources/Wrapper/can_trc.h"
+
+#include <stdio.h>
+
+#define TEST_FILE    "TCx8_TraceQuery.dat"
+#define TEST_RARE_ID  0x18DA00F1U
+#define TEST_ID       0x101U
+
+class TraceQuery : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    static uint32_t Next(uint32_t &seed) {
+        seed = seed * 1103515245U + 12345U;
+        return seed >> 8;
+    }
+    // the n-th frame: CAN 2.0 at 1Mbit/s, 80% bus load (48 periodic identifiers, 8 data bytes)
+    // and a burst of 10 diagnostic frames every 60 seconds (rare 29-bit identifier)
+    static void Frame(uint32_t n, uint32_t &seed, uint64_t &nsec, can_trc_record_t &record) {
+        uint32_t rnd = Next(seed);
+        memset(&record, 0, sizeof(can_trc_record_t));
+        if ((n % 384000U) < 10U) {
+            record.id = TEST_RARE_ID;
+            record.flags = CANTRC_FLAG_XTD;
+        }
+        else {
+            record.id = 0x100U + (n % 48U);
+            record.flags = ((n % 10U) == 0U) ? CANTRC_FLAG_TX : 0U;
+        }
+        record.dlc = 8U;
+        record.len = 8U;
+        record.data[0] = (uint8_t)n;
+        record.data[1] = (uint8_t)(n >> 8);
+        record.data[2] = (uint8_t)(rnd & 0x03U);
+        nsec += (uint64_t)(146U + (rnd % 20U)) * 1000ull;
+        record.nsec = nsec;
+    }
+    // write an indexed compact trace file (blocks of 64KB, LZ4)
+    static long Write(uint32_t frames, uint64_t &duration) {
+        static trc_encoder_t encoder;
+        trc_index_t index;
+        can_trc_header_t header = {};
+        can_trc_block_t block;
+        can_trc_trailer_t trailer;
+        can_trc_record_t record;
+        const void *data;
+        size_t size;
+        uint32_t seed = 4711U;
+        uint64_t nsec = 0ull, offset;
+        long bytes;
+
+        FILE *fp = fopen(TEST_FILE, "wb");
+        if (fp == NULL)
+            return -1;
+        memcpy(header.magic, CANTRC_MAGIC, sizeof(header.magic));
+        header.version = CANTRC_VERSION_COMPACT;
+        header.hdr_size = (uint16_t)sizeof(can_trc_header_t);
+        (void)fwrite(&header, 1, sizeof(can_trc_header_t), fp);
+        offset = sizeof(can_trc_header_t);
+        trc_encoder_init(&encoder, PCAN_TRACE_CODEC_LZ4, CANTRC_BLOCK_SIZE);
+        trc_index_init(&index);
+        for (uint32_t n = 0U; n <= frames; n++) {
+            if (n < frames) {
+                Frame(n, seed, nsec, record);
+                if (trc_encode(&encoder, &record) == 0)
+                    continue;
+            }
+            if ((size = trc_finish(&encoder, &data)) > 0) {
+                (void)trc_index_add(&index, &encoder.index, offset);
+                (void)fwrite(data, 1, size, fp);
+                offset += (uint64_t)size;
+            }
+            if (n < frames)
+                (void)trc_encode(&encoder, &record);
+        }
+        trc_index_seal(&index, offset, &block, &trailer);
+        (void)fwrite(&block, 1, sizeof(can_trc_block_t), fp);
+        (void)fwrite(index.entries, sizeof(can_trc_index_t), (size_t)index.count, fp);
+        (void)fwrite(&trailer, 1, sizeof(can_trc_trailer_t), fp);
+        trc_index_free(&index);
+        bytes = ftell(fp);
+        (void)fclose(fp);
+        duration = nsec;
+        return bytes;
+    }
+    // read the trace file with a query (index) or all records (filtered here)
+    static long Read(const can_trc_query_t &query, bool indexed, double &seconds, can_trc_stats_t &stats) {
+        can_trc_reader_t *reader = NULL;
+        can_trc_record_t record;
+        long n = 0;
+        struct timespec start = CTimer::GetTime();
+        if (can_trc_open(TEST_FILE, &reader) != CANERR_NOERROR)
+            return -1;
+        if (indexed && (can_trc_query(reader, &query) != CANERR_NOERROR))
+            n = -1;
+        while ((n >= 0) && (can_trc_read(reader, &record) == CANERR_NOERROR)) {
+            if (!indexed && ((record.nsec < query.from) || (record.nsec > query.until) ||
+                             ((query.count > 0U) && (record.id != query.ids[0]))))
+                continue;
+            n++;
+        }
+        (void)can_trc_stats(reader, &stats);
+        (void)can_trc_close(reader);
+        struct timespec stop = CTimer::GetTime();
+        seconds = CTimer::DiffTime(start, stop);
+        return n;
+    }
+};
+
+// @gtest TCx8.0: Query latency of an indexed trace file vs. file size (benchmark)
+//
+// @expected: CANERR_NOERROR (the latencies are reported, not checked)
+//
+TEST_F(TraceQuery, GTEST_TESTCASE(QueryLatencyVersusFileSize, GTEST_ENABLED)) {
+    const uint32_t sizes[] = { 1000000U, 4000000U, 16000000U };
+    can_trc_query_t query[2] = {};
+    can_trc_stats_t stats;
+    double indexed = 0.0, scanned = 0.0;
+    uint64_t duration;
+    long bytes, found, expected;
+    // @test:
+    for (size_t i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+        // @- write an indexed trace file
+        ASSERT_LT(0L, bytes = Write(sizes[i], duration));
+        std::cout << "[   INFO   ] " << sizes[i] << " frames, " << ((double)bytes / 1048576.0) << " MB, "
+                  << (duration / 1000000000ull) << " s" << std::endl;
+        // @- sub(1): one identifier within 5 seconds in the middle of the trace
+        query[0].from = duration / 2ull;
+        query[0].until = query[0].from + 5000000000ull;
+        query[0].count = 1U;
+        query[0].ids[0] = TEST_ID;
+        // @- sub(2): a rare identifier over the whole trace
+        query[1].from = 0ull;
+        query[1].until = UINT64_MAX;
+        query[1].count = 1U;
+        query[1].ids[0] = TEST_RARE_ID;
+        for (int j = 0; j < 2; j++) {
+            expected = Read(query[j], false, scanned, stats);
+            found = Read(query[j], true, indexed, stats);
+            EXPECT_EQ(expected, found);
+            EXPECT_LT(stats.read, stats.blocks);
+            std::cout << "[   INFO   ] " << ((j == 0) ? "time range:  " : "identifier:  ") << found << " records, "
+                      << stats.read << " of " << stats.blocks << " blocks read, "
+                      << (indexed * 1000.0) << " ms (full scan " << (scanned * 1000.0) << " ms)" << std::endl;
+        }
+    }
+    (void)remove(TEST_FILE);
+    // @end.
+}
+
+//  $Id: TCx8_TraceQuery.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
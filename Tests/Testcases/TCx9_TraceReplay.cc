@@ -0,0 +1,189 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#include <stdio.h>
+
+#define TEST_FILE     "TCx9_TraceReplay.txt"
+#define TEST_FRAMES   500
+#define TEST_PERIOD   1000U  // [usec]
+#define TEST_ID1      0x101U
+#define TEST_ID2      0x202U
+#define TEST_REMAP    0x18DA00F1U
+
+class TraceReplay : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // write a trace file like can_moni (default format): frames every TEST_PERIOD
+    // with two alternating identifiers, a greeting and a status message
+    static bool Write(int32_t frames) {
+        FILE *fp = fopen(TEST_FILE, "w");
+        if (fp == NULL)
+            return false;
+        fprintf(fp, "CAN Monitor for PEAK-System PCAN Interfaces\n\n");
+        for (int32_t n = 0; n < frames; n++) {
+            uint64_t usec = (uint64_t)n * TEST_PERIOD;
+            fprintf(fp, "%-7i  %3u.%04u  %03X  S---- 8  %02X %02X 00 00 00 00 00 00  ........\n", n + 1,
+                    (unsigned)(usec / 1000000U), (unsigned)((usec % 1000000U) / 100U),
+                    (n % 2) ? TEST_ID2 : TEST_ID1, (unsigned)(n & 0xFF), (unsigned)((n >> 8) & 0xFF));
+        }
+        fprintf(fp, "%-7i  %3u.%04u  000  Error 4  00 00 00 00  ....\n", frames + 1, 0U, 0U);
+        return (fclose(fp) == 0);
+    }
+    // receive frames until a time-out, count them per identifier
+    static int32_t Reader(CCanDevice &dut, int32_t &id1, int32_t &id2, int32_t &remapped) {
+        CANAPI_Message_t message = {};
+        int32_t received = 0;
+        id1 = id2 = remapped = 0;
+        while (dut.ReadMessage(message, 100U) == CCanApi::NoError) {
+            if (message.sts)
+                continue;
+            if (message.id == TEST_ID1) id1++;
+            if (message.id == TEST_ID2) id2++;
+            if ((message.id == TEST_REMAP) && message.xtd) remapped++;
+            received++;
+        }
+        return received;
+    }
+};
+
+// @gtest TCx9.0: Replay of a trace file at real time and at max. rate with filter and remap
+//
+// @expected: CANERR_NOERROR, all frames received and the duration of the trace file kept
+//
+TEST_F(TraceReplay, GTEST_TESTCASE(RealTimeAndMaxRate, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Return_t retVal;
+    can_pcan_replay_t options = {};
+    can_pcan_replay_stats_t stats = {};
+    int32_t id1, id2, remapped;
+    // @pre:
+    // @- write a trace file (can_moni format)
+    ASSERT_TRUE(Write(TEST_FRAMES)) << "[  ERROR!  ] trace file could not be written";
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- a replay requires a started controller
+    options.speed = 100U;
+    retVal = dut1.ReplayTrace(TEST_FILE, options, stats);
+    EXPECT_EQ(CCanApi::ControllerOffline, retVal);
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- sub(1): a speed below 0.1 times real time is rejected
+    options.speed = PCAN_REPLAY_SPEED_MIN - 1U;
+    retVal = dut1.ReplayTrace(TEST_FILE, options, stats);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- sub(2): replay at real time, the status message is not sent
+    options.speed = 100U;
+    retVal = dut1.ReplayTrace(TEST_FILE, options, stats);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ((uint64_t)TEST_FRAMES + 1U, stats.records);
+    EXPECT_EQ((uint64_t)1U, stats.skipped);
+    EXPECT_EQ((uint64_t)TEST_FRAMES, stats.sent);
+    EXPECT_EQ(TEST_FRAMES, Reader(dut2, id1, id2, remapped));
+    EXPECT_EQ(TEST_FRAMES / 2, id1);
+    EXPECT_EQ(TEST_FRAMES / 2, id2);
+    // @- the duration of the trace file is kept (within 5%)
+    uint64_t duration = (uint64_t)(TEST_FRAMES - 1) * TEST_PERIOD;
+    EXPECT_LE(duration, stats.elapsed);
+    EXPECT_GE(duration + duration / 20U, stats.elapsed);
+    std::cout << "[   INFO   ] lateness: min " << stats.min << " usec, avg " << stats.avg << " usec, max " << stats.max << " usec" << std::endl;
+    // @- sub(3): replay at max. rate, one identifier remapped to a 29-bit identifier
+    options.speed = 0U;
+    options.count = 1U;
+    options.ids[0] = TEST_ID2;
+    options.remaps = 1U;
+    options.remap[0].from = TEST_ID2;
+    options.remap[0].to = TEST_REMAP;
+    retVal = dut1.ReplayTrace(TEST_FILE, options, stats);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ((uint64_t)TEST_FRAMES / 2U, stats.sent);
+    EXPECT_EQ((uint64_t)TEST_FRAMES / 2U + 1U, stats.skipped);
+    EXPECT_GT(duration / 2U, stats.elapsed);
+    EXPECT_EQ(TEST_FRAMES / 2, Reader(dut2, id1, id2, remapped));
+    EXPECT_EQ(0, id1);
+    EXPECT_EQ(0, id2);
+    EXPECT_EQ(TEST_FRAMES / 2, remapped);
+    // @post:
+    (void)remove(TEST_FILE);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCx9_TraceReplay.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
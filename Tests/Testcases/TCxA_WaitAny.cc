@@ -0,0 +1,191 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#include <thread>
+#include <chrono>
+
+#define TEST_FRAMES   8
+#define TEST_TIMEOUT  100U  // [msec]
+
+class WaitAny : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // send some frames, return the number of frames sent
+    static int32_t Sender(CCanDevice &dut, uint32_t id, int32_t frames) {
+        CANAPI_Message_t message = {};
+        int32_t sent = 0;
+        message.id = id;
+        message.dlc = CAN_MAX_DLC;
+        for (int32_t n = 0; n < frames; n++) {
+            message.data[0] = (uint8_t)n;
+            if (dut.WriteMessage(message, TEST_WRITE_TIMEOUT) == CCanApi::NoError)
+                sent++;
+        }
+        return sent;
+    }
+    // read until the receive queue is empty, return the number of frames read
+    static int32_t Drain(CCanDevice &dut, uint32_t id) {
+        CANAPI_Message_t message = {};
+        int32_t received = 0;
+        while (dut.ReadMessage(message, 0U) == CCanApi::NoError) {
+            if (!message.sts && (message.id == id))
+                received++;
+        }
+        return received;
+    }
+};
+
+// @gtest TCxA.0: Wait on two channels, only the channel that received messages is ready
+//
+// @expected: CANERR_NOERROR and the index of the receiving channel only
+//
+TEST_F(WaitAny, GTEST_TESTCASE(ReadySetOfTwoChannels, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CPeakCAN *objects[2] = { &dut1, &dut2 };
+    CCanApi::EChannelState state;
+    CANAPI_Return_t retVal;
+    size_t ready[2] = { 9U, 9U };
+    size_t count = 9U;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- a wait requires started controllers
+    retVal = CPeakCAN::WaitAny(objects, 2U, ready, count, 0U);
+    EXPECT_EQ(CCanApi::ControllerOffline, retVal);
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- sub(1): illegal parameters
+    retVal = CPeakCAN::WaitAny(objects, 0U, ready, count, 0U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    retVal = CPeakCAN::WaitAny(objects, 65U, ready, count, 0U);  // more than MAXIMUM_WAIT_OBJECTS
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    retVal = CPeakCAN::WaitAny(NULL, 2U, ready, count, 0U);
+    EXPECT_EQ(CCanApi::NullPointer, retVal);
+    // @- sub(2): nothing received, the wait times out
+    auto start = std::chrono::steady_clock::now();
+    retVal = CPeakCAN::WaitAny(objects, 2U, ready, count, TEST_TIMEOUT);
+    auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    EXPECT_EQ(0U, count);
+    EXPECT_GE(waited, (long long)TEST_TIMEOUT - 1);
+    // @- sub(3): DUT1 sends, only DUT2 (index 1) is ready
+    EXPECT_EQ(TEST_FRAMES, Sender(dut1, 0x101U, TEST_FRAMES));
+    retVal = CPeakCAN::WaitAny(objects, 2U, ready, count, TEST_TIMEOUT);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(1U, count);
+    EXPECT_EQ(1U, ready[0]);
+    EXPECT_EQ(TEST_FRAMES, Drain(dut2, 0x101U));
+    // @- sub(4): DUT2 sends, only DUT1 (index 0) is ready
+    EXPECT_EQ(TEST_FRAMES, Sender(dut2, 0x202U, TEST_FRAMES));
+    retVal = CPeakCAN::WaitAny(objects, 2U, ready, count, TEST_TIMEOUT);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(1U, count);
+    EXPECT_EQ(0U, ready[0]);
+    EXPECT_EQ(TEST_FRAMES, Drain(dut1, 0x202U));
+    // @- sub(5): both send, both are ready (possibly in two turns)
+    EXPECT_EQ(TEST_FRAMES, Sender(dut1, 0x101U, TEST_FRAMES));
+    EXPECT_EQ(TEST_FRAMES, Sender(dut2, 0x202U, TEST_FRAMES));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    bool seen[2] = { false, false };
+    for (int turn = 0; (turn < 2) && !(seen[0] && seen[1]); turn++) {
+        retVal = CPeakCAN::WaitAny(objects, 2U, ready, count, TEST_TIMEOUT);
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        for (size_t i = 0U; (retVal == CCanApi::NoError) && (i < count); i++)
+            seen[ready[i]] = true;
+    }
+    EXPECT_TRUE(seen[0]);
+    EXPECT_TRUE(seen[1]);
+    EXPECT_EQ(TEST_FRAMES, Drain(dut1, 0x202U));
+    EXPECT_EQ(TEST_FRAMES, Drain(dut2, 0x101U));
+    // @- sub(6): a signal aborts an infinite wait without a ready channel
+    std::thread signaler([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        (void)dut2.SignalChannel();
+    });
+    retVal = CPeakCAN::WaitAny(objects, 2U, ready, count, CANWAIT_INFINITE);
+    signaler.join();
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    EXPECT_EQ(0U, count);
+    // @post:
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxA_WaitAny.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
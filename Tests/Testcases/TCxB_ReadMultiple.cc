@@ -0,0 +1,224 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#define TEST_FRAMES  100
+#define TEST_BATCH   16U
+#define TEST_ID      0x123U
+
+class ReadMultiple : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    static CANAPI_Return_t SendFrames(CCanDevice &dut, int frames) {
+        CANAPI_Message_t message = {};
+        CANAPI_Return_t retVal = CCanApi::NoError;
+        message.id = TEST_ID;
+        message.dlc = 4U;
+        for (int i = 0; (i < frames) && (retVal == CCanApi::NoError); i++) {
+            message.data[0] = (uint8_t)i;
+            message.data[1] = (uint8_t)(i >> 8);
+            message.data[2] = (uint8_t)(i >> 16);
+            message.data[3] = (uint8_t)(i >> 24);
+            do {
+                retVal = dut.WriteMessage(message, TEST_WRITE_TIMEOUT);
+            } while (retVal == CCanApi::TransmitterBusy);
+        }
+        return retVal;
+    }
+    static int Number(const CANAPI_Message_t &message) {
+        return (int)((uint32_t)message.data[0] | ((uint32_t)message.data[1] << 8) |
+                     ((uint32_t)message.data[2] << 16) | ((uint32_t)message.data[3] << 24));
+    }
+};
+
+// @gtest TCxB.0: Read received messages in batches
+//
+// @expected: CANERR_NOERROR and all messages in the order they were sent
+//
+TEST_F(ReadMultiple, GTEST_TESTCASE(MessagesInBatchesAndInOrder, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t buffer[TEST_BATCH] = {};
+    struct timespec last = { 0, 0 };
+    uint64_t before = 0U, after = 0U;
+    size_t count = 0U;
+    int total = 0;
+    bool ordered = true, monotonic = true;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- remember the receive counter of DUT1
+    retVal = dut1.GetProperty(CANPROP_GET_RX_COUNTER, (void*)&before, sizeof(uint64_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- send some frames by DUT2
+    retVal = SendFrames(dut2, TEST_FRAMES);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.WriteMessage() failed with error code " << retVal;
+    // @- read them by DUT1 in batches of up to 16 messages
+    while (total < TEST_FRAMES) {
+        retVal = dut1.ReadMessages(buffer, TEST_BATCH, count, TEST_READ_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ReadMessages() failed with error code " << retVal;
+        ASSERT_GE(count, 1U);
+        ASSERT_LE(count, (size_t)TEST_BATCH);
+        for (size_t i = 0U; i < count; i++) {
+            ordered = ordered && (buffer[i].id == TEST_ID) && (Number(buffer[i]) == total);
+            monotonic = monotonic && ((buffer[i].timestamp.tv_sec > last.tv_sec) ||
+                        ((buffer[i].timestamp.tv_sec == last.tv_sec) && (buffer[i].timestamp.tv_nsec >= last.tv_nsec)));
+            last.tv_sec = buffer[i].timestamp.tv_sec;
+            last.tv_nsec = buffer[i].timestamp.tv_nsec;
+            total++;
+        }
+    }
+    EXPECT_EQ(TEST_FRAMES, total);
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(monotonic);
+    // @- the receive counter is updated once per batch
+    retVal = dut1.GetProperty(CANPROP_GET_RX_COUNTER, (void*)&after, sizeof(uint64_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ((uint64_t)TEST_FRAMES, after - before);
+    // @- nothing more to read
+    retVal = dut1.ReadMessages(buffer, TEST_BATCH, count, 0U);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    EXPECT_EQ(0U, count);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxB.1: Read messages in batches with invalid parameters or in wrong states
+//
+// @expected: CANERR_OFFLINE, CANERR_ILLPARA, CANERR_NULLPTR resp. CANERR_RX_EMPTY
+//
+TEST_F(ReadMultiple, GTEST_TESTCASE(ParametersAndStates, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t buffer[TEST_BATCH] = {};
+    size_t count = 0U;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @test:
+    // @- sub(1): not started
+    retVal = dut1.ReadMessages(buffer, TEST_BATCH, count, 0U);
+    EXPECT_EQ(CCanApi::ControllerOffline, retVal);
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    PCBUSB_INIT_DELAY();
+    // @- sub(2): no message buffer
+    retVal = dut1.ReadMessages(buffer, 0U, count, 0U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- sub(3): null-pointer
+    retVal = dut1.ReadMessages(NULL, TEST_BATCH, count, 0U);
+    EXPECT_EQ(CCanApi::NullPointer, retVal);
+    // @- sub(4): message queue empty (polling)
+    count = TEST_BATCH;
+    retVal = dut1.ReadMessages(buffer, TEST_BATCH, count, 0U);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    EXPECT_EQ(0U, count);
+    // @- sub(5): message queue empty (time-out)
+    count = TEST_BATCH;
+    retVal = dut1.ReadMessages(buffer, TEST_BATCH, count, TEST_READ_TIMEOUT);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    EXPECT_EQ(0U, count);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxB_ReadMultiple.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
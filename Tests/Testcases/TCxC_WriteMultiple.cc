@@ -0,0 +1,275 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#define TEST_FRAMES   32
+#define TEST_ILLEGAL  5
+#define TEST_ID       0x321U
+
+class WriteMultiple : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    static void Messages(CANAPI_Message_t *messages, int n) {
+        for (int i = 0; i < n; i++) {
+            memset(&messages[i], 0, sizeof(CANAPI_Message_t));
+            messages[i].id = TEST_ID;
+            messages[i].dlc = 2U;
+            messages[i].data[0] = (uint8_t)i;
+            messages[i].data[1] = (uint8_t)(i >> 8);
+        }
+    }
+    // transmit all messages, resume after the last message sent if the transmitter is busy
+    static CANAPI_Return_t WriteAll(CCanDevice &dut, const CANAPI_Message_t *messages, size_t n, size_t &total) {
+        CANAPI_Return_t retVal;
+        size_t sent = 0U;
+        total = 0U;
+        do {
+            retVal = dut.WriteMessages(&messages[total], n - total, sent, TEST_WRITE_TIMEOUT);
+            total += sent;
+        } while ((retVal == CCanApi::TransmitterBusy) && (total < n));
+        return retVal;
+    }
+};
+
+// @gtest TCxC.0: Write messages in one call
+//
+// @expected: CANERR_NOERROR and all messages received in the order they were given
+//
+TEST_F(WriteMultiple, GTEST_TESTCASE(AllMessagesInOrder, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t messages[TEST_FRAMES];
+    CANAPI_Message_t message = {};
+    uint64_t before = 0U, after = 0U;
+    size_t total = 0U;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- remember the transmit counter of DUT1
+    retVal = dut1.GetProperty(CANPROP_GET_TX_COUNTER, (void*)&before, sizeof(uint64_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- send all messages by DUT1 (resumed if the transmitter is busy)
+    Messages(messages, TEST_FRAMES);
+    retVal = WriteAll(dut1, messages, TEST_FRAMES, total);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.WriteMessages() failed with error code " << retVal;
+    EXPECT_EQ((size_t)TEST_FRAMES, total);
+    // @- the transmit counter has been updated by all messages
+    retVal = dut1.GetProperty(CANPROP_GET_TX_COUNTER, (void*)&after, sizeof(uint64_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ((uint64_t)TEST_FRAMES, after - before);
+    // @- DUT2 receives them in order
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        retVal = dut2.ReadMessage(message, TEST_READ_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ReadMessage() failed with error code " << retVal;
+        EXPECT_EQ(TEST_ID, message.id);
+        EXPECT_EQ(2U, message.dlc);
+        EXPECT_EQ((uint8_t)i, message.data[0]);
+        EXPECT_EQ((uint8_t)(i >> 8), message.data[1]);
+    }
+    retVal = dut2.ReadMessage(message, 0U);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxC.1: Write messages in one call with an illegal message in between
+//
+// @expected: CANERR_ILLPARA and the messages before the illegal one are sent
+//
+TEST_F(WriteMultiple, GTEST_TESTCASE(StopAtIllegalMessage, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t messages[TEST_FRAMES];
+    CANAPI_Message_t message = {};
+    size_t sent = TEST_FRAMES;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- the message at index 5 has an invalid identifier
+    Messages(messages, TEST_FRAMES);
+    messages[TEST_ILLEGAL].id = CAN_MAX_STD_ID + 1U;
+    retVal = dut1.WriteMessages(messages, TEST_FRAMES, sent, TEST_WRITE_TIMEOUT);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    EXPECT_EQ((size_t)TEST_ILLEGAL, sent);
+    // @- DUT2 receives the messages before the illegal one only
+    for (int i = 0; i < TEST_ILLEGAL; i++) {
+        retVal = dut2.ReadMessage(message, TEST_READ_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ReadMessage() failed with error code " << retVal;
+        EXPECT_EQ((uint8_t)i, message.data[0]);
+    }
+    retVal = dut2.ReadMessage(message, TEST_READ_TIMEOUT);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxC.2: Write messages in one call with invalid parameters or in wrong states
+//
+// @expected: CANERR_OFFLINE, CANERR_NULLPTR resp. CANERR_NOERROR for no message
+//
+TEST_F(WriteMultiple, GTEST_TESTCASE(ParametersAndStates, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t messages[TEST_FRAMES];
+    size_t sent = TEST_FRAMES;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @test:
+    Messages(messages, TEST_FRAMES);
+    // @- sub(1): not started
+    retVal = dut1.WriteMessages(messages, TEST_FRAMES, sent, 0U);
+    EXPECT_EQ(CCanApi::ControllerOffline, retVal);
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    PCBUSB_INIT_DELAY();
+    // @- sub(2): null-pointer
+    retVal = dut1.WriteMessages(NULL, TEST_FRAMES, sent, 0U);
+    EXPECT_EQ(CCanApi::NullPointer, retVal);
+    // @- sub(3): no message at all
+    sent = TEST_FRAMES;
+    retVal = dut1.WriteMessages(NULL, 0U, sent, 0U);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0U, sent);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxC_WriteMultiple.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
@@ -0,0 +1,292 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+class FilterList : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // send one message per identifier by DUT2
+    static void SendIds(CCanDevice &dut, const uint32_t *ids, int n, bool xtd) {
+        CANAPI_Message_t message = {};
+        CANAPI_Return_t retVal;
+        for (int i = 0; i < n; i++) {
+            message.id = ids[i];
+            message.xtd = xtd ? 1 : 0;
+            message.dlc = 1U;
+            message.data[0] = (uint8_t)i;
+            retVal = dut.WriteMessage(message, TEST_WRITE_TIMEOUT);
+            ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.WriteMessage() failed with error code " << retVal;
+        }
+    }
+    // receive the expected messages by DUT1, nothing else must arrive
+    static void ReceiveIds(CCanDevice &dut, const uint32_t *ids, int n, bool xtd) {
+        CANAPI_Message_t message = {};
+        CANAPI_Return_t retVal;
+        for (int i = 0; i < n; i++) {
+            retVal = dut.ReadMessage(message, TEST_READ_TIMEOUT);
+            ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ReadMessage() failed with error code " << retVal;
+            EXPECT_EQ(ids[i], message.id);
+            EXPECT_EQ(xtd, message.xtd ? true : false);
+        }
+    }
+};
+
+// @gtest TCxD.0: Receive 11-bit identifiers through a list of identifier ranges
+//
+// @expected: only identifiers within one of the ranges are received
+//
+TEST_F(FilterList, GTEST_TESTCASE(StandardRanges, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    const can_pcan_filter_t ranges[] = { { 0x100U, 0x10FU, 0U }, { 0x200U, 0x200U, 0U }, { 0x7F0U, 0x7FFU, 0U } };
+    const uint32_t sent[] = { 0x0FFU, 0x100U, 0x108U, 0x10FU, 0x110U, 0x1FFU, 0x200U, 0x201U, 0x7EFU, 0x7FFU };
+    const uint32_t accepted[] = { 0x100U, 0x108U, 0x10FU, 0x200U, 0x7FFU };
+    CANAPI_Message_t message = {};
+    uint32_t count = 0U;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- set the filter list of DUT1 (3 ranges)
+    retVal = dut1.SetFilterList(ranges, sizeof(ranges) / sizeof(ranges[0]));
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.SetFilterList() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- the filter list has 3 ranges
+    retVal = dut1.GetProperty(PCANPROP_GET_FILTER_COUNT, (void*)&count, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(3U, count);
+    // @- send 11-bit identifiers inside and at the borders of the ranges by DUT2
+    SendIds(dut2, sent, sizeof(sent) / sizeof(sent[0]), false);
+    // @- DUT1 receives only the identifiers within the ranges
+    ReceiveIds(dut1, accepted, sizeof(accepted) / sizeof(accepted[0]), false);
+    // @- nothing else has been received by DUT1
+    retVal = dut1.ReadMessage(message, TEST_READ_TIMEOUT);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxD.1: Receive 11-bit and 29-bit identifiers through a list with overlapping ranges
+//
+// @expected: only identifiers within one of the ranges of the same format are received
+//
+TEST_F(FilterList, GTEST_TESTCASE(MixedFormats, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    const can_pcan_filter_t ranges[] = { { 0x1800U, 0x2FFFU, 1U }, { 0x1000U, 0x1FFFU, 1U }, { 0x123U, 0x123U, 0U } };
+    const uint32_t sent_xtd[] = { 0x0FFFU, 0x1000U, 0x1FFFU, 0x2000U, 0x2FFFU, 0x3000U, 0x123U };
+    const uint32_t accepted_xtd[] = { 0x1000U, 0x1FFFU, 0x2000U, 0x2FFFU };
+    const uint32_t sent_std[] = { 0x122U, 0x123U, 0x124U, 0x7FFU };
+    const uint32_t accepted_std[] = { 0x123U };
+    CANAPI_Message_t message = {};
+    uint32_t count = 0U;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- set the filter list of DUT1 (2 overlapping 29-bit ranges and one 11-bit identifier)
+    retVal = dut1.SetFilterList(ranges, sizeof(ranges) / sizeof(ranges[0]));
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.SetFilterList() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- the filter list counts the ranges as given
+    retVal = dut1.GetProperty(PCANPROP_GET_FILTER_COUNT, (void*)&count, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(3U, count);
+    // @- send 29-bit identifiers by DUT2 (the last one matches the 11-bit range only)
+    SendIds(dut2, sent_xtd, sizeof(sent_xtd) / sizeof(sent_xtd[0]), true);
+    // @- DUT1 receives only the 29-bit identifiers within the merged range
+    ReceiveIds(dut1, accepted_xtd, sizeof(accepted_xtd) / sizeof(accepted_xtd[0]), true);
+    // @- send 11-bit identifiers by DUT2
+    SendIds(dut2, sent_std, sizeof(sent_std) / sizeof(sent_std[0]), false);
+    // @- DUT1 receives only the 11-bit identifier of the list
+    ReceiveIds(dut1, accepted_std, sizeof(accepted_std) / sizeof(accepted_std[0]), false);
+    // @- nothing else has been received by DUT1
+    retVal = dut1.ReadMessage(message, TEST_READ_TIMEOUT);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxD.2: Set a filter list with invalid ranges or in wrong states
+//
+// @expected: CANERR_ILLPARA resp. CANERR_ONLINE and the filter list unchanged
+//
+TEST_F(FilterList, GTEST_TESTCASE(ParametersAndStates, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    const can_pcan_filter_t ranges[] = { { 0x100U, 0x1FFU, 0U }, { 0x300U, 0x3FFU, 0U } };
+    const can_pcan_filter_t reversed[] = { { 0x1FFU, 0x100U, 0U } };
+    const can_pcan_filter_t too_large[] = { { 0x700U, 0x800U, 0U } };
+    uint32_t count = 0U;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @test:
+    // @- sub(1): first identifier greater than last identifier
+    retVal = dut1.SetFilterList(reversed, 1U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- sub(2): 11-bit range exceeds the 11-bit identifier space
+    retVal = dut1.SetFilterList(too_large, 1U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- no filter list set so far
+    retVal = dut1.GetProperty(PCANPROP_GET_FILTER_COUNT, (void*)&count, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0U, count);
+    // @- sub(3): set a valid filter list
+    retVal = dut1.SetFilterList(ranges, 2U);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    PCBUSB_INIT_DELAY();
+    // @- sub(4): not allowed while started (neither set nor turned off)
+    retVal = dut1.SetFilterList(ranges, 1U);
+    EXPECT_EQ(CCanApi::ControllerOnline, retVal);
+    retVal = dut1.SetFilterList(NULL, 0U);
+    EXPECT_EQ(CCanApi::ControllerOnline, retVal);
+    retVal = dut1.GetProperty(PCANPROP_GET_FILTER_COUNT, (void*)&count, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(2U, count);
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- sub(5): turn the filter list off
+    retVal = dut1.SetFilterList(NULL, 0U);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    retVal = dut1.GetProperty(PCANPROP_GET_FILTER_COUNT, (void*)&count, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0U, count);
+    // @post:
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxD_FilterList.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
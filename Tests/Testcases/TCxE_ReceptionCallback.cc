@@ -0,0 +1,233 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+#define TEST_BATCH    16U
+#define TEST_TIMEOUT  500U  // [msec]
+
+class ReceptionCallback : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // send some frames with a running number, return the number of frames sent
+    static int32_t Sender(CCanDevice &dut, uint32_t id, int32_t frames) {
+        CANAPI_Message_t message = {};
+        int32_t sent = 0;
+        message.id = id;
+        message.dlc = CAN_MAX_DLC;
+        for (int32_t n = 0; n < frames; n++) {
+            message.data[0] = (uint8_t)(n >> 0);
+            message.data[1] = (uint8_t)(n >> 8);
+            message.data[2] = (uint8_t)(n >> 16);
+            message.data[3] = (uint8_t)(n >> 24);
+            if (dut.WriteMessage(message, TEST_WRITE_TIMEOUT) == CCanApi::NoError)
+                sent++;
+        }
+        return sent;
+    }
+};
+
+// @gtest TCxE.0: Reception handler gets all received messages in order and in batches
+//
+// @expected: CANERR_NOERROR and every message once, at most 'batchMax' messages per call
+//
+TEST_F(ReceptionCallback, GTEST_TESTCASE(MessagesInOrderAndInBatches, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Return_t retVal;
+    int32_t frames = g_Options.GetNumberOfTestFrames();
+    std::atomic<int32_t> received(0);
+    std::atomic<int32_t> misordered(0);
+    std::atomic<int32_t> oversized(0);
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- a batch size of zero is rejected
+    retVal = dut2.SetReceiveHandler([](const CANAPI_Message_t *messages, size_t count) { (void)messages; (void)count; }, 0U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- set the reception handler of DUT2 (before the controller is started)
+    retVal = dut2.SetReceiveHandler([&](const CANAPI_Message_t *messages, size_t count) {
+        if (count > TEST_BATCH)
+            oversized++;
+        for (size_t i = 0U; i < count; i++) {
+            int32_t number = (int32_t)((uint32_t)messages[i].data[0] | ((uint32_t)messages[i].data[1] << 8) |
+                                      ((uint32_t)messages[i].data[2] << 16) | ((uint32_t)messages[i].data[3] << 24));
+            if (messages[i].sts || (messages[i].id != 0x123U))
+                continue;
+            if (number != received)
+                misordered++;
+            received++;
+        }
+    }, TEST_BATCH);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- DUT1 sends some frames, the handler of DUT2 receives them
+    EXPECT_EQ(frames, Sender(dut1, 0x123U, frames));
+    auto start = std::chrono::steady_clock::now();
+    while ((received < frames) &&
+           (std::chrono::steady_clock::now() - start) < std::chrono::milliseconds(TEST_TIMEOUT + frames))
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(frames, (int32_t)received);
+    EXPECT_EQ(0, (int32_t)misordered);
+    EXPECT_EQ(0, (int32_t)oversized);
+    // @- the handler has taken the messages from the receive queue
+    CANAPI_Message_t message = {};
+    retVal = dut2.ReadMessage(message, 0U);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    // @- clear the reception handler, no more calls
+    retVal = dut2.SetReceiveHandler(nullptr);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(frames, Sender(dut1, 0x123U, frames));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_EQ(frames, (int32_t)received);
+    // @- the messages remain in the receive queue
+    int32_t remaining = 0;
+    while (dut2.ReadMessage(message, TEST_READ_TIMEOUT) == CCanApi::NoError)
+        remaining += (!message.sts && (message.id == 0x123U)) ? 1 : 0;
+    EXPECT_EQ(frames, remaining);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxE.1: Replace the reception handler while another thread waits on the same channel
+//
+// @expected: CANERR_NOERROR and the blocking read is not aborted (it times out after the full time)
+//
+TEST_F(ReceptionCallback, GTEST_TESTCASE(ReplaceDoesNotAbortBlockingRead, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @- set a reception handler of DUT1 (the callback thread is running)
+    retVal = dut1.SetReceiveHandler([](const CANAPI_Message_t *messages, size_t count) { (void)messages; (void)count; }, TEST_BATCH);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @test:
+    // @- a blocking read on DUT1 (nothing is sent, so it has to time out)
+    CANAPI_Return_t readVal = CCanApi::NoError;
+    long long waited = 0;
+    std::thread reader([&]() {
+        CANAPI_Message_t message = {};
+        auto start = std::chrono::steady_clock::now();
+        readVal = dut1.ReadMessage(message, (uint16_t)TEST_TIMEOUT);
+        waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    });
+    // @- meanwhile the handler is replaced and cleared (this stops the callback thread twice)
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    retVal = dut1.SetReceiveHandler([](const CANAPI_Message_t *messages, size_t count) { (void)messages; (void)count; }, 1U);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    retVal = dut1.SetReceiveHandler(nullptr);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    reader.join();
+    EXPECT_EQ(CCanApi::ReceiverEmpty, readVal);
+    EXPECT_GE(waited, (long long)TEST_TIMEOUT - 1);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxE_ReceptionCallback.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
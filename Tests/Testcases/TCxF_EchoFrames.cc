@@ -0,0 +1,292 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#define TEST_FRAMES   32
+#define TEST_ID       0x456U
+
+class EchoFrames : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    static void Message(CANAPI_Message_t &message, int i) {
+        memset(&message, 0, sizeof(CANAPI_Message_t));
+        message.id = TEST_ID;
+        message.dlc = 2U;
+        message.data[0] = (uint8_t)i;
+        message.data[1] = (uint8_t)(i >> 8);
+    }
+};
+
+// @gtest TCxF.0: Transmit messages with echo frames turned on
+//
+// @expected: an echo frame per message sent and the write-to-bus latency of all messages
+//
+TEST_F(EchoFrames, GTEST_TESTCASE(EchoOfTransmittedMessages, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t message = {};
+    can_pcan_latency_t latency = {};
+    uint64_t histogram[PCAN_LATENCY_BINS] = {};
+    uint64_t total = 0U;
+    uint8_t echo = 1U;
+    uint8_t flags = 0U;
+    uint64_t nsec = 0U;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- turn echo frames of DUT1 on
+    retVal = dut1.SetProperty(PCANPROP_SET_TX_ECHO, (void*)&echo, sizeof(uint8_t));
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.SetProperty(PCANPROP_SET_TX_ECHO) failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- send some messages by DUT1 and read their echo frames
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        Message(message, i);
+        retVal = dut1.WriteMessage(message, TEST_WRITE_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.WriteMessage() failed with error code " << retVal;
+        retVal = dut1.ReadMessage(message, nsec, flags, TEST_READ_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ReadMessage() failed with error code " << retVal;
+        EXPECT_EQ(PCAN_MSGFLAG_ECHO, flags);
+        EXPECT_EQ(TEST_ID, message.id);
+        EXPECT_EQ((uint8_t)i, message.data[0]);
+        EXPECT_EQ((uint8_t)(i >> 8), message.data[1]);
+    }
+    // @- DUT2 receives them (w/o echo flag)
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        retVal = dut2.ReadMessage(message, nsec, flags, TEST_READ_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ReadMessage() failed with error code " << retVal;
+        EXPECT_EQ(0U, flags);
+        EXPECT_EQ((uint8_t)i, message.data[0]);
+    }
+    // @- all messages have been confirmed by their echo frame
+    retVal = dut1.GetProperty(PCANPROP_GET_TX_LATENCY, (void*)&latency, sizeof(can_pcan_latency_t));
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.GetProperty(PCANPROP_GET_TX_LATENCY) failed with error code " << retVal;
+    EXPECT_EQ((uint64_t)TEST_FRAMES, latency.count);
+    EXPECT_EQ(0U, latency.unmatched);
+    EXPECT_LE(latency.min, latency.avg);
+    EXPECT_LE(latency.avg, latency.max);
+    // @- the latency histogram counts all of them
+    retVal = dut1.GetProperty(PCANPROP_GET_TX_LATENCY_HIST, (void*)histogram, sizeof(histogram));
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.GetProperty(PCANPROP_GET_TX_LATENCY_HIST) failed with error code " << retVal;
+    for (int i = 0; i < PCAN_LATENCY_BINS; i++)
+        total += histogram[i];
+    EXPECT_EQ((uint64_t)TEST_FRAMES, total);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxF.1: Transmit messages with echo frames turned off (default)
+//
+// @expected: no echo frames received and no latency statistics available
+//
+TEST_F(EchoFrames, GTEST_TESTCASE(EchoFramesTurnedOff, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t message = {};
+    can_pcan_latency_t latency = {};
+    uint64_t histogram[PCAN_LATENCY_BINS] = {};
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- send some messages by DUT1
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        Message(message, i);
+        retVal = dut1.WriteMessage(message, TEST_WRITE_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.WriteMessage() failed with error code " << retVal;
+    }
+    // @- DUT2 receives them
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        retVal = dut2.ReadMessage(message, TEST_READ_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ReadMessage() failed with error code " << retVal;
+        EXPECT_EQ((uint8_t)i, message.data[0]);
+    }
+    // @- DUT1 receives no echo frames
+    retVal = dut1.ReadMessage(message, TEST_READ_TIMEOUT);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    // @- no latency statistics w/o echo frames
+    retVal = dut1.GetProperty(PCANPROP_GET_TX_LATENCY, (void*)&latency, sizeof(can_pcan_latency_t));
+    EXPECT_EQ(CCanApi::NotSupported, retVal);
+    retVal = dut1.GetProperty(PCANPROP_GET_TX_LATENCY_HIST, (void*)histogram, sizeof(histogram));
+    EXPECT_EQ(CCanApi::NotSupported, retVal);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxF.2: Turn echo frames on or off in wrong states or with invalid parameters
+//
+// @expected: CANERR_ONLINE resp. CANERR_ILLPARA
+//
+TEST_F(EchoFrames, GTEST_TESTCASE(ParametersAndStates, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    can_pcan_latency_t latency = {};
+    uint64_t histogram[PCAN_LATENCY_BINS] = {};
+    uint8_t echo = 1U;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @test:
+    // @- sub(1): turn echo frames on (not started)
+    retVal = dut1.SetProperty(PCANPROP_SET_TX_ECHO, (void*)&echo, sizeof(uint8_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    PCBUSB_INIT_DELAY();
+    // @- sub(2): not allowed while started
+    echo = 0U;
+    retVal = dut1.SetProperty(PCANPROP_SET_TX_ECHO, (void*)&echo, sizeof(uint8_t));
+    EXPECT_EQ(CCanApi::ControllerOnline, retVal);
+    // @- sub(3): buffers too small
+    retVal = dut1.GetProperty(PCANPROP_GET_TX_LATENCY, (void*)&latency, sizeof(can_pcan_latency_t) - 1U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    retVal = dut1.GetProperty(PCANPROP_GET_TX_LATENCY_HIST, (void*)histogram, sizeof(histogram) - 1U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- sub(4): no messages sent so far
+    retVal = dut1.GetProperty(PCANPROP_GET_TX_LATENCY, (void*)&latency, sizeof(can_pcan_latency_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0U, latency.count);
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- sub(5): turn echo frames off (stopped)
+    retVal = dut1.SetProperty(PCANPROP_SET_TX_ECHO, (void*)&echo, sizeof(uint8_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    retVal = dut1.GetProperty(PCANPROP_GET_TX_LATENCY, (void*)&latency, sizeof(can_pcan_latency_t));
+    EXPECT_EQ(CCanApi::NotSupported, retVal);
+    // @post:
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxF_EchoFrames.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
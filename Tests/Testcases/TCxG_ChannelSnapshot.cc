@@ -0,0 +1,185 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#if (OPTION_CANAPI_LIBRARY != 0)
+#define TEST_GET_LIBRARY_ID(dut, arg)  g_Options.GetLibraryId(dut), (arg)
+#else
+#define TEST_GET_LIBRARY_ID(dut, arg)  (arg)
+#endif
+#define CHANNEL_AVAILABLE  0x01U  // PCAN_CHANNEL_AVAILABLE (PCANBasic.h)
+#define CHANNEL_OCCUPIED   0x02U  // PCAN_CHANNEL_OCCUPIED (PCANBasic.h)
+
+class ChannelSnapshot : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // look up a channel in the interface list and get its snapshot data
+    // note: 'lib' must not be initialized, i.e. it queries library properties
+    static CANAPI_Return_t ChannelInfo(CCanDevice &lib, int32_t channel, can_pcan_channel_t &info) {
+        CCanApi::SChannelInfo entry = {};
+        bool found = CCanDevice::GetFirstChannel(TEST_GET_LIBRARY_ID(DUT1, entry));
+        while (found) {
+            if (entry.m_nChannelNo == channel)
+                return lib.GetProperty(PCANPROP_GET_CHANNEL_INFO, (void*)&info, sizeof(can_pcan_channel_t));
+            found = CCanDevice::GetNextChannel(entry);
+        }
+        return CCanApi::ResourceError;
+    }
+};
+
+// @gtest TCxG.0: Get the snapshot data of all channels in the interface list
+//
+// @expected: snapshot data for each listed channel with its channel no. and an available or occupied condition
+//
+TEST_F(ChannelSnapshot, GTEST_TESTCASE(ListedChannels, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    CCanDevice lib = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::SChannelInfo entry = {};
+    can_pcan_channel_t info = {};
+    int listed = 0;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @test:
+    // @- take a new snapshot of the attached channels
+    retVal = CCanDevice::RefreshChannels();
+    if (CCanApi::NotSupported == retVal) {
+        (void)dut1.TeardownChannel();
+        GTEST_SKIP() << "PCAN_ATTACHED_CHANNELS not supported by the driver";
+    }
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] CCanDevice::RefreshChannels() failed with error code " << retVal;
+    // @- loop over the list of devices and get their snapshot data
+    bool found = CCanDevice::GetFirstChannel(TEST_GET_LIBRARY_ID(DUT1, entry));
+    while (found) {
+        retVal = lib.GetProperty(PCANPROP_GET_CHANNEL_INFO, (void*)&info, sizeof(can_pcan_channel_t));
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        EXPECT_EQ(entry.m_nChannelNo, info.channel);
+        EXPECT_NE(0U, info.condition & (CHANNEL_AVAILABLE | CHANNEL_OCCUPIED));
+        listed++;
+        // next please
+        found = CCanDevice::GetNextChannel(entry);
+    }
+    // @- DUT1 is in the snapshot
+    EXPECT_GE(listed, 1);
+    retVal = ChannelInfo(lib, g_Options.GetChannelNo(DUT1), info);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(g_Options.GetChannelNo(DUT1), info.channel);
+    // @- sub(1): buffer too small
+    retVal = lib.GetProperty(PCANPROP_GET_CHANNEL_INFO, (void*)&info, sizeof(can_pcan_channel_t) - 1U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @post:
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxG.1: Get the snapshot data of a channel while initialized and after torn down
+//
+// @expected: the condition of DUT1 changes from occupied to available, and it is probed accordingly
+//
+TEST_F(ChannelSnapshot, GTEST_TESTCASE(InitializedAndTornDown, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    CCanDevice lib = CCanDevice(TEST_DEVICE(DUT1));
+    can_pcan_channel_t info = {};
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @test:
+    // @- take a new snapshot of the attached channels
+    retVal = CCanDevice::RefreshChannels();
+    if (CCanApi::NotSupported == retVal) {
+        (void)dut1.TeardownChannel();
+        GTEST_SKIP() << "PCAN_ATTACHED_CHANNELS not supported by the driver";
+    }
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] CCanDevice::RefreshChannels() failed with error code " << retVal;
+    // @- DUT1 is occupied (by this test) resp. probed as occupied
+    retVal = ChannelInfo(lib, g_Options.GetChannelNo(DUT1), info);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] DUT1 not found in the snapshot";
+    EXPECT_EQ(CHANNEL_OCCUPIED, info.condition & CHANNEL_OCCUPIED);
+    retVal = lib.ProbeChannel(state);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(CCanApi::ChannelOccupied, state);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- DUT1 is probed as available again (the snapshot is taken anew)
+    retVal = lib.ProbeChannel(state);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(CCanApi::ChannelAvailable, state);
+    retVal = ChannelInfo(lib, g_Options.GetChannelNo(DUT1), info);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] DUT1 not found in the snapshot";
+    EXPECT_EQ(CHANNEL_AVAILABLE, info.condition);
+    // @- initialize DUT1 with configured settings (again)
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @post:
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxG_ChannelSnapshot.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
@@ -0,0 +1,294 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#define TEST_RESTARTS  3
+
+class ControllerResume : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // get both restart counters of a device
+    static void Restarts(CCanDevice &dut, uint64_t &full, uint64_t &fast) {
+        CANAPI_Return_t retVal;
+        full = fast = (uint64_t)-1;
+        retVal = dut.GetProperty(PCANPROP_GET_RESTART_FULL, (void*)&full, sizeof(uint64_t));
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        retVal = dut.GetProperty(PCANPROP_GET_RESTART_FAST, (void*)&fast, sizeof(uint64_t));
+        EXPECT_EQ(CCanApi::NoError, retVal);
+    }
+};
+
+// @gtest TCxH.0: Restart the CAN controller with the same configuration
+//
+// @expected: the CAN controller is resumed (fast restart) and messages are sent and received as before
+//
+TEST_F(ControllerResume, GTEST_TESTCASE(SameConfiguration, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    int32_t frames = g_Options.GetNumberOfTestFrames();
+    uint64_t full = 0U, fast = 0U;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- the first start has been a full restart
+    Restarts(dut1, full, fast);
+    EXPECT_EQ(1U, full);
+    EXPECT_EQ(0U, fast);
+    // @- loop over some restarts with the same configuration
+    for (int i = 1; i <= TEST_RESTARTS; i++) {
+        // @-- stop/reset DUT1
+        retVal = dut1.ResetController();
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        // @-- start DUT1 with configured bit-rate settings (again)
+        retVal = dut1.StartController();
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+        // @-- the CAN controller has been resumed
+        Restarts(dut1, full, fast);
+        EXPECT_EQ(1U, full);
+        EXPECT_EQ((uint64_t)i, fast);
+        // @-- send some frames to DUT2 and receive some frames from DUT2
+        EXPECT_EQ(frames, dut1.SendSomeFrames(dut2, frames));
+        EXPECT_EQ(frames, dut1.ReceiveSomeFrames(dut2, frames));
+    }
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxH.1: Restart the CAN controller with a changed acceptance filter resp. echo frames
+//
+// @expected: the CAN controller is reinitialized (full restart) for each change only
+//
+TEST_F(ControllerResume, GTEST_TESTCASE(ChangedConfiguration, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    int32_t frames = g_Options.GetNumberOfTestFrames();
+    uint64_t full = 0U, fast = 0U;
+    uint8_t echo = 1U;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- the first start has been a full restart
+    Restarts(dut1, full, fast);
+    EXPECT_EQ(1U, full);
+    EXPECT_EQ(0U, fast);
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- set 11-bit filter (code 0x000 and mask 0x000, i.e. all 11-bit identifiers accepted)
+    retVal = dut1.SetFilter11Bit(0x000U, 0x000U);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT1 with configured bit-rate settings (again)
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- the CAN controller has been reinitialized (filter changed)
+    Restarts(dut1, full, fast);
+    EXPECT_EQ(2U, full);
+    EXPECT_EQ(0U, fast);
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT1 with configured bit-rate settings (again)
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- the CAN controller has been resumed (same filter)
+    Restarts(dut1, full, fast);
+    EXPECT_EQ(2U, full);
+    EXPECT_EQ(1U, fast);
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- turn echo frames of DUT1 on
+    retVal = dut1.SetProperty(PCANPROP_SET_TX_ECHO, (void*)&echo, sizeof(uint8_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT1 with configured bit-rate settings (again)
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- the CAN controller has been reinitialized (echo frames turned on)
+    Restarts(dut1, full, fast);
+    EXPECT_EQ(3U, full);
+    EXPECT_EQ(1U, fast);
+    // @- receive some frames from DUT2 (no echo frames, DUT1 sends nothing)
+    EXPECT_EQ(frames, dut1.ReceiveSomeFrames(dut2, frames));
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxH.2: Get the restart counters before the first start and after re-initialization
+//
+// @expected: both counters are zero after initialization of the channel
+//
+TEST_F(ControllerResume, GTEST_TESTCASE(CountersOfChannel, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    uint64_t full = 0U, fast = 0U;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @test:
+    // @- not started yet
+    Restarts(dut1, full, fast);
+    EXPECT_EQ(0U, full);
+    EXPECT_EQ(0U, fast);
+    // @- start, stop and start DUT1
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    PCBUSB_INIT_DELAY();
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    Restarts(dut1, full, fast);
+    EXPECT_EQ(1U, full);
+    EXPECT_EQ(1U, fast);
+    // @- sub(1): buffer too small
+    retVal = dut1.GetProperty(PCANPROP_GET_RESTART_FULL, (void*)&full, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    retVal = dut1.GetProperty(PCANPROP_GET_RESTART_FAST, (void*)&fast, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- tear down and initialize DUT1 again
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- both counters start from zero
+    Restarts(dut1, full, fast);
+    EXPECT_EQ(0U, full);
+    EXPECT_EQ(0U, fast);
+    // @post:
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxH_ControllerResume.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
@@ -0,0 +1,245 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+#include "PeakCAN_Extensions.h"
+
+class PropertySnapshot : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // compare a snapshot with the single properties (nothing sent or received in between)
+    static void Compare(CCanDevice &dut, const can_pcan_snapshot_t &snapshot) {
+        CANAPI_Return_t retVal;
+        CANAPI_Status_t status = {};
+        uint64_t counter = 0U, filter = 0U;
+        uint8_t mode = 0U;
+        EXPECT_EQ((uint16_t)PCAN_SNAPSHOT_VERSION, snapshot.version);
+        EXPECT_EQ((uint16_t)sizeof(can_pcan_snapshot_t), snapshot.size);
+        retVal = dut.GetStatus(status);
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        EXPECT_EQ(status.byte, snapshot.status);
+        retVal = dut.GetProperty(CANPROP_GET_OP_MODE, (void*)&mode, sizeof(uint8_t));
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        EXPECT_EQ(mode, snapshot.mode);
+        retVal = dut.GetProperty(CANPROP_GET_TX_COUNTER, (void*)&counter, sizeof(uint64_t));
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        EXPECT_EQ(counter, snapshot.tx);
+        retVal = dut.GetProperty(CANPROP_GET_RX_COUNTER, (void*)&counter, sizeof(uint64_t));
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        EXPECT_EQ(counter, snapshot.rx);
+        retVal = dut.GetProperty(CANPROP_GET_ERR_COUNTER, (void*)&counter, sizeof(uint64_t));
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        EXPECT_EQ(counter, snapshot.err);
+        retVal = dut.GetProperty(CANPROP_GET_FILTER_11BIT, (void*)&filter, sizeof(uint64_t));
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        EXPECT_EQ(filter, snapshot.filter_11bit);
+        retVal = dut.GetProperty(CANPROP_GET_FILTER_29BIT, (void*)&filter, sizeof(uint64_t));
+        EXPECT_EQ(CCanApi::NoError, retVal);
+        EXPECT_EQ(filter, snapshot.filter_29bit);
+    }
+};
+
+// @gtest TCxI.0: Get a property snapshot after messages have been sent and received
+//
+// @expected: the snapshot equals the single properties
+//
+TEST_F(PropertySnapshot, GTEST_TESTCASE(WhileRunning, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    int32_t frames = g_Options.GetNumberOfTestFrames();
+    can_pcan_snapshot_t snapshot = {};
+    CANAPI_Bitrate_t bitrate = {};
+    CANAPI_BusSpeed_t speed = {};
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- send some frames to DUT2 and receive some frames from DUT2
+    EXPECT_EQ(frames, dut1.SendSomeFrames(dut2, frames));
+    EXPECT_EQ(frames, dut1.ReceiveSomeFrames(dut2, frames));
+    // @- get a property snapshot of DUT1
+    retVal = dut1.GetProperty(PCANPROP_GET_SNAPSHOT, (void*)&snapshot, sizeof(can_pcan_snapshot_t));
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.GetProperty(PCANPROP_GET_SNAPSHOT) failed with error code " << retVal;
+    // @- compare it with the single properties
+    Compare(dut1, snapshot);
+    EXPECT_FALSE((snapshot.status & CANSTAT_RESET) ? true : false);
+    EXPECT_EQ((uint64_t)frames, snapshot.tx);
+    EXPECT_EQ((uint64_t)frames, snapshot.rx);
+    // @- the bit-rate is the one of the last full restart (w/o driver call)
+    retVal = dut1.GetBitrate(bitrate);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    retVal = dut1.GetBusSpeed(speed);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(speed.nominal.speed, snapshot.speed.nominal.speed);
+    EXPECT_EQ(speed.data.speed, snapshot.speed.data.speed);
+    if (bitrate.index > 0)
+        EXPECT_EQ(0, memcmp(&bitrate.btr, &snapshot.bitrate.btr, sizeof(bitrate.btr)));
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxI.1: Get a property snapshot before the first start and after the CAN controller has been stopped
+//
+// @expected: the snapshot equals the single properties and the status tells the controller is stopped
+//
+TEST_F(PropertySnapshot, GTEST_TESTCASE(WhileStopped, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    can_pcan_snapshot_t snapshot = {};
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @test:
+    // @- sub(1): not started yet
+    retVal = dut1.GetProperty(PCANPROP_GET_SNAPSHOT, (void*)&snapshot, sizeof(can_pcan_snapshot_t));
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.GetProperty(PCANPROP_GET_SNAPSHOT) failed with error code " << retVal;
+    Compare(dut1, snapshot);
+    EXPECT_TRUE((snapshot.status & CANSTAT_RESET) ? true : false);
+    EXPECT_EQ(0U, snapshot.busload);
+    EXPECT_EQ(0U, snapshot.tx);
+    EXPECT_EQ(0U, snapshot.rx);
+    // @- set 11-bit filter (code 0x100 and mask 0x700)
+    retVal = dut1.SetFilter11Bit(0x100U, 0x700U);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start and stop DUT1
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    PCBUSB_INIT_DELAY();
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- sub(2): stopped (with the 11-bit filter written to the device)
+    retVal = dut1.GetProperty(PCANPROP_GET_SNAPSHOT, (void*)&snapshot, sizeof(can_pcan_snapshot_t));
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.GetProperty(PCANPROP_GET_SNAPSHOT) failed with error code " << retVal;
+    Compare(dut1, snapshot);
+    EXPECT_TRUE((snapshot.status & CANSTAT_RESET) ? true : false);
+    EXPECT_EQ(0U, snapshot.busload);
+    EXPECT_EQ(((uint64_t)0x100U << 32) | (uint64_t)0x700U, snapshot.filter_11bit);
+    // @post:
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxI.2: Get a property snapshot with invalid parameters
+//
+// @expected: CANERR_NULLPTR resp. CANERR_ILLPARA
+//
+TEST_F(PropertySnapshot, GTEST_TESTCASE(InvalidParameters, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    can_pcan_snapshot_t snapshot = {};
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @test:
+    // @- sub(1): null-pointer
+    retVal = dut1.GetProperty(PCANPROP_GET_SNAPSHOT, NULL, sizeof(can_pcan_snapshot_t));
+    EXPECT_EQ(CCanApi::NullPointer, retVal);
+    // @- sub(2): buffer too small
+    retVal = dut1.GetProperty(PCANPROP_GET_SNAPSHOT, (void*)&snapshot, sizeof(can_pcan_snapshot_t) - 1U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @post:
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxI_PropertySnapshot.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
@@ -0,0 +1,296 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#define TEST_SAMPLES    30
+#define TEST_INTERVAL   (20U * CTimer::MSEC)
+#define TEST_TOLERANCE  0.010  // in [sec]
+
+class TimeMapping : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    // send one message by DUT2 and read it by DUT1
+    static void Exchange(CCanDevice &sender, CCanDevice &receiver, int i, CANAPI_Message_t &message) {
+        CANAPI_Return_t retVal;
+        memset(&message, 0, sizeof(CANAPI_Message_t));
+        message.id = 0x100U;
+        message.dlc = 1U;
+        message.data[0] = (uint8_t)i;
+        retVal = sender.WriteMessage(message, TEST_WRITE_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.WriteMessage() failed with error code " << retVal;
+        retVal = receiver.ReadMessage(message, TEST_READ_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ReadMessage() failed with error code " << retVal;
+        EXPECT_EQ((uint8_t)i, message.data[0]);
+    }
+    // select the time base of DUT1 (if stopped)
+    static CANAPI_Return_t TimeMode(CCanDevice &dut, uint8_t mode) {
+        return dut.SetProperty(PCANPROP_SET_TIME_MODE, (void*)&mode, sizeof(uint8_t));
+    }
+};
+
+// @gtest TCxJ.0: Receive messages with time-stamps mapped onto the wall-clock time
+//
+// @expected: each time-stamp lies between the host time before sending and after reading the message
+//
+TEST_F(TimeMapping, GTEST_TESTCASE(RealtimeTimeStamps, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t message = {};
+    struct timespec before, after;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- select the wall-clock time as time base of DUT1
+    retVal = TimeMode(dut1, PCAN_TIME_REALTIME);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.SetProperty(PCANPROP_SET_TIME_MODE) failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- loop over some messages sent by DUT2 and received by DUT1
+    for (int i = 0; i < TEST_SAMPLES; i++) {
+        before = CTimer::GetTime();
+        Exchange(dut2, dut1, i, message);
+        after = CTimer::GetTime();
+        // @-- the time-stamp is within the host time of the exchange
+        EXPECT_GE(CTimer::DiffTime(before, message.timestamp), -TEST_TOLERANCE);
+        EXPECT_GE(CTimer::DiffTime(message.timestamp, after), -TEST_TOLERANCE);
+        CTimer::Delay(TEST_INTERVAL);
+    }
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxJ.1: Receive messages with time-stamps mapped onto the monotonic host clock
+//
+// @expected: time-stamps increase with the host time, a plausible skew and jitter, both reset by a restart
+//
+TEST_F(TimeMapping, GTEST_TESTCASE(MonotonicTimeStamps, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t message = {};
+    struct timespec previous = {}, now, last = {};
+    int32_t skew = INT32_MAX;
+    uint32_t jitter = UINT32_MAX;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- select the monotonic host clock as time base of DUT1
+    retVal = TimeMode(dut1, PCAN_TIME_MONOTONIC);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.SetProperty(PCANPROP_SET_TIME_MODE) failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- nothing received so far, i.e. no skew and no jitter
+    retVal = dut1.GetProperty(PCANPROP_GET_TIME_SKEW, (void*)&skew, sizeof(int32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0, skew);
+    retVal = dut1.GetProperty(PCANPROP_GET_TIME_JITTER, (void*)&jitter, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0U, jitter);
+    // @- loop over some messages sent by DUT2 and received by DUT1 (several sampling windows)
+    for (int i = 0; i < TEST_SAMPLES; i++) {
+        Exchange(dut2, dut1, i, message);
+        now = CTimer::GetTime();
+        // @-- the time-stamps advance like the host time
+        if (i > 0) {
+            EXPECT_GT(CTimer::DiffTime(previous, message.timestamp), 0.0);
+            EXPECT_NEAR(CTimer::DiffTime(last, now), CTimer::DiffTime(previous, message.timestamp), TEST_TOLERANCE);
+        }
+        previous = message.timestamp;
+        last = now;
+        CTimer::Delay(TEST_INTERVAL);
+    }
+    // @- the skew of the device clock is plausible (1000 ppm at most)
+    retVal = dut1.GetProperty(PCANPROP_GET_TIME_SKEW, (void*)&skew, sizeof(int32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_LE(skew, 1000000);
+    EXPECT_GE(skew, -1000000);
+    // @- the residual jitter is below the tolerance
+    retVal = dut1.GetProperty(PCANPROP_GET_TIME_JITTER, (void*)&jitter, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_LT((double)jitter / 1000000000.0, TEST_TOLERANCE);
+    // @- stop/reset and start DUT1 again (the mapping is restarted)
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    retVal = dut1.GetProperty(PCANPROP_GET_TIME_SKEW, (void*)&skew, sizeof(int32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0, skew);
+    retVal = dut1.GetProperty(PCANPROP_GET_TIME_JITTER, (void*)&jitter, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0U, jitter);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxJ.2: Select the time base with invalid parameters or in wrong states
+//
+// @expected: CANERR_ILLPARA resp. CANERR_ONLINE
+//
+TEST_F(TimeMapping, GTEST_TESTCASE(ParametersAndStates, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    int32_t skew = INT32_MAX;
+    uint32_t jitter = UINT32_MAX;
+    CANAPI_Return_t retVal;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @test:
+    // @- sub(1): unknown time base
+    retVal = TimeMode(dut1, PCAN_TIME_REALTIME + 1U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- sub(2): buffers too small
+    retVal = dut1.GetProperty(PCANPROP_GET_TIME_SKEW, (void*)&skew, sizeof(int16_t));
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    retVal = dut1.GetProperty(PCANPROP_GET_TIME_JITTER, (void*)&jitter, sizeof(uint16_t));
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- sub(3): select the device clock (default)
+    retVal = TimeMode(dut1, PCAN_TIME_DEVICE);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    PCBUSB_INIT_DELAY();
+    // @- sub(4): not allowed while started
+    retVal = TimeMode(dut1, PCAN_TIME_MONOTONIC);
+    EXPECT_EQ(CCanApi::ControllerOnline, retVal);
+    // @- sub(5): no mapping with the device clock
+    retVal = dut1.GetProperty(PCANPROP_GET_TIME_SKEW, (void*)&skew, sizeof(int32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0, skew);
+    retVal = dut1.GetProperty(PCANPROP_GET_TIME_JITTER, (void*)&jitter, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0U, jitter);
+    // @post:
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxJ_TimeMapping.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
@@ -0,0 +1,188 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#define TEST_FRAMES      100
+#define TEST_QUEUE_SIZE  256U
+#define LOW_PRIORITY_ID  0x700U  // priority class 7
+#define HIGH_PRIORITY_ID 0x010U  // priority class 0
+
+class TransmitQueue : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    static uint64_t GetTxCounter(CCanDevice &dut) {
+        uint64_t value = 0U;
+        (void)dut.GetProperty(CANPROP_GET_TX_COUNTER, (void*)&value, sizeof(uint64_t));
+        return value;
+    }
+};
+
+// @gtest TCxK.0: Software transmit queue sends urgent messages first and books them when handed to the driver
+//
+// @expected: CANERR_NOERROR and the high-priority message overtakes the queued low-priority messages
+//
+TEST_F(TransmitQueue, GTEST_TESTCASE(PriorityOrderAndAccounting, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t trmMsg = {};
+    CANAPI_Message_t rcvMsg = {};
+    CANAPI_Return_t retVal;
+    can_pcan_queuing_t queuing[PCAN_TRMQ_CLASSES];
+    uint32_t size = TEST_QUEUE_SIZE;
+    uint32_t value32 = 0U;
+    uint64_t value64 = 0U;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- w/o a software transmit queue its properties are not supported
+    retVal = dut1.GetProperty(PCANPROP_GET_TRM_QUEUE_DROPPED, (void*)&value64, sizeof(uint64_t));
+    EXPECT_EQ(CCanApi::NotSupported, retVal);
+    // @- set the size of the software transmit queue of DUT1 (while stopped)
+    retVal = dut1.SetProperty(PCANPROP_SET_TRM_QUEUE_SIZE, (void*)&size, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- sub(1): the size cannot be changed while started
+    retVal = dut1.SetProperty(PCANPROP_SET_TRM_QUEUE_SIZE, (void*)&size, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::ControllerOnline, retVal);
+    retVal = dut1.GetProperty(CANPROP_GET_TRM_QUEUE_SIZE, (void*)&value32, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(TEST_QUEUE_SIZE, value32);
+    // @- sub(2): an invalid message is refused when written, not dropped later
+    trmMsg.id = CAN_MAX_STD_ID + 1U;
+    trmMsg.dlc = CAN_MAX_DLC;
+    retVal = dut1.WriteMessage(trmMsg, 0U);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- sub(3): queue low-priority messages, then one high-priority message
+    trmMsg.id = LOW_PRIORITY_ID;
+    for (int i = 0; i < TEST_FRAMES; i++) {
+        trmMsg.data[0] = (uint8_t)i;
+        retVal = dut1.WriteMessage(trmMsg, 0U);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.WriteMessage() failed with error code " << retVal;
+    }
+    trmMsg.id = HIGH_PRIORITY_ID;
+    retVal = dut1.WriteMessage(trmMsg, 0U);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- messages are booked when handed to the driver, not when queued
+    // @  (about 1 ms of bus time is handed over in advance)
+    EXPECT_LT(GetTxCounter(dut1), (uint64_t)(TEST_FRAMES + 1));
+    // @- DUT2 receives the high-priority message early, the others in FIFO order
+    int position = -1, last = -1;
+    bool fifo = true;
+    for (int n = 0; n < (TEST_FRAMES + 1); n++) {
+        retVal = dut2.ReadMessage(rcvMsg, TEST_READ_TIMEOUT * 10U);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ReadMessage() failed with error code " << retVal;
+        if (rcvMsg.id == HIGH_PRIORITY_ID)
+            position = n;
+        else {
+            fifo = fifo && ((int)rcvMsg.data[0] == (last + 1));
+            last = (int)rcvMsg.data[0];
+        }
+    }
+    EXPECT_GE(position, 0);
+    EXPECT_LT(position, 10);
+    EXPECT_TRUE(fifo);
+    // @- all messages have been booked and none has been dropped
+    EXPECT_EQ((uint64_t)(TEST_FRAMES + 1), GetTxCounter(dut1));
+    retVal = dut1.GetProperty(PCANPROP_GET_TRM_QUEUE_DROPPED, (void*)&value64, sizeof(uint64_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(0U, value64);
+    // @- queuing latency per priority class
+    retVal = dut1.GetProperty(PCANPROP_GET_TRM_QUEUE_LATENCY, (void*)queuing, sizeof(queuing));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(1U, queuing[0].count);
+    EXPECT_EQ((uint64_t)TEST_FRAMES, queuing[7].count);
+    EXPECT_LE(queuing[7].min, queuing[7].avg);
+    EXPECT_LE(queuing[7].avg, queuing[7].max);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- switch the software transmit queue off again
+    size = 0U;
+    retVal = dut1.SetProperty(PCANPROP_SET_TRM_QUEUE_SIZE, (void*)&size, sizeof(uint32_t));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxK_TransmitQueue.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
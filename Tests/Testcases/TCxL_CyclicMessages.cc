@@ -0,0 +1,236 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+
+#include <thread>
+#include <chrono>
+
+#define TEST_FRAMES    20
+#define TEST_TIMEOUT   100U    // [msec]
+#define FAST_ID        0x100U
+#define FAST_PERIOD    10000U  // [usec]
+#define SLOW_ID        0x200U
+#define SLOW_PERIOD    20000U  // [usec]
+
+class CyclicMessages : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    static CANAPI_Message_t Message(uint32_t id, uint8_t data) {
+        CANAPI_Message_t message = {};
+        message.id = id;
+        message.dlc = 1U;
+        message.data[0] = data;
+        return message;
+    }
+};
+
+// @gtest TCxL.0: Cyclic messages are sent at their period and stop when removed
+//
+// @expected: CANERR_NOERROR and the number of messages received matches the periods and the statistics
+//
+TEST_F(CyclicMessages, GTEST_TESTCASE(PeriodUpdateAndRemove, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanDevice dut2 = CCanDevice(TEST_DEVICE(DUT2));
+    CCanApi::EChannelState state;
+    CANAPI_Message_t message = {};
+    CANAPI_Return_t retVal;
+    can_pcan_cyclic_t stats = {};
+    int fast = -1, slow = -1;
+    int nFast = 0, nSlow = 0;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- probe if DUT2 is present and not occupied
+    retVal = dut2.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT2) << " is not available";
+    // @- check if different channels have been selected
+    ASSERT_TRUE((g_Options.GetChannelNo(DUT1) != g_Options.GetChannelNo(DUT2)) || \
+                (g_Options.GetLibraryId(DUT1) != g_Options.GetLibraryId(DUT2))) << "[  ERROR!  ] same channel selected twice";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- initialize DUT2 with configured settings
+    retVal = dut2.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT2 with configured bit-rate settings
+    retVal = dut2.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.StartController() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- sub(1): a period shorter than the time grid is refused
+    retVal = dut1.AddCyclic(Message(FAST_ID, 0x00U), 100U, 0U, fast);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    // @- sub(2): add two cyclic messages with different periods
+    retVal = dut1.AddCyclic(Message(FAST_ID, 0x00U), FAST_PERIOD, 0U, fast);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.AddCyclic() failed with error code " << retVal;
+    retVal = dut1.AddCyclic(Message(SLOW_ID, 0x00U), SLOW_PERIOD, 0U, slow);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.AddCyclic() failed with error code " << retVal;
+    EXPECT_NE(fast, slow);
+    // @- receive a number of the fast message and count the slow ones
+    while (nFast < TEST_FRAMES) {
+        retVal = dut2.ReadMessage(message, TEST_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ReadMessage() failed with error code " << retVal;
+        if (message.id == FAST_ID)
+            nFast++;
+        else if (message.id == SLOW_ID)
+            nSlow++;
+    }
+    // @- the slow message is sent about half as often
+    EXPECT_GE(nSlow, (TEST_FRAMES / 2) - 3);
+    EXPECT_LE(nSlow, (TEST_FRAMES / 2) + 3);
+    // @- sub(3): the statistics tell the transmissions and lateness
+    retVal = dut1.GetCyclicStatistics(fast, stats);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(FAST_PERIOD, stats.period);
+    EXPECT_GE(stats.sent, (uint64_t)TEST_FRAMES);
+    EXPECT_LE(stats.avg, stats.max);
+    // @- sub(4): update the content of the fast message
+    retVal = dut1.UpdateCyclic(fast, Message(FAST_ID, 0xAAU));
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    bool updated = false;
+    for (int i = 0; (i < TEST_FRAMES) && !updated; i++) {
+        retVal = dut2.ReadMessage(message, TEST_TIMEOUT);
+        ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut2.ReadMessage() failed with error code " << retVal;
+        updated = (message.id == FAST_ID) && (message.data[0] == 0xAAU);
+    }
+    EXPECT_TRUE(updated);
+    // @- sub(5): remove both messages, then nothing is sent anymore
+    retVal = dut1.RemoveCyclic(fast);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    retVal = dut1.RemoveCyclic(slow);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    retVal = dut1.GetCyclicStatistics(fast, stats);
+    EXPECT_EQ(CCanApi::IllegalParameter, retVal);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * SLOW_PERIOD / 1000));
+    while (dut2.ReadMessage(message, 0U) == CCanApi::NoError)
+        ;
+    std::this_thread::sleep_for(std::chrono::milliseconds(2 * SLOW_PERIOD / 1000));
+    retVal = dut2.ReadMessage(message, 0U);
+    EXPECT_EQ(CCanApi::ReceiverEmpty, retVal);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- stop/reset DUT2
+    retVal = dut2.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT2
+    retVal = dut2.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+// @gtest TCxL.1: A re-used entry starts with fresh statistics
+//
+// @expected: CANERR_NOERROR and no transmission of the removed message is booked to its successor
+//
+TEST_F(CyclicMessages, GTEST_TESTCASE(ReusedEntryStatistics, GTEST_ENABLED)) {
+    CCanDevice dut1 = CCanDevice(TEST_DEVICE(DUT1));
+    CCanApi::EChannelState state;
+    CANAPI_Return_t retVal;
+    can_pcan_cyclic_t stats = {};
+    int index = -1, again = -1;
+    // @pre:
+    // @- probe if DUT1 is present and not occupied
+    retVal = dut1.ProbeChannel(state);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.ProbeChannel() failed with error code " << retVal;
+    ASSERT_EQ(CCanApi::ChannelAvailable, state) << "[  ERROR!  ] " << g_Options.GetDeviceName(DUT1) << " is not available";
+    // @- initialize DUT1 with configured settings
+    retVal = dut1.InitializeChannel();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.InitializeChannel() failed with error code " << retVal;
+    // @- start DUT1 with configured bit-rate settings
+    retVal = dut1.StartController();
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.StartController() failed with error code " << retVal;
+    // @- issue(PeakCAN): why do we need a delay here?
+    PCBUSB_INIT_DELAY();
+    // @test:
+    // @- add a message with a short period and let it run for a while
+    retVal = dut1.AddCyclic(Message(FAST_ID, 0x00U), 1000U, 0U, index);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.AddCyclic() failed with error code " << retVal;
+    std::this_thread::sleep_for(std::chrono::milliseconds(TEST_TIMEOUT));
+    // @- remove it and add another one with a long phase
+    retVal = dut1.RemoveCyclic(index);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    retVal = dut1.AddCyclic(Message(SLOW_ID, 0x00U), SLOW_PERIOD, 10U * SLOW_PERIOD, again);
+    ASSERT_EQ(CCanApi::NoError, retVal) << "[  ERROR!  ] dut1.AddCyclic() failed with error code " << retVal;
+    EXPECT_EQ(index, again);
+    std::this_thread::sleep_for(std::chrono::milliseconds(SLOW_PERIOD / 1000));
+    // @- the new message has not been sent yet
+    retVal = dut1.GetCyclicStatistics(again, stats);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    EXPECT_EQ(SLOW_PERIOD, stats.period);
+    EXPECT_EQ(0U, stats.sent);
+    EXPECT_EQ(0U, stats.missed);
+    EXPECT_EQ(0U, stats.max);
+    // @- remove it
+    retVal = dut1.RemoveCyclic(again);
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @post:
+    // @- stop/reset DUT1
+    retVal = dut1.ResetController();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @- tear down DUT1
+    retVal = dut1.TeardownChannel();
+    EXPECT_EQ(CCanApi::NoError, retVal);
+    // @end.
+}
+
+//  $Id: TCxL_CyclicMessages.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
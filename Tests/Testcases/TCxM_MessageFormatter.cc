@@ -0,0 +1,332 @@
+//  SPDX-License-Identifier: BSD-2-Clause OR GPL-2.0-or-later
+//
+//  CAN Interface API, Version 3 (Testing)
+//
+//  Copyright (c) 2004-2025 Uwe Vogt, UV Software, Berlin (info@uv-software.com)
+//  All rights reserved.
+//
+//  This file is part of CAN API V3.
+//
+//  CAN API V3 is dual-licensed under the BSD 2-Clause "Simplified" License
+//  and under the GNU General Public License v2.0 (or any later version).
+//  You can choose between one of them if you use this file.
+//
+//  (1) BSD 2-Clause "Simplified" License
+//
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are met:
+//  1. Redistributions of source code must retain the above copyright notice, this
+//     list of conditions and the following disclaimer.
+//  2. Redistributions in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//  CAN API V3 IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+//  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+//  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+//  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+//  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+//  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+//  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+//  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+//  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+//  OF CAN API V3, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+//  (2) GNU General Public License v2.0 or later
+//
+//  CAN API V3 is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation; either version 2 of the License, or
+//  (at your option) any later version.
+//
+//  CAN API V3 is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License along
+//  with CAN API V3; if not, see <https://www.gnu.org/licenses/>.
+//
+#include "pch.h"
+#include "../../Sources/CANAPI/can_msg.h"
+
+#define TEST_MESSAGES  5
+#define TEST_OPTIONS   5
+
+class MessageFormatter : public testing::Test {
+    virtual void SetUp() {}
+    virtual void TearDown() {}
+protected:
+    struct Options {
+        msg_fmt_timestamp_t time_stamp; msg_fmt_option_t time_usec; msg_fmt_time_t time_format;
+        msg_fmt_number_t id; msg_fmt_option_t id_xtd;
+        msg_fmt_number_t dlc; msg_fmt_canfd_t dlc_format; int dlc_brackets;
+        msg_fmt_option_t flags; msg_fmt_number_t data; msg_fmt_option_t ascii; int ascii_subst;
+        msg_fmt_option_t channel; msg_fmt_option_t counter;
+        msg_fmt_separator_t separator; msg_fmt_wraparound_t wraparound; msg_fmt_option_t eol;
+        const char *rx_prompt; const char *tx_prompt;
+    };
+    // option sets (absolute time-stamps in seconds or days, i.e. w/o time zone)
+    static const Options &GetOptions(int n) {
+        static const Options options[TEST_OPTIONS] = {
+            { MSG_FMT_TIMESTAMP_ABSOLUTE, MSG_FMT_OPTION_OFF, MSG_FMT_TIME_SEC, MSG_FMT_NUMBER_HEX, MSG_FMT_OPTION_OFF,
+              MSG_FMT_NUMBER_DEC, MSG_FMT_CANFD_LENGTH, '\0', MSG_FMT_OPTION_ON, MSG_FMT_NUMBER_HEX, MSG_FMT_OPTION_ON, '.',
+              MSG_FMT_OPTION_OFF, MSG_FMT_OPTION_ON, MSG_FMT_SEPARATOR_SPACES, MSG_FMT_WRAPAROUND_NO, MSG_FMT_OPTION_OFF, "", "" },
+            { MSG_FMT_TIMESTAMP_ABSOLUTE, MSG_FMT_OPTION_ON, MSG_FMT_TIME_DJD, MSG_FMT_NUMBER_DEC, MSG_FMT_OPTION_OFF,
+              MSG_FMT_NUMBER_HEX, MSG_FMT_CANFD_LENGTH, '[', MSG_FMT_OPTION_ON, MSG_FMT_NUMBER_DEC, MSG_FMT_OPTION_OFF, '.',
+              MSG_FMT_OPTION_ON, MSG_FMT_OPTION_OFF, MSG_FMT_SEPARATOR_TABS, MSG_FMT_WRAPAROUND_8, MSG_FMT_OPTION_ON, "R>", "T>" },
+            { MSG_FMT_TIMESTAMP_ABSOLUTE, MSG_FMT_OPTION_ON, MSG_FMT_TIME_SEC, MSG_FMT_NUMBER_OCT, MSG_FMT_OPTION_ON,
+              MSG_FMT_NUMBER_OCT, MSG_FMT_CANFD_DLC, '(', MSG_FMT_OPTION_OFF, MSG_FMT_NUMBER_OCT, MSG_FMT_OPTION_ON, '_',
+              MSG_FMT_OPTION_OFF, MSG_FMT_OPTION_ON, MSG_FMT_SEPARATOR_SPACES, MSG_FMT_WRAPAROUND_16, MSG_FMT_OPTION_OFF, "", "" },
+            { MSG_FMT_TIMESTAMP_ABSOLUTE, MSG_FMT_OPTION_OFF, MSG_FMT_TIME_DJD, MSG_FMT_NUMBER_HEX, MSG_FMT_OPTION_ON,
+              MSG_FMT_NUMBER_DEC, MSG_FMT_CANFD_LENGTH, '\0', MSG_FMT_OPTION_ON, MSG_FMT_NUMBER_HEX, MSG_FMT_OPTION_ON, '.',
+              MSG_FMT_OPTION_ON, MSG_FMT_OPTION_ON, MSG_FMT_SEPARATOR_TABS, MSG_FMT_WRAPAROUND_10, MSG_FMT_OPTION_OFF, "", "" },
+            { MSG_FMT_TIMESTAMP_ABSOLUTE, MSG_FMT_OPTION_ON, MSG_FMT_TIME_SEC, MSG_FMT_NUMBER_HEX, MSG_FMT_OPTION_OFF,
+              MSG_FMT_NUMBER_DEC, MSG_FMT_CANFD_LENGTH, '\0', MSG_FMT_OPTION_ON, MSG_FMT_NUMBER_HEX, MSG_FMT_OPTION_ON, '.',
+              MSG_FMT_OPTION_OFF, MSG_FMT_OPTION_ON, MSG_FMT_SEPARATOR_SPACES, MSG_FMT_WRAPAROUND_32, MSG_FMT_OPTION_ON, "<", ">" }
+        };
+        return options[n];
+    }
+    // messages: CAN 2.0, CAN FD w/ BRS, remote frame, status message and CAN FD w/ ESI
+    static msg_message_t GetMessage(int n) {
+        msg_message_t message = {};
+        switch (n) {
+        case 0: message.id = 0x123U; message.dlc = 8U;
+            for (int i = 0; i < 7; i++) message.data[i] = (uint8_t)(0x41 + i);
+            message.data[7] = 0x01U; message.timestamp.tv_sec = 1700000000; message.timestamp.tv_nsec = 123456789; break;
+        case 1: message.id = 0x1ABCDEF0U; message.xtd = 1; message.fdf = 1; message.brs = 1; message.dlc = 15U;
+            for (int i = 0; i < 64; i++) message.data[i] = (uint8_t)(i * 3);
+            message.timestamp.tv_sec = 1700000001; message.timestamp.tv_nsec = 500000; break;
+        case 2: message.id = 0x7FFU; message.rtr = 1; message.dlc = 0U;
+            message.timestamp.tv_sec = 1700000002; message.timestamp.tv_nsec = 999999999; break;
+        case 3: message.id = 0U; message.sts = 1; message.dlc = 4U;
+            message.data[0] = 0x10U; message.data[1] = 0x20U; message.data[2] = 0x30U; message.data[3] = 0x40U;
+            message.timestamp.tv_sec = 86399; message.timestamp.tv_nsec = 1000; break;
+        case 4: message.id = 0x18DA00F1U; message.xtd = 1; message.fdf = 1; message.esi = 1; message.dlc = 9U;
+            for (int i = 0; i < 12; i++) message.data[i] = (uint8_t)(0x7A + i);
+            break;
+        }
+        return message;
+    }
+    static msg_message_t GetMessage(int32_t sec, int32_t msec) {
+        msg_message_t message = GetMessage(0);
+        message.timestamp.tv_sec = sec;
+        message.timestamp.tv_nsec = msec * 1000000L;
+        return message;
+    }
+    static void SetOptions(const Options &o) {
+        (void)msg_set_fmt_time_stamp(o.time_stamp); (void)msg_set_fmt_time_usec(o.time_usec); (void)msg_set_fmt_time_format(o.time_format);
+        (void)msg_set_fmt_id(o.id); (void)msg_set_fmt_id_xtd(o.id_xtd);
+        (void)msg_set_fmt_dlc(o.dlc); (void)msg_set_fmt_dlc_format(o.dlc_format); (void)msg_set_fmt_dlc_brackets(o.dlc_brackets);
+        (void)msg_set_fmt_flags(o.flags); (void)msg_set_fmt_data(o.data); (void)msg_set_fmt_ascii(o.ascii); (void)msg_set_fmt_ascii_subst(o.ascii_subst);
+        (void)msg_set_fmt_channel(o.channel); (void)msg_set_fmt_counter(o.counter);
+        (void)msg_set_fmt_separator(o.separator); (void)msg_set_fmt_wraparound(o.wraparound); (void)msg_set_fmt_eol(o.eol);
+        (void)msg_set_fmt_rx_prompt(o.rx_prompt); (void)msg_set_fmt_tx_prompt(o.tx_prompt);
+    }
+    static void SetOptions(msg_formatter_t *f, const Options &o) {
+        (void)msg_set_fmt_time_stamp_r(f, o.time_stamp); (void)msg_set_fmt_time_usec_r(f, o.time_usec); (void)msg_set_fmt_time_format_r(f, o.time_format);
+        (void)msg_set_fmt_id_r(f, o.id); (void)msg_set_fmt_id_xtd_r(f, o.id_xtd);
+        (void)msg_set_fmt_dlc_r(f, o.dlc); (void)msg_set_fmt_dlc_format_r(f, o.dlc_format); (void)msg_set_fmt_dlc_brackets_r(f, o.dlc_brackets);
+        (void)msg_set_fmt_flags_r(f, o.flags); (void)msg_set_fmt_data_r(f, o.data); (void)msg_set_fmt_ascii_r(f, o.ascii); (void)msg_set_fmt_ascii_subst_r(f, o.ascii_subst);
+        (void)msg_set_fmt_channel_r(f, o.channel); (void)msg_set_fmt_counter_r(f, o.counter);
+        (void)msg_set_fmt_separator_r(f, o.separator); (void)msg_set_fmt_wraparound_r(f, o.wraparound); (void)msg_set_fmt_eol_r(f, o.eol);
+        (void)msg_set_fmt_rx_prompt_r(f, o.rx_prompt); (void)msg_set_fmt_tx_prompt_r(f, o.tx_prompt);
+    }
+};
+
+// @gtest TCxM.0: Output of the (non-reentrant) message formatter for a set of messages and options
+//
+// @expected: the same strings as before the formatter context was introduced
+//
+TEST_F(MessageFormatter, GTEST_TESTCASE(LegacyOutputUnchanged, GTEST_ENABLED)) {
+    // note: the strings have been taken from the previous implementation of can_msg.c
+    static const char *expected[TEST_OPTIONS * TEST_MESSAGES] = {
+    /* 0.0 */ "0        1700000000.1234  123  S---- 8  41 42 43 44 45 46 47 01  ABCDEFG.",
+    /* 0.1 */ "1        1700000001.0005  1ABCDEF0  XFB-- 64  00 03 06 09 0C 0F 12 15 18 1B 1E 21 24 27 2A 2D 30 33 36 39 3C 3F 42 45 48 4B 4E 51 54 57 5A 5D 60 63 66 69 6C 6F 72 75 78 7B 7E 81 84 87 8A 8D 90 93 96 99 9C 9F A2 A5 A8 AB AE B1 B4 B7 BA BD  ...........!$'*-0369<?BEHKNQTWZ]`cfilorux{~.....................",
+    /* 0.2 */ "2        1700000002.9999  7FF  S---R 0",
+    /* 0.3 */ "3        86399.0000  000  Error 4  10 20 30 40              . 0@",
+    /* 0.4 */ "4          0.0000  18DA00F1  XF-E- 12  7A 7B 7C 7D 7E 7F 80 81 82 83 84 85                                                                                                                                                              z{|}~.......",
+    /* 1.0 */ "R>\t19675.925927354823\t0\t291 \tS----\t[8]\t65  66  67  68  69  70  71  1  \n"
+            "",
+    /* 1.1 */ "T>\t19675.925937505788\t1\t448585456\tXFB--\t[40]\t0   3   6   9   12  15  18  21 \n"
+            "\t24  27  30  33  36  39  42  45 \n"
+            "\t48  51  54  57  60  63  66  69 \n"
+            "\t72  75  78  81  84  87  90  93 \n"
+            "\t96  99  102 105 108 111 114 117\n"
+            "\t120 123 126 129 132 135 138 141\n"
+            "\t144 147 150 153 156 159 162 165\n"
+            "\t168 171 174 177 180 183 186 189\n"
+            "",
+    /* 1.2 */ "R>\t19675.925960648146\t2\t2047\tS---R\t[0]\n"
+            "",
+    /* 1.3 */ "T>\t0.999988425938\t0\t0   \tError\t[4]\t16  32  48  64 \n"
+            "",
+    /* 1.4 */ "R>\t0.000000000000\t1\t416940273\tXF-E-\t[C]\t122 123 124 125 126 127 128 129\n"
+            "\t130 131 132 133\n"
+            "",
+    /* 2.0 */ "10       1700000000.123456  0000000443  (10)  101 102 103 104 105 106 107 001                                  ABCDEFG_",
+    /* 2.1 */ "11       1700000001.000500  3257157360  (17)   000 003 006 011 014 017 022 025 030 033 036 041 044 047 052 055  ___________!$'*-\n"
+            "                                               060 063 066 071 074 077 102 105 110 113 116 121 124 127 132 135  0369<?BEHKNQTWZ]\n"
+            "                                               140 143 146 151 154 157 162 165 170 173 176 201 204 207 212 215  `cfilorux{~_____\n"
+            "                                               220 223 226 231 234 237 242 245 250 253 256 261 264 267 272 275  ________________",
+    /* 2.2 */ "12       1700000002.999999  0000003777  (00)",
+    /* 2.3 */ "13       86399.000001  0000000000  (04)  020 040 060 100                                                  _ 0@",
+    /* 2.4 */ "14         0.000000  3066400361  (11)   172 173 174 175 176 177 200 201 202 203 204 205                  z{|}~_______",
+    /* 3.0 */ "15\t19675.925927350\t0\t00000123\tS----\t8\t41 42 43 44 45 46 47 01      \tABCDEFG.",
+    /* 3.1 */ "16\t19675.925937512\t1\t1ABCDEF0\tXFB--\t64\t00 03 06 09 0C 0F 12 15 18 1B\t..........\n"
+            "\t1E 21 24 27 2A 2D 30 33 36 39\t.!$'*-0369\n"
+            "\t3C 3F 42 45 48 4B 4E 51 54 57\t<?BEHKNQTW\n"
+            "\t5A 5D 60 63 66 69 6C 6F 72 75\tZ]`cfiloru\n"
+            "\t78 7B 7E 81 84 87 8A 8D 90 93\tx{~.......\n"
+            "\t96 99 9C 9F A2 A5 A8 AB AE B1\t..........\n"
+            "\tB4 B7 BA BD                  \t....",
+    /* 3.2 */ "17\t19675.925960648\t2\t000007FF\tS---R\t0",
+    /* 3.3 */ "18\t0.999988426\t0\t00000000\tError\t4\t10 20 30 40                  \t. 0@",
+    /* 3.4 */ "19\t0.000000000\t1\t18DA00F1\tXF-E-\t12\t7A 7B 7C 7D 7E 7F 80 81 82 83\tz{|}~.....\n"
+            "\t84 85                        \t..",
+    /* 4.0 */ "< 20       1700000000.123456  123  S---- 8  41 42 43 44 45 46 47 01                                                                          ABCDEFG.\n"
+            "",
+    /* 4.1 */ "> 21       1700000001.000500  1ABCDEF0  XFB-- 64  00 03 06 09 0C 0F 12 15 18 1B 1E 21 24 27 2A 2D 30 33 36 39 3C 3F 42 45 48 4B 4E 51 54 57 5A 5D  ...........!$'*-0369<?BEHKNQTWZ]\n"
+            "                                                  60 63 66 69 6C 6F 72 75 78 7B 7E 81 84 87 8A 8D 90 93 96 99 9C 9F A2 A5 A8 AB AE B1 B4 B7 BA BD  `cfilorux{~.....................\n"
+            "",
+    /* 4.2 */ "< 22       1700000002.999999  7FF  S---R 0\n"
+            "",
+    /* 4.3 */ "> 23       86399.000001  000  Error 4  10 20 30 40                                                                                      . 0@\n"
+            "",
+    /* 4.4 */ "< 24         0.000000  18DA00F1  XF-E- 12  7A 7B 7C 7D 7E 7F 80 81 82 83 84 85                                                              z{|}~.......\n"
+            ""
+    };
+    char buffer[MSG_STRING_LENGTH] = "";
+    msg_formatter_t *formatter;
+    // @pre:
+    // @- create a message formatter
+    formatter = msg_create(MSG_FORMAT_DEFAULT);
+    ASSERT_TRUE(formatter != NULL) << "[  ERROR!  ] msg_create() failed";
+    // @test:
+    for (int o = 0; o < TEST_OPTIONS; o++) {
+        // @- set the same options for the legacy API and the formatter
+        SetOptions(GetOptions(o));
+        SetOptions(formatter, GetOptions(o));
+        for (int k = 0; k < TEST_MESSAGES; k++) {
+            msg_message_t message = GetMessage(k);
+            msg_direction_t direction = (k & 1) ? MSG_TX_MESSAGE : MSG_RX_MESSAGE;
+            msg_counter_t counter = (msg_counter_t)((o * TEST_MESSAGES) + k);
+            msg_channel_t channel = (msg_channel_t)(k % 3);
+            // @- sub(o.k): legacy API, output as before
+            EXPECT_STREQ(expected[(o * TEST_MESSAGES) + k], msg_format_message(&message, direction, counter, channel))
+                << "[  ERROR!  ] option set " << o << ", message " << k;
+            // @- sub(o.k): formatter context, same output as the legacy API
+            EXPECT_STREQ(expected[(o * TEST_MESSAGES) + k], msg_format_message_r(formatter, &message, direction, channel, counter, buffer, sizeof(buffer)))
+                << "[  ERROR!  ] option set " << o << ", message " << k;
+        }
+    }
+    // @post:
+    // @- restore the default options of the legacy API
+    SetOptions({ MSG_FMT_TIMESTAMP_ZERO, MSG_FMT_OPTION_OFF, MSG_FMT_TIME_SEC, MSG_FMT_NUMBER_HEX, MSG_FMT_OPTION_OFF,
+                 MSG_FMT_NUMBER_DEC, MSG_FMT_CANFD_LENGTH, '\0', MSG_FMT_OPTION_ON, MSG_FMT_NUMBER_HEX, MSG_FMT_OPTION_ON, '.',
+                 MSG_FMT_OPTION_OFF, MSG_FMT_OPTION_ON, MSG_FMT_SEPARATOR_SPACES, MSG_FMT_WRAPAROUND_NO, MSG_FMT_OPTION_OFF, "", "" });
+    // @- destroy the message formatter
+    msg_destroy(formatter);
+    // @end.
+}
+
+// @gtest TCxM.1: Relative time-stamps of two message formatters (e.g. two channels)
+//
+// @expected: each formatter keeps its own time-stamp reference
+//
+TEST_F(MessageFormatter, GTEST_TESTCASE(IndependentTimeStamps, GTEST_ENABLED)) {
+    char buffer[MSG_STRING_LENGTH] = "";
+    msg_formatter_t *first, *second;
+    msg_message_t message;
+    // @pre:
+    // @- create two message formatters with relative time-stamps
+    first = msg_create(MSG_FORMAT_DEFAULT);
+    ASSERT_TRUE(first != NULL) << "[  ERROR!  ] msg_create() failed";
+    second = msg_create(MSG_FORMAT_DEFAULT);
+    ASSERT_TRUE(second != NULL) << "[  ERROR!  ] msg_create() failed";
+    EXPECT_EQ(1, msg_set_fmt_time_stamp_r(first, MSG_FMT_TIMESTAMP_RELATIVE));
+    EXPECT_EQ(1, msg_set_fmt_time_stamp_r(second, MSG_FMT_TIMESTAMP_RELATIVE));
+    // @test:
+    // @- sub(1): messages of both channels interleaved
+    message = GetMessage(10, 0);
+    EXPECT_STREQ("  0.0000", msg_format_time_r(first, &message, buffer, sizeof(buffer)));
+    message = GetMessage(100, 0);
+    EXPECT_STREQ("  0.0000", msg_format_time_r(second, &message, buffer, sizeof(buffer)));
+    message = GetMessage(10, 500);
+    EXPECT_STREQ("  0.5000", msg_format_time_r(first, &message, buffer, sizeof(buffer)));
+    message = GetMessage(100, 250);
+    EXPECT_STREQ("  0.2500", msg_format_time_r(second, &message, buffer, sizeof(buffer)));
+    message = GetMessage(12, 0);
+    EXPECT_STREQ("  1.5000", msg_format_time_r(first, &message, buffer, sizeof(buffer)));
+    message = GetMessage(100, 750);
+    EXPECT_STREQ("  0.5000", msg_format_time_r(second, &message, buffer, sizeof(buffer)));
+    // @- sub(2): zero-based time-stamps of the second formatter from its first message
+    EXPECT_EQ(1, msg_set_fmt_time_stamp_r(second, MSG_FMT_TIMESTAMP_ZERO));
+    msg_reset_r(second);
+    message = GetMessage(200, 0);
+    EXPECT_STREQ("  0.0000", msg_format_time_r(second, &message, buffer, sizeof(buffer)));
+    message = GetMessage(13, 0);
+    EXPECT_STREQ("  1.0000", msg_format_time_r(first, &message, buffer, sizeof(buffer)));
+    message = GetMessage(203, 0);
+    EXPECT_STREQ("  3.0000", msg_format_time_r(second, &message, buffer, sizeof(buffer)));
+    message = GetMessage(204, 500);
+    EXPECT_STREQ("  4.5000", msg_format_time_r(second, &message, buffer, sizeof(buffer)));
+    // @- sub(3): a reset of the first formatter does not affect the second one
+    msg_reset_r(first);
+    message = GetMessage(20, 0);
+    EXPECT_STREQ("  0.0000", msg_format_time_r(first, &message, buffer, sizeof(buffer)));
+    message = GetMessage(205, 0);
+    EXPECT_STREQ("  5.0000", msg_format_time_r(second, &message, buffer, sizeof(buffer)));
+    // @post:
+    // @- destroy the message formatters
+    msg_destroy(first);
+    msg_destroy(second);
+    // @end.
+}
+
+// @gtest TCxM.2: Formatting into a buffer shorter than the formatted message
+//
+// @expected: the string is truncated to fit into the buffer and always zero-terminated
+//
+TEST_F(MessageFormatter, GTEST_TESTCASE(TruncationIntoShortBuffer, GTEST_ENABLED)) {
+    char full[MSG_STRING_LENGTH] = "";
+    char buffer[MSG_STRING_LENGTH + 1] = "";
+    msg_formatter_t *formatter;
+    msg_message_t message = GetMessage(1);
+    size_t length, sizes[] = { 1U, 2U, 10U, 0U, 0U, 0U };
+    // @pre:
+    // @- create a message formatter (absolute time-stamps, i.e. w/o reference)
+    formatter = msg_create(MSG_FORMAT_DEFAULT);
+    ASSERT_TRUE(formatter != NULL) << "[  ERROR!  ] msg_create() failed";
+    SetOptions(formatter, GetOptions(2));
+    // @- format the message into a buffer of maximal size
+    ASSERT_TRUE(msg_format_message_r(formatter, &message, MSG_RX_MESSAGE, 0, 0U, full, sizeof(full)) == full);
+    length = strlen(full);
+    ASSERT_GT(length, 10U);
+    sizes[3] = length; sizes[4] = length + 1U; sizes[5] = length + 2U;
+    // @test:
+    for (size_t i = 0U; i < (sizeof(sizes) / sizeof(sizes[0])); i++) {
+        // @- sub(i): format into a buffer of the given size, the byte after it is a guard
+        memset(buffer, '#', sizeof(buffer));
+        EXPECT_TRUE(msg_format_message_r(formatter, &message, MSG_RX_MESSAGE, 0, 0U, buffer, sizes[i]) == buffer);
+        size_t expected = (sizes[i] > length) ? length : (sizes[i] - 1U);
+        EXPECT_EQ(expected, strlen(buffer)) << "[  ERROR!  ] buffer size " << sizes[i];
+        EXPECT_EQ(0, strncmp(full, buffer, expected)) << "[  ERROR!  ] buffer size " << sizes[i];
+        EXPECT_EQ('#', buffer[sizes[i]]) << "[  ERROR!  ] buffer size " << sizes[i];
+    }
+    // @- sub(6): the fields are truncated the same way
+    memset(buffer, '#', sizeof(buffer));
+    EXPECT_STREQ("000 00", msg_format_data_r(formatter, &message, buffer, 7U));
+    EXPECT_EQ('#', buffer[7]);
+    EXPECT_STREQ("325", msg_format_id_r(formatter, &message, buffer, 4U));
+    EXPECT_STREQ("", msg_format_flags_r(formatter, &message, buffer, 1U));
+    // @- sub(7): a buffer of size zero is refused
+    EXPECT_TRUE(msg_format_message_r(formatter, &message, MSG_RX_MESSAGE, 0, 0U, buffer, 0U) == NULL);
+    EXPECT_TRUE(msg_format_time_r(formatter, &message, buffer, 0U) == NULL);
+    // @post:
+    // @- destroy the message formatter
+    msg_destroy(formatter);
+    // @end.
+}
+
+//  $Id: TCxM_MessageFormatter.cc 1411 2025-01-17 18:59:07Z quaoar $  Copyright (c) UV Software, Berlin.
@@ -17,6 +17,11 @@
 #else
  #include <windows.h>
 #endif
+#if defined(__APPLE__)
+ #include "PCBUSB.h"
+#else
+ #include "PCANBasic.h"
+#endif
 #include <inttypes.h>
 
 //#define SECOND_CHANNEL
@@ -70,6 +75,10 @@
 #define OPTION_NO   (0)
 #define OPTION_YES  (1)
 
+#define BENCH_ROUNDS  20
+#define BENCH_FRAMES  64
+#define BENCH_DRAIN   100000U  // time to transmit the frames of one round in [usec] (125kbps or faster)
+
 #define OPTION_TIME_DRIVER  (0)
 #define OPTION_TIME_ZERO    (1)
 #define OPTION_TIME_ABS     (2)
@@ -87,6 +96,8 @@ typedef CPeakCAN  CCanDriver;
 static void sigterm(int signo);
 
 static void verbose(const can_mode_t &mode, const can_bitrate_t &bitrate, const can_speed_t &speed);
+static void benchmark(int32_t channel, const CANAPI_OpMode_t &mode);
+static uint64_t nanoseconds(void);
 
 static volatile int running = 1;
 
@@ -152,6 +163,7 @@ int main(int argc, const char * argv[]) {
 //    int option_trace = OPTION_NO;
 //    int option_log = OPTION_NO;
     int option_xor = OPTION_NO;
+    int option_bench = OPTION_NO;
     uint64_t received = 0ULL;
     uint64_t expected = 0ULL;
     time_t now = 0L;
@@ -242,6 +254,8 @@ int main(int argc, const char * argv[]) {
         if (!strcmp(argv[i], "LIST")) option_list = OPTION_YES;
 //        if (!strcmp(argv[i], "PATH")) option_path = OPTION_YES;
         if (!strcmp(argv[i], "EXIT")) option_exit = OPTION_YES;
+        /* micro-benchmark: PCANBasic (baseline) vs. CAN API */
+        if (!strcmp(argv[i], "BENCH")) option_bench = OPTION_YES;
         /* additional operation modes (bit field) */
         if (!strcmp(argv[i], "SHARED")) opMode.shrd = 1;
         if (!strcmp(argv[i], "MONITOR")) opMode.mon = 1;
@@ -551,6 +565,11 @@ int main(int argc, const char * argv[]) {
         fprintf(stdout, ">>> mySecond.StartController: status = 0x%02X\n", status.byte);
     }
 #endif
+    /* micro-benchmark */
+    if (option_bench) {
+        benchmark(channel, opMode);
+        goto teardown;
+    }
     /* transmit messages */
     if (option_transmit) {
 #ifdef __linux__
@@ -819,6 +838,99 @@ static void verbose(const can_mode_t &mode, const can_bitrate_t &bitrate, const
     }
 }
 
+static void benchmark(int32_t channel, const CANAPI_OpMode_t &mode)
+{
+    TPCANHandle board = (TPCANHandle)channel;
+#ifdef SECOND_CHANNEL
+    TPCANHandle second = (TPCANHandle)(channel + 1);
+#endif
+    TPCANMsg txPcan = {}, rxPcan;
+    TPCANMsgFD txPcanFd = {}, rxPcanFd;
+    TPCANTimestamp timestamp;
+    TPCANTimestampFD timestampFd;
+    CANAPI_Message_t txMessage = {}, rxMessage;
+    double best[4] = { 1.0e18, 1.0e18, 1.0e18, 1.0e18 };  // ns per call: write/read by PCANBasic, write/read by CAN API
+    double time;
+    uint64_t start;
+    int round, i;
+
+    /* note: each round writes some frames by PCANBasic and by the CAN API (w/o waiting),
+     *       then the frames are read from the second channel (w/o SECOND_CHANNEL a read
+     *       polls the empty receive queue); the best average per call of all rounds is taken */
+    txPcan.ID = 0x100U;
+    txPcan.MSGTYPE = PCAN_MESSAGE_STANDARD;
+    txPcan.LEN = CAN_MAX_LEN;
+    txPcanFd.ID = 0x100U;
+    txPcanFd.MSGTYPE = PCAN_MESSAGE_FD | (mode.brse ? PCAN_MESSAGE_BRS : 0x00U);
+    txPcanFd.DLC = CANFD_MAX_DLC;
+    txMessage.id = 0x100U;
+#if (OPTION_CAN_2_0_ONLY != 0)
+    txMessage.dlc = CAN_MAX_DLC;
+#else
+    txMessage.fdf = mode.fdoe;
+    txMessage.brs = mode.brse;
+    txMessage.dlc = mode.fdoe ? CANFD_MAX_DLC : CAN_MAX_DLC;
+#endif
+    for (round = 0; (round < BENCH_ROUNDS) && running; round++) {
+        /* baseline: PCANBasic */
+        start = nanoseconds();
+        if (!mode.fdoe)
+            for (i = 0; i < BENCH_FRAMES; i++) (void)CAN_Write(board, &txPcan);
+        else
+            for (i = 0; i < BENCH_FRAMES; i++) (void)CAN_WriteFD(board, &txPcanFd);
+        if ((time = (double)(nanoseconds() - start) / (double)BENCH_FRAMES) < best[0]) best[0] = time;
+        usleep(BENCH_DRAIN);
+        start = nanoseconds();
+#ifdef SECOND_CHANNEL
+        if (!mode.fdoe)
+            for (i = 0; i < BENCH_FRAMES; i++) (void)CAN_Read(second, &rxPcan, &timestamp);
+        else
+            for (i = 0; i < BENCH_FRAMES; i++) (void)CAN_ReadFD(second, &rxPcanFd, &timestampFd);
+#else
+        if (!mode.fdoe)
+            for (i = 0; i < BENCH_FRAMES; i++) (void)CAN_Read(board, &rxPcan, &timestamp);
+        else
+            for (i = 0; i < BENCH_FRAMES; i++) (void)CAN_ReadFD(board, &rxPcanFd, &timestampFd);
+#endif
+        if ((time = (double)(nanoseconds() - start) / (double)BENCH_FRAMES) < best[1]) best[1] = time;
+        /* specialized: can_write and can_read */
+        start = nanoseconds();
+        for (i = 0; i < BENCH_FRAMES; i++) (void)myDriver.WriteMessage(txMessage, 0U);
+        if ((time = (double)(nanoseconds() - start) / (double)BENCH_FRAMES) < best[2]) best[2] = time;
+        usleep(BENCH_DRAIN);
+        start = nanoseconds();
+#ifdef SECOND_CHANNEL
+        for (i = 0; i < BENCH_FRAMES; i++) (void)mySecond.ReadMessage(rxMessage, 0U);
+#else
+        for (i = 0; i < BENCH_FRAMES; i++) (void)myDriver.ReadMessage(rxMessage, 0U);
+#endif
+        if ((time = (double)(nanoseconds() - start) / (double)BENCH_FRAMES) < best[3]) best[3] = time;
+    }
+    fprintf(stdout, ">>> Benchmark (%s): best of %i rounds with %i frames\n", mode.fdoe ? "CAN FD" : "CAN 2.0", round, BENCH_FRAMES);
+    fprintf(stdout, "    PCANBasic: CAN_Write%s %.0f ns/call, CAN_Read%s %.0f ns/call\n",
+                    mode.fdoe ? "FD" : "", best[0], mode.fdoe ? "FD" : "", best[1]);
+    fprintf(stdout, "    CAN API:   can_write %.0f ns/call, can_read %.0f ns/call\n", best[2], best[3]);
+#ifndef SECOND_CHANNEL
+    fprintf(stdout, "    (reading from an empty receive queue, define SECOND_CHANNEL to read the frames)\n");
+#endif
+}
+
+static uint64_t nanoseconds(void)
+{
+#if defined(_WIN32) || defined(_WIN64)
+    LARGE_INTEGER counter, frequency;
+
+    (void)QueryPerformanceFrequency(&frequency);
+    (void)QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1000000000.0 / (double)frequency.QuadPart);
+#else
+    struct timespec now;
+
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64_t)now.tv_sec * 1000000000ULL) + (uint64_t)now.tv_nsec;
+#endif
+}
+
 #if defined(_WIN32) || defined(_WIN64)
  /* usleep(3) - Linux man page
   *
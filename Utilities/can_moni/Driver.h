@@ -26,7 +26,7 @@
 #error Compilation with legacy CAN 2.0 frame format!
 #else
 #define CAN_FD_SUPPORTED    1  // don't touch that dial
-#define CAN_TRACE_SUPPORTED 0  // write trace file (1=PCAN)
+#define CAN_TRACE_SUPPORTED 2  // write trace file (1=PCAN, 2=BIN|CSV|TRC)
 #endif
 #if !defined(__APPLE__)
 #define MONITOR_INTERFACE  "PEAK-System PCAN Interfaces"
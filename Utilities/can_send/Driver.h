@@ -27,6 +27,7 @@
 #else
 #define CAN_FD_SUPPORTED    1  // don't touch that dial
 #define CAN_TRACE_SUPPORTED 0  // write trace file (1=PCAN)
+#define CAN_REPLAY_SUPPORTED 1  // replay trace file (1=PCAN)
 #endif
 #if !defined(__APPLE__)
 #define SENDER_INTERFACE  "PEAK-System PCAN Interfaces"
@@ -77,6 +77,10 @@ struct SOptions {
         eTraceLogger,
         eTraceVendor
     } m_eTraceMode;
+#endif
+#if (CAN_REPLAY_SUPPORTED != 0)
+    char* m_szReplayFile;
+    can_pcan_replay_t m_ReplayOptions;
 #endif
     bool m_fListBitrates;
     bool m_fListBoards;
@@ -80,6 +80,11 @@ SOptions::SOptions() {
     m_XtdFilter.m_u32Mask = CANACC_MASK_29BIT;
 #if (CAN_TRACE_SUPPORTED != 0)
     m_eTraceMode = SOptions::eTraceOff;
+#endif
+#if (CAN_REPLAY_SUPPORTED != 0)
+    m_szReplayFile = (char*)NULL;
+    memset(&m_ReplayOptions, 0, sizeof(m_ReplayOptions));
+    m_ReplayOptions.speed = 100U;  // real time
 #endif
     m_fListBitrates = false;
     m_fListBoards = false;
@@ -108,6 +113,15 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
     int optXtdMask = 0;
 #if (CAN_TRACE_SUPPORTED != 0)
     int optTraceMode = 0;
+#endif
+#if (CAN_REPLAY_SUPPORTED != 0)
+    int optReplay = 0;
+    int optSpeed = 0;
+    int optFilter = 0;
+    int optRemap = 0;
+    int64_t intarg2;
+    double dblarg;
+    char* ptr;
 #endif
     int optListBitrates = 0;
     int optListBoards = 0;
@@ -138,6 +152,10 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
         {"xtd-code", required_argument, 0, '3'},
         {"xtd-mask", required_argument, 0, '4'},
         {"trace", required_argument, 0, 'Y'},
+        {"replay", required_argument, 0, '5'},
+        {"speed", required_argument, 0, '6'},
+        {"filter", required_argument, 0, '7'},
+        {"remap", required_argument, 0, '8'},
         {"list-bitrates", optional_argument, 0, 'l'},
 #if (OPTION_CANAPI_LIBRARY != 0)
         {"list-boards", optional_argument, 0, 'L'},
@@ -466,6 +484,86 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
                 return 1;
             }
             break;
+#endif
+#if (CAN_REPLAY_SUPPORTED != 0)
+        /* option '--replay=<filename>' */
+        case '5':
+            if (optReplay++) {
+                fprintf(err, "%s: duplicated option `--replay'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg == NULL) {
+                fprintf(err, "%s: missing argument for option `--replay'\n", m_szBasename);
+                return 1;
+            }
+            m_szReplayFile = optarg;
+            break;
+        /* option '--speed=(<factor>|MAX)' */
+        case '6':
+            if (optSpeed++) {
+                fprintf(err, "%s: duplicated option `--speed'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg == NULL) {
+                fprintf(err, "%s: missing argument for option `--speed'\n", m_szBasename);
+                return 1;
+            }
+            if (!strcasecmp(optarg, "MAX"))
+                m_ReplayOptions.speed = 0U;
+            else if ((sscanf(optarg, "%lf", &dblarg) == 1) &&
+                     (dblarg >= (PCAN_REPLAY_SPEED_MIN / 100.)) && (dblarg <= 1000.))
+                m_ReplayOptions.speed = (uint32_t)(dblarg * 100. + .5);
+            else {
+                fprintf(err, "%s: illegal argument for option `--speed'\n", m_szBasename);
+                return 1;
+            }
+            break;
+        /* option '--filter=<id>[,<id>...]' */
+        case '7':
+            if (optFilter++) {
+                fprintf(err, "%s: duplicated option `--filter'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg == NULL) {
+                fprintf(err, "%s: missing argument for option `--filter'\n", m_szBasename);
+                return 1;
+            }
+            ptr = optarg;
+            do {
+                if ((m_ReplayOptions.count >= PCAN_REPLAY_IDS) ||
+                    (sscanf(ptr, "%" SCNx64, &intarg) != 1) || ((intarg & ~CAN_MAX_XTD_ID) != 0)) {
+                    fprintf(err, "%s: illegal argument for option `--filter'\n", m_szBasename);
+                    return 1;
+                }
+                m_ReplayOptions.ids[m_ReplayOptions.count++] = (uint32_t)intarg;
+                if ((ptr = strchr(ptr, ',')) != NULL)
+                    ptr++;
+            } while (ptr != NULL);
+            break;
+        /* option '--remap=<id>:<id>[,<id>:<id>...]' */
+        case '8':
+            if (optRemap++) {
+                fprintf(err, "%s: duplicated option `--remap'\n", m_szBasename);
+                return 1;
+            }
+            if (optarg == NULL) {
+                fprintf(err, "%s: missing argument for option `--remap'\n", m_szBasename);
+                return 1;
+            }
+            ptr = optarg;
+            do {
+                if ((m_ReplayOptions.remaps >= PCAN_REPLAY_REMAPS) ||
+                    (sscanf(ptr, "%" SCNx64 ":%" SCNx64, &intarg, &intarg2) != 2) ||
+                    ((intarg & ~CAN_MAX_XTD_ID) != 0) || ((intarg2 & ~CAN_MAX_XTD_ID) != 0)) {
+                    fprintf(err, "%s: illegal argument for option `--remap'\n", m_szBasename);
+                    return 1;
+                }
+                m_ReplayOptions.remap[m_ReplayOptions.remaps].from = (uint32_t)intarg;
+                m_ReplayOptions.remap[m_ReplayOptions.remaps++].to = (uint32_t)intarg2;
+                if ((ptr = strchr(ptr, ',')) != NULL)
+                    ptr++;
+            } while (ptr != NULL);
+            break;
 #endif
         /* option '--list-bitrates[=(2.0|FDF[+BRS])]' */
         case 'l':
@@ -593,6 +691,13 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
         m_szInterface = (char*)argv[optind];
     }
     // (4) check for illegal combinations
+#if (CAN_REPLAY_SUPPORTED != 0)
+    /* - check for a trace file (speed, filter and remap are replay options) */
+    if ((optSpeed || optFilter || optRemap) && !optReplay && !m_fExit) {
+        fprintf(err, "%s: option `--speed', `--filter' or `--remap' without option `--replay'\n", m_szBasename);
+        return 1;
+    }
+#endif
 #if (CAN_FD_SUPPORTED != 0)
     /* - check bit-timing index (n/a for CAN FD) */
     if (m_OpMode.fdoe && (m_Bitrate.btr.frequency <= CANBTR_INDEX_1M) && !m_fExit) {
@@ -656,6 +761,12 @@ void SOptions::ShowUsage(FILE* stream, bool args) {
     fprintf(stream, "     --trace=(BIN|CSV|TRC)            write a trace file (default=OFF)\n");
 #endif
 #endif
+#if (CAN_REPLAY_SUPPORTED != 0)
+    fprintf(stream, "     --replay=<filename>              send the messages of a trace file (instead of stdin)\n");
+    fprintf(stream, "     --speed=(<factor>|MAX)           replay speed: 0.1 up to 1000 times real time (default=1)\n");
+    fprintf(stream, "     --filter=<id>[,<id>...]          replay only these identifiers (up to %i)\n", PCAN_REPLAY_IDS);
+    fprintf(stream, "     --remap=<id>:<id>[,...]          send an identifier of the trace file as another one\n");
+#endif
 #if (SERIAL_CAN_SUPPORTED != 0)
     fprintf(stream, "     --protocol=(Lawicel|CANable)     select SLCAN protocol (default=Lawicel)\n");
 #endif
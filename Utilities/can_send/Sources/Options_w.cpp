@@ -68,21 +68,25 @@ extern "C" {
 #define XTD_MASK_CHR      20
 #define TRACEFILE_STR     21
 #define TRACEFILE_CHR     22
-#define LISTBITRATES_STR  23
-#define LISTBOARDS_STR    24
-#define LISTBOARDS_CHR    25
-#define TESTBOARDS_STR    26
-#define TESTBOARDS_CHR    27
-#define PROTOCOL_STR      28
-#define PROTOCOL_CHR      29
-#define JSON_STR          30
-#define JSON_CHR          31
-#define HELP              32
-#define QUESTION_MARK     33
-#define ABOUT             34
-#define CHARACTER_MJU     35
-#define VERSION           36
-#define MAX_OPTIONS       37
+#define REPLAY_STR        23
+#define SPEED_STR         24
+#define FILTER_STR        25
+#define REMAP_STR         26
+#define LISTBITRATES_STR  27
+#define LISTBOARDS_STR    28
+#define LISTBOARDS_CHR    29
+#define TESTBOARDS_STR    30
+#define TESTBOARDS_CHR    31
+#define PROTOCOL_STR      32
+#define PROTOCOL_CHR      33
+#define JSON_STR          34
+#define JSON_CHR          35
+#define HELP              36
+#define QUESTION_MARK     37
+#define ABOUT             38
+#define CHARACTER_MJU     39
+#define VERSION           40
+#define MAX_OPTIONS       41
 
 static char* option[MAX_OPTIONS] = {
     (char*)"BAUDRATE", (char*)"bd",
@@ -97,6 +101,10 @@ static char* option[MAX_OPTIONS] = {
     (char*)"CODE", (char*)"MASK",
     (char*)"XTD-CODE", (char*)"XTD-MASK",
     (char*)"TRACE", (char*)"trc",
+    (char*)"REPLAY",
+    (char*)"SPEED",
+    (char*)"FILTER",
+    (char*)"REMAP",
     (char*)"LIST-BITRATES",
     (char*)"LIST-BOARDS", (char*)"list",
     (char*)"TEST-BOARDS", (char*)"test",
@@ -146,6 +154,11 @@ SOptions::SOptions() {
     m_XtdFilter.m_u32Mask = CANACC_MASK_29BIT;
 #if (CAN_TRACE_SUPPORTED != 0)
     m_eTraceMode = SOptions::eTraceOff;
+#endif
+#if (CAN_REPLAY_SUPPORTED != 0)
+    m_szReplayFile = (char*)NULL;
+    memset(&m_ReplayOptions, 0, sizeof(m_ReplayOptions));
+    m_ReplayOptions.speed = 100U;  // real time
 #endif
     m_fListBitrates = false;
     m_fListBoards = false;
@@ -176,6 +189,15 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
     int optXtdMask = 0;
 #if (CAN_TRACE_SUPPORTED != 0)
     int optTraceMode = 0;
+#endif
+#if (CAN_REPLAY_SUPPORTED != 0)
+    int optReplay = 0;
+    int optSpeed = 0;
+    int optFilter = 0;
+    int optRemap = 0;
+    int64_t intarg2;
+    double dblarg;
+    char* ptr;
 #endif
     int optListBitrates = 0;
     int optListBoards = 0;
@@ -557,6 +579,86 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
                 return 1;
             }
             break;
+#endif
+#if (CAN_REPLAY_SUPPORTED != 0)
+        /* option '--replay=<filename>' */
+        case REPLAY_STR:
+            if ((optReplay++)) {
+                fprintf(err, "%s: duplicated option /REPLAY\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) == NULL) {
+                fprintf(err, "%s: missing argument for option /REPLAY\n", m_szBasename);
+                return 1;
+            }
+            m_szReplayFile = optarg;
+            break;
+        /* option '--speed=(<factor>|MAX)' */
+        case SPEED_STR:
+            if ((optSpeed++)) {
+                fprintf(err, "%s: duplicated option /SPEED\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) == NULL) {
+                fprintf(err, "%s: missing argument for option /SPEED\n", m_szBasename);
+                return 1;
+            }
+            if (!strcasecmp(optarg, "MAX"))
+                m_ReplayOptions.speed = 0U;
+            else if ((sscanf_s(optarg, "%lf", &dblarg) == 1) &&
+                     (dblarg >= (PCAN_REPLAY_SPEED_MIN / 100.)) && (dblarg <= 1000.))
+                m_ReplayOptions.speed = (uint32_t)(dblarg * 100. + .5);
+            else {
+                fprintf(err, "%s: illegal argument for option /SPEED\n", m_szBasename);
+                return 1;
+            }
+            break;
+        /* option '--filter=<id>[,<id>...]' */
+        case FILTER_STR:
+            if ((optFilter++)) {
+                fprintf(err, "%s: duplicated option /FILTER\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) == NULL) {
+                fprintf(err, "%s: missing argument for option /FILTER\n", m_szBasename);
+                return 1;
+            }
+            ptr = optarg;
+            do {
+                if ((m_ReplayOptions.count >= PCAN_REPLAY_IDS) ||
+                    (sscanf_s(ptr, "%lli", &intarg) != 1) || ((intarg & ~CAN_MAX_XTD_ID) != 0)) {
+                    fprintf(err, "%s: illegal argument for option /FILTER\n", m_szBasename);
+                    return 1;
+                }
+                m_ReplayOptions.ids[m_ReplayOptions.count++] = (uint32_t)intarg;
+                if ((ptr = strchr(ptr, ',')) != NULL)
+                    ptr++;
+            } while (ptr != NULL);
+            break;
+        /* option '--remap=<id>:<id>[,<id>:<id>...]' */
+        case REMAP_STR:
+            if ((optRemap++)) {
+                fprintf(err, "%s: duplicated option /REMAP\n", m_szBasename);
+                return 1;
+            }
+            if ((optarg = getOptionParameter()) == NULL) {
+                fprintf(err, "%s: missing argument for option /REMAP\n", m_szBasename);
+                return 1;
+            }
+            ptr = optarg;
+            do {
+                if ((m_ReplayOptions.remaps >= PCAN_REPLAY_REMAPS) ||
+                    (sscanf_s(ptr, "%lli:%lli", &intarg, &intarg2) != 2) ||
+                    ((intarg & ~CAN_MAX_XTD_ID) != 0) || ((intarg2 & ~CAN_MAX_XTD_ID) != 0)) {
+                    fprintf(err, "%s: illegal argument for option /REMAP\n", m_szBasename);
+                    return 1;
+                }
+                m_ReplayOptions.remap[m_ReplayOptions.remaps].from = (uint32_t)intarg;
+                m_ReplayOptions.remap[m_ReplayOptions.remaps++].to = (uint32_t)intarg2;
+                if ((ptr = strchr(ptr, ',')) != NULL)
+                    ptr++;
+            } while (ptr != NULL);
+            break;
 #endif
         /* option '--list-bitrates[=(2.0|FDF[+BRS])]' */
         case LISTBITRATES_STR:
@@ -672,6 +774,13 @@ int SOptions::ScanCommanline(int argc, const char* argv[], FILE* err, FILE* out)
         return 1;
     }
     // (4) check for illegal combinations
+#if (CAN_REPLAY_SUPPORTED != 0)
+    /* - check for a trace file (speed, filter and remap are replay options) */
+    if ((optSpeed || optFilter || optRemap) && !optReplay && !m_fExit) {
+        fprintf(err, "%s: option /SPEED, /FILTER or /REMAP without option /REPLAY\n", m_szBasename);
+        return 1;
+    }
+#endif
 #if (CAN_FD_SUPPORTED != 0)
     /* - check bit-timing index (n/a for CAN FD) */
     if (m_OpMode.fdoe && (m_Bitrate.btr.frequency <= CANBTR_INDEX_1M) && !m_fExit) {
@@ -735,6 +844,12 @@ void SOptions::ShowUsage(FILE* stream, bool args) {
     fprintf(stream, "  /TRaCe:(BIN|CSV|TRC)                write a trace file (default=OFF)\n");
 #endif
 #endif
+#if (CAN_REPLAY_SUPPORTED != 0)
+    fprintf(stream, "  /REPLAY:<filename>                  send the messages of a trace file (instead of stdin)\n");
+    fprintf(stream, "  /SPEED:(<factor>|MAX)               replay speed: 0.1 up to 1000 times real time (default=1)\n");
+    fprintf(stream, "  /FILTER:<id>[,<id>...]              replay only these identifiers (up to %i)\n", PCAN_REPLAY_IDS);
+    fprintf(stream, "  /REMAP:<id>:<id>[,...]              send an identifier of the trace file as another one\n");
+#endif
 #if (SERIAL_CAN_SUPPORTED != 0)
     fprintf(stream, "  /PRotocol:(Lawicel|CANable)         select SLCAN protocol (default=Lawicel)\n");
 #endif
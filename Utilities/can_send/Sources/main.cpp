@@ -55,10 +55,14 @@
 #endif
 
 #define MAX_ID  (CAN_MAX_STD_ID + 1)
+#define TX_TIMEOUT  100U  // time to wait for the transmit queue [ms]
 
 class CCanDevice : public CCanDriver {
 public:
     uint64_t SendMessage();
+#if (CAN_REPLAY_SUPPORTED != 0)
+    uint64_t ReplayMessages(const char* filename, const can_pcan_replay_t& options);
+#endif
 public:
     int ListCanDevices(void);
     int TestCanDevices(CANAPI_OpMode_t opMode);
@@ -327,7 +331,12 @@ int main(int argc, const char* argv[]) {
     }
 #endif
     fprintf(stdout, "OK!\n");
-    /* - parse and send messages */
+    /* - parse and send messages (or replay a trace file) */
+#if (CAN_REPLAY_SUPPORTED != 0)
+    if (opts.m_szReplayFile)
+        canDevice.ReplayMessages(opts.m_szReplayFile, opts.m_ReplayOptions);
+    else
+#endif
     canDevice.SendMessage();
     /* - stop trace session (if enabled) */
 #if (CAN_TRACE_SUPPORTED != 0)
@@ -380,6 +389,7 @@ uint64_t CCanDevice::SendMessage() {
 
     struct timespec t0;
     uint64_t dt = 0;
+    uint64_t deadline = 0;
     uint32_t data = 0;
 #if !defined(_WIN32) && !defined(_WIN64)
     fprintf(stdout, "\nEnter a message to send (or ^D to quit):\n");
@@ -402,24 +412,27 @@ uint64_t CCanDevice::SendMessage() {
             fprintf(stderr, "! Sorry, you entered an invalid message (syntax error)\n");
             continue;
         }
+        // t0 timestamp - start of the journey
+        t0 = CTimer::GetTime();
+        deadline = 0;
         // send message one or more times
         for (uint32_t i = 0; i < count; i++) {
-            // t0 timestamp - start of journey
-            t0 = CTimer::GetTime();
-            // send message, retry when busy
+            // send message, wait when busy (blocking write)
             do {
-                retVal = WriteMessage(message);
+                retVal = WriteMessage(message, TX_TIMEOUT);
             } while ((retVal == CCanApi::TransmitterBusy) && running);
             // abort on error
             if (retVal != CCanApi::NoError) {
                 fprintf(stderr, "! Sorry, the message could not be sent (error=%i)\n", retVal);
                 break;
             }
-            // t1 timestamp - end of journey
-            dt = CTimer::DiffTimeInUsec(t0, CTimer::GetTime());
-            // delay if t1-t0 < cycle time
-            if ((0 < cycle) && (dt < cycle)) {
-                CTimer::Delay(cycle - dt);
+            // delay until the next deadline (absolute, i.e. without drift)
+            if (0 < cycle) {
+                deadline += cycle;
+                dt = CTimer::DiffTimeInUsec(t0, CTimer::GetTime());
+                if (dt < deadline) {
+                    CTimer::Delay(deadline - dt);
+                }
             }
             // increment or decrement data
             data = (uint32_t)message.data[0]
@@ -444,6 +457,51 @@ uint64_t CCanDevice::SendMessage() {
     return 0;
 }
 
+#if (CAN_REPLAY_SUPPORTED != 0)
+uint64_t CCanDevice::ReplayMessages(const char* filename, const can_pcan_replay_t& options) {
+    can_pcan_replay_stats_t stats = {};
+    CANAPI_Return_t retVal;
+    uint64_t sum = 0;
+    int bin;
+
+    if (options.speed)
+        fprintf(stdout, "\nReplay of '%s' at %.2fx speed (or ^C to stop)...", filename, (double)options.speed / 100.);
+    else
+        fprintf(stdout, "\nReplay of '%s' at max. rate (or ^C to stop)...", filename);
+    fflush(stdout);
+    // send the messages of the trace file (blocking, until its end or ^C)
+    retVal = ReplayTrace(filename, options, stats);
+    if (retVal != CCanApi::NoError) {
+        fprintf(stdout, "FAILED!\n");
+        fprintf(stderr, "+++ error: trace file could not be replayed (%i)\n", retVal);
+        return 0;
+    }
+    fprintf(stdout, running ? "OK!\n" : "STOPPED!\n");
+    fprintf(stdout, "Messages=%" PRIu64 " sent, %" PRIu64 " failed, %" PRIu64 " of %" PRIu64 " records skipped\n",
+                    stats.sent, stats.failed, stats.skipped, stats.records);
+    fprintf(stdout, "Duration=%.3fs (read-ahead buffer %" PRIu64 " times empty)\n", (double)stats.elapsed / 1000000., stats.stalls);
+    // timing error: lateness to the deadlines (not at max. rate)
+    if (options.speed && stats.sent) {
+        for (bin = 0; bin < (PCAN_LATENCY_BINS - 1); bin++) {
+            if ((sum += stats.histogram[bin]) >= (stats.sent - stats.sent / 100))
+                break;
+        }
+        fprintf(stdout, "Lateness=%" PRIu32 "us min, %" PRIu32 "us avg, %" PRIu32 "us max, 99%% below %" PRIu64 "us\n",
+                        stats.min, stats.avg, stats.max, (bin < (PCAN_LATENCY_BINS - 1)) ? (uint64_t)2 << bin : (uint64_t)stats.max + 1);
+        for (bin = 0; bin < PCAN_LATENCY_BINS; bin++) {
+            if (stats.histogram[bin] == 0)
+                continue;
+            if (bin < (PCAN_LATENCY_BINS - 1))
+                fprintf(stdout, "  %7" PRIu64 " .. %7" PRIu64 "us: %" PRIu64 "\n",
+                                bin ? (uint64_t)1 << bin : (uint64_t)0, ((uint64_t)2 << bin) - 1, stats.histogram[bin]);
+            else
+                fprintf(stdout, "  %7" PRIu64 " us and more: %" PRIu64 "\n", (uint64_t)1 << bin, stats.histogram[bin]);
+        }
+    }
+    return stats.sent;
+}
+#endif
+
 /*  List all supported CAN devices from CAN device list :
  *  - wrapper library: the device list is hard-wired (cf. can_boards[])
  *  - loader library: the device list is read from JSON configurations files